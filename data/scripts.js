@@ -1041,6 +1041,12 @@ async function loadConfig() {
       if ($("touch-prev")) $("touch-prev").value = config.touch_prev !== undefined ? config.touch_prev : -1;
       if ($("touch-threshold")) $("touch-threshold").value = config.touch_threshold !== undefined ? config.touch_threshold : 40;
       if ($("touch-debounce")) $("touch-debounce").value = config.touch_debounce !== undefined ? config.touch_debounce : 50;
+      // MPD configuration
+      if ($("mpd-budget")) $("mpd-budget").value = config.mpd_budget !== undefined ? config.mpd_budget : 5;
+      if ($("mpd-timeout")) $("mpd-timeout").value = config.mpd_timeout !== undefined ? config.mpd_timeout : 60;
+      if ($("mpd-queue")) $("mpd-queue").value = config.mpd_queue !== undefined ? config.mpd_queue : 16384;
+      if ($("mpd-keepalive")) $("mpd-keepalive").value = config.mpd_keepalive !== undefined ? config.mpd_keepalive : 30;
+      if ($("control-port")) $("control-port").value = config.control_port !== undefined ? config.control_port : 0;
       
       // Populate display types dropdown with data from server
       if (config.displays && Array.isArray(config.displays)) {
@@ -1109,6 +1115,12 @@ async function saveConfig() {
     touch_prev: parseInt($("touch-prev").value),
     touch_threshold: parseInt($("touch-threshold").value),
     touch_debounce: parseInt($("touch-debounce").value),
+    // MPD configuration
+    mpd_budget: parseInt($("mpd-budget").value),
+    mpd_timeout: parseInt($("mpd-timeout").value),
+    mpd_queue: parseInt($("mpd-queue").value),
+    mpd_keepalive: parseInt($("mpd-keepalive").value),
+    control_port: parseInt($("control-port").value),
   };
   // Try to send the data to API
   try {
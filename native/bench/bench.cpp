@@ -0,0 +1,846 @@
+/*
+ * CubeRadio - In-process MPD benchmark
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "main.h"
+#include "mpd.h"
+#include "player.h"
+#include "playlist.h"
+#include "control.h"
+#include <Host.h>
+#include <HostHeap.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * @brief Benchmark scenario
+ * @details The request is written to the server in one piece, then the
+ * server is serviced until all expected responses (OK or ACK lines) arrived,
+ * at least once per iteration.
+ */
+struct Scenario {
+  const char* name;      ///< Scenario name, used to select it on the command line
+  const char* request;   ///< Protocol data sent per iteration
+  int responses;         ///< Number of OK/ACK terminated responses expected
+};
+
+static const Scenario scenarios[] = {
+  {"ping",         "ping\n",                                                   1},
+  {"status",       "status\n",                                                 1},
+  {"currentsong",  "currentsong\n",                                            1},
+  {"playlistinfo", "playlistinfo\n",                                           1},
+  {"setvol",       "setvol 50\n",                                              1},
+  {"play",         "play 0\n",                                                 1},
+  {"stop",         "stop\n",                                                   1},
+  {"unknown",      "foo bar\n",                                                1},
+  {"search",       "search Title radio\n",                                     1},
+  {"filter",       "search \"(Title contains 'radio')\"\n",                   1},
+  {"cmdlist",      "command_list_ok_begin\nstatus\ncurrentsong\ncommand_list_end\n", 1},
+  {"pipeline",     "ping\nping\nping\nping\nping\nping\nping\nping\n",         8},
+  {"statuses",     "status\nstatus\nstatus\nstatus\nstatus\nstatus\nstatus\nstatus\n", 8},
+  {"nothing",      "",                                                         0},
+};
+
+/**
+ * @brief Binary control protocol scenario
+ * @details One request frame per iteration, the MPD scenario doing the same
+ * is named for comparison.
+ */
+struct ControlScenario {
+  const char* name;      ///< Scenario name, used to select it on the command line
+  uint8_t op;            ///< Request operation
+  int32_t arg;           ///< Request argument
+  const char* mpd;       ///< Equivalent MPD scenario
+};
+
+static const ControlScenario controlScenarios[] = {
+  {"ctl-status", CONTROL_OP_STATUS, 0,  "status"},
+  {"ctl-volume", CONTROL_OP_VOLUME, 50, "setvol"},
+  {"ctl-play",   CONTROL_OP_PLAY,   0,  "play"},
+  {"ctl-stop",   CONTROL_OP_STOP,   0,  "stop"},
+};
+
+/**
+ * @brief HTTP scenario
+ * @details Every connection sends the request again as soon as the previous
+ * response arrived, so the server always has one request per connection.
+ */
+struct HTTPScenario {
+  const char* name;      ///< Scenario name, used to select it on the command line
+  const char* request;   ///< Request sent per iteration
+  bool reconnect;        ///< Open a new connection for every request
+  int responses;         ///< Responses to the request data, 0 for one
+};
+
+static const HTTPScenario httpScenarios[] = {
+  {"http-player",  "GET /api/player HTTP/1.1\r\nHost: bench\r\n\r\n", false},
+  {"http-mixer",   "POST /api/mixer HTTP/1.1\r\nHost: bench\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 9\r\n\r\nvolume=11", false},
+  {"http-streams", "GET /api/streams HTTP/1.1\r\nHost: bench\r\n\r\n", false},
+  {"http-static",  "GET /styles.css HTTP/1.1\r\nHost: bench\r\n\r\n", false},
+  {"http-export",  "GET /api/config/export HTTP/1.1\r\nHost: bench\r\n\r\n", false},
+  {"http-close",   "GET /api/player HTTP/1.1\r\nHost: bench\r\nConnection: close\r\n\r\n", true},
+  // Scene change: station 5, volume 12, bass 2, play, as separate requests and as one batch
+  {"scene-single", "POST /api/mixer HTTP/1.1\r\nHost: bench\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 9\r\n\r\nvolume=12"
+                   "POST /api/mixer HTTP/1.1\r\nHost: bench\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 6\r\n\r\nbass=2"
+                   "POST /api/player HTTP/1.1\r\nHost: bench\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 19\r\n\r\naction=play&index=5"
+                   "GET /api/streams HTTP/1.1\r\nHost: bench\r\n\r\n", false, 4},
+  {"scene-batch",  "POST /api/batch HTTP/1.1\r\nHost: bench\r\nContent-Type: application/json\r\nContent-Length: 89\r\n\r\n"
+                   "[{\"action\":\"select\",\"index\":5},{\"action\":\"mixer\",\"volume\":12,\"bass\":2},{\"action\":\"play\"}]",
+                   false},
+};
+
+// Extra connections kept in idle mode during the scenarios
+static std::vector<WiFiClient> idleClients;
+
+/**
+ * @brief Service the idle connections
+ * @details Reads the notifications sent to the idle connections and puts
+ * them back into idle mode, like an MPD client waiting for changes does.
+ */
+static void serviceIdleClients() {
+  char buf[256];
+  for (WiFiClient& idle : idleClients) {
+    int n = idle.read((uint8_t*)buf, sizeof(buf));
+    if (n > 0) {
+      idle.write((const uint8_t*)"idle\n", 5);
+    }
+  }
+}
+
+/**
+ * @brief Result of one scenario
+ */
+struct Result {
+  uint64_t allocations;  ///< Heap allocations made by the server
+  uint64_t writes;       ///< Socket writes (TCP segments) made by the server
+  uint64_t serverNs;     ///< Time spent inside handleClient()
+  uint64_t totalNs;      ///< Round trip time, including the client side
+  uint64_t bytes;        ///< Response bytes received
+  uint64_t calls;        ///< Number of handleClient() calls
+};
+
+/**
+ * @brief Count complete responses in the received data
+ * @details A response ends with a line that is "OK" or starts with "ACK".
+ * @param data Received data
+ * @return Number of complete responses
+ */
+static int countResponses(const std::string& data) {
+  int count = 0;
+  size_t start = 0;
+  size_t eol;
+  while ((eol = data.find('\n', start)) != std::string::npos) {
+    if (data.compare(start, eol - start, "OK") == 0 || data.compare(start, 3, "ACK") == 0) {
+      count++;
+    }
+    start = eol + 1;
+  }
+  return count;
+}
+
+/**
+ * @brief Get a monotonic timestamp
+ * @return Nanoseconds
+ */
+static uint64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Run one scenario
+ * @details Heap allocations and socket writes are counted only inside
+ * handleClient(), so the client side of the benchmark does not show up in
+ * the figures.
+ * @param client Connected client
+ * @param sc Scenario to run
+ * @param iterations Number of iterations
+ * @return Accumulated result
+ */
+static Result runScenario(WiFiClient& client, const Scenario& sc, int iterations) {
+  Result r = {0, 0, 0, 0, 0, 0};
+  std::string data;
+  data.reserve(16384);
+  char buf[4096];
+  size_t reqLen = strlen(sc.request);
+  for (int i = 0; i < iterations; i++) {
+    data.clear();
+    uint64_t start = nowNs();
+    if (reqLen > 0) {
+      client.write((const uint8_t*)sc.request, reqLen);
+    }
+    do {
+      uint64_t allocs = hostHeapStats().allocations;
+      uint64_t writes = hostSocketWrites();
+      uint64_t t0 = nowNs();
+      mpdInterface.handleClient();
+      r.serverNs += nowNs() - t0;
+      r.allocations += hostHeapStats().allocations - allocs;
+      r.writes += hostSocketWrites() - writes;
+      r.calls++;
+      int n;
+      while ((n = client.read((uint8_t*)buf, sizeof(buf))) > 0) {
+        data.append(buf, n);
+        r.bytes += n;
+      }
+      serviceIdleClients();
+    } while (countResponses(data) < sc.responses);
+    r.totalNs += nowNs() - start;
+  }
+  return r;
+}
+
+/**
+ * @brief Run one binary control scenario
+ * @details Same measurements as runScenario(), around
+ * ControlInterface::handleClient().
+ * @param client Connected control client
+ * @param sc Scenario to run
+ * @param iterations Number of iterations
+ * @return Accumulated result
+ */
+static Result runControlScenario(WiFiClient& client, const ControlScenario& sc, int iterations) {
+  Result r = {0, 0, 0, 0, 0, 0};
+  uint8_t request[CONTROL_REQUEST_SIZE] = {CONTROL_MAGIC, sc.op, 0, 0,
+                                           (uint8_t)sc.arg, (uint8_t)(sc.arg >> 8),
+                                           (uint8_t)(sc.arg >> 16), (uint8_t)(sc.arg >> 24)};
+  uint8_t buf[256];
+  for (int i = 0; i < iterations; i++) {
+    request[2] = (uint8_t)i;
+    uint64_t start = nowNs();
+    client.write(request, sizeof(request));
+    size_t received = 0;
+    do {
+      uint64_t allocs = hostHeapStats().allocations;
+      uint64_t writes = hostSocketWrites();
+      uint64_t t0 = nowNs();
+      controlInterface.handleClient();
+      r.serverNs += nowNs() - t0;
+      r.allocations += hostHeapStats().allocations - allocs;
+      r.writes += hostSocketWrites() - writes;
+      r.calls++;
+      int n;
+      while ((n = client.read(buf, sizeof(buf))) > 0) {
+        received += n;
+        r.bytes += n;
+      }
+    } while (received < CONTROL_STATUS_SIZE);
+    r.totalNs += nowNs() - start;
+  }
+  return r;
+}
+
+/**
+ * @brief Get the length of the first complete HTTP response
+ * @details Chunked bodies end with the last, empty chunk.
+ * @param data Received data
+ * @return Length of the response, 0 if not complete yet
+ */
+static size_t httpResponseLength(const std::string& data) {
+  size_t headEnd = data.find("\r\n\r\n");
+  if (headEnd == std::string::npos) {
+    return 0;
+  }
+  size_t chunked = data.find("Transfer-Encoding: chunked");
+  if (chunked != std::string::npos && chunked < headEnd) {
+    size_t pos = headEnd + 4;
+    while (true) {
+      size_t eol = data.find("\r\n", pos);
+      if (eol == std::string::npos) {
+        return 0;
+      }
+      size_t size = strtoul(data.c_str() + pos, nullptr, 16);
+      if (data.size() < eol + 2 + size + 2) {
+        return 0;
+      }
+      pos = eol + 2 + size + 2;
+      if (size == 0) {
+        return pos;
+      }
+    }
+  }
+  size_t length = 0;
+  size_t pos = data.find("Content-Length: ");
+  if (pos != std::string::npos && pos < headEnd) {
+    length = strtoul(data.c_str() + pos + 16, nullptr, 10);
+  }
+  size_t total = headEnd + 4 + length;
+  return data.size() >= total ? total : 0;
+}
+
+/**
+ * @brief Run one HTTP scenario over several connections at once
+ * @details Same measurements as runScenario(), around
+ * HTTPServer::handleClient(), for all connections together. With a slow
+ * client, one more connection uploads a request body a byte per pass,
+ * which must not slow the others down.
+ * @param port Web server port
+ * @param sc Scenario to run
+ * @param iterations Number of requests (or request groups), over all connections
+ * @param concurrency Number of connections
+ * @param slow Add the slow uploading connection
+ * @return Accumulated result
+ */
+static Result runHTTPScenario(uint16_t port, const HTTPScenario& sc, int iterations, int concurrency, bool slow) {
+  Result r = {0, 0, 0, 0, 0, 0};
+  std::vector<WiFiClient> clients(concurrency);
+  std::vector<std::string> data(concurrency);
+  std::vector<int> received(concurrency);
+  int responses = sc.responses > 0 ? sc.responses : 1;
+  size_t reqLen = strlen(sc.request);
+  int sent = 0;
+  int done = 0;
+  char buf[4096];
+  WiFiClient slowClient;
+  int slowRemaining = 30000;
+  if (slow && slowClient.connect("127.0.0.1", port)) {
+    static const char head[] = "POST /api/mixer HTTP/1.1\r\nHost: bench\r\n"
+                               "Content-Type: application/json\r\nContent-Length: 30000\r\n\r\n";
+    slowClient.write((const uint8_t*)head, sizeof(head) - 1);
+  }
+  uint64_t start = nowNs();
+  for (int i = 0; i < concurrency && sent < iterations; i++, sent++) {
+    clients[i].connect("127.0.0.1", port);
+    clients[i].setNoDelay(true);
+    clients[i].write((const uint8_t*)sc.request, reqLen);
+  }
+  while (done < iterations) {
+    if (slowClient && slowRemaining > 0) {
+      slowClient.write((const uint8_t*)" ", 1);
+      slowRemaining--;
+    }
+    uint64_t allocs = hostHeapStats().allocations;
+    uint64_t writes = hostSocketWrites();
+    uint64_t t0 = nowNs();
+    server.handleClient();
+    r.serverNs += nowNs() - t0;
+    r.allocations += hostHeapStats().allocations - allocs;
+    r.writes += hostSocketWrites() - writes;
+    r.calls++;
+    for (int i = 0; i < concurrency; i++) {
+      int n;
+      while ((n = clients[i].read((uint8_t*)buf, sizeof(buf))) > 0) {
+        data[i].append(buf, n);
+        r.bytes += n;
+      }
+      size_t length = httpResponseLength(data[i]);
+      if (length == 0) {
+        continue;
+      }
+      data[i].erase(0, length);
+      if (++received[i] < responses) {
+        continue;
+      }
+      received[i] = 0;
+      done++;
+      if (sent < iterations) {
+        if (sc.reconnect) {
+          clients[i].stop();
+          clients[i].connect("127.0.0.1", port);
+          clients[i].setNoDelay(true);
+        }
+        clients[i].write((const uint8_t*)sc.request, reqLen);
+        sent++;
+      }
+    }
+  }
+  r.totalNs = nowNs() - start;
+  for (WiFiClient& client : clients) {
+    client.stop();
+  }
+  slowClient.stop();
+  // Let the server notice the closed connections before the next scenario
+  for (int i = 0; i < 10; i++) {
+    server.handleClient();
+  }
+  return r;
+}
+
+/**
+ * @brief Build a playlist upload like a radio directory export
+ * @details Each station carries the fields a directory such as
+ * radio-browser.info returns, most of them unused by the importer.
+ * @param stations Number of stations
+ * @return JSON array text
+ */
+static std::string importBody(int stations) {
+  std::string body = "[";
+  char item[512];
+  for (int i = 0; i < stations; i++) {
+    snprintf(item, sizeof(item),
+             "%s{\"changeuuid\":\"c%07d-0000-4000-8000-000000000000\","
+             "\"stationuuid\":\"s%07d-0000-4000-8000-000000000000\","
+             "\"name\":\"Bench Station %d\",\"url\":\"http://stream.example.com:8000/station%d.mp3\","
+             "\"url_resolved\":\"http://stream.example.com:8000/station%d.mp3\","
+             "\"homepage\":\"https://station%d.example.com/\",\"favicon\":\"\","
+             "\"tags\":\"pop,rock,news\",\"country\":\"Romania\",\"countrycode\":\"RO\","
+             "\"codec\":\"MP3\",\"bitrate\":128,\"hls\":0,\"votes\":%d}",
+             i ? "," : "", i, i, i, i, i, i, i * 7);
+    body += item;
+  }
+  body += "]";
+  return body;
+}
+
+// Peak heap growth allowed for a playlist upload, whatever its size: the
+// staging playlist, the parser and the save of the new playlist
+#define IMPORT_HEAP_LIMIT 32768
+
+/**
+ * @brief Read a file from SPIFFS
+ * @param path File path
+ * @return File contents, empty if missing
+ */
+static std::string readSPIFFS(const char* path) {
+  std::string text;
+  File file = SPIFFS.open(path, "r");
+  if (!file) {
+    return text;
+  }
+  char buf[512];
+  size_t n;
+  while ((n = file.read((uint8_t*)buf, sizeof(buf))) > 0) {
+    text.append(buf, n);
+  }
+  file.close();
+  return text;
+}
+
+/**
+ * @brief Check the playlist an upload of importBody() left behind
+ * @details Both the playlist in memory and playlist.json must hold the
+ * uploaded stations, in order.
+ * @param stations Number of stations uploaded
+ * @return true if both match the upload
+ */
+static bool checkImportedPlaylist(int stations) {
+  DynamicJsonDocument doc(PLAYLIST_BUFFER_SIZE);
+  if (deserializeJson(doc, readSPIFFS("/playlist.json")) || !doc.is<JsonArray>()) {
+    fprintf(stderr, "Import: playlist.json is missing or invalid\n");
+    return false;
+  }
+  JsonArray saved = doc.as<JsonArray>();
+  if (player.getPlaylistCount() != stations || (int)saved.size() != stations) {
+    fprintf(stderr, "Import: %d stations uploaded, %d in the playlist, %d saved\n",
+            stations, player.getPlaylistCount(), (int)saved.size());
+    return false;
+  }
+  char name[STREAM_NAME_SIZE];
+  char url[STREAM_URL_SIZE];
+  for (int i = 0; i < stations; i++) {
+    snprintf(name, sizeof(name), "Bench Station %d", i);
+    snprintf(url, sizeof(url), "http://stream.example.com:8000/station%d.mp3", i);
+    const StreamInfo& item = player.getPlaylistItem(i);
+    if (strcmp(item.name, name) || strcmp(item.url, url) ||
+        strcmp(saved[i]["name"] | "", name) || strcmp(saved[i]["url"] | "", url)) {
+      fprintf(stderr, "Import: station %d differs from the upload\n", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Upload a playlist to POST /api/streams and check the outcome
+ * @details The body is written in segment sized pieces with the server
+ * serviced in between, as it would arrive over WiFi. An upload that fits
+ * the playlist must be accepted and replace both the playlist and
+ * playlist.json; a larger one must be parsed to its end, rejected with
+ * "Playlist exceeds maximum size" and leave both unchanged. Either way the
+ * peak heap growth must stay below IMPORT_HEAP_LIMIT, as the upload is
+ * parsed as it arrives instead of being held in memory.
+ * @param port Web server port
+ * @param stations Number of stations in the upload
+ * @param iterations Number of uploads
+ * @param peak Set to the largest peak heap growth of an upload
+ * @param ok Cleared if any check failed
+ * @return Accumulated result
+ */
+static Result runImport(uint16_t port, int stations, int iterations, size_t& peak, bool& ok) {
+  Result r = {0, 0, 0, 0, 0, 0};
+  std::string body = importBody(stations);
+  std::string request = "POST /api/streams HTTP/1.1\r\nHost: bench\r\nContent-Type: application/json\r\n"
+                        "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+  bool accepted = stations <= MAX_PLAYLIST_SIZE;
+  const char* expected = accepted ? "Playlist updated successfully" : "Playlist exceeds maximum size";
+  std::string data;
+  char buf[4096];
+  peak = 0;
+  uint64_t start = nowNs();
+  for (int i = 0; i < iterations; i++) {
+    std::string savedBefore = readSPIFFS("/playlist.json");
+    uint32_t versionBefore = player.getPlaylistVersion();
+    WiFiClient client;
+    client.connect("127.0.0.1", port);
+    size_t offset = 0;
+    size_t length = 0;
+    data.clear();
+    hostHeapResetPeak();
+    size_t base = hostHeapStats().bytesInUse;
+    while (length == 0) {
+      if (offset < request.size()) {
+        size_t n = std::min((size_t)1460, request.size() - offset);
+        offset += client.write((const uint8_t*)request.data() + offset, n);
+      }
+      uint64_t allocs = hostHeapStats().allocations;
+      unsigned long long writes = hostSocketWrites();
+      uint64_t t0 = nowNs();
+      server.handleClient();
+      r.serverNs += nowNs() - t0;
+      r.allocations += hostHeapStats().allocations - allocs;
+      r.writes += hostSocketWrites() - writes;
+      r.calls++;
+      int n;
+      while ((n = client.read((uint8_t*)buf, sizeof(buf))) > 0) {
+        data.append(buf, n);
+      }
+      length = httpResponseLength(data);
+    }
+    size_t growth = hostHeapStats().peakBytes - base;
+    peak = std::max(peak, growth);
+    r.bytes += body.size();
+    client.stop();
+    // The response, then what the upload left behind
+    bool status = data.compare(0, 12, accepted ? "HTTP/1.1 200" : "HTTP/1.1 400") == 0;
+    if (!status || data.find(expected) == std::string::npos) {
+      fprintf(stderr, "Import of %d stations: expected \"%s\", got:\n%s\n", stations, expected,
+              data.substr(0, length).c_str());
+      ok = false;
+    }
+    if (accepted) {
+      ok = checkImportedPlaylist(stations) && ok;
+    } else if (readSPIFFS("/playlist.json") != savedBefore || player.getPlaylistVersion() != versionBefore) {
+      fprintf(stderr, "Import of %d stations: rejected upload changed the playlist\n", stations);
+      ok = false;
+    }
+    if (growth >= IMPORT_HEAP_LIMIT) {
+      fprintf(stderr, "Import of %d stations: heap grew by %zu bytes, limit %d\n", stations, growth,
+              IMPORT_HEAP_LIMIT);
+      ok = false;
+    }
+  }
+  r.totalNs = nowNs() - start;
+  for (int i = 0; i < 10; i++) {
+    server.handleClient();
+  }
+  return r;
+}
+
+/**
+ * @brief Measure the binary request handling alone
+ * @details Times ControlInterface::execute() on status requests, without
+ * the socket calls, to compare with the MPD dispatch figure.
+ * @param iterations Number of requests
+ */
+static void runControlExecute(int iterations) {
+  uint8_t request[CONTROL_REQUEST_SIZE] = {CONTROL_MAGIC, CONTROL_OP_STATUS, 0, 0, 0, 0, 0, 0};
+  uint8_t reply[CONTROL_STATUS_SIZE];
+  unsigned sum = 0;
+  uint64_t allocs = hostHeapStats().allocations;
+  uint64_t t0 = nowNs();
+  for (int i = 0; i < iterations; i++) {
+    request[2] = (uint8_t)i;
+    controlInterface.execute(request, reply);
+    sum += reply[2];
+  }
+  uint64_t elapsed = nowNs() - t0;
+  printf("%-14s %10d %10.2f %10s %12.4f %12s %10d\n", "ctl-execute", iterations,
+         (double)(hostHeapStats().allocations - allocs) / iterations, "-",
+         elapsed / 1000.0 / iterations, "-", (int)(sum > 0) * CONTROL_STATUS_SIZE);
+}
+
+/**
+ * @brief Measure the command lookup alone
+ * @details Looks up every name the server reports with "commands", plus an
+ * unknown one, and reports the average time per lookup. Names that cannot be
+ * found point to an unsorted registry.
+ * @param client Connected client
+ * @param iterations Number of passes over all names
+ * @return true if every reported command was found
+ */
+static bool runDispatch(WiFiClient& client, int iterations) {
+  // Collect the command names
+  static const Scenario commands = {"commands", "commands\n", 1};
+  std::string data;
+  char buf[4096];
+  client.write((const uint8_t*)commands.request, strlen(commands.request));
+  while (countResponses(data) < commands.responses) {
+    mpdInterface.handleClient();
+    int n;
+    while ((n = client.read((uint8_t*)buf, sizeof(buf))) > 0) {
+      data.append(buf, n);
+    }
+  }
+  std::vector<std::string> names;
+  size_t start = 0;
+  size_t eol;
+  while ((eol = data.find('\n', start)) != std::string::npos) {
+    if (data.compare(start, 9, "command: ") == 0) {
+      names.push_back(data.substr(start + 9, eol - start - 9));
+    }
+    start = eol + 1;
+  }
+  names.push_back("unknowncommand");
+  // Every reported command must resolve, except the unknown one
+  bool ok = true;
+  for (size_t i = 0; i + 1 < names.size(); i++) {
+    if (!MPDInterface::findCommand(names[i].c_str(), names[i].length())) {
+      fprintf(stderr, "Command not found in registry: %s\n", names[i].c_str());
+      ok = false;
+    }
+  }
+  // Time the lookups
+  size_t found = 0;
+  uint64_t t0 = nowNs();
+  for (int i = 0; i < iterations; i++) {
+    for (const std::string& name : names) {
+      found += MPDInterface::findCommand(name.c_str(), name.length()) != nullptr;
+    }
+  }
+  uint64_t elapsed = nowNs() - t0;
+  uint64_t lookups = (uint64_t)iterations * names.size();
+  printf("%-14s %10llu %10s %10s %12.4f %12s %10zu\n", "dispatch", (unsigned long long)lookups, "-", "-",
+         elapsed / 1000.0 / lookups, "-", found / iterations);
+  return ok;
+}
+
+/**
+ * @brief Check if a scenario was selected on the command line
+ * @param name Scenario name
+ * @param argc Argument count
+ * @param argv Arguments, scenario names start at optind
+ * @return true if selected, or if no scenario was named
+ */
+static bool isSelected(const char* name, int argc, char* argv[]) {
+  if (optind >= argc) {
+    return true;
+  }
+  for (int i = optind; i < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Print command line help
+ * @param name Program name
+ */
+static void usage(const char* name) {
+  printf("Usage: %s [-n iterations] [-i clients] [-p port] [-s dir] [-P] [-C num] [-S] [scenario ...]\n", name);
+  printf("  -n num   iterations per scenario (default 2000)\n");
+  printf("  -i num   extra connections kept in idle mode (default 0)\n");
+  printf("  -p port  MPD port used for the loopback connection (default 6690)\n");
+  printf("  -s dir   seed SPIFFS with the JSON files from dir (default: data)\n");
+  printf("  -P       play the first stream, with a stream title, before the scenarios\n");
+  printf("  -C num   concurrent connections of the HTTP scenarios (default %d)\n", HTTP_MAX_CLIENTS - 1);
+  printf("  -S       add a slow uploading connection to the HTTP scenarios\n");
+  printf("Scenarios:");
+  for (const Scenario& sc : scenarios) {
+    printf(" %s", sc.name);
+  }
+  for (const ControlScenario& sc : controlScenarios) {
+    printf(" %s", sc.name);
+  }
+  for (const HTTPScenario& sc : httpScenarios) {
+    printf(" %s", sc.name);
+  }
+  printf(" import-20 import-1000 ctl-execute dispatch\n");
+}
+
+/**
+ * @brief Benchmark entry point
+ * @details Starts the MPD server in-process, connects one client over the
+ * loopback interface and runs the selected scenarios back to back.
+ */
+int main(int argc, char* argv[]) {
+  int iterations = 2000;
+  int idleCount = 0;
+  uint16_t port = 6690;
+  const char* seedDir = "data";
+  bool playing = false;
+  int concurrency = HTTP_MAX_CLIENTS - 1;
+  bool slow = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:i:p:s:PC:Sh")) != -1) {
+    switch (opt) {
+      case 'n': iterations = atoi(optarg); break;
+      case 'i': idleCount = atoi(optarg); break;
+      case 'p': port = (uint16_t)atoi(optarg); break;
+      case 's': seedDir = optarg; break;
+      case 'P': playing = true; break;
+      case 'C': concurrency = atoi(optarg); break;
+      case 'S': slow = true; break;
+      default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+    }
+  }
+  Serial.setEnabled(false);
+  if (!SPIFFS.begin(true)) {
+    fprintf(stderr, "Failed to initialize SPIFFS\n");
+    return 1;
+  }
+  seedFilesystem(seedDir);
+  player.setupAudioOutput();
+  player.loadPlaylist();
+  player.getPlaylist()->validate();
+  player.loadPlayerState();
+  if (playing && player.getPlaylistCount() > 0) {
+    // status and currentsong report the full stream details while playing
+    player.setPlaylistIndex(0);
+    const StreamInfo& item = player.getPlaylistItem(0);
+    player.startStream(item.url, item.name);
+    // Connect, as the audio task would
+    player.handleAudio();
+    player.setStreamTitle("Some Artist - Some Title");
+    player.setBitrate(128);
+  }
+  mpdServer.begin(port);
+  if (!mpdServer) {
+    fprintf(stderr, "Failed to listen on port %u\n", port);
+    return 1;
+  }
+  // Connect and consume the greeting
+  WiFiClient client;
+  if (!client.connect("127.0.0.1", port)) {
+    fprintf(stderr, "Failed to connect to port %u\n", port);
+    return 1;
+  }
+  client.setNoDelay(true);
+  std::string greeting;
+  char buf[256];
+  while (greeting.find('\n') == std::string::npos) {
+    mpdInterface.handleClient();
+    int n = client.read((uint8_t*)buf, sizeof(buf));
+    if (n > 0) {
+      greeting.append(buf, n);
+    }
+  }
+  // Park the extra connections in idle mode
+  for (int i = 0; i < idleCount; i++) {
+    WiFiClient idle;
+    if (!idle.connect("127.0.0.1", port)) {
+      fprintf(stderr, "Failed to connect to port %u\n", port);
+      return 1;
+    }
+    idle.setNoDelay(true);
+    idle.write((const uint8_t*)"idle\n", 5);
+    idleClients.push_back(idle);
+  }
+  for (int i = 0; i < 10; i++) {
+    mpdInterface.handleClient();
+    serviceIdleClients();
+  }
+  printf("%-14s %10s %10s %10s %12s %12s %10s\n", "scenario", "iter", "allocs/it", "writes/it",
+         "server us/it", "total us/it", "bytes/it");
+  for (const Scenario& sc : scenarios) {
+    if (!isSelected(sc.name, argc, argv)) {
+      continue;
+    }
+    // Warm up, so one time allocations do not count
+    runScenario(client, sc, 10);
+    Result r = runScenario(client, sc, iterations);
+    printf("%-14s %10d %10.2f %10.2f %12.2f %12.2f %10.0f\n", sc.name, iterations,
+           (double)r.allocations / iterations,
+           (double)r.writes / iterations,
+           r.serverNs / 1000.0 / iterations,
+           r.totalNs / 1000.0 / iterations,
+           (double)r.bytes / iterations);
+  }
+  // Binary control protocol, on the next port
+  controlServer.begin(port + 1);
+  WiFiClient control;
+  if (!controlServer || !control.connect("127.0.0.1", port + 1)) {
+    fprintf(stderr, "Failed to connect to port %u\n", port + 1);
+    return 1;
+  }
+  control.setNoDelay(true);
+  for (const ControlScenario& sc : controlScenarios) {
+    if (!isSelected(sc.name, argc, argv)) {
+      continue;
+    }
+    runControlScenario(control, sc, 10);
+    Result r = runControlScenario(control, sc, iterations);
+    printf("%-14s %10d %10.2f %10.2f %12.2f %12.2f %10.0f\n", sc.name, iterations,
+           (double)r.allocations / iterations,
+           (double)r.writes / iterations,
+           r.serverNs / 1000.0 / iterations,
+           r.totalNs / 1000.0 / iterations,
+           (double)r.bytes / iterations);
+  }
+  control.stop();
+  // Web server, on the port after the control one
+  setupHostWebServer();
+  server.begin(port + 2);
+  if (!webServer) {
+    fprintf(stderr, "Failed to listen on port %u\n", port + 2);
+    return 1;
+  }
+  for (const HTTPScenario& sc : httpScenarios) {
+    if (!isSelected(sc.name, argc, argv)) {
+      continue;
+    }
+    runHTTPScenario(port + 2, sc, 10, concurrency, false);
+    Result r = runHTTPScenario(port + 2, sc, iterations, concurrency, slow);
+    printf("%-14s %10d %10.2f %10.2f %12.2f %12.2f %10.0f\n", sc.name, iterations,
+           (double)r.allocations / iterations,
+           (double)r.writes / iterations,
+           r.serverNs / 1000.0 / iterations,
+           r.totalNs / 1000.0 / iterations,
+           (double)r.bytes / iterations);
+  }
+  // Streamed playlist uploads, checked as they run; the bytes column is the
+  // upload size and the peak heap growth follows on its own line. 1000
+  // stations exceed the playlist, so that upload must be rejected
+  bool ok = true;
+  static const int importSizes[] = {20, 1000};
+  for (int stations : importSizes) {
+    std::string name = "import-" + std::to_string(stations);
+    if (!isSelected(name.c_str(), argc, argv)) {
+      continue;
+    }
+    int uploads = std::max(1, iterations / 100);
+    size_t peak = 0;
+    Result r = runImport(port + 2, stations, uploads, peak, ok);
+    printf("%-14s %10d %10.2f %10.2f %12.2f %12.2f %10.0f\n", name.c_str(), uploads,
+           (double)r.allocations / uploads,
+           (double)r.writes / uploads,
+           r.serverNs / 1000.0 / uploads,
+           r.totalNs / 1000.0 / uploads,
+           (double)r.bytes / uploads);
+    printf("%-14s peak heap growth %zu bytes\n", "", peak);
+  }
+  if (isSelected("ctl-execute", argc, argv)) {
+    // Request handling alone, columns are requests, us/request and frame size
+    runControlExecute(iterations * 50);
+  }
+  if (isSelected("dispatch", argc, argv)) {
+    // Command lookup alone, columns are lookups, us/lookup and commands found
+    ok = runDispatch(client, iterations) && ok;
+  }
+  client.stop();
+  for (WiFiClient& idle : idleClients) {
+    idle.stop();
+  }
+  return ok ? 0 : 1;
+}
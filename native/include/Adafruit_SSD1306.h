@@ -0,0 +1,27 @@
+/*
+ * CubeRadio - Host-native Adafruit SSD1306 stub
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADAFRUIT_SSD1306_H
+#define ADAFRUIT_SSD1306_H
+
+#include <Adafruit_GFX.h>
+
+// The display driver is not part of the host build
+class Adafruit_SSD1306 : public Adafruit_GFX {};
+
+#endif // ADAFRUIT_SSD1306_H
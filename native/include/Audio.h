@@ -0,0 +1,70 @@
+/*
+ * CubeRadio - Host-native stub of the ESP32-audioI2S Audio class
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIO_H_STUB
+#define AUDIO_H_STUB
+
+#include <Arduino.h>
+
+/**
+ * @brief Audio decoder stub
+ * @details Accepts every call the Player makes and pretends to be playing a
+ * 128 kbps MP3 stream once connecttohost() succeeds. No audio is decoded.
+ */
+class Audio {
+public:
+  explicit Audio(bool internalDAC = false, uint8_t channelEnabled = 3, uint8_t i2sPort = 0) {
+    (void)internalDAC;
+    (void)channelEnabled;
+    (void)i2sPort;
+  }
+  bool setPinout(uint8_t bclk, uint8_t lrc, uint8_t dout, int8_t mclk = -1) {
+    (void)bclk; (void)lrc; (void)dout; (void)mclk;
+    return true;
+  }
+  void setBufsize(int rambuf_sz, int psrambuf_sz) { (void)rambuf_sz; (void)psrambuf_sz; }
+  void setVolume(uint8_t vol) { volume = vol; }
+  uint8_t getVolume() { return volume; }
+  void setTone(int8_t low, int8_t band, int8_t high) { (void)low; (void)band; (void)high; }
+  bool connecttohost(const char* host, const char* user = "", const char* pwd = "") {
+    (void)user;
+    (void)pwd;
+    running = host && (strncmp(host, "http://", 7) == 0 || strncmp(host, "https://", 8) == 0);
+    return running;
+  }
+  bool stopSong() {
+    bool wasRunning = running;
+    running = false;
+    return wasRunning;
+  }
+  bool isRunning() { return running; }
+  void loop() {}
+  uint32_t getBitRate(bool avg = false) { (void)avg; return running ? 128000 : 0; }
+  uint32_t getSampleRate() { return running ? 44100 : 0; }
+  uint8_t getBitsPerSample() { return running ? 16 : 0; }
+  uint8_t getChannels() { return running ? 2 : 0; }
+  const char* getCodecname() { return running ? "MP3" : ""; }
+  uint32_t inBufferFilled() { return running ? 4096 : 0; }
+  uint32_t inBufferFree() { return running ? 4096 : 8192; }
+
+private:
+  bool running = false;  ///< Simulated playback state
+  uint8_t volume = 0;    ///< Last volume set
+};
+
+#endif // AUDIO_H_STUB
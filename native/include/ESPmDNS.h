@@ -0,0 +1,32 @@
+/*
+ * CubeRadio - Host-native mDNS stub
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESPMDNS_H
+#define ESPMDNS_H
+
+#include <Arduino.h>
+
+// Service advertisement is not available in the host build
+class MDNSResponder {
+public:
+  bool begin(const char* hostName) { (void)hostName; return true; }
+  void addService(const char* service, const char* proto, uint16_t port) { (void)service; (void)proto; (void)port; }
+};
+extern MDNSResponder MDNS;
+
+#endif // ESPMDNS_H
@@ -0,0 +1,105 @@
+/*
+ * CubeRadio - Host-native filesystem shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FS_H
+#define FS_H
+
+#include <Arduino.h>
+#include <memory>
+
+namespace fs {
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+/**
+ * @brief File handle backed by a stdio stream
+ * @details Copies share the same stream, which is closed by close() or when
+ * the last copy is destroyed, matching the ESP32 fs::File semantics.
+ */
+class File : public Stream {
+public:
+  File() {}
+  File(FILE* fp, const char* path);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* buffer, size_t size);
+  int peek() override;
+  void flush() override;
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char* name() const;
+  const char* path() const;
+  bool isDirectory() const { return false; }
+  File openNextFile(const char* mode = FILE_READ) { (void)mode; return File(); }
+
+private:
+  struct Handle;
+  std::shared_ptr<Handle> handle;  ///< Shared stdio stream
+};
+
+/**
+ * @brief Flat filesystem rooted in a host directory
+ * @details Paths such as "/playlist.json" map to files inside the root
+ * directory, which defaults to a fresh temporary directory.
+ */
+class FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10, const char* partitionLabel = nullptr);
+  void end() {}
+  bool format();
+  File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+  File open(const String& path, const char* mode = FILE_READ, const bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* pathFrom, const char* pathTo);
+  bool rename(const String& pathFrom, const String& pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+  size_t totalBytes() { return 1024 * 1024; }
+  size_t usedBytes();
+
+  // Host only: select the directory backing the filesystem
+  void setRoot(const char* dir);
+  const char* getRoot();
+
+private:
+  String root;  ///< Host directory backing the filesystem
+  String hostPath(const char* path);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // FS_H
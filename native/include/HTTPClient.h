@@ -0,0 +1,35 @@
+/*
+ * CubeRadio - Host-native HTTPClient stub
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <WiFi.h>
+
+// Outgoing HTTP requests are not available in the host build
+class HTTPClient {
+public:
+  bool begin(const String& url) { (void)url; return false; }
+  void setTimeout(uint16_t timeout) { (void)timeout; }
+  int GET() { return -1; }
+  int getSize() { return -1; }
+  WiFiClient* getStreamPtr() { return nullptr; }
+  void end() {}
+};
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,52 @@
+/*
+ * CubeRadio - Helpers shared by the host-native programs
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+class Player;
+class MPDInterface;
+class ArtCache;
+class ControlInterface;
+
+// Globals defined in native/src/globals.cpp, as main.cpp does on the device
+extern Player player;
+extern ArtCache artCache;
+extern MPDInterface mpdInterface;
+extern ControlInterface controlInterface;
+
+/**
+ * @brief Copy the JSON files of a directory into the SPIFFS root
+ * @param dir Source directory
+ */
+void seedFilesystem(const char* dir);
+
+/**
+ * @brief Register the web routes served by the host programs
+ */
+void setupHostWebServer();
+
+/**
+ * @brief Number of send() calls made by all WiFiClient objects
+ * @details With TCP_NODELAY each call leaves as at least one TCP segment, so
+ * this is the segment count the firmware would produce for the same traffic.
+ * @return Send calls since start
+ */
+unsigned long long hostSocketWrites();
+
+#endif // HOST_H
@@ -0,0 +1,49 @@
+/*
+ * CubeRadio - Host-native heap accounting
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOSTHEAP_H
+#define HOSTHEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Heap counters of the host process
+ * @details Updated by the malloc family wrappers in native/src/heap.cpp, so
+ * every String, ArduinoJson document and STL container is accounted for.
+ */
+struct HostHeapStats {
+  uint64_t allocations;  ///< Number of successful malloc/calloc/realloc calls
+  uint64_t frees;        ///< Number of free calls with a non-null pointer
+  size_t bytesInUse;     ///< Bytes currently allocated
+  size_t peakBytes;      ///< Highest value of bytesInUse
+};
+
+/**
+ * @brief Get a snapshot of the heap counters
+ * @return Current counter values
+ */
+HostHeapStats hostHeapStats();
+
+/**
+ * @brief Restart the peak tracking from the bytes currently in use
+ * @details Lets a benchmark measure the peak of one operation alone.
+ */
+void hostHeapResetPeak();
+
+#endif // HOSTHEAP_H
@@ -0,0 +1,30 @@
+/*
+ * CubeRadio - Host-native SPIFFS shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPIFFS_H
+#define SPIFFS_H
+
+#include "FS.h"
+
+namespace fs {
+class SPIFFSFS : public FS {};
+} // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
+
+#endif // SPIFFS_H
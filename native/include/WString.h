@@ -0,0 +1,154 @@
+/*
+ * CubeRadio - Host-native Arduino String shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Host replacement for the Arduino String class
+ * @details Implements the subset of the ESP32 Arduino String API used by the
+ * firmware. Like the ESP32 core, short strings (up to 11 characters) are kept
+ * in an inline buffer so heap allocation counts measured on the host match the
+ * device for typical MPD tokens such as "OK\n".
+ */
+class String {
+public:
+  String(const char* cstr = "");
+  String(const char* cstr, size_t length);
+  String(const String& str);
+  String(String&& str);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+  ~String();
+
+  // Memory management
+  bool reserve(size_t size);
+  size_t length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+
+  // Assignment and concatenation
+  String& operator=(const String& rhs);
+  String& operator=(String&& rhs);
+  String& operator=(const char* cstr);
+  bool concat(const String& str);
+  bool concat(const char* cstr);
+  bool concat(const char* cstr, size_t length);
+  bool concat(char c);
+  bool concat(int num);
+  bool concat(unsigned int num);
+  bool concat(long num);
+  bool concat(unsigned long num);
+  String& operator+=(const String& rhs) { concat(rhs); return *this; }
+  String& operator+=(const char* cstr) { concat(cstr); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+  String& operator+=(int num) { concat(num); return *this; }
+  String& operator+=(unsigned int num) { concat(num); return *this; }
+  String& operator+=(long num) { concat(num); return *this; }
+  String& operator+=(unsigned long num) { concat(num); return *this; }
+
+  // Comparison
+  int compareTo(const String& s) const;
+  bool equals(const String& s) const;
+  bool equals(const char* cstr) const;
+  bool equalsIgnoreCase(const String& s) const;
+  bool operator==(const String& rhs) const { return equals(rhs); }
+  bool operator==(const char* cstr) const { return equals(cstr); }
+  bool operator!=(const String& rhs) const { return !equals(rhs); }
+  bool operator!=(const char* cstr) const { return !equals(cstr); }
+  bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+  bool startsWith(const String& prefix) const;
+  bool startsWith(const String& prefix, size_t offset) const;
+  bool endsWith(const String& suffix) const;
+
+  // Character access
+  char charAt(size_t index) const;
+  void setCharAt(size_t index, char c);
+  char operator[](size_t index) const;
+  char& operator[](size_t index);
+  const char* c_str() const { return buffer(); }
+  char* begin() { return wbuffer(); }
+  char* end() { return wbuffer() + len; }
+  const char* begin() const { return buffer(); }
+  const char* end() const { return buffer() + len; }
+
+  // Search
+  int indexOf(char ch, size_t fromIndex = 0) const;
+  int indexOf(const String& str, size_t fromIndex = 0) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(const String& str) const;
+  String substring(size_t beginIndex) const { return substring(beginIndex, len); }
+  String substring(size_t beginIndex, size_t endIndex) const;
+
+  // Modification
+  void replace(char find, char replace);
+  void replace(const String& find, const String& replace);
+  void remove(size_t index);
+  void remove(size_t index, size_t count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  // Conversion
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+private:
+  enum { SSO_CAPACITY = 11 };  ///< Inline capacity, matches the ESP32 core on 32-bit targets
+  char* ptr;                   ///< Heap buffer, nullptr while the inline buffer is in use
+  size_t len;                  ///< String length without terminator
+  size_t cap;                  ///< Usable capacity without terminator
+  char sso[SSO_CAPACITY + 1];  ///< Inline buffer for short strings
+
+  const char* buffer() const { return ptr ? ptr : sso; }
+  char* wbuffer() { return ptr ? ptr : sso; }
+  void init();
+  void invalidate();
+  bool changeBuffer(size_t maxStrLen);
+  String& copy(const char* cstr, size_t length);
+  void move(String& rhs);
+};
+
+// Temporary type of concatenation results in the ESP32 core, referenced by ArduinoJson
+class StringSumHelper : public String {
+public:
+  using String::String;
+  StringSumHelper(const String& s) : String(s) {}
+};
+
+// Concatenation helpers returning new strings
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(char lhs, const String& rhs);
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
+
+#endif // WSTRING_H
@@ -0,0 +1,129 @@
+/*
+ * CubeRadio - Host-native WiFi shim over POSIX sockets
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include <memory>
+
+/**
+ * @brief IPv4 address holder
+ */
+class IPAddress {
+public:
+  IPAddress(uint32_t address = 0) : addr(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  operator uint32_t() const { return addr; }
+  String toString() const;
+
+private:
+  uint32_t addr;  ///< Address in network byte order
+};
+
+/**
+ * @brief TCP client over a POSIX socket
+ * @details Mirrors the ESP32 WiFiClient: copies share the same socket, the
+ * socket is closed when the last copy goes away or stop() is called, reads
+ * never block and writes block until the data is queued in the kernel.
+ */
+class WiFiClient : public Stream {
+public:
+  WiFiClient();
+  explicit WiFiClient(int fd);
+  ~WiFiClient() override;
+
+  int connect(IPAddress ip, uint16_t port);
+  int connect(const char* host, uint16_t port);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size);
+  int read(char* buffer, size_t size) { return read((uint8_t*)buffer, size); }
+  int peek() override;
+  void flush() override;
+  void stop();
+  uint8_t connected();
+  operator bool() { return connected(); }
+  bool operator==(const WiFiClient& rhs) const { return sock == rhs.sock; }
+  bool operator!=(const WiFiClient& rhs) const { return sock != rhs.sock; }
+  int fd() const;
+  int setNoDelay(bool nodelay);
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+
+private:
+  struct Socket;
+  std::shared_ptr<Socket> sock;  ///< Shared socket handle
+  bool _connected;               ///< Connection state as seen by this copy
+};
+
+/**
+ * @brief TCP listening server over a POSIX socket
+ * @details hasClient() polls the listening socket without blocking and keeps
+ * the accepted connection until available() hands it out.
+ */
+class WiFiServer {
+public:
+  WiFiServer(uint16_t port = 80, uint8_t maxClients = 4);
+  ~WiFiServer();
+  void begin(uint16_t port = 0);
+  void setNoDelay(bool nodelay) { noDelay = nodelay; }
+  bool hasClient();
+  WiFiClient available();
+  WiFiClient accept() { return available(); }
+  void end();
+  void stop() { end(); }
+  void close() { end(); }
+  int fd() const { return sockfd; }
+  uint16_t port() const { return serverPort; }
+  operator bool() const { return sockfd >= 0; }
+
+private:
+  int sockfd;            ///< Listening socket
+  int acceptedfd;        ///< Connection accepted by hasClient() but not yet handed out
+  uint16_t serverPort;   ///< TCP port
+  uint8_t backlog;       ///< Listen backlog
+  bool noDelay;          ///< Set TCP_NODELAY on accepted clients
+};
+
+// Connection status values used by the firmware
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+/**
+ * @brief WiFi station stub, the host is always connected
+ */
+class WiFiClass {
+public:
+  wl_status_t status() { return WL_CONNECTED; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  String SSID() { return String("host"); }
+  int32_t RSSI() { return -40; }
+  bool isConnected() { return true; }
+};
+extern WiFiClass WiFi;
+
+#endif // WIFI_H
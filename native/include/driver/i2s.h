@@ -0,0 +1,32 @@
+/*
+ * CubeRadio - Host-native I2S driver stub
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DRIVER_I2S_H
+#define DRIVER_I2S_H
+
+#include <stdint.h>
+
+typedef enum {
+  I2S_NUM_0 = 0,
+  I2S_NUM_1 = 1
+} i2s_port_t;
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+#endif // DRIVER_I2S_H
@@ -0,0 +1,195 @@
+/*
+ * CubeRadio - Host-native Arduino core shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+#include <sched.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// Reference point for millis() and micros()
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+  // Closest host equivalent of giving the FreeRTOS scheduler a chance to run
+  sched_yield();
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  // Same integer arithmetic as the ESP32 core
+  const long dividend = out_max - out_min;
+  const long divisor = in_max - in_min;
+  const long delta = x - in_min;
+  if (divisor == 0) {
+    return -1;
+  }
+  return (delta * dividend + (divisor / 2)) / divisor + out_min;
+}
+
+long random(long howbig) {
+  return howbig > 0 ? rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++)) {
+      n++;
+    } else {
+      break;
+    }
+  }
+  return n;
+}
+
+size_t Print::print(long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits) {
+  return print(String(value, (unsigned int)digits));
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[128];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  if ((size_t)len < sizeof(buf)) {
+    return write((const uint8_t*)buf, len);
+  }
+  // Output did not fit, format again into a heap buffer
+  std::unique_ptr<char[]> big(new char[len + 1]);
+  va_start(args, format);
+  vsnprintf(big.get(), len + 1, format, args);
+  va_end(args);
+  return write((const uint8_t*)big.get(), len);
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    delay(1);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String ret;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return ret;
+}
+
+String Stream::readString() {
+  String ret;
+  int c = timedRead();
+  while (c >= 0) {
+    ret += (char)c;
+    c = timedRead();
+  }
+  return ret;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (enabled) {
+    fputc(c, stdout);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (enabled) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+void EspClass::restart() {
+  fflush(stdout);
+  exit(0);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  // The host has no meaningful heap limit, report the WROOM figure
+  return 320 * 1024;
+}
+
+uint32_t EspClass::getHeapSize() {
+  return 320 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return 320 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return 110 * 1024;
+}
@@ -0,0 +1,239 @@
+/*
+ * CubeRadio - Host-native filesystem shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SPIFFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::SPIFFSFS SPIFFS;
+
+namespace fs {
+
+/**
+ * @brief Stream handle shared between File copies
+ */
+struct File::Handle {
+  FILE* fp;
+  String path;
+  Handle(FILE* f, const char* p) : fp(f), path(p) {}
+  ~Handle() {
+    if (fp) {
+      fclose(fp);
+    }
+  }
+};
+
+File::File(FILE* fp, const char* path) : handle(std::make_shared<Handle>(fp, path)) {}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  return fwrite(buffer, 1, size, handle->fp);
+}
+
+int File::available() {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  return (int)(size() - position());
+}
+
+int File::read() {
+  if (!handle || !handle->fp) {
+    return -1;
+  }
+  int c = fgetc(handle->fp);
+  return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  return fread(buffer, 1, size, handle->fp);
+}
+
+int File::peek() {
+  int c = read();
+  if (c >= 0) {
+    ungetc(c, handle->fp);
+  }
+  return c;
+}
+
+void File::flush() {
+  if (handle && handle->fp) {
+    fflush(handle->fp);
+  }
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!handle || !handle->fp) {
+    return false;
+  }
+  int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+  return fseek(handle->fp, pos, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  long pos = ftell(handle->fp);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!handle || !handle->fp) {
+    return 0;
+  }
+  struct stat st;
+  fflush(handle->fp);
+  if (fstat(fileno(handle->fp), &st) < 0) {
+    return 0;
+  }
+  return (size_t)st.st_size;
+}
+
+void File::close() {
+  if (handle && handle->fp) {
+    fclose(handle->fp);
+    handle->fp = nullptr;
+  }
+  handle.reset();
+}
+
+File::operator bool() const {
+  return handle && handle->fp;
+}
+
+const char* File::name() const {
+  if (!handle) {
+    return "";
+  }
+  const char* slash = strrchr(handle->path.c_str(), '/');
+  return slash ? slash + 1 : handle->path.c_str();
+}
+
+const char* File::path() const {
+  return handle ? handle->path.c_str() : "";
+}
+
+bool FS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  (void)formatOnFail;
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  return getRoot()[0] != '\0';
+}
+
+void FS::setRoot(const char* dir) {
+  root = dir ? dir : "";
+  // Strip the trailing slash so paths can be appended directly
+  while (root.length() > 1 && root.endsWith("/")) {
+    root.remove(root.length() - 1);
+  }
+}
+
+const char* FS::getRoot() {
+  if (root.length() == 0) {
+    // Default to a private temporary directory
+    char tmpl[] = "/tmp/cuberadio-spiffs-XXXXXX";
+    if (mkdtemp(tmpl)) {
+      root = tmpl;
+    }
+  }
+  return root.c_str();
+}
+
+String FS::hostPath(const char* path) {
+  String result = getRoot();
+  if (path && path[0] != '/') {
+    result += "/";
+  }
+  result += path ? path : "";
+  return result;
+}
+
+bool FS::format() {
+  DIR* dir = opendir(getRoot());
+  if (!dir) {
+    return false;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    ::remove(hostPath(entry->d_name).c_str());
+  }
+  closedir(dir);
+  return true;
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+  (void)create;
+  // SPIFFS files are always binary, "w" truncates and "a" appends
+  String fmode = mode;
+  if (fmode.indexOf('b') < 0) {
+    fmode += "b";
+  }
+  FILE* fp = fopen(hostPath(path).c_str(), fmode.c_str());
+  if (!fp) {
+    return File();
+  }
+  return File(fp, path);
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+size_t FS::usedBytes() {
+  size_t used = 0;
+  DIR* dir = opendir(getRoot());
+  if (!dir) {
+    return 0;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    struct stat st;
+    if (entry->d_name[0] != '.' && stat(hostPath(entry->d_name).c_str(), &st) == 0) {
+      used += st.st_size;
+    }
+  }
+  closedir(dir);
+  return used;
+}
+
+} // namespace fs
@@ -0,0 +1,118 @@
+/*
+ * CubeRadio - Host-native FreeRTOS shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <sched.h>
+
+/**
+ * @brief Host task
+ * @details Tasks run as detached threads; priority and core are ignored.
+ * The notification count works as the FreeRTOS one used as a counting
+ * semaphore.
+ */
+struct HostTask {
+  TaskFunction_t function;          ///< Task entry point
+  void* parameters;                 ///< Argument passed to the entry point
+  std::mutex notifyMutex;           ///< Guards notifications
+  std::condition_variable notified; ///< Signalled by xTaskNotifyGive()
+  uint32_t notifications = 0;       ///< Notifications not taken yet
+};
+
+// Task the calling thread runs, the main thread gets its own handle
+static HostTask mainTask{nullptr, nullptr};
+static thread_local HostTask* currentTask = &mainTask;
+
+void hostEnterCritical(portMUX_TYPE* mux) {
+  // Spin like the ESP32 does, critical sections are short
+  while (__atomic_exchange_n(&mux->owner, 1, __ATOMIC_ACQUIRE)) {
+    sched_yield();
+  }
+}
+
+void hostExitCritical(portMUX_TYPE* mux) {
+  __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+  HostTask* hostTask = new HostTask{task, parameters};
+  if (handle) {
+    *handle = hostTask;
+  }
+  std::thread([hostTask]() {
+    currentTask = hostTask;
+    hostTask->function(hostTask->parameters);
+  }).detach();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticks) {
+  HostTask* task = currentTask;
+  std::unique_lock<std::mutex> lock(task->notifyMutex);
+  if (ticks == portMAX_DELAY) {
+    task->notified.wait(lock, [task]() { return task->notifications > 0; });
+  } else {
+    task->notified.wait_for(lock, std::chrono::milliseconds(ticks), [task]() { return task->notifications > 0; });
+  }
+  uint32_t count = task->notifications;
+  if (count > 0) {
+    task->notifications = clearCountOnExit ? 0 : count - 1;
+  }
+  return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  HostTask* hostTask = (HostTask*)task;
+  {
+    std::lock_guard<std::mutex> lock(hostTask->notifyMutex);
+    hostTask->notifications++;
+  }
+  hostTask->notified.notify_one();
+  return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return new std::recursive_timed_mutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticks) {
+  std::recursive_timed_mutex* m = (std::recursive_timed_mutex*)mutex;
+  if (ticks == portMAX_DELAY) {
+    m->lock();
+    return pdTRUE;
+  }
+  return m->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  ((std::recursive_timed_mutex*)mutex)->unlock();
+  return pdTRUE;
+}
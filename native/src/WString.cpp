@@ -0,0 +1,375 @@
+/*
+ * CubeRadio - Host-native Arduino String shim
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WString.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+String::String(const char* cstr) {
+  init();
+  if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, size_t length) {
+  init();
+  if (cstr) copy(cstr, length);
+}
+
+String::String(const String& str) {
+  init();
+  copy(str.buffer(), str.len);
+}
+
+String::String(String&& str) {
+  init();
+  move(str);
+}
+
+String::String(char c) {
+  init();
+  char buf[2] = {c, '\0'};
+  copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) {
+  init();
+  char buf[2 + 8 * sizeof(long)];
+  if (base == 10) {
+    snprintf(buf, sizeof(buf), "%ld", value);
+  } else if (value < 0) {
+    buf[0] = '-';
+    String tail((unsigned long)(-value), base);
+    strncpy(buf + 1, tail.c_str(), sizeof(buf) - 2);
+    buf[sizeof(buf) - 1] = '\0';
+  } else {
+    String tmp((unsigned long)value, base);
+    copy(tmp.c_str(), tmp.length());
+    return;
+  }
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) {
+  init();
+  char buf[1 + 8 * sizeof(unsigned long)];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    unsigned long digit = value % base;
+    *--p = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value && p > buf);
+  copy(p, strlen(p));
+}
+
+String::String(long long value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned long long value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+  init();
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  free(ptr);
+}
+
+void String::init() {
+  ptr = nullptr;
+  len = 0;
+  cap = SSO_CAPACITY;
+  sso[0] = '\0';
+}
+
+void String::invalidate() {
+  free(ptr);
+  init();
+}
+
+bool String::reserve(size_t size) {
+  if (size <= cap) return true;
+  return changeBuffer(size);
+}
+
+bool String::changeBuffer(size_t maxStrLen) {
+  // Stay in the inline buffer while the string fits
+  if (maxStrLen <= SSO_CAPACITY && !ptr) {
+    return true;
+  }
+  char* newBuffer = (char*)malloc(maxStrLen + 1);
+  if (!newBuffer) return false;
+  memcpy(newBuffer, buffer(), len + 1);
+  free(ptr);
+  ptr = newBuffer;
+  cap = maxStrLen;
+  return true;
+}
+
+String& String::copy(const char* cstr, size_t length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  memmove(wbuffer(), cstr, length);
+  len = length;
+  wbuffer()[len] = '\0';
+  return *this;
+}
+
+void String::move(String& rhs) {
+  if (rhs.ptr) {
+    free(ptr);
+    ptr = rhs.ptr;
+    cap = rhs.cap;
+    len = rhs.len;
+    rhs.init();
+  } else {
+    copy(rhs.sso, rhs.len);
+    rhs.init();
+  }
+}
+
+String& String::operator=(const String& rhs) {
+  if (this == &rhs) return *this;
+  return copy(rhs.buffer(), rhs.len);
+}
+
+String& String::operator=(String&& rhs) {
+  if (this != &rhs) move(rhs);
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  if (cstr) return copy(cstr, strlen(cstr));
+  invalidate();
+  return *this;
+}
+
+bool String::concat(const char* cstr, size_t length) {
+  if (!cstr) return false;
+  if (length == 0) return true;
+  // Handle self-concatenation by copying the source first
+  if (cstr >= buffer() && cstr < buffer() + cap + 1) {
+    String tmp(cstr, length);
+    return concat(tmp.c_str(), length);
+  }
+  size_t newLen = len + length;
+  if (newLen > cap) {
+    // Grow geometrically like the ESP32 core to amortise repeated appends
+    size_t grow = cap + cap / 2;
+    if (!changeBuffer(newLen > grow ? newLen : grow)) return false;
+  }
+  memcpy(wbuffer() + len, cstr, length);
+  len = newLen;
+  wbuffer()[len] = '\0';
+  return true;
+}
+
+bool String::concat(const String& str) { return concat(str.buffer(), str.len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+
+int String::compareTo(const String& s) const {
+  return strcmp(buffer(), s.buffer());
+}
+
+bool String::equals(const String& s) const {
+  return len == s.len && memcmp(buffer(), s.buffer(), len) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  if (!cstr) return len == 0;
+  return strcmp(buffer(), cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (len != s.len) return false;
+  return strncasecmp(buffer(), s.buffer(), len) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, size_t offset) const {
+  if (offset > len || prefix.len > len - offset) return false;
+  return strncmp(buffer() + offset, prefix.buffer(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.len > len) return false;
+  return strcmp(buffer() + len - suffix.len, suffix.buffer()) == 0;
+}
+
+char String::charAt(size_t index) const {
+  return index < len ? buffer()[index] : '\0';
+}
+
+void String::setCharAt(size_t index, char c) {
+  if (index < len) wbuffer()[index] = c;
+}
+
+char String::operator[](size_t index) const {
+  return charAt(index);
+}
+
+char& String::operator[](size_t index) {
+  static char dummy;
+  if (index >= len) {
+    dummy = '\0';
+    return dummy;
+  }
+  return wbuffer()[index];
+}
+
+int String::indexOf(char ch, size_t fromIndex) const {
+  if (fromIndex >= len) return -1;
+  const char* found = strchr(buffer() + fromIndex, ch);
+  return found ? (int)(found - buffer()) : -1;
+}
+
+int String::indexOf(const String& str, size_t fromIndex) const {
+  if (fromIndex >= len) return -1;
+  const char* found = strstr(buffer() + fromIndex, str.buffer());
+  return found ? (int)(found - buffer()) : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+  const char* found = strrchr(buffer(), ch);
+  return found ? (int)(found - buffer()) : -1;
+}
+
+int String::lastIndexOf(const String& str) const {
+  if (str.len == 0 || str.len > len) return -1;
+  for (size_t i = len - str.len + 1; i-- > 0;) {
+    if (strncmp(buffer() + i, str.buffer(), str.len) == 0) return (int)i;
+  }
+  return -1;
+}
+
+String String::substring(size_t beginIndex, size_t endIndex) const {
+  if (beginIndex > endIndex) {
+    size_t tmp = beginIndex;
+    beginIndex = endIndex;
+    endIndex = tmp;
+  }
+  if (beginIndex >= len) return String();
+  if (endIndex > len) endIndex = len;
+  return String(buffer() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  for (size_t i = 0; i < len; i++) {
+    if (wbuffer()[i] == find) wbuffer()[i] = replace;
+  }
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (find.len == 0) return;
+  String result;
+  size_t pos = 0;
+  while (pos < len) {
+    const char* found = strstr(buffer() + pos, find.buffer());
+    if (!found) break;
+    size_t idx = found - buffer();
+    result.concat(buffer() + pos, idx - pos);
+    result.concat(replace);
+    pos = idx + find.len;
+  }
+  result.concat(buffer() + pos, len - pos);
+  *this = result;
+}
+
+void String::remove(size_t index) {
+  remove(index, (size_t)-1);
+}
+
+void String::remove(size_t index, size_t count) {
+  if (index >= len) return;
+  if (count > len - index) count = len - index;
+  memmove(wbuffer() + index, wbuffer() + index + count, len - index - count + 1);
+  len -= count;
+}
+
+void String::toLowerCase() {
+  for (size_t i = 0; i < len; i++) wbuffer()[i] = (char)tolower((unsigned char)wbuffer()[i]);
+}
+
+void String::toUpperCase() {
+  for (size_t i = 0; i < len; i++) wbuffer()[i] = (char)toupper((unsigned char)wbuffer()[i]);
+}
+
+void String::trim() {
+  if (len == 0) return;
+  char* begin = wbuffer();
+  while (isspace((unsigned char)*begin)) begin++;
+  char* end = wbuffer() + len - 1;
+  while (end >= begin && isspace((unsigned char)*end)) end--;
+  len = (end >= begin) ? (size_t)(end - begin + 1) : 0;
+  if (begin > wbuffer()) memmove(wbuffer(), begin, len);
+  wbuffer()[len] = '\0';
+}
+
+long String::toInt() const { return atol(buffer()); }
+float String::toFloat() const { return (float)atof(buffer()); }
+double String::toDouble() const { return atof(buffer()); }
+
+String operator+(const String& lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(char lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
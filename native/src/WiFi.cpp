@@ -0,0 +1,318 @@
+/*
+ * CubeRadio - Host-native WiFi shim over POSIX sockets
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "WiFi.h"
+#include "Host.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr & 0xFF, (addr >> 8) & 0xFF, (addr >> 16) & 0xFF, (addr >> 24) & 0xFF);
+  return String(buf);
+}
+
+/**
+ * @brief Socket handle shared between WiFiClient copies
+ */
+struct WiFiClient::Socket {
+  int fd;
+  explicit Socket(int f) : fd(f) {}
+  ~Socket() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+static void setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+WiFiClient::WiFiClient() : _connected(false) {}
+
+WiFiClient::WiFiClient(int fd) : sock(std::make_shared<Socket>(fd)), _connected(true) {
+  setNonBlocking(fd);
+}
+
+WiFiClient::~WiFiClient() {}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  stop();
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  addr.sin_port = htons(port);
+  if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    ::close(fd);
+    return 0;
+  }
+  sock = std::make_shared<Socket>(fd);
+  setNonBlocking(fd);
+  _connected = true;
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  struct addrinfo hints;
+  struct addrinfo* res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) {
+    return 0;
+  }
+  uint32_t ip = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(res);
+  return connect(IPAddress(ip), port);
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+// Socket write counter, see hostSocketWrites()
+static std::atomic<unsigned long long> socketWrites(0);
+
+unsigned long long hostSocketWrites() {
+  return socketWrites.load();
+}
+
+// Count every send() of the process, including the non-blocking writes the
+// MPD server makes on the raw socket, by taking the place of the libc one
+extern "C" ssize_t send(int fd, const void* buffer, size_t size, int flags) {
+  socketWrites++;
+  return syscall(SYS_sendto, fd, buffer, size, flags, nullptr, 0);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (!sock || !_connected) {
+    return 0;
+  }
+  // Block until everything is queued, like lwIP with the default send timeout
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t res = ::send(sock->fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (res > 0) {
+      sent += res;
+    } else if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      struct pollfd pfd = {sock->fd, POLLOUT, 0};
+      if (poll(&pfd, 1, (int)_timeout) <= 0) {
+        break;
+      }
+    } else {
+      _connected = false;
+      break;
+    }
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  if (!sock || !_connected) {
+    return 0;
+  }
+  int count = 0;
+  if (ioctl(sock->fd, FIONREAD, &count) < 0) {
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (!sock || !_connected) {
+    return -1;
+  }
+  ssize_t res = ::recv(sock->fd, buffer, size, MSG_DONTWAIT);
+  if (res == 0) {
+    // Orderly shutdown by the peer
+    _connected = false;
+    return -1;
+  }
+  if (res < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      _connected = false;
+    }
+    return -1;
+  }
+  return (int)res;
+}
+
+int WiFiClient::peek() {
+  if (!sock || !_connected) {
+    return -1;
+  }
+  uint8_t c;
+  ssize_t res = ::recv(sock->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  return res == 1 ? c : -1;
+}
+
+void WiFiClient::flush() {
+  // The ESP32 core discards pending input on flush
+  uint8_t buf[256];
+  while (available() > 0) {
+    if (read(buf, sizeof(buf)) <= 0) {
+      break;
+    }
+  }
+}
+
+void WiFiClient::stop() {
+  if (sock && sock->fd >= 0) {
+    ::close(sock->fd);
+    sock->fd = -1;
+  }
+  sock.reset();
+  _connected = false;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!sock || sock->fd < 0 || !_connected) {
+    return 0;
+  }
+  // Probe the socket the same way the ESP32 core does
+  uint8_t dummy;
+  ssize_t res = ::recv(sock->fd, &dummy, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (res == 0) {
+    _connected = false;
+  } else if (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+    _connected = false;
+  }
+  return _connected;
+}
+
+int WiFiClient::fd() const {
+  return sock ? sock->fd : -1;
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+  if (!sock) {
+    return -1;
+  }
+  int flag = nodelay ? 1 : 0;
+  return setsockopt(sock->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (!sock || getpeername(sock->fd, (struct sockaddr*)&addr, &len) < 0) {
+    return IPAddress();
+  }
+  return IPAddress(addr.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (!sock || getpeername(sock->fd, (struct sockaddr*)&addr, &len) < 0) {
+    return 0;
+  }
+  return ntohs(addr.sin_port);
+}
+
+WiFiServer::WiFiServer(uint16_t port, uint8_t maxClients)
+    : sockfd(-1), acceptedfd(-1), serverPort(port), backlog(maxClients), noDelay(false) {}
+
+WiFiServer::~WiFiServer() {
+  end();
+}
+
+void WiFiServer::begin(uint16_t port) {
+  if (port) {
+    serverPort = port;
+  }
+  end();
+  sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (sockfd < 0) {
+    Serial.printf("WiFiServer: socket failed: %s\n", strerror(errno));
+    return;
+  }
+  int enable = 1;
+  setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(serverPort);
+  if (bind(sockfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(sockfd, backlog) < 0) {
+    Serial.printf("WiFiServer: cannot listen on port %u: %s\n", serverPort, strerror(errno));
+    ::close(sockfd);
+    sockfd = -1;
+    return;
+  }
+  setNonBlocking(sockfd);
+}
+
+bool WiFiServer::hasClient() {
+  if (acceptedfd >= 0) {
+    return true;
+  }
+  if (sockfd < 0) {
+    return false;
+  }
+  acceptedfd = ::accept(sockfd, nullptr, nullptr);
+  return acceptedfd >= 0;
+}
+
+WiFiClient WiFiServer::available() {
+  if (!hasClient()) {
+    return WiFiClient();
+  }
+  int fd = acceptedfd;
+  acceptedfd = -1;
+  if (noDelay) {
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  }
+  return WiFiClient(fd);
+}
+
+void WiFiServer::end() {
+  if (acceptedfd >= 0) {
+    ::close(acceptedfd);
+    acceptedfd = -1;
+  }
+  if (sockfd >= 0) {
+    ::close(sockfd);
+    sockfd = -1;
+  }
+}
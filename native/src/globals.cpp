@@ -0,0 +1,124 @@
+/*
+ * CubeRadio - Host-native definitions of the firmware globals
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pins.h"
+#include "main.h"
+#include "mpd.h"
+#include "player.h"
+#include "artcache.h"
+#include "control.h"
+#include "importer.h"
+#include <Host.h>
+#include <dirent.h>
+
+// Globals normally defined in main.cpp
+const char* BUILD_TIME = __DATE__ "T" __TIME__"Z";
+WiFiServer mpdServer(6600, MPD_MAX_CLIENTS);
+WiFiServer controlServer(0, CONTROL_MAX_CLIENTS);
+WiFiServer webServer(80, HTTP_MAX_CLIENTS);
+HTTPServer server(webServer);
+Player player;
+ArtCache artCache;
+MPDInterface mpdInterface(mpdServer, player, artCache);
+ControlInterface controlInterface(controlServer, player);
+PlaylistImporter playlistImporter(player);
+ConfigImporter configImporter(SPIFFS);
+
+// Configuration structure definition, same defaults as the firmware
+Config config = {
+  DEFAULT_I2S_DOUT,
+  DEFAULT_I2S_BCLK,
+  DEFAULT_I2S_LRC,
+  DEFAULT_LED_PIN,
+  DEFAULT_ROTARY_CLK,
+  DEFAULT_ROTARY_DT,
+  DEFAULT_ROTARY_SW,
+  DEFAULT_BOARD_BUTTON,
+  DEFAULT_DISPLAY_SDA,
+  DEFAULT_DISPLAY_SCL,
+  DEFAULT_DISPLAY_TYPE,
+  DEFAULT_DISPLAY_ADDR,
+  DEFAULT_DISPLAY_TIMEOUT,
+  DEFAULT_TOUCH_PLAY,
+  DEFAULT_TOUCH_NEXT,
+  DEFAULT_TOUCH_PREV,
+  DEFAULT_TOUCH_THRESHOLD,
+  DEFAULT_TOUCH_DEBOUNCE,
+  DEFAULT_MPD_BUDGET,
+  DEFAULT_MPD_TIMEOUT,
+  DEFAULT_MPD_QUEUE,
+  DEFAULT_MPD_KEEPALIVE,
+  DEFAULT_CONTROL_PORT
+};
+
+// There is no display or WebSocket in the host build
+void updateDisplay() {}
+void sendStatusToClients(bool fullStatus) { (void)fullStatus; }
+
+/**
+ * @brief Copy the files of a directory into the SPIFFS root
+ * @details Seeds the temporary filesystem with the playlist, settings and
+ * web pages shipped in data/ so the host starts with the same content as a
+ * freshly flashed device.
+ * @param dir Source directory
+ */
+void seedFilesystem(const char* dir) {
+  DIR* d = opendir(dir);
+  if (!d) {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(d)) != nullptr) {
+    const char* name = entry->d_name;
+    if (name[0] == '.') {
+      continue;
+    }
+    String src = String(dir) + "/" + name;
+    FILE* in = fopen(src.c_str(), "rb");
+    if (!in) {
+      continue;
+    }
+    File out = SPIFFS.open(String("/") + name, "w");
+    char buf[512];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+      out.write((const uint8_t*)buf, n);
+    }
+    out.close();
+    fclose(in);
+  }
+  closedir(d);
+}
+
+/**
+ * @brief Register the host web routes
+ * @details The API routes are the firmware's own, see setupApiRoutes(), and
+ * the static pages are mapped as setupWebServer() maps them. The WiFi,
+ * configuration and proxy routes need the network stack and are left out.
+ */
+void setupHostWebServer() {
+  setupApiRoutes();
+  server.serveStatic("/", SPIFFS, "/player.html");
+  server.serveStatic("/playlist", SPIFFS, "/playlist.html");
+  server.serveStatic("/wifi", SPIFFS, "/wifi.html");
+  server.serveStatic("/config", SPIFFS, "/config.html");
+  server.serveStatic("/about", SPIFFS, "/about.html");
+  server.serveStatic("/styles.css", SPIFFS, "/styles.css");
+  server.serveStatic("/scripts.js", SPIFFS, "/scripts.js");
+  server.serveStatic("/pico.min.css", SPIFFS, "/pico.min.css");
+}
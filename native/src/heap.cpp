@@ -0,0 +1,103 @@
+/*
+ * CubeRadio - Host-native heap accounting
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HostHeap.h"
+#include <atomic>
+#include <malloc.h>
+
+// glibc entry points of the real allocator
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+static std::atomic<uint64_t> heapAllocations(0);
+static std::atomic<uint64_t> heapFrees(0);
+static std::atomic<size_t> heapInUse(0);
+static std::atomic<size_t> heapPeak(0);
+
+/**
+ * @brief Account for a new block
+ * @param ptr Block returned by the allocator
+ */
+static void heapAdd(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  heapAllocations++;
+  size_t inUse = heapInUse += malloc_usable_size(ptr);
+  size_t peak = heapPeak.load();
+  while (inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse)) {
+  }
+}
+
+/**
+ * @brief Account for a block about to be released
+ * @param ptr Block passed to free
+ */
+static void heapRemove(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+  heapFrees++;
+  heapInUse -= malloc_usable_size(ptr);
+}
+
+extern "C" void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  heapAdd(ptr);
+  return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  heapAdd(ptr);
+  return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  // A realloc counts as a new allocation, it may move the block
+  size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+  void* result = __libc_realloc(ptr, size);
+  if (result || size == 0) {
+    heapInUse -= oldSize;
+    if (ptr) {
+      heapFrees++;
+    }
+    heapAdd(result);
+  }
+  return result;
+}
+
+extern "C" void free(void* ptr) {
+  heapRemove(ptr);
+  __libc_free(ptr);
+}
+
+HostHeapStats hostHeapStats() {
+  HostHeapStats stats;
+  stats.allocations = heapAllocations.load();
+  stats.frees = heapFrees.load();
+  stats.bytesInUse = heapInUse.load();
+  stats.peakBytes = heapPeak.load();
+  return stats;
+}
+
+void hostHeapResetPeak() {
+  heapPeak = heapInUse.load();
+}
@@ -0,0 +1,153 @@
+/*
+ * CubeRadio - Host-native runner for the MPD server
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "main.h"
+#include "mpd.h"
+#include "player.h"
+#include "playlist.h"
+#include "control.h"
+#include <Host.h>
+#include <unistd.h>
+
+/**
+ * @brief Print command line help
+ * @param name Program name
+ */
+static void usage(const char* name) {
+  printf("Usage: %s [-p port] [-d dir] [-s dir] [-l ms] [-b ms] [-t s] [-Q bytes] [-c port] [-w port] [-L] [-q]\n", name);
+  printf("  -p port  MPD port (default 6600)\n");
+  printf("  -d dir   directory backing SPIFFS (default: new temporary directory)\n");
+  printf("  -s dir   seed SPIFFS with the files from dir (default: data)\n");
+  printf("  -l ms    delay at the end of each loop pass (default 150, as on the device)\n");
+  printf("  -b ms    MPD command budget per loop pass (default %d, 0 = one command)\n", DEFAULT_MPD_BUDGET);
+  printf("  -t s     MPD client timeout (default %d, 0 = never)\n", DEFAULT_MPD_TIMEOUT);
+  printf("  -Q bytes MPD send queue limit per client (default %d)\n", DEFAULT_MPD_QUEUE);
+  printf("  -c port  binary control protocol port (default off)\n");
+  printf("  -w port  web server port (default off)\n");
+  printf("  -L       service MPD from the loop instead of its own task\n");
+  printf("  -q       quiet, disable Serial logging\n");
+}
+
+/**
+ * @brief Wake the loop on player changes, as playerEventListener() in main.cpp
+ * @param events Changed subsystems
+ * @param context Loop task
+ */
+static void wakeLoop(uint8_t events, void* context) {
+  xTaskNotifyGive((TaskHandle_t)context);
+}
+
+/**
+ * @brief Host entry point
+ * @details Mirrors the MPD related parts of setup() and loop() in main.cpp:
+ * mounts the filesystem, loads playlist and player state, starts the MPD
+ * server in its own task and runs the loop with the same per-pass delay as
+ * the firmware.
+ */
+int main(int argc, char* argv[]) {
+  uint16_t port = 6600;
+  const char* seedDir = "data";
+  unsigned long loopDelay = 150;
+  uint16_t webPort = 0;
+  bool mpdInLoop = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:d:s:l:b:t:Q:c:w:Lqh")) != -1) {
+    switch (opt) {
+      case 'p': port = (uint16_t)atoi(optarg); break;
+      case 'd': SPIFFS.setRoot(optarg); seedDir = nullptr; break;
+      case 's': seedDir = optarg; break;
+      case 'l': loopDelay = strtoul(optarg, nullptr, 10); break;
+      case 'b': config.mpd_budget = atoi(optarg); break;
+      case 't': config.mpd_timeout = atoi(optarg); break;
+      case 'Q': config.mpd_queue = atoi(optarg); break;
+      case 'c': config.control_port = atoi(optarg); break;
+      case 'w': webPort = (uint16_t)atoi(optarg); break;
+      case 'L': mpdInLoop = true; break;
+      case 'q': Serial.setEnabled(false); break;
+      default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+    }
+  }
+  Serial.begin(115200);
+  Serial.println("CubeRadio - An ESP32-based internet radio player with MPD protocol support");
+  Serial.print("Build timestamp: ");
+  Serial.println(BUILD_TIME);
+  // Mount the filesystem and seed it for a fresh run
+  if (!SPIFFS.begin(true)) {
+    Serial.println("ERROR: Failed to initialize SPIFFS");
+    return 1;
+  }
+  if (seedDir) {
+    seedFilesystem(seedDir);
+  }
+  Serial.printf("SPIFFS root: %s\n", SPIFFS.getRoot());
+  // Same initialization order as setup()
+  player.setEventListener(wakeLoop, xTaskGetCurrentTaskHandle());
+  player.setupAudioOutput();
+  player.loadPlaylist();
+  player.getPlaylist()->validate();
+  player.loadPlayerState();
+  mpdServer.begin(port);
+  if (!mpdServer) {
+    return 1;
+  }
+  Serial.printf("MPD server started on port %u\n", port);
+  if (!mpdInLoop && !mpdInterface.startTask()) {
+    Serial.println("ERROR: Failed to create MPDTask, serving MPD from loop()");
+  }
+  if (!mpdInLoop && !artCache.startTask()) {
+    Serial.println("ERROR: Failed to create ArtTask, fetching art from loop()");
+  }
+  if (config.control_port > 0) {
+    controlServer.begin(config.control_port);
+    if (!controlServer) {
+      return 1;
+    }
+    Serial.printf("Control server started on port %d\n", config.control_port);
+    if (!mpdInLoop && !controlInterface.startTask()) {
+      Serial.println("ERROR: Failed to create ControlTask, serving control from loop()");
+    }
+  }
+  if (webPort > 0) {
+    setupHostWebServer();
+    server.begin(webPort);
+    if (!webServer) {
+      return 1;
+    }
+    Serial.printf("Web server started on port %u\n", webPort);
+  }
+  // Service the MPD server like loop() does
+  for (;;) {
+    if (webPort > 0) {
+      server.handleClient();
+    }
+    if (!mpdInterface.isTaskRunning()) {
+      mpdInterface.handleClient();
+    }
+    if (config.control_port > 0 && !controlInterface.isTaskRunning()) {
+      controlInterface.handleClient();
+    }
+    player.handleAudio();
+    if (!artCache.isTaskRunning()) {
+      artCache.handle();
+    }
+    if (loopDelay > 0) {
+      ulTaskNotifyTake(pdTRUE, webPort && server.isActive() ? min(loopDelay, 5UL) : loopDelay);
+    }
+  }
+  return 0;
+}
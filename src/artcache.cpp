@@ -0,0 +1,434 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "artcache.h"
+#include "main.h"
+
+// Image buffers go to PSRAM when available
+#if defined(BOARD_HAS_PSRAM)
+#define ART_MALLOC(size) ps_malloc(size)
+#define ART_REALLOC(ptr, size) ps_realloc(ptr, size)
+#else
+#define ART_MALLOC(size) malloc(size)
+#define ART_REALLOC(ptr, size) realloc(ptr, size)
+#endif
+
+/**
+ * @brief ArtCache constructor
+ */
+ArtCache::ArtCache() {
+  memoryUsed = 0;
+  useCounter = 0;
+  pending = false;
+  pendingStream = 0;
+  pendingImage[0] = '\0';
+  nextMiss = 0;
+  version = 0;
+  for (int i = 0; i < ART_CACHE_ENTRIES; i++) {
+    entries[i] = {0, 0, nullptr, 0, 0};
+  }
+  for (int i = 0; i < ART_CACHE_MISSES; i++) {
+    misses[i] = 0;
+  }
+  mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+/**
+ * @brief Hash a URL into a cache key
+ * @details 32-bit FNV-1a, never 0 since that marks free entries.
+ * @param text URL
+ * @return Hash value
+ */
+uint32_t ArtCache::hash(const char* text) {
+  uint32_t h = 2166136261u;
+  while (*text) {
+    h ^= (uint8_t)*text++;
+    h *= 16777619u;
+  }
+  return h ? h : 1;
+}
+
+/**
+ * @brief Set the image of a stream
+ * @details Only the last request is kept, a station change replaces the
+ * fetch of the previous station if it did not start yet.
+ * @param streamUrl Stream URL, the key clients ask for
+ * @param imageUrl URL of the logo or cover image
+ */
+void ArtCache::request(const char* streamUrl, const char* imageUrl) {
+  if (!streamUrl || !imageUrl || !VALIDATE_URL(imageUrl) || strlen(imageUrl) >= sizeof(pendingImage)) {
+    return;
+  }
+  uint32_t stream = hash(streamUrl);
+  uint32_t image = hash(imageUrl);
+  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  // Nothing to do if this image is already cached for the stream
+  Entry* entry = find(stream);
+  if (!entry || entry->image != image) {
+    pendingStream = stream;
+    strcpy(pendingImage, imageUrl);
+    pending = true;
+  }
+  xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * @brief Fetch the scheduled image, if any
+ * @details Downloads the image without holding the cache lock, so MPD
+ * clients keep getting the cached images meanwhile. Images larger than
+ * ART_CACHE_MAX_IMAGE, or that are not PNG, JPEG, GIF, WebP or ICO, are
+ * dropped.
+ * @return true if a new image was stored
+ */
+bool ArtCache::handle() {
+  if (!pending) {
+    return false;
+  }
+  // Take the request
+  char url[sizeof(pendingImage)];
+  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  uint32_t stream = pendingStream;
+  strcpy(url, pendingImage);
+  pending = false;
+  xSemaphoreGiveRecursive(mutex);
+  // Download the image
+  HTTPClient http;
+  http.setTimeout(ART_FETCH_TIMEOUT);
+  if (!http.begin(url)) {
+    return false;
+  }
+  int code = http.GET();
+  int length = http.getSize();
+  if (code != 200 || length > ART_CACHE_MAX_IMAGE || length == 0) {
+    Serial.printf("Art fetch failed (%d, %d bytes): %s\n", code, length, url);
+    http.end();
+    return false;
+  }
+  // Read into a buffer of the announced size, or of the largest size if unknown
+  size_t capacity = length > 0 ? length : ART_CACHE_MAX_IMAGE;
+  uint8_t* data = (uint8_t*)ART_MALLOC(capacity);
+  if (!data) {
+    Serial.println("Art fetch failed: out of memory");
+    http.end();
+    return false;
+  }
+  WiFiClient* client = http.getStreamPtr();
+  size_t size = 0;
+  unsigned long start = millis();
+  while (client && size < capacity && millis() - start < ART_FETCH_TIMEOUT) {
+    int available = client->available();
+    if (available <= 0) {
+      if (!client->connected()) {
+        break;
+      }
+      delay(1);
+      continue;
+    }
+    int n = client->read(data + size, min((size_t)available, capacity - size));
+    if (n > 0) {
+      size += n;
+    }
+  }
+  bool complete = (length > 0) ? (size == (size_t)length) : (size < capacity || !client->available());
+  http.end();
+  if (!complete || !strncmp(mimeType(data, size), "application/", 12)) {
+    Serial.printf("Art fetch failed (incomplete or not an image): %s\n", url);
+    free(data);
+    return false;
+  }
+  // Give back what an unknown length left unused
+  if (size < capacity) {
+    uint8_t* shrunk = (uint8_t*)ART_REALLOC(data, size);
+    if (shrunk) {
+      data = shrunk;
+    }
+  }
+  uint32_t image = hash(url);
+  saveToFlash(stream, image, data, size);
+  store(stream, image, data, size);
+  version++;
+  Serial.printf("Art cached: %u bytes from %s\n", (unsigned)size, url);
+  return true;
+}
+
+/**
+ * @brief Start the fetch task
+ * @details Downloads run in their own task, so a slow image server stalls
+ * neither loop() nor MPD. Priority, stack size and core are set with
+ * ART_TASK_PRIORITY, ART_TASK_STACK_SIZE and ART_TASK_CORE.
+ * @return true if the task was created, false if loop() has to call handle()
+ */
+bool ArtCache::startTask() {
+  BaseType_t result = xTaskCreatePinnedToCore(artTask, "ArtTask", ART_TASK_STACK_SIZE, this,
+                                              ART_TASK_PRIORITY, &taskHandle, ART_TASK_CORE);
+  if (result != pdPASS) {
+    taskHandle = nullptr;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Fetch task function
+ * @details Checks for a requested image every ART_TASK_POLL_MS.
+ * @param parameters The ArtCache instance
+ */
+void ArtCache::artTask(void* parameters) {
+  ArtCache* self = (ArtCache*)parameters;
+  while (true) {
+    self->handle();
+    vTaskDelay(pdMS_TO_TICKS(ART_TASK_POLL_MS));
+  }
+}
+
+/**
+ * @brief Get the image of a stream and lock it in the cache
+ * @param streamUrl Stream URL
+ * @param size Image size in bytes
+ * @return Image data, or nullptr if there is no image for this stream
+ */
+const uint8_t* ArtCache::acquire(const char* streamUrl, size_t& size) {
+  uint32_t stream = hash(streamUrl);
+  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  Entry* entry = find(stream);
+  if (!entry && !isMiss(stream)) {
+    // Reload an image fetched before a reboot or evicted from memory
+    uint32_t image;
+    size_t length;
+    uint8_t* data = loadFromFlash(stream, image, length);
+    if (data) {
+      store(stream, image, data, length);
+      entry = find(stream);
+    } else {
+      setMiss(stream, true);
+    }
+  }
+  if (!entry) {
+    xSemaphoreGiveRecursive(mutex);
+    return nullptr;
+  }
+  entry->lastUsed = ++useCounter;
+  size = entry->size;
+  return entry->data;
+}
+
+/**
+ * @brief Unlock the image returned by acquire()
+ */
+void ArtCache::release() {
+  xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * @brief Guess the MIME type of an image from its first bytes
+ * @param data Image data
+ * @param size Image size
+ * @return MIME type, "application/octet-stream" if unknown
+ */
+const char* ArtCache::mimeType(const uint8_t* data, size_t size) {
+  if (size >= 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0) {
+    return "image/png";
+  }
+  if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) {
+    return "image/jpeg";
+  }
+  if (size >= 6 && (memcmp(data, "GIF87a", 6) == 0 || memcmp(data, "GIF89a", 6) == 0)) {
+    return "image/gif";
+  }
+  if (size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WEBP", 4) == 0) {
+    return "image/webp";
+  }
+  if (size >= 4 && memcmp(data, "\0\0\1\0", 4) == 0) {
+    return "image/x-icon";
+  }
+  return "application/octet-stream";
+}
+
+/**
+ * @brief Find the entry of a stream
+ * @param stream Stream URL hash
+ * @return Entry, or nullptr if not cached
+ */
+ArtCache::Entry* ArtCache::find(uint32_t stream) {
+  for (int i = 0; i < ART_CACHE_ENTRIES; i++) {
+    if (entries[i].stream == stream) {
+      return &entries[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Check whether a stream is known to have no image
+ * @param stream Stream URL hash
+ * @return true if neither memory nor SPIFFS had an image last time
+ */
+bool ArtCache::isMiss(uint32_t stream) const {
+  for (int i = 0; i < ART_CACHE_MISSES; i++) {
+    if (misses[i] == stream) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Remember or forget that a stream has no image
+ * @details The oldest miss is replaced when all slots are taken.
+ * @param stream Stream URL hash
+ * @param miss true to remember the miss, false once an image is stored
+ */
+void ArtCache::setMiss(uint32_t stream, bool miss) {
+  for (int i = 0; i < ART_CACHE_MISSES; i++) {
+    if (misses[i] == stream) {
+      if (!miss) {
+        misses[i] = 0;
+      }
+      return;
+    }
+  }
+  if (miss) {
+    misses[nextMiss] = stream;
+    nextMiss = (nextMiss + 1) % ART_CACHE_MISSES;
+  }
+}
+
+/**
+ * @brief Store an image, taking ownership of the buffer
+ * @details Replaces the previous image of the stream and evicts the least
+ * recently used images until the new one fits in ART_CACHE_MEMORY and has
+ * an entry.
+ * @param stream Stream URL hash
+ * @param image Image URL hash
+ * @param data Image data, allocated with ART_MALLOC
+ * @param size Image size
+ */
+void ArtCache::store(uint32_t stream, uint32_t image, uint8_t* data, size_t size) {
+  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  setMiss(stream, false);
+  Entry* old = find(stream);
+  if (old) {
+    evict(*old);
+  }
+  for (;;) {
+    Entry* slot = nullptr;
+    Entry* oldest = nullptr;
+    for (int i = 0; i < ART_CACHE_ENTRIES; i++) {
+      Entry& e = entries[i];
+      if (e.stream == 0) {
+        slot = &e;
+      } else if (!oldest || e.lastUsed < oldest->lastUsed) {
+        oldest = &e;
+      }
+    }
+    if (slot && memoryUsed + size <= ART_CACHE_MEMORY) {
+      *slot = {stream, image, data, size, ++useCounter};
+      memoryUsed += size;
+      break;
+    }
+    if (!oldest) {
+      // Larger than the whole cache
+      free(data);
+      break;
+    }
+    evict(*oldest);
+  }
+  xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * @brief Drop an image from memory
+ * @param entry Entry to free
+ */
+void ArtCache::evict(Entry& entry) {
+  free(entry.data);
+  memoryUsed -= entry.size;
+  entry = {0, 0, nullptr, 0, 0};
+}
+
+/**
+ * @brief Load the image of a stream from SPIFFS
+ * @details Files are named after the stream URL hash and start with the
+ * image URL hash, so a changed logo is noticed by request().
+ * @param stream Stream URL hash
+ * @param image Image URL hash read from the file
+ * @param size Image size
+ * @return Image data allocated with ART_MALLOC, or nullptr
+ */
+uint8_t* ArtCache::loadFromFlash(uint32_t stream, uint32_t& image, size_t& size) {
+#if ART_CACHE_FLASH
+  char path[16];
+  snprintf(path, sizeof(path), "/art_%08lx", (unsigned long)stream);
+  if (!SPIFFS.exists(path)) {
+    return nullptr;
+  }
+  File file = SPIFFS.open(path, "r");
+  if (!file) {
+    return nullptr;
+  }
+  size_t length = file.size();
+  if (length <= sizeof(image) || length - sizeof(image) > ART_CACHE_MAX_IMAGE) {
+    file.close();
+    return nullptr;
+  }
+  size = length - sizeof(image);
+  uint8_t* data = (uint8_t*)ART_MALLOC(size);
+  if (data && (file.read((uint8_t*)&image, sizeof(image)) != sizeof(image) ||
+               file.read(data, size) != size)) {
+    free(data);
+    data = nullptr;
+  }
+  file.close();
+  return data;
+#else
+  return nullptr;
+#endif
+}
+
+/**
+ * @brief Write the image of a stream to SPIFFS
+ * @details Skipped when it would leave less than ART_CACHE_FLASH_RESERVE
+ * bytes free, the cache then works from memory only.
+ * @param stream Stream URL hash
+ * @param image Image URL hash
+ * @param data Image data
+ * @param size Image size
+ */
+void ArtCache::saveToFlash(uint32_t stream, uint32_t image, const uint8_t* data, size_t size) {
+#if ART_CACHE_FLASH
+  char path[16];
+  snprintf(path, sizeof(path), "/art_%08lx", (unsigned long)stream);
+  // Replace the previous image of this stream
+  if (SPIFFS.exists(path)) {
+    SPIFFS.remove(path);
+  }
+  if (SPIFFS.usedBytes() + size + ART_CACHE_FLASH_RESERVE > SPIFFS.totalBytes()) {
+    return;
+  }
+  File file = SPIFFS.open(path, "w");
+  if (!file) {
+    return;
+  }
+  bool ok = file.write((const uint8_t*)&image, sizeof(image)) == sizeof(image) &&
+            file.write(data, size) == size;
+  file.close();
+  if (!ok) {
+    SPIFFS.remove(path);
+  }
+#endif
+}
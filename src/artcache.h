@@ -0,0 +1,195 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARTCACHE_H
+#define ARTCACHE_H
+
+#include <Arduino.h>
+
+// Cache sizes, images live in PSRAM when the board has it
+#if defined(BOARD_HAS_PSRAM)
+#ifndef ART_CACHE_ENTRIES
+#define ART_CACHE_ENTRIES 16              ///< Images kept in memory
+#endif
+#ifndef ART_CACHE_MEMORY
+#define ART_CACHE_MEMORY (512 * 1024)     ///< Memory for all images
+#endif
+#ifndef ART_CACHE_MAX_IMAGE
+#define ART_CACHE_MAX_IMAGE (128 * 1024)  ///< Largest image accepted
+#endif
+#else
+#ifndef ART_CACHE_ENTRIES
+#define ART_CACHE_ENTRIES 4
+#endif
+#ifndef ART_CACHE_MEMORY
+#define ART_CACHE_MEMORY (48 * 1024)
+#endif
+#ifndef ART_CACHE_MAX_IMAGE
+#define ART_CACHE_MAX_IMAGE (24 * 1024)
+#endif
+#endif
+
+// Keep fetched images in SPIFFS too, so they survive reboots and evictions
+#ifndef ART_CACHE_FLASH
+#define ART_CACHE_FLASH 1
+#endif
+
+// SPIFFS space left free for the configuration and playlist
+#ifndef ART_CACHE_FLASH_RESERVE
+#define ART_CACHE_FLASH_RESERVE (64 * 1024)
+#endif
+
+// Longest time spent fetching one image, in milliseconds
+#ifndef ART_FETCH_TIMEOUT
+#define ART_FETCH_TIMEOUT 3000
+#endif
+
+// Streams remembered as having no image, so a miss reads SPIFFS once
+#ifndef ART_CACHE_MISSES
+#define ART_CACHE_MISSES 16
+#endif
+
+// Fetch task settings
+#ifndef ART_TASK_PRIORITY
+#define ART_TASK_PRIORITY 1        ///< Same as loop(), the fetch is not urgent
+#endif
+#ifndef ART_TASK_STACK_SIZE
+#define ART_TASK_STACK_SIZE 8192   ///< Stack size in bytes, room for a TLS handshake
+#endif
+#ifndef ART_TASK_CORE
+#define ART_TASK_CORE 1            ///< Same core as loop(), the audio task runs on core 0
+#endif
+#ifndef ART_TASK_POLL_MS
+#define ART_TASK_POLL_MS 100       ///< Longest wait before a requested fetch starts
+#endif
+
+/**
+ * @brief Station art cache
+ * @details Keeps the logos and cover images of recently played stations,
+ * keyed by the stream URL, so MPD clients get them from the device instead
+ * of the internet. Images are fetched by their own task when the stream
+ * reports its icon URL, kept in memory with least recently used eviction
+ * and, when ART_CACHE_FLASH is set, written to SPIFFS to be reloaded on a
+ * miss. Streams found in neither are remembered, so asking again for a
+ * station without art does not read SPIFFS.
+ *
+ * The cache is used from several tasks and guards itself with a recursive
+ * mutex. acquire() returns with the mutex held so the image cannot be
+ * evicted while it is sent; release() must follow.
+ */
+class ArtCache {
+public:
+  ArtCache();
+
+  /**
+   * @brief Set the image of a stream
+   * @details Records the image URL of a stream and schedules a fetch, unless
+   * the same image is already cached. Safe to call from any task.
+   * @param streamUrl Stream URL, the key clients ask for
+   * @param imageUrl URL of the logo or cover image
+   */
+  void request(const char* streamUrl, const char* imageUrl);
+
+  /**
+   * @brief Fetch the scheduled image, if any
+   * @details Blocks for up to ART_FETCH_TIMEOUT. Called by the fetch task,
+   * or by loop() if the task could not be started.
+   * @return true if a new image was stored
+   */
+  bool handle();
+
+  /**
+   * @brief Start the fetch task
+   * @return true if the task was created, false if loop() has to call handle()
+   */
+  bool startTask();
+
+  /**
+   * @brief Check whether the fetch task is running
+   * @return true if the task runs handle()
+   */
+  bool isTaskRunning() const { return taskHandle != nullptr; }
+
+  /**
+   * @brief Get the number of images fetched since boot
+   * @details Lets loop() notice new images without polling the cache.
+   * @return Fetch counter
+   */
+  uint32_t getVersion() const { return version; }
+
+  /**
+   * @brief Get the image of a stream and lock it in the cache
+   * @details Looks the image up in memory, then in SPIFFS. On success the
+   * cache stays locked until release() is called.
+   * @param streamUrl Stream URL
+   * @param size Image size in bytes
+   * @return Image data, or nullptr if there is no image for this stream
+   */
+  const uint8_t* acquire(const char* streamUrl, size_t& size);
+
+  /**
+   * @brief Unlock the image returned by acquire()
+   */
+  void release();
+
+  /**
+   * @brief Guess the MIME type of an image from its first bytes
+   * @param data Image data
+   * @param size Image size
+   * @return MIME type, "application/octet-stream" if unknown
+   */
+  static const char* mimeType(const uint8_t* data, size_t size);
+
+private:
+  /**
+   * @brief One cached image
+   */
+  struct Entry {
+    uint32_t stream;    ///< Hash of the stream URL, 0 for a free entry
+    uint32_t image;     ///< Hash of the image URL
+    uint8_t* data;      ///< Image data
+    size_t size;        ///< Image size
+    uint32_t lastUsed;  ///< Use counter value at the last access
+  };
+
+  Entry entries[ART_CACHE_ENTRIES];  ///< Cached images
+  size_t memoryUsed;                 ///< Bytes used by all images
+  uint32_t useCounter;               ///< Incremented on every access, for LRU
+  SemaphoreHandle_t mutex;           ///< Guards the entries and the pending fetch
+  uint32_t misses[ART_CACHE_MISSES]; ///< Hashes of streams without an image
+  int nextMiss;                      ///< Slot of the next miss, round robin
+  TaskHandle_t taskHandle = nullptr; ///< Fetch task, if started
+  volatile uint32_t version;         ///< Incremented for every image fetched
+
+  // Fetch scheduled by request()
+  volatile bool pending;             ///< A fetch is scheduled
+  uint32_t pendingStream;            ///< Hash of the stream URL to fetch for
+  char pendingImage[256];            ///< Image URL to fetch
+
+  Entry* find(uint32_t stream);
+  bool isMiss(uint32_t stream) const;
+  void setMiss(uint32_t stream, bool miss);
+  static void artTask(void* parameters);
+  void store(uint32_t stream, uint32_t image, uint8_t* data, size_t size);
+  void evict(Entry& entry);
+  uint8_t* loadFromFlash(uint32_t stream, uint32_t& image, size_t& size);
+  void saveToFlash(uint32_t stream, uint32_t image, const uint8_t* data, size_t size);
+  static uint32_t hash(const char* text);
+};
+
+#endif // ARTCACHE_H
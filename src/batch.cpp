@@ -0,0 +1,299 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "batch.h"
+#include "main.h"
+#include "player.h"
+#include "playlist.h"
+
+/**
+ * @brief PlayerBatch constructor
+ * @param playerRef Player the actions apply to
+ */
+PlayerBatch::PlayerBatch(Player& playerRef) : player(playerRef) {
+  reset();
+}
+
+/**
+ * @brief Check and apply a batch
+ * @param actions Array of actions
+ * @return true if applied, false if rejected (see error())
+ */
+bool PlayerBatch::run(JsonVariantConst actions) {
+  reset();
+  if (!actions.is<JsonArrayConst>()) {
+    errorMessage = "Batch must be an array of actions";
+    return false;
+  }
+  JsonArrayConst list = actions.as<JsonArrayConst>();
+  if (list.size() == 0) {
+    errorMessage = "Batch has no actions";
+    return false;
+  }
+  if (list.size() > BATCH_MAX_ACTIONS) {
+    errorMessage = "Batch has more than " + String(BATCH_MAX_ACTIONS) + " actions";
+    return false;
+  }
+  {
+    // Nobody else changes the player between the checks and the changes
+    PlayerLock guard(player);
+    int position = 0;
+    int playPosition = -1;
+    for (JsonVariantConst action : list) {
+      if (!action.is<JsonObjectConst>()) {
+        return fail(position, "Action must be an object");
+      }
+      if (!parseAction(action.as<JsonObjectConst>(), position)) {
+        return false;
+      }
+      if (transport == TRANSPORT_PLAY) {
+        playPosition = position;
+      }
+      position++;
+    }
+    // A new selection while playing switches to it
+    if (transport == TRANSPORT_NONE && select >= 0 && player.isPlaying() &&
+        select != player.getPlaylistIndex()) {
+      transport = TRANSPORT_PLAY;
+      playPosition = position - 1;
+    }
+    if (transport == TRANSPORT_PLAY && url.length() == 0 && !resolvePlay(playPosition)) {
+      return false;
+    }
+    apply();
+  }
+  // Persist and broadcast once for the whole batch
+  player.savePlayerState();
+  updateDisplay();
+  sendStatusToClients();
+  return true;
+}
+
+/**
+ * @brief Get the reason a batch was rejected
+ * @return Error message, naming the action at fault
+ */
+const String& PlayerBatch::error() const {
+  return errorMessage;
+}
+
+/**
+ * @brief Add the resulting player and mixer state to a response
+ * @param obj Object to fill
+ */
+void PlayerBatch::report(JsonObject obj) const {
+  obj["state"] = player.isPlaying() ? "play" : "stop";
+  obj["index"] = player.getPlaylistIndex();
+  obj["name"] = player.getStreamName();
+  obj["volume"] = player.getVolume();
+  obj["bass"] = player.getBass();
+  obj["mid"] = player.getMid();
+  obj["treble"] = player.getTreble();
+}
+
+/**
+ * @brief Forget the previous batch
+ */
+void PlayerBatch::reset() {
+  select = -1;
+  volume = -1;
+  for (int i = 0; i < 3; i++) {
+    tone[i] = 0;
+    toneSet[i] = false;
+  }
+  transport = TRANSPORT_NONE;
+  url = String();
+  name = String();
+  errorMessage = String();
+}
+
+/**
+ * @brief Check one action and add it to the batch
+ * @param action Action object
+ * @param position Position of the action, for error messages
+ * @return false if the action is invalid
+ */
+bool PlayerBatch::parseAction(JsonObjectConst action, int position) {
+  const char* type = action["action"] | "";
+  int index = -1;
+  if (action.containsKey("index") && !readInt(action["index"], index)) {
+    return fail(position, "Index must be a number");
+  }
+  if (index >= player.getPlaylistCount()) {
+    return fail(position, "Invalid playlist index");
+  }
+  if (strcmp(type, "select") == 0) {
+    if (index < 0) {
+      return fail(position, "Missing playlist index");
+    }
+    select = index;
+  } else if (strcmp(type, "play") == 0) {
+    transport = TRANSPORT_PLAY;
+    url = action["url"] | "";
+    name = action["name"] | "";
+    if (url.length() > 0) {
+      if (!url.startsWith("http://") && !url.startsWith("https://")) {
+        return fail(position, "Invalid URL format. Must start with http:// or https://");
+      }
+      if (name.length() == 0) {
+        name = "Unknown Station";
+      }
+      // The selection follows the stream, see apply()
+      select = -1;
+    } else if (index >= 0) {
+      select = index;
+    }
+  } else if (strcmp(type, "stop") == 0) {
+    transport = TRANSPORT_STOP;
+    url = String();
+  } else if (strcmp(type, "mixer") == 0) {
+    return parseMixer(action, position);
+  } else {
+    return fail(position, "Invalid action. Supported actions: select, play, stop, mixer");
+  }
+  return true;
+}
+
+/**
+ * @brief Check a mixer action and add it to the batch
+ * @param action Action object
+ * @param position Position of the action, for error messages
+ * @return false if a value is out of range
+ */
+bool PlayerBatch::parseMixer(JsonObjectConst action, int position) {
+  static const char* const keys[3] = {"bass", "mid", "treble"};
+  static const char* const errors[3] = {
+    "Bass must be between -6 and 6", "Midrange must be between -6 and 6", "Treble must be between -6 and 6",
+  };
+  bool found = false;
+  if (action.containsKey("volume")) {
+    int value;
+    if (!readInt(action["volume"], value) || value < 0 || value > 22) {
+      return fail(position, "Volume must be between 0 and 22");
+    }
+    volume = value;
+    found = true;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (action.containsKey(keys[i])) {
+      int value;
+      if (!readInt(action[keys[i]], value) || value < -6 || value > 6) {
+        return fail(position, errors[i]);
+      }
+      tone[i] = value;
+      toneSet[i] = true;
+      found = true;
+    }
+  }
+  if (!found) {
+    return fail(position, "Missing data: volume, bass, mid, or treble");
+  }
+  return true;
+}
+
+/**
+ * @brief Find the stream to play when the batch names none
+ * @details The stream selected by the batch, else the current stream,
+ * else the selected playlist position.
+ * @param position Position of the play action, for error messages
+ * @return false if there is nothing to play
+ */
+bool PlayerBatch::resolvePlay(int position) {
+  if (select < 0 && player.getStreamUrl()[0] != '\0') {
+    url = player.getStreamUrl();
+    name = player.getStreamName()[0] != '\0' ? player.getStreamName() : "Unknown Station";
+    return true;
+  }
+  int index = select >= 0 ? select : player.getPlaylistIndex();
+  if (index < 0 || index >= player.getPlaylistCount()) {
+    return fail(position, "Missing required parameters for play action");
+  }
+  const StreamInfo& item = player.getPlaylistItem(index);
+  url = item.url;
+  name = item.name;
+  select = index;
+  return true;
+}
+
+/**
+ * @brief Reject the batch
+ * @param position Position of the action at fault
+ * @param message Reason
+ * @return false
+ */
+bool PlayerBatch::fail(int position, const char* message) {
+  errorMessage = "Action " + String(position) + ": " + message;
+  return false;
+}
+
+/**
+ * @brief Make the changes, with the player locked by the caller
+ * @details Nothing is announced here, run() refreshes the display and the
+ * web clients once with the final state.
+ */
+void PlayerBatch::apply() {
+  if (volume >= 0) {
+    player.setVolume(volume);
+  }
+  if (toneSet[0] || toneSet[1] || toneSet[2]) {
+    player.setTone(toneSet[0] ? tone[0] : player.getBass(), toneSet[1] ? tone[1] : player.getMid(),
+                   toneSet[2] ? tone[2] : player.getTreble());
+  }
+  if (select >= 0) {
+    player.setPlaylistIndex(select);
+  }
+  if (transport == TRANSPORT_STOP) {
+    player.stopStream(false);
+  } else if (transport == TRANSPORT_PLAY) {
+    // Keep the selection on a playlist stream given by URL
+    if (select < 0) {
+      for (int i = 0; i < player.getPlaylistCount(); i++) {
+        if (url == player.getPlaylistItem(i).url) {
+          player.setPlaylistIndex(i);
+          break;
+        }
+      }
+    }
+    player.stopStream(false);
+    player.startStream(url.c_str(), name.c_str(), false);
+  }
+}
+
+/**
+ * @brief Read an integer given as a number or a numeric string
+ * @param value JSON value
+ * @param out Integer read
+ * @return false if the value is neither
+ */
+bool PlayerBatch::readInt(JsonVariantConst value, int& out) {
+  if (value.is<const char*>()) {
+    const char* text = value.as<const char*>();
+    char* end;
+    long number = strtol(text, &end, 10);
+    if (end == text || *end != '\0') {
+      return false;
+    }
+    out = (int)number;
+    return true;
+  }
+  if (value.is<int>()) {
+    out = value.as<int>();
+    return true;
+  }
+  return false;
+}
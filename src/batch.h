@@ -0,0 +1,105 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class Player;
+
+// Most actions accepted in one batch
+#ifndef BATCH_MAX_ACTIONS
+#define BATCH_MAX_ACTIONS 16
+#endif
+
+/**
+ * @brief Applies several player and mixer actions as one change
+ * @details Takes the array posted to /api/batch, for instance
+ *   [{"action": "select", "index": 5},
+ *    {"action": "mixer", "volume": 12, "bass": 2},
+ *    {"action": "play"}]
+ * Actions:
+ *   select  {"index": n}, select a playlist position, switching to it if
+ *           playing, as the control protocol does
+ *   play    {"index": n} or {"url": "...", "name": "..."}, or nothing for
+ *           the selected stream (the current one if none is selected)
+ *   stop    stop playback
+ *   mixer   any of "volume" (0-22), "bass", "mid", "treble" (-6 to 6)
+ *
+ * The whole batch is checked first and nothing changes if an action is
+ * invalid. It is then applied with the player locked, so MPD and the other
+ * clients never see half of it: later values of the same setting win, the
+ * mixer is set before the stream starts and the stream is switched at most
+ * once. The state is saved and the display and WebSocket clients updated
+ * once, at the end.
+ */
+class PlayerBatch {
+public:
+  PlayerBatch(Player& playerRef);
+
+  /**
+   * @brief Check and apply a batch
+   * @param actions Array of actions
+   * @return true if applied, false if rejected (see error())
+   */
+  bool run(JsonVariantConst actions);
+
+  /**
+   * @brief Get the reason a batch was rejected
+   * @return Error message, naming the action at fault
+   */
+  const String& error() const;
+
+  /**
+   * @brief Add the resulting player and mixer state to a response
+   * @param obj Object to fill
+   */
+  void report(JsonObject obj) const;
+
+private:
+  /**
+   * @brief Playback change requested by the batch
+   */
+  enum Transport {
+    TRANSPORT_NONE,
+    TRANSPORT_PLAY,
+    TRANSPORT_STOP,
+  };
+
+  Player& player;
+  int select;           ///< Playlist position to select, -1 to keep
+  int volume;           ///< Volume to set, -1 to keep
+  int tone[3];          ///< Bass, mid and treble to set
+  bool toneSet[3];      ///< Which tone controls to set
+  Transport transport;  ///< Playback change
+  String url;           ///< Stream to play, empty for the selected one
+  String name;          ///< Name of that stream
+  String errorMessage;
+
+  void reset();
+  bool parseAction(JsonObjectConst action, int position);
+  bool parseMixer(JsonObjectConst action, int position);
+  bool resolvePlay(int position);
+  bool fail(int position, const char* message);
+  void apply();
+  static bool readInt(JsonVariantConst value, int& out);
+};
+
+#endif // BATCH_H
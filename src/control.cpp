@@ -0,0 +1,322 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "control.h"
+#include "main.h"
+#include "player.h"
+#include "playlist.h"
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <errno.h>
+
+// lwIP never raises SIGPIPE and may not know the flag
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * @brief ControlInterface constructor
+ * @param serverRef WiFiServer instance for control connections
+ * @param playerRef Player instance for controlling playback
+ */
+ControlInterface::ControlInterface(WiFiServer& serverRef, Player& playerRef)
+    : controlServer(serverRef), player(playerRef) {
+}
+
+/**
+ * @brief Accept connections, answer requests and push changes
+ * @details Requests may arrive split over several reads, each session keeps
+ * the part of the frame received so far. The player is locked only when a
+ * request is complete or a change is due to be pushed, then once for all of
+ * them, so the status frames are consistent and idle passes do not contend
+ * with the audio and MPD tasks.
+ */
+void ControlInterface::handleClient() {
+  // Close sessions whose client disconnected
+  for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+    if (sessions[i].client && !sessions[i].client.connected()) {
+      closeSession(sessions[i]);
+    }
+  }
+  // Accept new connections into a free slot
+  if (controlServer.hasClient()) {
+    Session* slot = nullptr;
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+      if (!sessions[i].client.connected()) {
+        slot = &sessions[i];
+        break;
+      }
+    }
+    WiFiClient newClient = controlServer.available();
+    if (slot) {
+      closeSession(*slot);
+      slot->client = newClient;
+      slot->client.setNoDelay(true);
+    } else {
+      newClient.stop();
+    }
+  }
+  // Receive the requests, nothing to do until one is complete
+  bool ready = false;
+  for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+    ready |= readFrame(sessions[i]);
+  }
+  if (!ready && eventVersion() == pushedVersion) {
+    return;
+  }
+  // Answer the complete requests
+  uint8_t reply[CONTROL_STATUS_SIZE];
+  PlayerLock guard(this->player);
+  for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+    Session& s = sessions[i];
+    while (s.client && s.length == CONTROL_REQUEST_SIZE) {
+      s.length = 0;
+      execute(s.frame, reply);
+      if (s.frame[1] == CONTROL_OP_SUBSCRIBE && reply[3] == CONTROL_OK) {
+        s.subscribed = s.frame[4] != 0;
+      }
+      if (!sendFrame(s, reply)) {
+        break;
+      }
+      // Pipelined requests
+      readFrame(s);
+    }
+  }
+  // Push the changes made by anyone, these requests included
+  uint32_t version = eventVersion();
+  if (version != pushedVersion) {
+    pushedVersion = version;
+    fillStatus(reply, CONTROL_OP_PUSH, 0, CONTROL_OK);
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+      if (sessions[i].client && sessions[i].subscribed) {
+        sendFrame(sessions[i], reply);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Read the rest of the request frame of a session
+ * @details Stops at the end of the frame, the following requests stay in
+ * the socket until this one is answered.
+ * @param s Session to read from
+ * @return true if the session has a complete request
+ */
+bool ControlInterface::readFrame(Session& s) {
+  while (s.client && s.length < CONTROL_REQUEST_SIZE && s.client.available() > 0) {
+    int n = s.client.read(s.frame + s.length, CONTROL_REQUEST_SIZE - s.length);
+    if (n <= 0) {
+      break;
+    }
+    s.length += n;
+    if (s.frame[0] != CONTROL_MAGIC) {
+      closeSession(s);
+      return false;
+    }
+  }
+  return s.client && s.length == CONTROL_REQUEST_SIZE;
+}
+
+/**
+ * @brief Execute one request frame
+ * @details Uses the same Player calls as the MPD play, stop and setvol
+ * handlers. The caller holds the player lock.
+ * @param request Request frame, CONTROL_REQUEST_SIZE bytes
+ * @param reply Status frame, CONTROL_STATUS_SIZE bytes
+ */
+void ControlInterface::execute(const uint8_t* request, uint8_t* reply) {
+  uint8_t op = request[1];
+  int32_t arg = (int32_t)((uint32_t)request[4] | (uint32_t)request[5] << 8 |
+                          (uint32_t)request[6] << 16 | (uint32_t)request[7] << 24);
+  int count = this->player.getPlaylistCount();
+  uint8_t result = CONTROL_OK;
+  switch (op) {
+    case CONTROL_OP_STATUS:
+      break;
+    case CONTROL_OP_PLAY:
+    case CONTROL_OP_SELECT:
+      if (arg < (op == CONTROL_OP_PLAY ? -1 : 0) || arg >= count) {
+        result = CONTROL_ERR_ARG;
+      } else if (op == CONTROL_OP_SELECT && !this->player.isPlaying()) {
+        // Only remember the selection, like turning the rotary encoder
+        this->player.setPlaylistIndex(arg);
+        this->player.savePlayerState();
+        updateDisplay();
+      } else {
+        int index = arg >= 0 ? arg : this->player.getPlaylistIndex();
+        if (index < 0 || index >= count) {
+          result = CONTROL_ERR_FAILED;
+        } else {
+          this->player.stopStream();
+          this->player.setPlaylistIndex(index);
+          const StreamInfo& item = this->player.getPlaylistItem(index);
+          this->player.startStream(item.url, item.name);
+          this->player.savePlayerState();
+        }
+      }
+      break;
+    case CONTROL_OP_STOP:
+      this->player.stopStream();
+      break;
+    case CONTROL_OP_VOLUME:
+      if (arg < 0 || arg > 100) {
+        result = CONTROL_ERR_ARG;
+      } else {
+        // Same 0-100 to 0-22 scale conversion as the MPD setvol command
+        this->player.setVolume(map(arg, 0, 100, 0, 22));
+        updateDisplay();
+        sendStatusToClients();
+      }
+      break;
+    case CONTROL_OP_SUBSCRIBE:
+      if (arg != 0 && arg != 1) {
+        result = CONTROL_ERR_ARG;
+      }
+      break;
+    default:
+      result = CONTROL_ERR_OP;
+      break;
+  }
+  fillStatus(reply, op, request[2], result);
+}
+
+/**
+ * @brief Fill a status frame
+ * @param reply Status frame, CONTROL_STATUS_SIZE bytes
+ * @param op Operation answered, or CONTROL_OP_PUSH
+ * @param seq Sequence number of the request, 0 for pushes
+ * @param result Result code
+ */
+void ControlInterface::fillStatus(uint8_t* reply, uint8_t op, uint8_t seq, uint8_t result) {
+  int16_t index = (int16_t)this->player.getPlaylistIndex();
+  uint16_t count = (uint16_t)this->player.getPlaylistCount();
+  uint16_t bitrate = (uint16_t)this->player.getBitrate();
+  uint32_t elapsed = 0;
+  if (this->player.isPlaying() && this->player.getPlayStartTime() > 0) {
+    elapsed = (millis() / 1000) - this->player.getPlayStartTime();
+  }
+  reply[0] = CONTROL_MAGIC;
+  reply[1] = op;
+  reply[2] = seq;
+  reply[3] = result;
+  reply[4] = this->player.isPlaying() ? 1 : 0;
+  reply[5] = (uint8_t)map(this->player.getVolume(), 0, 22, 0, 100);
+  reply[6] = (uint8_t)index;
+  reply[7] = (uint8_t)((uint16_t)index >> 8);
+  reply[8] = (uint8_t)count;
+  reply[9] = (uint8_t)(count >> 8);
+  reply[10] = (uint8_t)bitrate;
+  reply[11] = (uint8_t)(bitrate >> 8);
+  reply[12] = (uint8_t)elapsed;
+  reply[13] = (uint8_t)(elapsed >> 8);
+  reply[14] = (uint8_t)(elapsed >> 16);
+  reply[15] = (uint8_t)(elapsed >> 24);
+}
+
+/**
+ * @brief Combine the change counters of the pushed subsystems
+ * @return A value that changes whenever one of the counters does
+ */
+uint32_t ControlInterface::eventVersion() const {
+  return this->player.getEventVersion(PLAYER_EVENT_PLAYER) +
+         this->player.getEventVersion(PLAYER_EVENT_MIXER) +
+         this->player.getEventVersion(PLAYER_EVENT_PLAYLIST);
+}
+
+/**
+ * @brief Send a status frame without blocking
+ * @details A 16 byte frame only fails to fit when the client has not read
+ * kilobytes of earlier frames; such a client is disconnected.
+ * @param s Session to send to
+ * @param frame Status frame, CONTROL_STATUS_SIZE bytes
+ * @return true if the frame was sent
+ */
+bool ControlInterface::sendFrame(Session& s, const uint8_t* frame) {
+  int fd = s.client.fd();
+  ssize_t sent = fd >= 0 ? ::send(fd, frame, CONTROL_STATUS_SIZE, MSG_DONTWAIT | MSG_NOSIGNAL) : -1;
+  if (sent != CONTROL_STATUS_SIZE) {
+    closeSession(s);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Disconnect a session and free its slot
+ * @param s Session to close
+ */
+void ControlInterface::closeSession(Session& s) {
+  s.client.stop();
+  s.length = 0;
+  s.subscribed = false;
+}
+
+/**
+ * @brief Start the control task
+ * @details Runs the control server next to the MPD task, with the same
+ * priority and core, so automation requests do not wait for loop().
+ * @return true if the task was created, false if loop() has to call handleClient()
+ */
+bool ControlInterface::startTask() {
+  BaseType_t result = xTaskCreatePinnedToCore(controlTask, "ControlTask", CONTROL_TASK_STACK_SIZE, this,
+                                              CONTROL_TASK_PRIORITY, &taskHandle, CONTROL_TASK_CORE);
+  if (result != pdPASS) {
+    taskHandle = nullptr;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Control task function
+ * @param parameters The ControlInterface instance
+ */
+void ControlInterface::controlTask(void* parameters) {
+  ControlInterface* self = (ControlInterface*)parameters;
+  while (true) {
+    self->handleClient();
+    self->waitForActivity(CONTROL_TASK_POLL_MS);
+  }
+}
+
+/**
+ * @brief Wait for data from any client
+ * @details Blocks in select() on the connected sockets for up to timeoutMs,
+ * the longest new connections and player changes wait to be handled.
+ * @param timeoutMs Longest wait in milliseconds
+ */
+void ControlInterface::waitForActivity(unsigned long timeoutMs) {
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  int maxFd = -1;
+  for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+    int fd = sessions[i].client ? sessions[i].client.fd() : -1;
+    if (fd >= 0) {
+      FD_SET(fd, &readSet);
+      maxFd = max(maxFd, fd);
+    }
+  }
+  if (maxFd < 0) {
+    vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+    return;
+  }
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  select(maxFd + 1, &readSet, nullptr, nullptr, &tv);
+}
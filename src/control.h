@@ -0,0 +1,149 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+class Player;
+
+// Default TCP port of the binary control protocol, 0 disables it
+#ifndef DEFAULT_CONTROL_PORT
+#define DEFAULT_CONTROL_PORT 0
+#endif
+
+// Maximum number of simultaneous control connections
+#ifndef CONTROL_MAX_CLIENTS
+#define CONTROL_MAX_CLIENTS 2
+#endif
+
+// Control task settings, same scheduling as the MPD task
+#ifndef CONTROL_TASK_PRIORITY
+#define CONTROL_TASK_PRIORITY 3
+#endif
+#ifndef CONTROL_TASK_STACK_SIZE
+#define CONTROL_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONTROL_TASK_CORE
+#define CONTROL_TASK_CORE 1
+#endif
+#ifndef CONTROL_TASK_POLL_MS
+#define CONTROL_TASK_POLL_MS 10
+#endif
+
+// Frame layout, all multi-byte fields are little endian
+#define CONTROL_MAGIC        0xCB  ///< First byte of every frame
+#define CONTROL_REQUEST_SIZE 8     ///< magic, op, seq, flags, int32 argument
+#define CONTROL_STATUS_SIZE  16    ///< magic, op, seq, result, status fields
+
+// Request operations
+#define CONTROL_OP_STATUS    0x01  ///< Report the status
+#define CONTROL_OP_PLAY      0x02  ///< Play the stream at the argument position, -1 for the selected one
+#define CONTROL_OP_STOP      0x03  ///< Stop playback
+#define CONTROL_OP_VOLUME    0x04  ///< Set the volume, argument 0 to 100
+#define CONTROL_OP_SELECT    0x05  ///< Select the stream at the argument position, switch to it if playing
+#define CONTROL_OP_SUBSCRIBE 0x06  ///< Push status changes, argument 1 to start and 0 to stop
+#define CONTROL_OP_PUSH      0x80  ///< Operation of pushed status frames
+
+// Result codes
+#define CONTROL_OK           0     ///< Done
+#define CONTROL_ERR_OP       1     ///< Unknown operation
+#define CONTROL_ERR_ARG      2     ///< Argument out of range
+#define CONTROL_ERR_FAILED   3     ///< The player could not do it, e.g. empty playlist
+
+/**
+ * @brief Binary control protocol server
+ * @details A small alternative to MPD for home automation: requests and
+ * replies are fixed-size frames, so a command costs a table-free switch and
+ * no text parsing or formatting.
+ *
+ * Requests are CONTROL_REQUEST_SIZE bytes:
+ * | 0 magic | 1 op | 2 seq | 3 flags (0) | 4-7 int32 argument |
+ *
+ * Every request is answered with a status frame of CONTROL_STATUS_SIZE
+ * bytes, so the caller sees the outcome without another round trip:
+ * | 0 magic | 1 op | 2 seq | 3 result | 4 playing | 5 volume (0-100) |
+ * | 6-7 int16 position | 8-9 uint16 streams | 10-11 uint16 kbps | 12-15 uint32 elapsed s |
+ *
+ * Subscribed connections also get a status frame with op CONTROL_OP_PUSH and
+ * seq 0 whenever playback, volume or the playlist change. A frame with a bad
+ * magic byte closes the connection, the stream cannot be resynchronized.
+ *
+ * Commands go through the same Player calls as the MPD handlers, with the
+ * player locked.
+ */
+class ControlInterface {
+public:
+  ControlInterface(WiFiServer& serverRef, Player& playerRef);
+
+  /**
+   * @brief Accept connections, answer requests and push changes
+   * @details Never blocks: replies that the socket does not take right away
+   * mean the client stopped reading, and it is disconnected.
+   */
+  void handleClient();
+
+  /**
+   * @brief Start the control task
+   * @return true if the task was created, false if loop() has to call handleClient()
+   */
+  bool startTask();
+
+  /**
+   * @brief Check if the control server runs in its own task
+   * @return true if the control task was started
+   */
+  bool isTaskRunning() const { return taskHandle != nullptr; }
+
+  /**
+   * @brief Execute one request frame
+   * @details Public for the benchmark, which times it alone.
+   * @param request Request frame, CONTROL_REQUEST_SIZE bytes
+   * @param reply Status frame, CONTROL_STATUS_SIZE bytes
+   */
+  void execute(const uint8_t* request, uint8_t* reply);
+
+private:
+  /**
+   * @brief One control connection
+   */
+  struct Session {
+    WiFiClient client;                     ///< Client connection
+    uint8_t frame[CONTROL_REQUEST_SIZE];   ///< Request being received
+    uint8_t length = 0;                    ///< Bytes of the request received
+    bool subscribed = false;               ///< Push status changes
+  };
+
+  WiFiServer& controlServer;               ///< Listening socket
+  Player& player;                          ///< Player controlled
+  Session sessions[CONTROL_MAX_CLIENTS];   ///< Connected clients
+  uint32_t pushedVersion = 0;              ///< Player event versions at the last push
+  TaskHandle_t taskHandle = nullptr;       ///< Control task, if started
+
+  void fillStatus(uint8_t* reply, uint8_t op, uint8_t seq, uint8_t result);
+  uint32_t eventVersion() const;
+  bool readFrame(Session& s);
+  bool sendFrame(Session& s, const uint8_t* frame);
+  void closeSession(Session& s);
+  void waitForActivity(unsigned long timeoutMs);
+  static void controlTask(void* parameters);
+};
+
+#endif // CONTROL_H
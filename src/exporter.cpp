@@ -0,0 +1,232 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "exporter.h"
+#include "main.h"
+
+/**
+ * @brief Copy text to the output, as far as it fits
+ * @details Strings are escaped as JSON requires; an escape sequence is
+ * never split, it waits for the next buffer instead.
+ * @param out Output position, advanced
+ * @param end End of the output buffer
+ * @param text Text to copy
+ * @param offset Characters of text already copied, advanced
+ * @param escape Escape the text as the content of a JSON string
+ * @return true if the whole text was copied
+ */
+static bool putText(uint8_t*& out, uint8_t* end, const char* text, size_t& offset, bool escape) {
+  for (const char* p = text + offset; *p; p++) {
+    unsigned char ch = (unsigned char)*p;
+    char sequence[8];
+    size_t length = 0;
+    if (escape && (ch == '"' || ch == '\\')) {
+      sequence[0] = '\\';
+      sequence[1] = ch;
+      length = 2;
+    } else if (escape && ch < 0x20) {
+      length = snprintf(sequence, sizeof(sequence), "\\u%04x", ch);
+    }
+    if (length == 0) {
+      if (out >= end) {
+        return false;
+      }
+      *out++ = ch;
+    } else {
+      if ((size_t)(end - out) < length) {
+        return false;
+      }
+      memcpy(out, sequence, length);
+      out += length;
+    }
+    offset++;
+  }
+  return true;
+}
+
+/**
+ * @brief PlaylistExporter constructor
+ * @param playerRef Player whose playlist is exported
+ */
+PlaylistExporter::PlaylistExporter(Player& playerRef)
+  : player(playerRef), part(PART_OPEN), offset(0), index(0) {
+  item.name[0] = '\0';
+  item.url[0] = '\0';
+}
+
+/**
+ * @brief Get the next piece of the JSON text
+ * @param buffer Buffer to fill
+ * @param size Buffer size
+ * @return Bytes stored, negative at the end
+ */
+int PlaylistExporter::read(uint8_t* buffer, size_t size) {
+  uint8_t* out = buffer;
+  uint8_t* end = buffer + size;
+  while (part != PART_DONE && out < end) {
+    bool done = false;
+    switch (part) {
+      case PART_OPEN:
+        done = putText(out, end, "[", offset, false);
+        break;
+      case PART_ITEM:
+        if (offset == 0 && !loadItem()) {
+          part = PART_CLOSE;
+          continue;
+        }
+        done = putText(out, end, index ? ",{\"name\":\"" : "{\"name\":\"", offset, false);
+        break;
+      case PART_NAME:
+        done = putText(out, end, item.name, offset, true);
+        break;
+      case PART_URL_KEY:
+        done = putText(out, end, "\",\"url\":\"", offset, false);
+        break;
+      case PART_URL:
+        done = putText(out, end, item.url, offset, true);
+        break;
+      case PART_ITEM_END:
+        done = putText(out, end, "\"}", offset, false);
+        break;
+      case PART_CLOSE:
+        done = putText(out, end, "]", offset, false);
+        break;
+      default:
+        break;
+    }
+    if (!done) {
+      break;
+    }
+    offset = 0;
+    if (part == PART_ITEM_END) {
+      index++;
+      part = PART_ITEM;
+    } else {
+      part = (Part)(part + 1);
+    }
+  }
+  if (out == buffer && part == PART_DONE) {
+    return -1;
+  }
+  return out - buffer;
+}
+
+/**
+ * @brief Copy the next playlist item
+ * @return false if there are no more items
+ */
+bool PlaylistExporter::loadItem() {
+  PlayerLock guard(player);
+  Playlist* playlist = player.getPlaylist();
+  if (index >= playlist->getCount()) {
+    return false;
+  }
+  item = playlist->getItem(index);
+  return true;
+}
+
+// Settings files in the backup, as ConfigImporter takes them
+const char* const ConfigExporter::sectionFiles[ConfigExporter::SECTIONS] = {
+  "/config.json", "/wifi.json", "/playlist.json", "/player.json",
+};
+
+/**
+ * @brief ConfigExporter constructor
+ * @param fsRef Filesystem holding the settings files
+ */
+ConfigExporter::ConfigExporter(fs::FS& fsRef)
+  : fs(fsRef), part(PART_OPEN), offset(0), section(-1), written(0) {
+  key[0] = '\0';
+}
+
+/**
+ * @brief Get the next piece of the backup
+ * @param buffer Buffer to fill
+ * @param size Buffer size
+ * @return Bytes stored, negative at the end
+ */
+int ConfigExporter::read(uint8_t* buffer, size_t size) {
+  uint8_t* out = buffer;
+  uint8_t* end = buffer + size;
+  while (part != PART_DONE && out < end) {
+    bool done = false;
+    switch (part) {
+      case PART_OPEN:
+        done = putText(out, end, "{", offset, false);
+        break;
+      case PART_KEY:
+        if (offset == 0 && !openSection()) {
+          part = PART_CLOSE;
+          continue;
+        }
+        done = putText(out, end, key, offset, false);
+        break;
+      case PART_CONTENT: {
+        // The file goes out as it is, it already holds JSON
+        int n = file.read(out, end - out);
+        if (n > 0) {
+          out += n;
+          continue;
+        }
+        file.close();
+        done = true;
+        break;
+      }
+      case PART_CLOSE:
+        done = putText(out, end, "}", offset, false);
+        break;
+      default:
+        break;
+    }
+    if (!done) {
+      break;
+    }
+    offset = 0;
+    part = (part == PART_CONTENT) ? PART_KEY : (Part)(part + 1);
+  }
+  if (out == buffer && part == PART_DONE) {
+    return -1;
+  }
+  return out - buffer;
+}
+
+/**
+ * @brief Open the next settings file to export
+ * @details Prepares its member name, after a comma unless it is the first.
+ * @return false if there are no more files
+ */
+bool ConfigExporter::openSection() {
+  while (++section < SECTIONS) {
+    const char* path = sectionFiles[section];
+    if (!fs.exists(path)) {
+      continue;
+    }
+    file = fs.open(path, "r");
+    if (!file) {
+      continue;
+    }
+    if (file.size() == 0) {
+      file.close();
+      continue;
+    }
+    snprintf(key, sizeof(key), "%s\n\"%s\":", written ? "," : "", path + 1);
+    written++;
+    return true;
+  }
+  return false;
+}
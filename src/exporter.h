@@ -0,0 +1,117 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "player.h"
+#include "playlist.h"
+
+/**
+ * @brief Serializes the playlist as JSON, a piece at a time
+ * @details Produces the same array of {"name": ..., "url": ...} objects
+ * the playlist file holds, straight from the playlist in memory, into
+ * whatever buffer it is given. Meant as the source of
+ * HTTPServer::sendStream(), so the response is never built in memory.
+ * Items are copied one at a time under the player lock, so the playlist
+ * may change during a long transfer.
+ */
+class PlaylistExporter {
+public:
+  PlaylistExporter(Player& playerRef);
+
+  /**
+   * @brief Get the next piece of the JSON text
+   * @param buffer Buffer to fill
+   * @param size Buffer size
+   * @return Bytes stored, negative at the end
+   */
+  int read(uint8_t* buffer, size_t size);
+
+private:
+  /**
+   * @brief Part of the output being written
+   */
+  enum Part {
+    PART_OPEN,
+    PART_ITEM,
+    PART_NAME,
+    PART_URL_KEY,
+    PART_URL,
+    PART_ITEM_END,
+    PART_CLOSE,
+    PART_DONE,
+  };
+
+  Player& player;
+  Part part;          ///< Part being written
+  size_t offset;      ///< Bytes of the part written
+  int index;          ///< Playlist item being written
+  StreamInfo item;    ///< Copy of that item
+
+  bool loadItem();
+};
+
+/**
+ * @brief Serializes a configuration backup, a piece at a time
+ * @details Produces the object read back by ConfigImporter, one member per
+ * settings file with the file content as value, reading each file through
+ * the buffer it is given, so files of any size are exported without being
+ * held in memory. Missing and empty files are left out.
+ */
+class ConfigExporter {
+public:
+  ConfigExporter(fs::FS& fsRef);
+
+  /**
+   * @brief Get the next piece of the backup
+   * @param buffer Buffer to fill
+   * @param size Buffer size
+   * @return Bytes stored, negative at the end
+   */
+  int read(uint8_t* buffer, size_t size);
+
+private:
+  static const int SECTIONS = 4;
+  static const char* const sectionFiles[SECTIONS];
+
+  /**
+   * @brief Part of the output being written
+   */
+  enum Part {
+    PART_OPEN,
+    PART_KEY,
+    PART_CONTENT,
+    PART_CLOSE,
+    PART_DONE,
+  };
+
+  fs::FS& fs;
+  Part part;          ///< Part being written
+  size_t offset;      ///< Bytes of the part written
+  int section;        ///< Settings file being written
+  int written;        ///< Settings files written so far
+  File file;          ///< Settings file being copied
+  char key[32];       ///< Member name of that file, with its separator
+
+  bool openSection();
+};
+
+#endif // EXPORTER_H
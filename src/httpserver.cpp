@@ -0,0 +1,1177 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "httpserver.h"
+#include <sys/socket.h>
+#include <errno.h>
+#include <ctype.h>
+#include <strings.h>
+
+// lwIP never raises SIGPIPE and may not know the flag
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Room kept before and after the data in the chunk buffer for the chunk
+// size line ("3ff\r\n") and the closing CRLF of chunked transfer encoding
+#define HTTP_CHUNK_HEAD 6
+#define HTTP_CHUNK_TAIL 2
+static_assert(HTTP_CHUNK_SIZE <= 0xffff, "Chunk size must fit four hex digits");
+
+/**
+ * @brief HTTPServer constructor
+ * @param serverRef WiFiServer instance for HTTP connections
+ */
+HTTPServer::HTTPServer(WiFiServer& serverRef) : httpServer(serverRef), assets(1024) {
+}
+
+/**
+ * @brief HTTPServer destructor
+ */
+HTTPServer::~HTTPServer() {
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    free(connections[i].chunk);
+  }
+}
+
+/**
+ * @brief Start listening
+ * @param port TCP port, 0 for the one given to the WiFiServer
+ */
+void HTTPServer::begin(uint16_t port) {
+  httpServer.begin(port);
+  httpServer.setNoDelay(true);
+  // Random on the ESP32, so version ETags differ from one boot to the next
+  epoch = (uint32_t)random(0x7fffffff);
+}
+
+/**
+ * @brief Check if a client is being served
+ * @return true if the server should be serviced again soon
+ */
+bool HTTPServer::isActive() const {
+  if (millis() - lastProgress < HTTP_ACTIVE_WINDOW) {
+    return true;
+  }
+  for (const Connection& c : connections) {
+    if (c.state == HTTP_STATE_BODY || c.state == HTTP_STATE_RESPONSE || c.headLength > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Register a request handler
+ * @param uri Request path, matched exactly
+ * @param method Request method, HTTP_ANY for all
+ * @param handler Function called for matching requests
+ */
+void HTTPServer::on(const char* uri, HTTPMethod method, HTTPHandler handler) {
+  routes.push_back({uri, method, handler, nullptr, String(), nullptr, nullptr, String(), false, false, nullptr});
+}
+
+/**
+ * @brief Register a request handler taking the body as it arrives
+ * @param uri Request path, matched exactly
+ * @param method Request method, HTTP_ANY for all
+ * @param handler Function called once the body was received
+ * @param bodyHandler Function receiving the body
+ */
+void HTTPServer::on(const char* uri, HTTPMethod method, HTTPHandler handler, HTTPBodyHandler bodyHandler) {
+  routes.push_back({uri, method, handler, nullptr, String(), nullptr, nullptr, String(), false, false, nullptr,
+                    bodyHandler});
+}
+
+/**
+ * @brief Serve a file for GET and HEAD requests
+ * @param uri Request path, matched exactly
+ * @param fs Filesystem holding the file
+ * @param path Path of the file
+ * @param cacheHeader Cache-Control value, or nullptr for none
+ */
+void HTTPServer::serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader) {
+  const WebAsset* asset = findWebAsset(path);
+  if (asset) {
+    routes.push_back({uri, HTTP_GET, HTTPHandler(), &fs, path, cacheHeader, asset->type,
+                      asset->etag, asset->gzip, false, asset});
+    return;
+  }
+  // The manifest is read once, the files are looked up now rather than on every request
+  if (assetsFS != &fs) {
+    assetsFS = &fs;
+    assets.clear();
+    File manifest = fs.open(HTTP_ASSET_MANIFEST, "r");
+    if (manifest) {
+      DeserializationError error = deserializeJson(assets, manifest);
+      if (error) {
+        Serial.printf("HTTP: invalid %s: %s\n", HTTP_ASSET_MANIFEST, error.c_str());
+        assets.clear();
+      }
+      manifest.close();
+    }
+  }
+  String gzPath = String(path) + ".gz";
+  Route route = {uri, HTTP_GET, HTTPHandler(), &fs, path, cacheHeader, contentTypeFor(path),
+                 String(), fs.exists(gzPath), fs.exists(path), nullptr};
+  const char* tag = assets[route.gzip ? gzPath.c_str() : path];
+  if (tag) {
+    route.etag = String("\"") + tag + "\"";
+  }
+  routes.push_back(route);
+}
+
+/**
+ * @brief Accept connections, read requests, run handlers and send responses
+ * @details Every connection is moved along its states as far as its socket
+ * allows without waiting. Connections that make no progress for
+ * HTTP_TIMEOUT are closed. When all slots are taken, a new connection
+ * replaces the keep-alive connection idle for the longest time; if none is
+ * idle, it waits in the accept queue.
+ */
+void HTTPServer::handleClient() {
+  for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+    Connection& c = connections[i];
+    if (c.state == HTTP_STATE_REQUEST) {
+      // Nothing to answer to a client that went away
+      if (c.headLength == 0 && c.client.available() <= 0 && !c.client.connected()) {
+        closeConnection(c);
+        continue;
+      }
+      readRequest(c);
+    } else if (c.state == HTTP_STATE_BODY) {
+      readBody(c);
+    } else if (c.state == HTTP_STATE_WAIT) {
+      serviceWait(c, false);
+    }
+    // The response often fits the socket right away
+    if (c.state == HTTP_STATE_RESPONSE) {
+      writeResponse(c);
+    }
+    // Parked requests have their own timeout
+    if (c.state != HTTP_STATE_FREE && c.state != HTTP_STATE_WAIT &&
+        millis() - c.lastActivity > HTTP_TIMEOUT) {
+      closeConnection(c);
+    }
+  }
+  // Accept new connections
+  while (httpServer.hasClient()) {
+    Connection* slot = nullptr;
+    Connection* parked = nullptr;
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+      Connection& c = connections[i];
+      if (c.state == HTTP_STATE_FREE) {
+        slot = &c;
+        break;
+      }
+      // Idle keep-alive connections can be reopened by their client
+      if (c.state == HTTP_STATE_REQUEST && c.headLength == 0 &&
+          (!slot || c.lastActivity < slot->lastActivity)) {
+        slot = &c;
+      }
+      if (c.state == HTTP_STATE_WAIT && (!parked || c.waitStart < parked->waitStart)) {
+        parked = &c;
+      }
+    }
+    if (!slot) {
+      // Answer the oldest parked request now, its slot frees once sent
+      if (parked) {
+        parked->keepAlive = false;
+        serviceWait(*parked, true);
+      }
+      break;
+    }
+    if (slot->state != HTTP_STATE_FREE) {
+      closeConnection(*slot);
+    }
+    slot->client = httpServer.available();
+    slot->client.setNoDelay(true);
+    slot->state = HTTP_STATE_REQUEST;
+    slot->lastActivity = lastProgress = millis();
+    readRequest(*slot);
+    if (slot->state == HTTP_STATE_RESPONSE) {
+      writeResponse(*slot);
+    }
+  }
+}
+
+/**
+ * @brief Read the request line and headers
+ * @details Once the headers are complete, starts reading the body or runs
+ * the handler. Bytes received after the headers are kept, they belong to
+ * the body or to the next request.
+ * @param c Connection
+ */
+void HTTPServer::readRequest(Connection& c) {
+  int available = c.client.available();
+  if (available > 0 && c.headLength < HTTP_MAX_HEADER) {
+    int n = c.client.read((uint8_t*)c.head + c.headLength, min((size_t)available, HTTP_MAX_HEADER - c.headLength));
+    if (n > 0) {
+      c.headLength += n;
+      c.lastActivity = lastProgress = millis();
+    }
+  }
+  // Look for the empty line ending the headers
+  size_t headEnd = 0;
+  for (size_t i = 0; i + 1 < c.headLength; i++) {
+    if (c.head[i] == '\n' && c.head[i + 1] == '\n') {
+      headEnd = i + 2;
+      break;
+    }
+    if (c.head[i] == '\n' && c.head[i + 1] == '\r' && i + 2 < c.headLength && c.head[i + 2] == '\n') {
+      headEnd = i + 3;
+      break;
+    }
+  }
+  if (headEnd == 0) {
+    if (c.headLength == HTTP_MAX_HEADER) {
+      sendError(c, 431, "Request headers too large");
+    }
+    return;
+  }
+  if (!parseHead(c, headEnd)) {
+    return;
+  }
+  if (c.route) {
+    passBody(c, HTTP_BODY_START, nullptr, 0);
+    // Refused, the body is left unread
+    if (c.responded) {
+      c.keepAlive = false;
+      c.headLength = 0;
+      return;
+    }
+  }
+  // Move what follows the headers to the body, keep the rest
+  size_t extra = c.headLength - headEnd;
+  size_t take = min(extra, c.bodyLength);
+  if (take > 0) {
+    if (c.route) {
+      passBody(c, HTTP_BODY_DATA, (const uint8_t*)c.head + headEnd, take);
+    } else {
+      c.body.concat(c.head + headEnd, take);
+    }
+  }
+  c.headLength = extra - take;
+  memmove(c.head, c.head + headEnd + take, c.headLength);
+  if (!bodyComplete(c)) {
+    c.state = HTTP_STATE_BODY;
+    readBody(c);
+  } else {
+    dispatch(c);
+  }
+}
+
+/**
+ * @brief Read the request body
+ * @details Takes what the socket has, the rest comes with the next calls.
+ * Runs the handler once the body is complete.
+ * @param c Connection
+ */
+void HTTPServer::readBody(Connection& c) {
+  char buffer[HTTP_CHUNK_SIZE];
+  int available;
+  while (!bodyComplete(c) && (available = c.client.available()) > 0) {
+    size_t received = c.route ? c.bodyReceived : c.body.length();
+    size_t want = min((size_t)available, min(sizeof(buffer), c.bodyLength - received));
+    int n = c.client.read((uint8_t*)buffer, want);
+    if (n <= 0) {
+      break;
+    }
+    if (c.route) {
+      passBody(c, HTTP_BODY_DATA, (const uint8_t*)buffer, n);
+    } else {
+      c.body.concat(buffer, n);
+    }
+    c.lastActivity = lastProgress = millis();
+  }
+  if (bodyComplete(c)) {
+    dispatch(c);
+  } else if (c.client.available() <= 0 && !c.client.connected()) {
+    closeConnection(c);
+  }
+}
+
+/**
+ * @brief Check if the whole request body was received
+ * @param c Connection
+ * @return true if it was
+ */
+bool HTTPServer::bodyComplete(const Connection& c) const {
+  return (c.route ? c.bodyReceived : c.body.length()) >= c.bodyLength;
+}
+
+/**
+ * @brief Pass the request body to the body handler of its route
+ * @param c Connection
+ * @param status Stage
+ * @param data Body bytes
+ * @param length Number of bytes
+ */
+void HTTPServer::passBody(Connection& c, HTTPBodyStatus status, const uint8_t* data, size_t length) {
+  current = &c;
+  c.route->body(status, data, length);
+  current = nullptr;
+  c.bodyReceived += length;
+}
+
+/**
+ * @brief Parse the request line and headers
+ * @details Fills the method, path, query arguments and headers of the
+ * connection. Malformed or unsupported requests are answered here.
+ * @param c Connection
+ * @param headEnd Length of the request line and headers
+ * @return true if the request can be handled
+ */
+bool HTTPServer::parseHead(Connection& c, size_t headEnd) {
+  static const struct {
+    const char* name;
+    HTTPMethod method;
+  } methods[] = {
+    {"GET", HTTP_GET}, {"HEAD", HTTP_HEAD}, {"POST", HTTP_POST}, {"PUT", HTTP_PUT},
+    {"PATCH", HTTP_PATCH}, {"DELETE", HTTP_DELETE}, {"OPTIONS", HTTP_OPTIONS},
+  };
+  const char* line = c.head;
+  const char* end = c.head + headEnd;
+  // Request line: method, target and version
+  const char* eol = (const char*)memchr(line, '\n', end - line);
+  const char* space = (const char*)memchr(line, ' ', eol - line);
+  const char* target = space ? space + 1 : nullptr;
+  const char* targetEnd = target ? (const char*)memchr(target, ' ', eol - target) : nullptr;
+  if (!targetEnd) {
+    sendError(c, 400, "Bad request");
+    return false;
+  }
+  bool known = false;
+  for (const auto& m : methods) {
+    if ((size_t)(space - line) == strlen(m.name) && memcmp(line, m.name, space - line) == 0) {
+      c.method = m.method;
+      known = true;
+      break;
+    }
+  }
+  if (!known) {
+    sendError(c, 501, "Method not implemented");
+    return false;
+  }
+  // HTTP/1.1 keeps the connection open by default
+  c.http11 = (eol - targetEnd > 8) && memcmp(targetEnd + 1, "HTTP/1.1", 8) == 0;
+  c.keepAlive = c.http11;
+  const char* query = (const char*)memchr(target, '?', targetEnd - target);
+  c.uri = urlDecode(target, (query ? query : targetEnd) - target);
+  if (query) {
+    parseArguments(c.args, query + 1, targetEnd - query - 1);
+  }
+  // Headers
+  bool chunked = false;
+  c.bodyLength = 0;
+  for (line = eol + 1; line < end; line = eol + 1) {
+    eol = (const char*)memchr(line, '\n', end - line);
+    const char* lineEnd = (eol > line && eol[-1] == '\r') ? eol - 1 : eol;
+    const char* colon = (const char*)memchr(line, ':', lineEnd - line);
+    if (!colon) {
+      continue;
+    }
+    const char* value = colon + 1;
+    while (value < lineEnd && (*value == ' ' || *value == '\t')) {
+      value++;
+    }
+    c.headers.push_back({String(line, colon - line), String(value, lineEnd - value)});
+    const Field& h = c.headers.back();
+    if (strcasecmp(h.name.c_str(), "Content-Length") == 0) {
+      c.bodyLength = strtoul(h.value.c_str(), nullptr, 10);
+    } else if (strcasecmp(h.name.c_str(), "Connection") == 0) {
+      if (strcasecmp(h.value.c_str(), "close") == 0) {
+        c.keepAlive = false;
+      } else if (strcasecmp(h.value.c_str(), "keep-alive") == 0) {
+        c.keepAlive = true;
+      }
+    } else if (strcasecmp(h.name.c_str(), "Transfer-Encoding") == 0) {
+      chunked = strcasecmp(h.value.c_str(), "identity") != 0;
+    }
+  }
+  if (chunked) {
+    sendError(c, 411, "Length required");
+    return false;
+  }
+  // Bodies taken by a body handler are not kept, whatever their size
+  const Route* route = findRoute(c);
+  if (route && route->body) {
+    c.route = route;
+    return true;
+  }
+  if (c.bodyLength > HTTP_MAX_BODY) {
+    sendError(c, 413, "Request body too large");
+    return false;
+  }
+  if (c.bodyLength > 0 && !c.body.reserve(c.bodyLength)) {
+    sendError(c, 500, "Out of memory");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Run the handler of a complete request
+ * @details Url-encoded form bodies are parsed into arguments, other bodies
+ * are passed as the "plain" argument. A handler that does not respond gets
+ * a 500 response sent for it.
+ * @param c Connection
+ */
+void HTTPServer::dispatch(Connection& c) {
+  if (c.body.length() > 0) {
+    current = &c;
+    String type = header("Content-Type");
+    current = nullptr;
+    if (strncasecmp(type.c_str(), "application/x-www-form-urlencoded", 33) == 0) {
+      parseArguments(c.args, c.body.c_str(), c.body.length());
+    } else {
+      c.args.push_back({"plain", std::move(c.body)});
+    }
+    c.body = String();
+  }
+  c.state = HTTP_STATE_RESPONSE;
+  current = &c;
+  const Route* route = c.route ? c.route : findRoute(c);
+  if (!route) {
+    send(404, "text/plain", String("Not found: ") + c.uri);
+  } else if (route->fs) {
+    sendStatic(c, *route);
+  } else {
+    route->handler();
+    if (!c.responded && c.state != HTTP_STATE_WAIT) {
+      c.keepAlive = false;
+      send(500, "text/plain", "No response");
+    }
+  }
+  current = nullptr;
+}
+
+/**
+ * @brief Find the route of a request
+ * @param c Connection
+ * @return Route, nullptr if none matches
+ */
+const HTTPServer::Route* HTTPServer::findRoute(const Connection& c) const {
+  for (const Route& r : routes) {
+    if (r.uri == c.uri && (r.method == HTTP_ANY || r.method == c.method ||
+                           (r.fs && c.method == HTTP_HEAD))) {
+      return &r;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Answer a request for a static file
+ * @details Answers 304 without touching the filesystem when the client
+ * has the current version. Linked-in files are sent from flash, others
+ * as the gzipped copy if the client takes it (or it is the only copy) and
+ * the file itself if not.
+ * @param c Connection
+ * @param route Static file route
+ */
+void HTTPServer::sendStatic(Connection& c, const Route& route) {
+  if (route.etag.length() > 0) {
+    sendHeader("ETag", route.etag);
+    if (route.cacheHeader) {
+      sendHeader("Cache-Control", route.cacheHeader);
+    } else {
+      sendHeader("Cache-Control", hasArg("v") ? HTTP_ASSET_CACHE : "no-cache");
+    }
+    String match = header("If-None-Match");
+    if (match.length() > 0 && (match.indexOf(route.etag) >= 0 || match == "*")) {
+      beginResponse(304, nullptr, 0);
+      return;
+    }
+  } else if (route.cacheHeader) {
+    sendHeader("Cache-Control", route.cacheHeader);
+  }
+  if (route.asset) {
+    if (route.gzip) {
+      sendHeader("Content-Encoding", "gzip");
+    }
+    beginResponse(200, route.type, route.asset->length);
+    if (c.method != HTTP_HEAD) {
+      c.data = webAssetData(route.asset);
+      c.dataLength = route.asset->length;
+    }
+    return;
+  }
+  bool gzip = route.gzip && (!route.plain || header("Accept-Encoding").indexOf("gzip") >= 0);
+  File file = route.fs->open(gzip ? route.path + ".gz" : route.path, "r");
+  if (!file) {
+    c.responseHeaders = String();
+    send(404, "text/plain", String("Not found: ") + c.uri);
+    return;
+  }
+  if (gzip) {
+    sendHeader("Content-Encoding", "gzip");
+  }
+  if (route.gzip && route.plain) {
+    sendHeader("Vary", "Accept-Encoding");
+  }
+  streamFile(file, route.type, 200);
+}
+
+/**
+ * @brief Send as much of the response as the socket takes
+ * @details Sends up to HTTP_SEND_BUDGET bytes without blocking, then
+ * returns so the other connections get their turn.
+ * @param c Connection
+ */
+void HTTPServer::writeResponse(Connection& c) {
+  int fd = c.client.fd();
+  size_t budget = HTTP_SEND_BUDGET;
+  while (budget > 0) {
+    const uint8_t* data;
+    size_t size;
+    if (c.outOffset < c.out.length()) {
+      data = (const uint8_t*)c.out.c_str() + c.outOffset;
+      size = c.out.length() - c.outOffset;
+    } else if (c.dataOffset < c.dataLength) {
+      data = c.data + c.dataOffset;
+      size = c.dataLength - c.dataOffset;
+    } else if (c.chunkOffset < c.chunkLength) {
+      data = c.chunk + c.chunkOffset;
+      size = c.chunkLength - c.chunkOffset;
+    } else if (fillChunk(c)) {
+      continue;
+    } else {
+      break;
+    }
+    ssize_t sent = fd >= 0 ? ::send(fd, data, min(size, budget), MSG_DONTWAIT | MSG_NOSIGNAL) : -1;
+    if (sent < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        closeConnection(c);
+      }
+      return;
+    }
+    if (c.outOffset < c.out.length()) {
+      c.outOffset += sent;
+    } else if (c.dataOffset < c.dataLength) {
+      c.dataOffset += sent;
+    } else {
+      c.chunkOffset += sent;
+    }
+    budget -= sent;
+    c.lastActivity = lastProgress = millis();
+  }
+  // Done when everything was sent and the body has ended
+  if (c.outOffset >= c.out.length() && c.dataOffset >= c.dataLength && c.chunkOffset >= c.chunkLength &&
+      (c.remaining == 0 || (!c.file && !c.source))) {
+    finishResponse(c);
+  }
+}
+
+/**
+ * @brief Check on a parked request
+ * @details Runs its waiter, which answers when it is ready, or at the
+ * latest once the wait is over. A client that went away is dropped.
+ * @param c Connection
+ * @param expire End the wait now
+ */
+void HTTPServer::serviceWait(Connection& c, bool expire) {
+  if (c.client.available() <= 0 && !c.client.connected()) {
+    closeConnection(c);
+    return;
+  }
+  bool expired = expire || millis() - c.waitStart >= c.waitTimeout;
+  current = &c;
+  c.waiter(expired);
+  if (!c.responded && expired) {
+    c.keepAlive = false;
+    send(500, "text/plain", "No response");
+  }
+  current = nullptr;
+  if (c.responded) {
+    c.waiter = nullptr;
+    c.lastActivity = millis();
+  }
+}
+
+/**
+ * @brief Get the next piece of the body from the file or stream
+ * @details With chunked transfer encoding the data is read after the room
+ * kept for the chunk size line, which is then written right before it, so
+ * the whole chunk goes out from the one buffer. The end of the body sends
+ * the last, empty chunk.
+ * @param c Connection
+ * @return true if the chunk buffer has new data
+ */
+bool HTTPServer::fillChunk(Connection& c) {
+  if (c.remaining == 0 || (!c.file && !c.source)) {
+    return false;
+  }
+  if (!c.chunk) {
+    c.chunk = (uint8_t*)malloc(HTTP_CHUNK_HEAD + HTTP_CHUNK_SIZE + HTTP_CHUNK_TAIL);
+    if (!c.chunk) {
+      c.keepAlive = false;
+      c.remaining = 0;
+      return false;
+    }
+  }
+  uint8_t* buffer = c.chunked ? c.chunk + HTTP_CHUNK_HEAD : c.chunk;
+  size_t want = HTTP_CHUNK_SIZE;
+  if (c.remaining > 0 && (size_t)c.remaining < want) {
+    want = c.remaining;
+  }
+  int n;
+  if (c.file) {
+    n = c.file.read(buffer, want);
+    if (n <= 0) {
+      n = -1;
+    }
+  } else {
+    n = c.source(buffer, want);
+  }
+  if (n < 0) {
+    // A body shorter than announced can only be ended by closing
+    if (c.remaining > 0) {
+      c.keepAlive = false;
+    }
+    c.remaining = 0;
+    if (!c.chunked) {
+      return false;
+    }
+    memcpy(c.chunk, "0\r\n\r\n", 5);
+    c.chunkLength = 5;
+    c.chunkOffset = 0;
+    return true;
+  }
+  if (n == 0) {
+    return false;
+  }
+  c.chunkLength = n;
+  c.chunkOffset = 0;
+  if (c.chunked) {
+    char line[HTTP_CHUNK_HEAD + 1];
+    int length = snprintf(line, sizeof(line), "%x\r\n", n);
+    c.chunkOffset = HTTP_CHUNK_HEAD - length;
+    memcpy(c.chunk + c.chunkOffset, line, length);
+    memcpy(buffer + n, "\r\n", HTTP_CHUNK_TAIL);
+    c.chunkLength = HTTP_CHUNK_HEAD + n + HTTP_CHUNK_TAIL;
+  }
+  if (c.remaining > 0) {
+    c.remaining -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief End the response, then wait for the next request or close
+ * @param c Connection
+ */
+void HTTPServer::finishResponse(Connection& c) {
+  if (!c.keepAlive) {
+    closeConnection(c);
+    return;
+  }
+  resetRequest(c);
+  c.state = HTTP_STATE_REQUEST;
+}
+
+/**
+ * @brief Start the response of the current request
+ * @details Formats the status line and headers into the output buffer.
+ * An unknown length closes the connection at the end of the body, unless
+ * the body is sent in chunks. 204 and 304 responses never have one.
+ * @param code HTTP status code
+ * @param contentType MIME type, or nullptr for none
+ * @param length Body length, negative if unknown
+ */
+void HTTPServer::beginResponse(int code, const char* contentType, long length) {
+  Connection& c = *current;
+  if (code == 204 || code == 304) {
+    length = -1;
+    c.chunked = false;
+  } else if (length < 0 && !c.chunked) {
+    c.keepAlive = false;
+  }
+  char line[96];
+  c.out.reserve(128 + c.responseHeaders.length() + (length > 0 && length < 2048 ? length : 0));
+  snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+  c.out = line;
+  if (contentType && contentType[0]) {
+    c.out += "Content-Type: ";
+    c.out += contentType;
+    c.out += "\r\n";
+  }
+  if (length >= 0) {
+    snprintf(line, sizeof(line), "Content-Length: %ld\r\n", length);
+    c.out += line;
+  } else if (c.chunked) {
+    c.out += "Transfer-Encoding: chunked\r\n";
+  }
+  c.out += c.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  c.out += c.responseHeaders;
+  c.out += "\r\n";
+  c.outOffset = 0;
+  c.remaining = 0;
+  c.state = HTTP_STATE_RESPONSE;
+  c.responded = true;
+}
+
+/**
+ * @brief Add a header to the response of the current request
+ * @param name Header name
+ * @param value Header value
+ * @param first Put it before the headers added so far
+ */
+void HTTPServer::sendHeader(const String& name, const String& value, bool first) {
+  String& headers = current->responseHeaders;
+  if (first) {
+    headers = name + ": " + value + "\r\n" + headers;
+    return;
+  }
+  // Grow once for the response headers, not once per header
+  if (headers.length() == 0) {
+    headers.reserve(160);
+  }
+  headers += name;
+  headers += ": ";
+  headers += value;
+  headers += "\r\n";
+}
+
+/**
+ * @brief Set the Content-Length of the next send()
+ * @param length Body length, (size_t)-1 if unknown
+ */
+void HTTPServer::setContentLength(size_t length) {
+  current->responseLength = (length == (size_t)-1) ? -1 : (long)length;
+}
+
+/**
+ * @brief Send a response with the body in memory
+ * @details For HEAD requests only the headers are sent.
+ * @param code HTTP status code
+ * @param contentType MIME type, or nullptr for none
+ * @param content Body
+ */
+void HTTPServer::send(int code, const char* contentType, const String& content) {
+  Connection& c = *current;
+  long length = c.responseLength >= 0 ? c.responseLength : (long)content.length();
+  beginResponse(code, contentType, length);
+  if (c.method != HTTP_HEAD) {
+    c.out += content;
+  }
+}
+
+/**
+ * @brief Send a response with the body in memory
+ * @param code HTTP status code
+ * @param contentType MIME type
+ * @param content Body
+ */
+void HTTPServer::send(int code, const String& contentType, const String& content) {
+  send(code, contentType.c_str(), content);
+}
+
+/**
+ * @brief Send a file as the response body
+ * @param file Open file
+ * @param contentType MIME type
+ * @param code HTTP status code
+ * @return File size
+ */
+size_t HTTPServer::streamFile(File& file, const String& contentType, int code) {
+  Connection& c = *current;
+  size_t size = file.size();
+  beginResponse(code, contentType.c_str(), (long)size);
+  if (c.method == HTTP_HEAD || size == 0) {
+    file.close();
+  } else {
+    c.file = file;
+    c.remaining = size;
+  }
+  return size;
+}
+
+/**
+ * @brief Send a response body produced over time
+ * @param code HTTP status code
+ * @param contentType MIME type
+ * @param source Body source
+ * @param length Body length, negative if unknown
+ */
+void HTTPServer::sendStream(int code, const String& contentType, HTTPSource source, long length) {
+  Connection& c = *current;
+  // HTTP/1.1 clients can tell where a body of unknown length ends
+  c.chunked = length < 0 && c.http11;
+  beginResponse(code, contentType.c_str(), length);
+  if (c.method != HTTP_HEAD && length != 0) {
+    c.source = source;
+    c.remaining = length;
+  }
+}
+
+/**
+ * @brief Park the current request until it can be answered
+ * @param waiter Function sending the response
+ * @param timeout Longest wait in milliseconds, at most HTTP_MAX_WAIT
+ */
+void HTTPServer::wait(HTTPWaiter waiter, unsigned long timeout) {
+  Connection& c = *current;
+  c.waiter = waiter;
+  c.waitStart = millis();
+  c.waitTimeout = min(timeout, (unsigned long)HTTP_MAX_WAIT);
+  c.state = HTTP_STATE_WAIT;
+}
+
+/**
+ * @brief Answer a request for a resource that changes now and then
+ * @param version Current version of the resource
+ * @param send Handler sending the resource
+ * @param weak The resource may differ in details while its version stays
+ */
+void HTTPServer::sendVersioned(HTTPVersion version, HTTPHandler send, bool weak) {
+  uint32_t since = version();
+  // The quoted part alone, If-None-Match compares weak tags by it
+  String tag = versionTag(since, false);
+  String match = header("If-None-Match");
+  bool fresh = match.length() > 0 && (match.indexOf(tag) >= 0 || match == "*");
+  // The response to send once the version is known
+  auto respond = [this, send, weak](uint32_t now, bool notModified) {
+    sendHeader("ETag", versionTag(now, weak));
+    sendHeader("Cache-Control", "no-cache");
+    if (notModified) {
+      beginResponse(304, nullptr, 0);
+    } else {
+      send();
+    }
+  };
+  long timeout = hasArg("wait") ? arg("wait").toInt() : 0;
+  bool unchanged = hasArg("since") ? (uint32_t)strtoul(arg("since").c_str(), nullptr, 10) == since : fresh;
+  if (timeout > 0 && unchanged) {
+    wait([version, respond, since, fresh](bool expired) {
+      uint32_t now = version();
+      if (now != since) {
+        respond(now, false);
+      } else if (expired) {
+        respond(now, fresh);
+      }
+    }, (unsigned long)timeout);
+    return;
+  }
+  respond(since, fresh);
+}
+
+/**
+ * @brief Format the ETag of a resource version
+ * @param version Resource version
+ * @param weak Make it a weak tag
+ * @return Quoted ETag
+ */
+String HTTPServer::versionTag(uint32_t version, bool weak) const {
+  char tag[32];
+  snprintf(tag, sizeof(tag), "%s\"%08x-%u\"", weak ? "W/" : "", (unsigned)epoch, (unsigned)version);
+  return String(tag);
+}
+
+/**
+ * @brief Answer a request that cannot be handled and close afterwards
+ * @param c Connection
+ * @param code HTTP status code
+ * @param message Body
+ */
+void HTTPServer::sendError(Connection& c, int code, const char* message) {
+  c.keepAlive = false;
+  c.headLength = 0;
+  current = &c;
+  send(code, "text/plain", message);
+  current = nullptr;
+}
+
+/**
+ * @brief Disconnect a client and free its slot
+ * @param c Connection
+ */
+void HTTPServer::closeConnection(Connection& c) {
+  // Let the body handler drop what it got of an unfinished body
+  if (c.state == HTTP_STATE_BODY && c.route && !c.responded) {
+    passBody(c, HTTP_BODY_ABORT, nullptr, 0);
+  }
+  c.client.stop();
+  resetRequest(c);
+  c.headLength = 0;
+  c.state = HTTP_STATE_FREE;
+}
+
+/**
+ * @brief Forget the request and response of a connection
+ * @details Keeps the bytes received after the request, they are the start
+ * of the next one.
+ * @param c Connection
+ */
+void HTTPServer::resetRequest(Connection& c) {
+  c.uri = String();
+  c.args.clear();
+  c.headers.clear();
+  c.body = String();
+  c.bodyLength = 0;
+  c.bodyReceived = 0;
+  c.route = nullptr;
+  c.responseHeaders = String();
+  c.responseLength = -1;
+  c.responded = false;
+  c.waiter = nullptr;
+  c.out = String();
+  c.outOffset = 0;
+  c.data = nullptr;
+  c.dataLength = 0;
+  c.dataOffset = 0;
+  if (c.file) {
+    c.file.close();
+  }
+  c.file = File();
+  c.source = nullptr;
+  c.remaining = -1;
+  c.chunked = false;
+  free(c.chunk);
+  c.chunk = nullptr;
+  c.chunkLength = 0;
+  c.chunkOffset = 0;
+}
+
+/**
+ * @brief Parse url-encoded name=value pairs
+ * @param args Arguments to add to
+ * @param data Encoded data
+ * @param length Data length
+ */
+void HTTPServer::parseArguments(std::vector<Field>& args, const char* data, size_t length) {
+  const char* end = data + length;
+  while (data < end) {
+    const char* amp = (const char*)memchr(data, '&', end - data);
+    const char* pairEnd = amp ? amp : end;
+    const char* equal = (const char*)memchr(data, '=', pairEnd - data);
+    if (pairEnd > data) {
+      if (equal) {
+        args.push_back({urlDecode(data, equal - data), urlDecode(equal + 1, pairEnd - equal - 1)});
+      } else {
+        args.push_back({urlDecode(data, pairEnd - data), String()});
+      }
+    }
+    data = pairEnd + 1;
+  }
+}
+
+/**
+ * @brief Decode %XX escapes and '+' spaces
+ * @param data Encoded text
+ * @param length Text length
+ * @return Decoded text
+ */
+String HTTPServer::urlDecode(const char* data, size_t length) {
+  String result;
+  result.reserve(length);
+  for (size_t i = 0; i < length; i++) {
+    char ch = data[i];
+    if (ch == '+') {
+      ch = ' ';
+    } else if (ch == '%' && i + 2 < length && isxdigit((unsigned char)data[i + 1]) &&
+               isxdigit((unsigned char)data[i + 2])) {
+      char hex[3] = {data[i + 1], data[i + 2], '\0'};
+      ch = (char)strtol(hex, nullptr, 16);
+      i += 2;
+    }
+    result += ch;
+  }
+  return result;
+}
+
+/**
+ * @brief Get the reason phrase of a status code
+ * @param code HTTP status code
+ * @return Reason phrase
+ */
+const char* HTTPServer::statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+/**
+ * @brief Guess the MIME type of a file from its extension
+ * @param path File path
+ * @return MIME type
+ */
+const char* HTTPServer::contentTypeFor(const String& path) {
+  static const struct {
+    const char* extension;
+    const char* type;
+  } types[] = {
+    {".html", "text/html"}, {".css", "text/css"}, {".js", "application/javascript"},
+    {".json", "application/json"}, {".png", "image/png"}, {".jpg", "image/jpeg"},
+    {".gif", "image/gif"}, {".svg", "image/svg+xml"}, {".ico", "image/x-icon"},
+    {".txt", "text/plain"},
+  };
+  const char* dot = strrchr(path.c_str(), '.');
+  if (dot) {
+    for (const auto& t : types) {
+      if (strcasecmp(dot, t.extension) == 0) {
+        return t.type;
+      }
+    }
+  }
+  return "application/octet-stream";
+}
+
+/**
+ * @brief Get the method of the current request
+ * @return Request method
+ */
+HTTPMethod HTTPServer::method() const {
+  return current->method;
+}
+
+/**
+ * @brief Get the path of the current request
+ * @return Request path, without the query
+ */
+const String& HTTPServer::uri() const {
+  return current->uri;
+}
+
+/**
+ * @brief Get the number of arguments of the current request
+ * @return Number of arguments
+ */
+int HTTPServer::args() const {
+  return current->args.size();
+}
+
+/**
+ * @brief Get an argument of the current request by name
+ * @param name Argument name
+ * @return Value, empty if missing
+ */
+String HTTPServer::arg(const char* name) const {
+  for (const Field& f : current->args) {
+    if (f.name == name) {
+      return f.value;
+    }
+  }
+  return String();
+}
+
+/**
+ * @brief Get an argument of the current request by position
+ * @param i Argument index
+ * @return Value, empty if out of range
+ */
+String HTTPServer::arg(int i) const {
+  return (i >= 0 && i < (int)current->args.size()) ? current->args[i].value : String();
+}
+
+/**
+ * @brief Get the name of an argument of the current request
+ * @param i Argument index
+ * @return Name, empty if out of range
+ */
+String HTTPServer::argName(int i) const {
+  return (i >= 0 && i < (int)current->args.size()) ? current->args[i].name : String();
+}
+
+/**
+ * @brief Check if the current request has an argument
+ * @param name Argument name
+ * @return true if present
+ */
+bool HTTPServer::hasArg(const char* name) const {
+  for (const Field& f : current->args) {
+    if (f.name == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Get the number of headers of the current request
+ * @return Number of headers
+ */
+int HTTPServer::headers() const {
+  return current->headers.size();
+}
+
+/**
+ * @brief Get a header of the current request by name
+ * @param name Header name, not case sensitive
+ * @return Value, empty if missing
+ */
+String HTTPServer::header(const char* name) const {
+  for (const Field& f : current->headers) {
+    if (strcasecmp(f.name.c_str(), name) == 0) {
+      return f.value;
+    }
+  }
+  return String();
+}
+
+/**
+ * @brief Get a header of the current request by position
+ * @param i Header index
+ * @return Value, empty if out of range
+ */
+String HTTPServer::header(int i) const {
+  return (i >= 0 && i < (int)current->headers.size()) ? current->headers[i].value : String();
+}
+
+/**
+ * @brief Get the name of a header of the current request
+ * @param i Header index
+ * @return Name, empty if out of range
+ */
+String HTTPServer::headerName(int i) const {
+  return (i >= 0 && i < (int)current->headers.size()) ? current->headers[i].name : String();
+}
+
+/**
+ * @brief Check if the current request has a header
+ * @param name Header name, not case sensitive
+ * @return true if present
+ */
+bool HTTPServer::hasHeader(const char* name) const {
+  for (const Field& f : current->headers) {
+    if (strcasecmp(f.name.c_str(), name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,401 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <FS.h>
+#include <ArduinoJson.h>
+#include <HTTP_Method.h>
+#include "webassets.h"
+#include <functional>
+#include <vector>
+
+// Maximum number of simultaneous HTTP connections
+#ifndef HTTP_MAX_CLIENTS
+#define HTTP_MAX_CLIENTS 4
+#endif
+
+// Longest request line and headers, in bytes
+#ifndef HTTP_MAX_HEADER
+#define HTTP_MAX_HEADER 1536
+#endif
+
+// Largest request body accepted, in bytes
+#ifndef HTTP_MAX_BODY
+#if defined(BOARD_HAS_PSRAM)
+#define HTTP_MAX_BODY (128 * 1024)
+#else
+#define HTTP_MAX_BODY (32 * 1024)
+#endif
+#endif
+
+// Close connections that made no progress for this long, in milliseconds
+#ifndef HTTP_TIMEOUT
+#define HTTP_TIMEOUT 10000
+#endif
+
+// Bytes sent to one connection per handleClient() call, so others get their turn
+#ifndef HTTP_SEND_BUDGET
+#define HTTP_SEND_BUDGET 8192
+#endif
+
+// A connection counts as active this long after its last progress, in milliseconds
+#ifndef HTTP_ACTIVE_WINDOW
+#define HTTP_ACTIVE_WINDOW 500
+#endif
+
+// Longest a request can be parked by wait(), in milliseconds
+#ifndef HTTP_MAX_WAIT
+#define HTTP_MAX_WAIT 30000
+#endif
+
+// Size of the buffer files and streams are sent through
+#ifndef HTTP_CHUNK_SIZE
+#define HTTP_CHUNK_SIZE 1024
+#endif
+
+// ETags of the static files, written by tools/gzip_assets.py
+#ifndef HTTP_ASSET_MANIFEST
+#define HTTP_ASSET_MANIFEST "/assets.json"
+#endif
+
+// Cache-Control of static files requested with their version (?v=etag)
+#ifndef HTTP_ASSET_CACHE
+#define HTTP_ASSET_CACHE "public, max-age=31536000, immutable"
+#endif
+
+/**
+ * @brief Request handler, reads the request and sends the response through the server
+ */
+typedef std::function<void(void)> HTTPHandler;
+
+/**
+ * @brief Stages of a request body passed to a body handler
+ */
+enum HTTPBodyStatus {
+  HTTP_BODY_START,   ///< Headers received, body follows
+  HTTP_BODY_DATA,    ///< Next piece of the body
+  HTTP_BODY_ABORT,   ///< The client went away before the end of the body
+};
+
+/**
+ * @brief Request body handler, for bodies processed as they arrive
+ * @details Called with HTTP_BODY_START once the headers are read (the
+ * request can be inspected and, to refuse it, answered right away), with
+ * HTTP_BODY_DATA for every piece of the body and with HTTP_BODY_ABORT if
+ * the request is not completed. The request handler runs after the last
+ * piece.
+ * @param status Stage
+ * @param data Body bytes, for HTTP_BODY_DATA
+ * @param length Number of bytes
+ */
+typedef std::function<void(HTTPBodyStatus status, const uint8_t* data, size_t length)> HTTPBodyHandler;
+
+/**
+ * @brief Response body source for sendStream()
+ * @details Called whenever the connection can take more data.
+ * @param buffer Buffer to fill
+ * @param size Buffer size
+ * @return Bytes stored, 0 if none are ready yet, negative at the end of the body
+ */
+typedef std::function<int(uint8_t* buffer, size_t size)> HTTPSource;
+
+/**
+ * @brief Parked request, see HTTPServer::wait()
+ * @details Called from the following handleClient() calls, with the request
+ * as the one being handled, until it sends a response.
+ * @param expired The wait is over, a response must be sent now
+ */
+typedef std::function<void(bool expired)> HTTPWaiter;
+
+/**
+ * @brief Current version of a resource, see HTTPServer::sendVersioned()
+ * @return Number changed on every change of the resource
+ */
+typedef std::function<uint32_t(void)> HTTPVersion;
+
+/**
+ * @brief Non-blocking HTTP/1.1 server
+ * @details Replaces the Arduino WebServer, keeping the part of its interface
+ * the handlers use (on(), serveStatic(), arg(), send(), streamFile(), ...),
+ * so routes and handlers are written the same way.
+ *
+ * Each connection is a small state machine: request headers, request body,
+ * response. handleClient() moves every connection as far as its socket
+ * allows without waiting, so a client uploading a playlist slowly or
+ * reading a large file slowly does not hold up the other clients, the
+ * WebSocket, MPD or the display. Handlers run one at a time from
+ * handleClient() and must not block; files and long bodies are sent with
+ * streamFile() and sendStream(), which return at once and leave the
+ * sending to the following calls.
+ *
+ * Connections are kept alive between requests unless the client asks
+ * otherwise. Request bodies go to the "plain" argument, or are parsed into
+ * arguments for url-encoded forms, like the Arduino WebServer does.
+ */
+class HTTPServer {
+public:
+  HTTPServer(WiFiServer& serverRef);
+  ~HTTPServer();
+
+  /**
+   * @brief Start listening
+   * @param port TCP port, 0 for the one given to the WiFiServer
+   */
+  void begin(uint16_t port = 0);
+
+  /**
+   * @brief Accept connections, read requests, run handlers and send responses
+   * @details Never blocks, call it from loop().
+   */
+  void handleClient();
+
+  /**
+   * @brief Check if a client is being served
+   * @details True while a request or response is in progress, or a
+   * connection made progress in the last HTTP_ACTIVE_WINDOW milliseconds,
+   * as while a browser loads a page and its assets. loop() then runs
+   * without its usual delay, so each request does not wait for a pass.
+   * @return true if the server should be serviced again soon
+   */
+  bool isActive() const;
+
+  /**
+   * @brief Register a request handler
+   * @param uri Request path, matched exactly
+   * @param method Request method, HTTP_ANY for all
+   * @param handler Function called for matching requests
+   */
+  void on(const char* uri, HTTPMethod method, HTTPHandler handler);
+
+  /**
+   * @brief Register a request handler taking the body as it arrives
+   * @details The body is passed to bodyHandler instead of being kept in
+   * memory, so it is not limited to HTTP_MAX_BODY.
+   * @param uri Request path, matched exactly
+   * @param method Request method, HTTP_ANY for all
+   * @param handler Function called once the body was received
+   * @param bodyHandler Function receiving the body
+   */
+  void on(const char* uri, HTTPMethod method, HTTPHandler handler, HTTPBodyHandler bodyHandler);
+
+  /**
+   * @brief Serve a file for GET and HEAD requests
+   * @details Files linked into the firmware (see webassets.h) are sent
+   * straight from flash, with their ETag, without touching the filesystem.
+   * For the others a gzipped copy (path.gz) is sent instead of the file to
+   * clients accepting it, or to all if the file itself is missing. Files
+   * listed in HTTP_ASSET_MANIFEST get their ETag, are revalidated by the
+   * browser (no-cache, answered with 304 while unchanged) and kept for a
+   * year when requested with their version (?v=etag).
+   * @param uri Request path, matched exactly
+   * @param fs Filesystem holding the file
+   * @param path Path of the file
+   * @param cacheHeader Cache-Control value, or nullptr for the default
+   */
+  void serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader = nullptr);
+
+  // Request being handled, valid inside a handler
+  HTTPMethod method() const;
+  const String& uri() const;
+  int args() const;
+  String arg(const char* name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  bool hasArg(const char* name) const;
+  int headers() const;
+  String header(const char* name) const;
+  String header(int i) const;
+  String headerName(int i) const;
+  bool hasHeader(const char* name) const;
+
+  // Response to the request being handled
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t length);
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content);
+
+  /**
+   * @brief Send a file as the response body
+   * @details The file is sent by the following handleClient() calls and
+   * closed at the end.
+   * @param file Open file
+   * @param contentType MIME type
+   * @param code HTTP status code
+   * @return File size
+   */
+  size_t streamFile(File& file, const String& contentType, int code = 200);
+
+  /**
+   * @brief Send a response body produced over time
+   * @details The source is called from the following handleClient() calls
+   * until it reports the end, or length bytes were sent. It is destroyed
+   * when the response ends or the client goes away.
+   * @param code HTTP status code
+   * @param contentType MIME type
+   * @param source Body source
+   * @param length Body length, negative if unknown (sent with chunked
+   * transfer encoding to HTTP/1.1 clients, the others get the connection
+   * closed at the end of the body)
+   */
+  void sendStream(int code, const String& contentType, HTTPSource source, long length = -1);
+
+  /**
+   * @brief Park the request until it can be answered
+   * @details The waiter is called from the following handleClient() calls
+   * until it responds, and once more with expired set after timeout. A
+   * parked request does not keep isActive() true, it is checked once per
+   * loop() pass. When a new client finds all connections taken, the oldest
+   * parked request is ended early to make room.
+   * @param waiter Function sending the response
+   * @param timeout Longest wait in milliseconds, at most HTTP_MAX_WAIT
+   */
+  void wait(HTTPWaiter waiter, unsigned long timeout);
+
+  /**
+   * @brief Answer a request for a resource that changes now and then
+   * @details The resource gets an ETag made from its version, and from a
+   * number picked at start, so tags from before a restart never match.
+   * A request with a matching If-None-Match is answered 304 without calling
+   * send. With a "wait=<ms>" argument, a request for the version it already
+   * has ("since=<version>", or the ETag in If-None-Match) is parked until
+   * the version changes or the wait is over, then answered as above.
+   * @param version Current version of the resource
+   * @param send Handler sending the resource
+   * @param weak The resource may differ in details while its version stays,
+   * e.g. a playing time
+   */
+  void sendVersioned(HTTPVersion version, HTTPHandler send, bool weak = false);
+
+private:
+  /**
+   * @brief Connection states
+   */
+  enum State {
+    HTTP_STATE_FREE,      ///< Slot not in use
+    HTTP_STATE_REQUEST,   ///< Reading the request line and headers
+    HTTP_STATE_BODY,      ///< Reading the request body
+    HTTP_STATE_RESPONSE,  ///< Sending the response
+    HTTP_STATE_WAIT,      ///< Request parked by wait()
+  };
+
+  /**
+   * @brief Name and value pair, for arguments and headers
+   */
+  struct Field {
+    String name;
+    String value;
+  };
+
+  struct Route;
+
+  /**
+   * @brief One client connection
+   */
+  struct Connection {
+    WiFiClient client;                ///< Client connection
+    State state = HTTP_STATE_FREE;    ///< Where the connection is
+    unsigned long lastActivity = 0;   ///< millis() of the last progress
+    char head[HTTP_MAX_HEADER];       ///< Request line and headers being received
+    size_t headLength = 0;            ///< Bytes in head
+    // Request
+    HTTPMethod method = HTTP_GET;     ///< Request method
+    String uri;                       ///< Request path
+    std::vector<Field> args;          ///< Query, form and "plain" arguments
+    std::vector<Field> headers;       ///< Request headers
+    String body;                      ///< Request body
+    size_t bodyLength = 0;            ///< Content-Length of the request
+    size_t bodyReceived = 0;          ///< Body bytes passed to the body handler
+    const Route* route = nullptr;     ///< Route whose body handler takes the body
+    bool keepAlive = false;           ///< Keep the connection after the response
+    bool http11 = false;              ///< The client speaks HTTP/1.1
+    // Response
+    String responseHeaders;           ///< Headers added by sendHeader()
+    long responseLength = -1;         ///< Length set by setContentLength()
+    bool responded = false;           ///< The handler sent a response
+    HTTPWaiter waiter;                ///< Parked request, see wait()
+    unsigned long waitStart = 0;      ///< millis() the request was parked
+    unsigned long waitTimeout = 0;    ///< Longest wait, in milliseconds
+    String out;                       ///< Status line, headers and short body
+    size_t outOffset = 0;             ///< Bytes of out sent
+    File file;                        ///< File being sent
+    HTTPSource source;                ///< Stream being sent
+    long remaining = -1;              ///< Body bytes left after out, negative if unknown
+    bool chunked = false;             ///< The body is sent with chunked transfer encoding
+    const uint8_t* data = nullptr;    ///< Body sent from flash, not copied
+    size_t dataLength = 0;            ///< Bytes at data
+    size_t dataOffset = 0;            ///< Bytes of data sent
+    uint8_t* chunk = nullptr;         ///< Buffer for file and stream data
+    size_t chunkLength = 0;           ///< Bytes in chunk
+    size_t chunkOffset = 0;           ///< Bytes of chunk sent
+  };
+
+  /**
+   * @brief Registered route
+   */
+  struct Route {
+    String uri;            ///< Request path
+    HTTPMethod method;     ///< Request method, HTTP_ANY for all
+    HTTPHandler handler;   ///< Handler, empty for static files
+    fs::FS* fs;            ///< Filesystem of a static file
+    String path;           ///< Path of a static file
+    const char* cacheHeader; ///< Cache-Control of a static file
+    const char* type;      ///< MIME type of a static file
+    String etag;           ///< Quoted ETag of a static file, empty if unknown
+    bool gzip;             ///< A gzipped copy of the static file exists
+    bool plain;            ///< The static file itself exists
+    const WebAsset* asset; ///< Linked-in copy of the static file, or nullptr
+    HTTPBodyHandler body;  ///< Receives the body as it arrives, empty to keep it
+  };
+
+  WiFiServer& httpServer;                    ///< Listening socket
+  Connection connections[HTTP_MAX_CLIENTS];  ///< Client connections
+  std::vector<Route> routes;                 ///< Registered routes
+  Connection* current = nullptr;             ///< Connection whose request is handled
+  unsigned long lastProgress = 0;            ///< millis() of the last progress on any connection
+  DynamicJsonDocument assets;                ///< ETags from HTTP_ASSET_MANIFEST
+  fs::FS* assetsFS = nullptr;                ///< Filesystem the ETags were read from
+  uint32_t epoch = 0;                        ///< Part of the version ETags, picked at start
+
+  void readRequest(Connection& c);
+  void readBody(Connection& c);
+  bool parseHead(Connection& c, size_t headEnd);
+  void dispatch(Connection& c);
+  const Route* findRoute(const Connection& c) const;
+  bool bodyComplete(const Connection& c) const;
+  void passBody(Connection& c, HTTPBodyStatus status, const uint8_t* data, size_t length);
+  void sendStatic(Connection& c, const Route& route);
+  void writeResponse(Connection& c);
+  void serviceWait(Connection& c, bool expire);
+  String versionTag(uint32_t version, bool weak) const;
+  bool fillChunk(Connection& c);
+  void finishResponse(Connection& c);
+  void beginResponse(int code, const char* contentType, long length);
+  void sendError(Connection& c, int code, const char* message);
+  void closeConnection(Connection& c);
+  void resetRequest(Connection& c);
+  static void parseArguments(std::vector<Field>& args, const char* data, size_t length);
+  static String urlDecode(const char* data, size_t length);
+  static const char* statusText(int code);
+  static const char* contentTypeFor(const String& path);
+};
+
+#endif // HTTPSERVER_H
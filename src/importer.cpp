@@ -0,0 +1,484 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "importer.h"
+#include "main.h"
+#include <new>
+
+/**
+ * @brief PlaylistImporter constructor
+ * @param playerRef Player whose playlist is replaced
+ */
+PlaylistImporter::PlaylistImporter(Player& playerRef)
+  : player(playerRef), parser(*this), staging(nullptr), active(false), received(0), count(0),
+    field(FIELD_OTHER), hasName(false), hasUrl(false), errorMessage(nullptr) {
+  name[0] = '\0';
+  url[0] = '\0';
+}
+
+/**
+ * @brief Start an import
+ * @return false if another import is in progress
+ */
+bool PlaylistImporter::begin() {
+  if (active) {
+    return false;
+  }
+  parser.reset();
+  active = true;
+  received = 0;
+  count = 0;
+  field = FIELD_OTHER;
+  errorMessage = nullptr;
+  // The items are collected apart, the body is still drained without one
+  staging = new (std::nothrow) Playlist();
+  if (!staging) {
+    fail("Not enough memory to import the playlist");
+  }
+  return true;
+}
+
+/**
+ * @brief Parse the next piece of the playlist
+ * @param data Bytes
+ * @param length Number of bytes
+ */
+void PlaylistImporter::feed(const uint8_t* data, size_t length) {
+  // After an error the rest of the body is only drained
+  if (!active || errorMessage) {
+    return;
+  }
+  received += length;
+  if (!parser.feed(data, length) && !errorMessage) {
+    Serial.printf("JSON parsing error: %s\n", parser.error());
+    fail("Invalid JSON format");
+  }
+}
+
+/**
+ * @brief End the import, replacing and saving the playlist if it is valid
+ * @details The new playlist is swapped in and saved under one player lock,
+ * so clients see a single playlist change.
+ * @return true if the playlist was imported
+ */
+bool PlaylistImporter::finish() {
+  if (!active) {
+    return false;
+  }
+  if (!errorMessage) {
+    if (received == 0) {
+      fail("Missing JSON data");
+    } else if (!parser.finish()) {
+      Serial.printf("JSON parsing error: %s\n", parser.error());
+      fail("Invalid JSON format");
+    } else if (count > MAX_PLAYLIST_SIZE) {
+      fail("Playlist exceeds maximum size");
+    }
+  }
+  if (!errorMessage) {
+    PlayerLock guard(player);
+    player.replacePlaylist(*staging);
+    player.savePlaylist();
+  }
+  release();
+  return !errorMessage;
+}
+
+/**
+ * @brief Give up an import, leaving the playlist unchanged
+ */
+void PlaylistImporter::abort() {
+  if (active) {
+    release();
+  }
+}
+
+/**
+ * @brief Get the reason the import failed
+ * @return Error message, nullptr if none
+ */
+const char* PlaylistImporter::error() const {
+  return errorMessage;
+}
+
+/**
+ * @brief Get the number of items parsed so far
+ * @return Item count, including the ones beyond MAX_PLAYLIST_SIZE
+ */
+int PlaylistImporter::getCount() const {
+  return count;
+}
+
+/**
+ * @brief An object starts: the root, which must be an array, or an item
+ */
+void PlaylistImporter::startObject() {
+  if (parser.depth() == 1) {
+    fail("JSON root must be an array");
+  } else if (parser.depth() == 2) {
+    hasName = false;
+    hasUrl = false;
+    name[0] = '\0';
+    url[0] = '\0';
+  }
+}
+
+/**
+ * @brief An object ends: add the item it held to the staging playlist
+ */
+void PlaylistImporter::endObject() {
+  if (errorMessage || parser.depth() != 1) {
+    return;
+  }
+  if (!hasName || !hasUrl) {
+    fail("Each item must have 'name' and 'url' fields");
+  } else if (name[0] == '\0' || url[0] == '\0') {
+    fail("Name and URL cannot be empty");
+  } else if (!VALIDATE_URL(url)) {
+    fail("Invalid URL format");
+  } else {
+    // Items beyond the limit are still validated, the size is checked last
+    if (count < MAX_PLAYLIST_SIZE) {
+      staging->addItem(name, url);
+    }
+    count++;
+  }
+}
+
+/**
+ * @brief An array starts: only the root may be one
+ */
+void PlaylistImporter::startArray() {
+  if (parser.depth() == 2) {
+    fail("Each item must have 'name' and 'url' fields");
+  }
+}
+
+/**
+ * @brief A key of an item: remember which field follows
+ * @param keyName Key
+ */
+void PlaylistImporter::key(const char* keyName) {
+  if (parser.depth() != 2) {
+    field = FIELD_OTHER;
+  } else if (strcmp(keyName, "name") == 0) {
+    field = FIELD_NAME;
+    hasName = true;
+  } else if (strcmp(keyName, "url") == 0) {
+    field = FIELD_URL;
+    hasUrl = true;
+  } else {
+    field = FIELD_OTHER;
+  }
+}
+
+/**
+ * @brief A value: keep the name and URL of the item
+ * @param text Value
+ * @param type Value type
+ */
+void PlaylistImporter::value(const char* text, JsonStreamType type) {
+  if (parser.depth() == 0) {
+    fail("JSON root must be an array");
+  } else if (parser.depth() == 1) {
+    fail("Each item must have 'name' and 'url' fields");
+  } else if (parser.depth() == 2 && type == JSON_STREAM_STRING) {
+    if (field == FIELD_NAME) {
+      SAFE_STRNCPY(name, text, sizeof(name));
+    } else if (field == FIELD_URL) {
+      SAFE_STRNCPY(url, text, sizeof(url));
+    }
+  }
+}
+
+/**
+ * @brief Record the first error, the rest of the body is ignored
+ * @param message Error message
+ */
+void PlaylistImporter::fail(const char* message) {
+  if (!errorMessage) {
+    errorMessage = message;
+  }
+}
+
+/**
+ * @brief End the import, freeing the staging playlist
+ */
+void PlaylistImporter::release() {
+  delete staging;
+  staging = nullptr;
+  active = false;
+}
+
+
+// Settings files a configuration backup holds
+const char* const ConfigImporter::sectionFiles[ConfigImporter::SECTIONS] = {
+  "config.json", "wifi.json", "playlist.json", "player.json"
+};
+
+/**
+ * @brief ConfigImporter constructor
+ * @param fsRef Filesystem holding the settings files
+ */
+ConfigImporter::ConfigImporter(fs::FS& fsRef)
+  : fs(fsRef), parser(*this), active(false), received(0), pending(-1), section(-1),
+    chunk(nullptr), copyFrom(0), errorMessage(nullptr) {
+  memset(written, 0, sizeof(written));
+}
+
+/**
+ * @brief Start an import
+ * @return false if another import is in progress
+ */
+bool ConfigImporter::begin() {
+  if (active) {
+    return false;
+  }
+  parser.reset();
+  active = true;
+  received = 0;
+  pending = -1;
+  section = -1;
+  memset(written, 0, sizeof(written));
+  errorMessage = nullptr;
+  return true;
+}
+
+/**
+ * @brief Parse and store the next piece of the backup
+ * @details The section being copied continues to the end of the piece and
+ * resumes at the start of the next one.
+ * @param data Bytes
+ * @param length Number of bytes
+ */
+void ConfigImporter::feed(const uint8_t* data, size_t length) {
+  if (!active || errorMessage) {
+    return;
+  }
+  received += length;
+  chunk = data;
+  copyFrom = 0;
+  if (!parser.feed(data, length) && !errorMessage) {
+    Serial.printf("Failed to parse uploaded JSON: %s\n", parser.error());
+    fail("Invalid JSON format");
+  }
+  if (section >= 0 && !errorMessage) {
+    copy(length);
+  }
+  chunk = nullptr;
+}
+
+/**
+ * @brief End the import, replacing the settings files
+ * @return true if the backup was imported
+ */
+bool ConfigImporter::finish() {
+  if (!active) {
+    return false;
+  }
+  if (!errorMessage) {
+    if (received == 0) {
+      fail("No file uploaded");
+    } else if (!parser.finish()) {
+      Serial.printf("Failed to parse uploaded JSON: %s\n", parser.error());
+      fail("Invalid JSON format");
+    }
+  }
+  if (errorMessage) {
+    abort();
+    return false;
+  }
+  for (int i = 0; i < SECTIONS; i++) {
+    if (!written[i]) {
+      continue;
+    }
+    String path = String("/") + sectionFiles[i];
+    fs.remove(path);
+    if (fs.rename(temporaryPath(i), path)) {
+      Serial.println("Saved " + String(sectionFiles[i]) + " to SPIFFS");
+    } else {
+      Serial.println("Failed to save " + String(sectionFiles[i]) + " to SPIFFS");
+      fail("Error importing configuration");
+    }
+  }
+  removeTemporary();
+  active = false;
+  return !errorMessage;
+}
+
+/**
+ * @brief Give up an import, leaving the settings files unchanged
+ */
+void ConfigImporter::abort() {
+  if (file) {
+    file.close();
+  }
+  section = -1;
+  removeTemporary();
+  active = false;
+}
+
+/**
+ * @brief Get the reason the import failed
+ * @return Error message, nullptr if none
+ */
+const char* ConfigImporter::error() const {
+  return errorMessage;
+}
+
+/**
+ * @brief An object starts: the root, or a section to copy
+ */
+void ConfigImporter::startObject() {
+  if (parser.depth() == 2) {
+    startSection();
+  }
+}
+
+/**
+ * @brief An object ends: the end of a section being copied
+ */
+void ConfigImporter::endObject() {
+  if (parser.depth() == 1) {
+    endSection();
+  }
+}
+
+/**
+ * @brief An array starts: the root must be an object, sections may be arrays
+ */
+void ConfigImporter::startArray() {
+  if (parser.depth() == 1) {
+    fail("JSON root must be an object");
+  } else if (parser.depth() == 2) {
+    startSection();
+  }
+}
+
+/**
+ * @brief An array ends: the end of a section being copied
+ */
+void ConfigImporter::endArray() {
+  if (parser.depth() == 1) {
+    endSection();
+  }
+}
+
+/**
+ * @brief A key: at the top level, the name of a section
+ * @param name Key
+ */
+void ConfigImporter::key(const char* name) {
+  if (parser.depth() != 1) {
+    return;
+  }
+  pending = -1;
+  for (int i = 0; i < SECTIONS; i++) {
+    if (strcmp(name, sectionFiles[i]) == 0) {
+      pending = i;
+      break;
+    }
+  }
+}
+
+/**
+ * @brief A value: the root must be an object, scalar sections are skipped
+ * @param text Value
+ * @param type Value type
+ */
+void ConfigImporter::value(const char* text, JsonStreamType type) {
+  if (parser.depth() == 0) {
+    fail("JSON root must be an object");
+  } else if (parser.depth() == 1) {
+    pending = -1;
+  }
+}
+
+/**
+ * @brief Start copying a section to its temporary file
+ */
+void ConfigImporter::startSection() {
+  if (pending < 0 || errorMessage) {
+    return;
+  }
+  file = fs.open(temporaryPath(pending), "w");
+  if (!file) {
+    fail("Error importing configuration");
+    return;
+  }
+  section = pending;
+  pending = -1;
+  copyFrom = parser.offset();
+}
+
+/**
+ * @brief Finish copying a section, including its closing bracket
+ */
+void ConfigImporter::endSection() {
+  if (section < 0 || errorMessage) {
+    return;
+  }
+  copy(parser.offset() + 1);
+  file.close();
+  if (!errorMessage) {
+    written[section] = true;
+  }
+  section = -1;
+}
+
+/**
+ * @brief Write the part of the current piece that belongs to the section
+ * @param end Offset in the piece the section part ends at
+ */
+void ConfigImporter::copy(size_t end) {
+  if (end > copyFrom && file.write(chunk + copyFrom, end - copyFrom) != end - copyFrom) {
+    fail("Error importing configuration");
+  }
+  copyFrom = end;
+}
+
+/**
+ * @brief Record the first error, the rest of the body is ignored
+ * @param message Error message
+ */
+void ConfigImporter::fail(const char* message) {
+  if (!errorMessage) {
+    errorMessage = message;
+  }
+}
+
+/**
+ * @brief Remove the temporary files of the sections
+ */
+void ConfigImporter::removeTemporary() {
+  for (int i = 0; i < SECTIONS; i++) {
+    String path = temporaryPath(i);
+    if (fs.exists(path)) {
+      fs.remove(path);
+    }
+  }
+}
+
+/**
+ * @brief Get the temporary file a section is copied to
+ * @param index Section index
+ * @return File path
+ */
+String ConfigImporter::temporaryPath(int index) {
+  return String("/") + sectionFiles[index] + ".tmp";
+}
@@ -0,0 +1,185 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "jsonstream.h"
+#include "player.h"
+#include "playlist.h"
+
+/**
+ * @brief Imports a playlist posted as JSON, while it is received
+ * @details Takes a JSON array of {"name": ..., "url": ...} objects in
+ * pieces and adds every complete item to a staging playlist as it is
+ * parsed, so the request body is never held in memory. Other fields of the
+ * items are skipped. Items beyond MAX_PLAYLIST_SIZE are validated but not
+ * kept, an oversized upload is rejected once it is read whole. Only when
+ * the whole array is valid, the staging playlist replaces the player's one
+ * and is saved; a failed or aborted import leaves the playlist untouched.
+ */
+class PlaylistImporter : public JsonStreamListener {
+public:
+  PlaylistImporter(Player& playerRef);
+
+  /**
+   * @brief Start an import
+   * @return false if another import is in progress
+   */
+  bool begin();
+
+  /**
+   * @brief Parse the next piece of the playlist
+   * @param data Bytes
+   * @param length Number of bytes
+   */
+  void feed(const uint8_t* data, size_t length);
+
+  /**
+   * @brief End the import, replacing and saving the playlist if it is valid
+   * @return true if the playlist was imported
+   */
+  bool finish();
+
+  /**
+   * @brief Give up an import, leaving the playlist unchanged
+   */
+  void abort();
+
+  /**
+   * @brief Get the reason the import failed
+   * @return Error message, nullptr if none
+   */
+  const char* error() const;
+
+  /**
+   * @brief Get the number of items parsed so far
+   * @return Item count, including the ones beyond MAX_PLAYLIST_SIZE
+   */
+  int getCount() const;
+
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonStreamType type) override;
+
+private:
+  /**
+   * @brief Item field the next value belongs to
+   */
+  enum Field {
+    FIELD_OTHER,
+    FIELD_NAME,
+    FIELD_URL,
+  };
+
+  Player& player;
+  JsonStreamParser parser;
+  Playlist* staging;              ///< Playlist being imported, nullptr if none
+  bool active;                    ///< An import is in progress
+  size_t received;                ///< Bytes parsed
+  int count;                      ///< Items parsed
+  Field field;                    ///< Field of the next value
+  bool hasName;                   ///< The item has a "name" field
+  bool hasUrl;                    ///< The item has a "url" field
+  char name[STREAM_NAME_SIZE];    ///< Name of the item being parsed
+  char url[STREAM_URL_SIZE];      ///< URL of the item being parsed
+  const char* errorMessage;
+
+  void fail(const char* message);
+  void release();
+};
+
+/**
+ * @brief Imports a configuration backup, while it is received
+ * @details Takes the object written by the configuration export, with one
+ * member per settings file ("config.json", "wifi.json", "playlist.json",
+ * "player.json"), and copies each member as it is received to a temporary
+ * file next to the one it replaces. Once the whole backup is parsed, the
+ * temporary files replace the settings files; if it is malformed or
+ * aborted, they are removed and nothing changes.
+ */
+class ConfigImporter : public JsonStreamListener {
+public:
+  ConfigImporter(fs::FS& fsRef);
+
+  /**
+   * @brief Start an import
+   * @return false if another import is in progress
+   */
+  bool begin();
+
+  /**
+   * @brief Parse and store the next piece of the backup
+   * @param data Bytes
+   * @param length Number of bytes
+   */
+  void feed(const uint8_t* data, size_t length);
+
+  /**
+   * @brief End the import, replacing the settings files
+   * @return true if the backup was imported
+   */
+  bool finish();
+
+  /**
+   * @brief Give up an import, leaving the settings files unchanged
+   */
+  void abort();
+
+  /**
+   * @brief Get the reason the import failed
+   * @return Error message, nullptr if none
+   */
+  const char* error() const;
+
+  void startObject() override;
+  void endObject() override;
+  void startArray() override;
+  void endArray() override;
+  void key(const char* name) override;
+  void value(const char* text, JsonStreamType type) override;
+
+private:
+  static const int SECTIONS = 4;
+  static const char* const sectionFiles[SECTIONS];
+
+  fs::FS& fs;
+  JsonStreamParser parser;
+  bool active;                    ///< An import is in progress
+  size_t received;                ///< Bytes parsed
+  int pending;                    ///< Section named by the last top-level key, -1 if none
+  int section;                    ///< Section being copied, -1 if none
+  bool written[SECTIONS];         ///< Sections stored in their temporary file
+  File file;                      ///< Temporary file of the section being copied
+  const uint8_t* chunk;           ///< Piece being parsed
+  size_t copyFrom;                ///< Offset in chunk the copy continues from
+  const char* errorMessage;
+
+  void startSection();
+  void endSection();
+  void copy(size_t end);
+  void fail(const char* message);
+  void removeTemporary();
+  static String temporaryPath(int index);
+};
+
+#endif // IMPORTER_H
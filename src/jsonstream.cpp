@@ -0,0 +1,409 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstream.h"
+#include <ctype.h>
+#include <stdlib.h>
+
+/**
+ * @brief JsonStreamParser constructor
+ * @param listenerRef Listener receiving the parsed parts
+ */
+JsonStreamParser::JsonStreamParser(JsonStreamListener& listenerRef) : listener(listenerRef) {
+  reset();
+}
+
+/**
+ * @brief Start a new document
+ */
+void JsonStreamParser::reset() {
+  state = STATE_VALUE;
+  stringIsKey = false;
+  escape = 0;
+  codepoint = 0;
+  surrogate = 0;
+  tokenLength = 0;
+  tokenTruncated = false;
+  lastTruncated = false;
+  stackDepth = 0;
+  position = 0;
+  errorMessage = nullptr;
+}
+
+/**
+ * @brief Parse the next piece of the document
+ * @param data Bytes
+ * @param length Number of bytes
+ * @return false once the document is malformed
+ */
+bool JsonStreamParser::feed(const uint8_t* data, size_t length) {
+  for (position = 0; position < length && state != STATE_ERROR; position++) {
+    parse((char)data[position]);
+  }
+  return state != STATE_ERROR;
+}
+
+/**
+ * @brief End the document
+ * @return true if it held exactly one complete value
+ */
+bool JsonStreamParser::finish() {
+  if (state == STATE_LITERAL) {
+    endLiteral();
+  }
+  if (state == STATE_ERROR) {
+    return false;
+  }
+  if (state != STATE_DONE) {
+    return fail(stackDepth == 0 && state == STATE_VALUE ? "Empty input" : "Incomplete input");
+  }
+  return true;
+}
+
+/**
+ * @brief Get the error of a malformed document
+ * @return Error message, nullptr if none
+ */
+const char* JsonStreamParser::error() const {
+  return errorMessage;
+}
+
+/**
+ * @brief Get the number of open objects and arrays
+ * @return Nesting depth
+ */
+int JsonStreamParser::depth() const {
+  return stackDepth;
+}
+
+/**
+ * @brief Get the offset of the byte being parsed in the current piece
+ * @return Offset
+ */
+size_t JsonStreamParser::offset() const {
+  return position;
+}
+
+/**
+ * @brief Check if the last key or value was cut to fit the token buffer
+ * @return true if it was cut
+ */
+bool JsonStreamParser::truncated() const {
+  return lastTruncated;
+}
+
+/**
+ * @brief Parse one byte
+ * @param c Byte
+ * @return false on error
+ */
+bool JsonStreamParser::parse(char c) {
+  bool space = (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+  switch (state) {
+    case STATE_VALUE:
+      return space || parseValue(c);
+    case STATE_VALUE_OR_END:
+      if (c == ']') {
+        return close('[');
+      }
+      return space || parseValue(c);
+    case STATE_KEY_OR_END:
+      if (c == '}') {
+        return close('{');
+      }
+      // Fall through
+    case STATE_KEY:
+      if (space) {
+        return true;
+      }
+      if (c != '"') {
+        return fail("Expected a key");
+      }
+      stringIsKey = true;
+      tokenLength = 0;
+      tokenTruncated = false;
+      surrogate = 0;
+      state = STATE_STRING;
+      return true;
+    case STATE_COLON:
+      if (space) {
+        return true;
+      }
+      if (c != ':') {
+        return fail("Expected ':'");
+      }
+      state = STATE_VALUE;
+      return true;
+    case STATE_AFTER:
+      if (space) {
+        return true;
+      }
+      if (c == ',') {
+        state = stack[stackDepth - 1] == '{' ? STATE_KEY : STATE_VALUE;
+        return true;
+      }
+      if (c == '}' || c == ']') {
+        return close(c == '}' ? '{' : '[');
+      }
+      return fail("Expected ',' or the end of the container");
+    case STATE_STRING:
+      return parseString(c);
+    case STATE_LITERAL:
+      if (isalnum((unsigned char)c) || c == '.' || c == '+' || c == '-') {
+        append(c);
+        return true;
+      }
+      // The literal ended, parse this byte in the state that follows it
+      return endLiteral() && parse(c);
+    case STATE_DONE:
+      return space || fail("Unexpected data after the document");
+    case STATE_ERROR:
+      return false;
+  }
+  return false;
+}
+
+/**
+ * @brief Parse the first byte of a value
+ * @param c Byte
+ * @return false on error
+ */
+bool JsonStreamParser::parseValue(char c) {
+  if (c == '{' || c == '[') {
+    return open(c);
+  }
+  tokenLength = 0;
+  tokenTruncated = false;
+  if (c == '"') {
+    stringIsKey = false;
+    surrogate = 0;
+    state = STATE_STRING;
+    return true;
+  }
+  if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+    append(c);
+    state = STATE_LITERAL;
+    return true;
+  }
+  return fail("Expected a value");
+}
+
+/**
+ * @brief Parse one byte of a string
+ * @param c Byte
+ * @return false on error
+ */
+bool JsonStreamParser::parseString(char c) {
+  // A high surrogate must be followed by a \u escape
+  if (surrogate && ((escape == 0 && c != '\\') || (escape == 1 && c != 'u'))) {
+    surrogate = 0;
+    appendCodepoint(0xFFFD);
+  }
+  if (escape == 1) {
+    escape = 0;
+    switch (c) {
+      case '"': append('"'); break;
+      case '\\': append('\\'); break;
+      case '/': append('/'); break;
+      case 'b': append('\b'); break;
+      case 'f': append('\f'); break;
+      case 'n': append('\n'); break;
+      case 'r': append('\r'); break;
+      case 't': append('\t'); break;
+      case 'u': escape = 2; codepoint = 0; break;
+      default: return fail("Invalid escape");
+    }
+    return true;
+  }
+  if (escape >= 2) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return fail("Invalid \\u escape");
+    }
+    codepoint = (codepoint << 4) | digit;
+    if (++escape == 6) {
+      escape = 0;
+      appendCodepoint(codepoint);
+    }
+    return true;
+  }
+  if (c == '\\') {
+    escape = 1;
+    return true;
+  }
+  if (c == '"') {
+    token[tokenLength] = '\0';
+    lastTruncated = tokenTruncated;
+    if (stringIsKey) {
+      listener.key(token);
+      state = STATE_COLON;
+    } else {
+      listener.value(token, JSON_STREAM_STRING);
+      afterValue();
+    }
+    return true;
+  }
+  if ((unsigned char)c < 0x20) {
+    return fail("Control character in string");
+  }
+  append(c);
+  return true;
+}
+
+/**
+ * @brief Check and report the number or literal just read
+ * @return false on error
+ */
+bool JsonStreamParser::endLiteral() {
+  token[tokenLength] = '\0';
+  lastTruncated = tokenTruncated;
+  JsonStreamType type;
+  if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0) {
+    type = JSON_STREAM_BOOL;
+  } else if (strcmp(token, "null") == 0) {
+    type = JSON_STREAM_NULL;
+  } else {
+    char* end;
+    strtod(token, &end);
+    if (tokenTruncated || end == token || *end != '\0' || token[0] == '+') {
+      return fail("Invalid literal");
+    }
+    type = JSON_STREAM_NUMBER;
+  }
+  listener.value(token, type);
+  afterValue();
+  return true;
+}
+
+/**
+ * @brief Open an object or array
+ * @param type '{' or '['
+ * @return false on error
+ */
+bool JsonStreamParser::open(char type) {
+  if (stackDepth >= JSON_STREAM_MAX_DEPTH) {
+    return fail("Too deeply nested");
+  }
+  stack[stackDepth++] = type;
+  if (type == '{') {
+    state = STATE_KEY_OR_END;
+    listener.startObject();
+  } else {
+    state = STATE_VALUE_OR_END;
+    listener.startArray();
+  }
+  return true;
+}
+
+/**
+ * @brief Close an object or array
+ * @param type '{' or '[' of the container being closed
+ * @return false on error
+ */
+bool JsonStreamParser::close(char type) {
+  if (stackDepth == 0 || stack[stackDepth - 1] != type) {
+    return fail("Mismatched bracket");
+  }
+  stackDepth--;
+  if (type == '{') {
+    listener.endObject();
+  } else {
+    listener.endArray();
+  }
+  afterValue();
+  return true;
+}
+
+/**
+ * @brief Move on after a complete value
+ */
+void JsonStreamParser::afterValue() {
+  state = stackDepth == 0 ? STATE_DONE : STATE_AFTER;
+}
+
+/**
+ * @brief Add a byte to the token, cutting what does not fit
+ * @param c Byte
+ */
+void JsonStreamParser::append(char c) {
+  if (tokenLength < sizeof(token) - 1) {
+    token[tokenLength++] = c;
+  } else {
+    tokenTruncated = true;
+  }
+}
+
+/**
+ * @brief Add a \u escape to the token as UTF-8
+ * @details Surrogate pairs are joined, unpaired surrogates become U+FFFD.
+ * @param cp UTF-16 code unit
+ */
+void JsonStreamParser::appendCodepoint(uint32_t cp) {
+  if (cp >= 0xD800 && cp <= 0xDBFF) {
+    if (surrogate) {
+      appendCodepoint(0xFFFD);
+    }
+    surrogate = cp;
+    return;
+  }
+  if (cp >= 0xDC00 && cp <= 0xDFFF) {
+    if (!surrogate) {
+      cp = 0xFFFD;
+    } else {
+      cp = 0x10000 + ((surrogate - 0xD800) << 10) + (cp - 0xDC00);
+      surrogate = 0;
+    }
+  } else if (surrogate) {
+    surrogate = 0;
+    appendCodepoint(0xFFFD);
+  }
+  if (cp < 0x80) {
+    append((char)cp);
+  } else if (cp < 0x800) {
+    append((char)(0xC0 | (cp >> 6)));
+    append((char)(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    append((char)(0xE0 | (cp >> 12)));
+    append((char)(0x80 | ((cp >> 6) & 0x3F)));
+    append((char)(0x80 | (cp & 0x3F)));
+  } else {
+    append((char)(0xF0 | (cp >> 18)));
+    append((char)(0x80 | ((cp >> 12) & 0x3F)));
+    append((char)(0x80 | ((cp >> 6) & 0x3F)));
+    append((char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+/**
+ * @brief Mark the document as malformed
+ * @param message Error message
+ * @return false
+ */
+bool JsonStreamParser::fail(const char* message) {
+  if (state != STATE_ERROR) {
+    errorMessage = message;
+    state = STATE_ERROR;
+  }
+  return false;
+}
@@ -0,0 +1,168 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAM_H
+#define JSONSTREAM_H
+
+#include <Arduino.h>
+
+// Longest string, key or number kept, longer ones are cut
+#ifndef JSON_STREAM_TOKEN_SIZE
+#define JSON_STREAM_TOKEN_SIZE 256
+#endif
+
+// Deepest nesting of objects and arrays accepted
+#ifndef JSON_STREAM_MAX_DEPTH
+#define JSON_STREAM_MAX_DEPTH 16
+#endif
+
+/**
+ * @brief Type of a scalar value
+ */
+enum JsonStreamType {
+  JSON_STREAM_STRING,
+  JSON_STREAM_NUMBER,
+  JSON_STREAM_BOOL,
+  JSON_STREAM_NULL,
+};
+
+/**
+ * @brief Receives the parts of a JSON document as they are parsed
+ * @details The parser depth() already counts a container in its start
+ * callback and no longer counts it in its end callback.
+ */
+class JsonStreamListener {
+public:
+  virtual ~JsonStreamListener() {}
+  virtual void startObject() {}
+  virtual void endObject() {}
+  virtual void startArray() {}
+  virtual void endArray() {}
+  /**
+   * @brief An object key
+   * @param name Key, cut to JSON_STREAM_TOKEN_SIZE - 1 bytes
+   */
+  virtual void key(const char* name) {}
+  /**
+   * @brief A scalar value
+   * @param text String contents, or the number, "true", "false" or "null" as written
+   * @param type Value type
+   */
+  virtual void value(const char* text, JsonStreamType type) {}
+};
+
+/**
+ * @brief Incremental JSON parser
+ * @details Takes the document in pieces of any size, as they come from the
+ * network, and reports keys, values and containers to a listener without
+ * building the document. Memory use is fixed: one token buffer and the
+ * nesting stack, whatever the size of the document.
+ */
+class JsonStreamParser {
+public:
+  JsonStreamParser(JsonStreamListener& listenerRef);
+
+  /**
+   * @brief Start a new document
+   */
+  void reset();
+
+  /**
+   * @brief Parse the next piece of the document
+   * @param data Bytes
+   * @param length Number of bytes
+   * @return false once the document is malformed, the rest is then ignored
+   */
+  bool feed(const uint8_t* data, size_t length);
+
+  /**
+   * @brief End the document
+   * @return true if it held exactly one complete value
+   */
+  bool finish();
+
+  /**
+   * @brief Get the error of a malformed document
+   * @return Error message, nullptr if none
+   */
+  const char* error() const;
+
+  /**
+   * @brief Get the number of open objects and arrays
+   * @return Nesting depth
+   */
+  int depth() const;
+
+  /**
+   * @brief Get the offset of the byte being parsed in the piece given to feed()
+   * @details Lets listeners copy parts of the document as they are.
+   * @return Offset
+   */
+  size_t offset() const;
+
+  /**
+   * @brief Check if the last key or value was cut to fit the token buffer
+   * @return true if it was cut
+   */
+  bool truncated() const;
+
+private:
+  /**
+   * @brief What the parser expects next
+   */
+  enum State {
+    STATE_VALUE,          ///< A value
+    STATE_VALUE_OR_END,   ///< A value or the end of an empty array
+    STATE_KEY_OR_END,     ///< A key or the end of an empty object
+    STATE_KEY,            ///< A key
+    STATE_COLON,          ///< The colon after a key
+    STATE_AFTER,          ///< A comma or the end of the container
+    STATE_STRING,         ///< String contents
+    STATE_LITERAL,        ///< Number, true, false or null
+    STATE_DONE,           ///< Nothing but whitespace
+    STATE_ERROR,          ///< Malformed, ignore the rest
+  };
+
+  JsonStreamListener& listener;
+  State state;
+  bool stringIsKey;                     ///< The string being read is a key
+  uint8_t escape;                       ///< 0, 1 after a backslash, 2..5 in \uXXXX
+  uint32_t codepoint;                   ///< \u escape being read
+  uint32_t surrogate;                   ///< High surrogate waiting for its pair
+  char token[JSON_STREAM_TOKEN_SIZE];   ///< String, key or literal being read
+  size_t tokenLength;
+  bool tokenTruncated;
+  bool lastTruncated;
+  char stack[JSON_STREAM_MAX_DEPTH];    ///< '{' or '[' for each open container
+  int stackDepth;
+  size_t position;                      ///< Offset in the current piece
+  const char* errorMessage;
+
+  bool parse(char c);
+  bool parseValue(char c);
+  bool parseString(char c);
+  bool endLiteral();
+  bool open(char type);
+  bool close(char type);
+  void afterValue();
+  void append(char c);
+  void appendCodepoint(uint32_t cp);
+  bool fail(const char* message);
+};
+
+#endif // JSONSTREAM_H
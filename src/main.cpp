@@ -24,6 +24,9 @@
 #include "player.h"
 #include "playlist.h"
 #include "touch.h"
+#include "artcache.h"
+#include "control.h"
+#include "importer.h"
 
 // Spleen fonts https://www.onlinewebfonts.com/icon
 #include "Spleen6x12.h" 
@@ -31,15 +34,18 @@
 #include "Spleen16x32.h"
 #include <ESPmDNS.h>
 #include <HTTPClient.h>
+#include <memory>
 
 
 // Global variables definitions
 char ssid[MAX_WIFI_NETWORKS][64] = {""};
 char password[MAX_WIFI_NETWORKS][64] = {""};
 int wifiNetworkCount = 0;
-WebServer server(80);
+WiFiServer webServer(80, HTTP_MAX_CLIENTS);
+HTTPServer server(webServer);
 WebSocketsServer webSocket(81);
-WiFiServer mpdServer(6600);
+WiFiServer mpdServer(6600, MPD_MAX_CLIENTS);
+WiFiServer controlServer(0, CONTROL_MAX_CLIENTS);
 const char* BUILD_TIME = __DATE__ "T" __TIME__"Z";
 String previousStatus = "";
 
@@ -50,6 +56,12 @@ Adafruit_SSD1306* displayOLED;
 Display* display;
 RotaryEncoder rotaryEncoder;
 TaskHandle_t audioTaskHandle = NULL;
+TaskHandle_t uiTaskHandle = NULL;
+
+// Display and WebSocket updates requested from other tasks, done by loop()
+volatile bool displayUpdatePending = false;
+volatile bool statusUpdatePending = false;
+volatile bool statusUpdateFull = false;
 
 Player player;
  
@@ -61,8 +73,18 @@ TouchButton* touchPrev = nullptr;
 // Flag to indicate board button press
 static volatile bool boardButtonPressed = false;
 
+// Station logos and cover images, served to MPD clients
+ArtCache artCache;
+
 // MPD Interface instance
-MPDInterface mpdInterface(mpdServer, player);
+MPDInterface mpdInterface(mpdServer, player, artCache);
+
+// Binary control protocol instance, for home automation
+ControlInterface controlInterface(controlServer, player);
+
+// Playlist and configuration uploads, parsed as they are received
+PlaylistImporter playlistImporter(player);
+ConfigImporter configImporter(SPIFFS);
 
 // Configuration structure definition
 Config config = {
@@ -83,7 +105,12 @@ Config config = {
   DEFAULT_TOUCH_NEXT,
   DEFAULT_TOUCH_PREV,
   DEFAULT_TOUCH_THRESHOLD,
-  DEFAULT_TOUCH_DEBOUNCE
+  DEFAULT_TOUCH_DEBOUNCE,
+  DEFAULT_MPD_BUDGET,
+  DEFAULT_MPD_TIMEOUT,
+  DEFAULT_MPD_QUEUE,
+  DEFAULT_MPD_KEEPALIVE,
+  DEFAULT_CONTROL_PORT
 };
 
 
@@ -149,6 +176,8 @@ void audio_info(const char *info) {
   if (info && strlen(info) > 0) {
     Serial.print("Audio Info: ");
     Serial.println(info);
+    // Count decode errors, underruns and reconnects for the MPD stats
+    player.countAudioInfo(info);
     // Check if the info contains StreamUrl=
     String infoStr = String(info);
     if (infoStr.startsWith("StreamUrl=")) {
@@ -169,6 +198,8 @@ void audio_info(const char *info) {
         player.setStreamIconUrl(urlPart.c_str());
         Serial.print("Cover image URL: ");
         Serial.println(player.getStreamIconUrl());
+        // Fetch it for the MPD clients
+        artCache.request(player.getStreamUrl(), urlPart.c_str());
         // Notify clients of the new cover image
         sendStatusToClients();
       }
@@ -214,144 +245,6 @@ void audio_id3data(const char *info) {
 }
 
 
-/**
- * @brief Read JSON file from SPIFFS
- * Helper function to read and parse JSON files from SPIFFS
- * @param filename Path to the file in SPIFFS
- * @param maxFileSize Maximum allowed file size
- * @param doc JsonDocument to populate with parsed data
- * @return true if successful, false otherwise
- */
-bool readJsonFile(const char* filename, size_t maxFileSize, DynamicJsonDocument& doc) {
-  // Check if the file exists
-  if (!SPIFFS.exists(filename)) {
-    Serial.printf("JSON file not found: %s\n", filename);
-    return false;
-  }
-  // Open the file
-  File file = SPIFFS.open(filename, "r");
-  if (!file) {
-    Serial.printf("Failed to open JSON file: %s\n", filename);
-    return false;
-  }
-  // Get the size of the file
-  size_t size = file.size();
-  if (size > maxFileSize) {
-    Serial.printf("JSON file too large: %s\n", filename);
-    file.close();
-    return false;
-  }
-  // Check if the file is empty
-  if (size == 0) {
-    Serial.printf("JSON file is empty: %s\n", filename);
-    file.close();
-    return false;
-  }
-  // Allocate buffer for file content
-  std::unique_ptr<char[]> buf(new char[size + 1]);
-  if (!buf) {
-    Serial.printf("Error: Failed to allocate memory for JSON file: %s\n", filename);
-    file.close();
-    return false;
-  }
-  // Read the file content
-  if (file.readBytes(buf.get(), size) != size) {
-    Serial.printf("Failed to read JSON file: %s\n", filename);
-    file.close();
-    return false;
-  }
-  // Null-terminate the buffer
-  buf[size] = '\0';
-  file.close();
-  // Parse the JSON document
-  DeserializationError error = deserializeJson(doc, buf.get());
-  if (error) {
-    Serial.printf("Failed to parse JSON file %s: %s\n", filename, error.c_str());
-    return false;
-  }
-  // Successfully read and parsed the JSON file
-  return true;
-}
-
-/**
- * @brief Write JSON file to SPIFFS
- * Helper function to serialize and write JSON files to SPIFFS
- * @param filename Path to the file in SPIFFS
- * @param doc JsonDocument to serialize
- * @return true if successful, false otherwise
- */
-bool writeJsonFile(const char* filename, DynamicJsonDocument& doc) {
-  // Create backup of existing file
-  String backupFilename = String(filename) + ".bak";
-  if (SPIFFS.exists(filename)) {
-    if (SPIFFS.exists(backupFilename)) {
-      SPIFFS.remove(backupFilename);
-    }
-    if (!SPIFFS.rename(filename, backupFilename)) {
-      Serial.printf("Warning: Failed to create backup of %s\n", filename);
-    }
-  }
-  // Open the file for writing
-  File file = SPIFFS.open(filename, "w");
-  if (!file) {
-    Serial.printf("Failed to open JSON file for writing: %s\n", filename);
-    // Try to restore from backup
-    if (SPIFFS.exists(backupFilename)) {
-      if (SPIFFS.rename(backupFilename, filename)) {
-        Serial.printf("Restored %s from backup\n", filename);
-      } else {
-        Serial.printf("Error: Failed to restore %s from backup\n", filename);
-      }
-    }
-    return false;
-  }
-  // Serialize the JSON document to the file
-  size_t bytesWritten = serializeJson(doc, file);
-  if (bytesWritten == 0) {
-    Serial.printf("Failed to write JSON to file: %s\n", filename);
-    file.close();
-    // Try to restore from backup
-    if (SPIFFS.exists(backupFilename)) {
-      SPIFFS.remove(filename); // Remove the failed file
-      if (SPIFFS.rename(backupFilename, filename)) {
-        Serial.printf("Restored %s from backup\n", filename);
-      } else {
-        Serial.printf("Error: Failed to restore %s from backup\n", filename);
-      }
-    }
-    return false;
-  }
-  file.close();
-  // Remove backup file after successful save
-  if (SPIFFS.exists(backupFilename)) {
-    SPIFFS.remove(backupFilename);
-  }
-  // Successfully wrote the JSON file
-  return true;
-}
-
-/**
- * @brief Send JSON response with status and message
- * Helper function to send standardized JSON responses
- * @param status Status string ("success" or "error")
- * @param message Human-readable message
- * @param code HTTP status code (default 200 for success, 400 for error)
- */
-void sendJsonResponse(const String& status, const String& message, int code = -1) {
-  // If code not specified, determine based on status
-  if (code == -1) {
-    code = (status == "success") ? 200 : 400;
-  }
-  // Create JSON response
-  DynamicJsonDocument doc(256);
-  doc["status"] = status;
-  doc["message"] = message;
-  String json;
-  serializeJson(doc, json);
-  server.send(code, "application/json", json);
-}
-
-
 /**
  * @brief Handle WiFi configuration API request
  * Returns the current WiFi configuration as JSON
@@ -652,6 +545,11 @@ void extractConfigFromJson(DynamicJsonDocument& doc) {
   if (doc.containsKey("touch_prev")) config.touch_prev = doc["touch_prev"];
   if (doc.containsKey("touch_threshold")) config.touch_threshold = doc["touch_threshold"];
   if (doc.containsKey("touch_debounce")) config.touch_debounce = doc["touch_debounce"];
+  if (doc.containsKey("mpd_budget")) config.mpd_budget = doc["mpd_budget"];
+  if (doc.containsKey("mpd_timeout")) config.mpd_timeout = doc["mpd_timeout"];
+  if (doc.containsKey("mpd_queue")) config.mpd_queue = doc["mpd_queue"];
+  if (doc.containsKey("mpd_keepalive")) config.mpd_keepalive = doc["mpd_keepalive"];
+  if (doc.containsKey("control_port")) config.control_port = doc["control_port"];
 }
 
 /**
@@ -678,6 +576,11 @@ void populateConfigJson(DynamicJsonDocument& doc) {
   doc["touch_prev"] = config.touch_prev;
   doc["touch_threshold"] = config.touch_threshold;
   doc["touch_debounce"] = config.touch_debounce;
+  doc["mpd_budget"] = config.mpd_budget;
+  doc["mpd_timeout"] = config.mpd_timeout;
+  doc["mpd_queue"] = config.mpd_queue;
+  doc["mpd_keepalive"] = config.mpd_keepalive;
+  doc["control_port"] = config.control_port;
 }
 
 /**
@@ -706,6 +609,11 @@ void loadConfig() {
   config.touch_prev = DEFAULT_TOUCH_PREV;
   config.touch_threshold = DEFAULT_TOUCH_THRESHOLD;
   config.touch_debounce = DEFAULT_TOUCH_DEBOUNCE;
+  config.mpd_budget = DEFAULT_MPD_BUDGET;
+  config.mpd_timeout = DEFAULT_MPD_TIMEOUT;
+  config.mpd_queue = DEFAULT_MPD_QUEUE;
+  config.mpd_keepalive = DEFAULT_MPD_KEEPALIVE;
+  config.control_port = DEFAULT_CONTROL_PORT;
   // Read configuration from SPIFFS
   if (!readJsonFile("/config.json", 1024, doc)) {
     Serial.println("Config file not found, using defaults");
@@ -808,6 +716,19 @@ void audioTask(void *pvParameters) {
   }
 }
 
+/**
+ * @brief Player event listener
+ * Ends the pause of loop() early, so web requests waiting for a player or
+ * mixer change are answered right away instead of on the next pass
+ * @param events Changed subsystems
+ * @param context Unused
+ */
+static void playerEventListener(uint8_t events, void* context) {
+  if (uiTaskHandle) {
+    xTaskNotifyGive(uiTaskHandle);
+  }
+}
+
 
 
 /**
@@ -1142,529 +1063,6 @@ void handleSimpleWebPage() {
 }
 
 
-/**
- * @brief Handle GET request for streams
- * Returns the current playlist as JSON
- * This function serves the current playlist in JSON format. If the playlist file
- * doesn't exist, it creates a default empty one.
- */
-void handleGetStreams() {
-  // Yield to other tasks before processing
-  yield();
-  // If playlist file doesn't exist, return a default empty one
-  if (!SPIFFS.exists("/playlist.json")) {
-    server.send(200, "application/json", "[]");
-    return;
-  }
-  File file = SPIFFS.open("/playlist.json", "r");
-  if (!file) {
-    server.send(200, "application/json", "[]");
-    return;
-  }
-  // Stream the file contents
-  server.streamFile(file, "application/json");
-  file.close();
-  // Yield to other tasks after processing
-  yield();
-}
-
-/**
- * @brief Handle POST request for streams
- * Updates the playlist with new JSON data and saves to SPIFFS
- * This function receives a new playlist via HTTP POST, validates it, and saves it to SPIFFS.
- * It supports both JSON array format and validates each stream entry.
- */
-void handlePostStreams() {
-  // Get the JSON data from the request
-  String jsonData = server.arg("plain");
-  // Validate that we received data
-  if (jsonData.length() == 0) {
-    sendJsonResponse("error", "Missing JSON data");
-    return;
-  }
-  // Parse the JSON data
-  DynamicJsonDocument doc(4096);
-  DeserializationError error = deserializeJson(doc, jsonData);
-  // Check for JSON parsing errors
-  if (error) {
-    Serial.print("JSON parsing error: ");
-    Serial.println(error.c_str());
-    sendJsonResponse("error", "Invalid JSON format");
-    return;
-  }
-  // Ensure it's an array
-  if (!doc.is<JsonArray>()) {
-    sendJsonResponse("error", "JSON root must be an array");
-    return;
-  }
-  // Get the array
-  JsonArray array = doc.as<JsonArray>();
-  // Validate array size
-  if (array.size() > MAX_PLAYLIST_SIZE) {
-    sendJsonResponse("error", "Playlist exceeds maximum size");
-    return;
-  }
-  // Clear existing playlist
-  player.clearPlaylist();
-  // Process each item in the array
-  for (JsonObject item : array) {
-    // Validate required fields
-    if (!item.containsKey("name") || !item.containsKey("url")) {
-      sendJsonResponse("error", "Each item must have 'name' and 'url' fields");
-      return;
-    }
-    // Extract name and url
-    const char* name = item["name"];
-    const char* url = item["url"];
-    // Validate data
-    if (!name || !url || strlen(name) == 0 || strlen(url) == 0) {
-      sendJsonResponse("error", "Name and URL cannot be empty");
-      return;
-    }
-    // Validate URL format
-    if (!VALIDATE_URL(url)) {
-      sendJsonResponse("error", "Invalid URL format");
-      return;
-    }
-    // Add to playlist
-    player.addPlaylistItem(name, url);
-  }
-  // Save to SPIFFS
-  player.savePlaylist();
-  // Send success response
-  sendJsonResponse("success", "Playlist updated successfully");
-}
-
-/**
- * @brief Handle player request
- * Controls stream playback (play/stop) or returns player status
- * This function handles HTTP requests to control playback or get player status.
- * For POST requests, it supports both JSON payload and form data with action parameter.
- * For GET requests, it returns player status and stream information.
- * 
- * POST /api/player:
- *   JSON payload: {"action": "play", "url": "...", "name": "...", "index": 0}
- *   JSON payload: {"action": "play", "index": 0}
- *   JSON payload: {"action": "stop"}
- *   Form data: action=play&url=...&name=...&index=0
- *   Form data: action=play&index=0
- *   Form data: action=stop
- * 
- * GET /api/player:
- *   Returns: {"status": "play|stop", "stream": {...}}
- *   When playing: stream object contains name, title, url, index, bitrate, elapsed
- *   When stopped: stream object is omitted
- */
-void handlePlayer() {
-  // Handle GET request - return player status
-  if (server.method() == HTTP_GET) {
-    // Create JSON document with appropriate size
-    DynamicJsonDocument doc(512);
-    // Add player status
-    doc["status"] = player.isPlaying() ? "play" : "stop";
-    // If playing, add stream information
-    if (player.isPlaying()) {
-      JsonObject streamObj = doc.createNestedObject("stream");
-      streamObj["name"] = player.getStreamName();
-      streamObj["title"] = player.getStreamTitle();
-      streamObj["url"] = player.getStreamUrl();
-      streamObj["index"] = player.getPlaylistIndex();
-      streamObj["bitrate"] = player.getBitrate();
-      // Calculate elapsed time
-      if (player.getPlayStartTime() > 0) {
-        unsigned long currentTime = millis() / 1000;
-        unsigned long elapsedTime = currentTime - player.getPlayStartTime();
-        streamObj["elapsed"] = elapsedTime;
-      } else {
-        streamObj["elapsed"] = 0;
-      }
-    }
-    // Serialize JSON to string
-    String json;
-    serializeJson(doc, json);
-    // Return status as JSON
-    server.send(200, "application/json", json);
-    return;
-  }
-  // Handle POST request - control playback
-  String action, url, name;
-  int index = -1;
-  // Check if request has JSON payload
-  if (server.hasArg("plain")) {
-    // Handle JSON payload
-    String json = server.arg("plain");
-    DynamicJsonDocument doc(512);
-    DeserializationError error = deserializeJson(doc, json);
-    // Check for JSON parsing errors
-    if (error) {
-      sendJsonResponse("error", "Invalid JSON");
-      return;
-    }
-    // Extract parameters from JSON
-    if (doc.containsKey("action")) {
-      action = doc["action"].as<String>();
-    }
-    if (doc.containsKey("url")) {
-      url = doc["url"].as<String>();
-    }
-    if (doc.containsKey("name")) {
-      name = doc["name"].as<String>();
-    }
-    if (doc.containsKey("index")) {
-      index = doc["index"].as<int>();
-    }
-  } 
-  // Check if request has form data
-  else if (server.hasArg("action")) {
-    // Handle form data
-    action = server.arg("action");
-    if (server.hasArg("url")) {
-      url = server.arg("url");
-    }
-    if (server.hasArg("name")) {
-      name = server.arg("name");
-    }
-    if (server.hasArg("index")) {
-      index = server.arg("index").toInt();
-    }
-  } 
-  else {
-    sendJsonResponse("error", "Missing action parameter");
-    return;
-  }
-  // Check for required action parameter
-  if (action.length() == 0) {
-    sendJsonResponse("error", "Missing required parameter: action");
-    return;
-  }
-  if (action == "play") {
-    // Handle case where only index is provided
-    if (url.length() == 0 && name.length() == 0 && index >= 0) {
-      // Validate index
-      if (index >= player.getPlaylistCount()) {
-        sendJsonResponse("error", "Invalid playlist index");
-        return;
-      }
-      // Extract stream data from playlist
-      url = String(player.getPlaylistItem(index).url);
-      name = String(player.getPlaylistItem(index).name);
-      player.setPlaylistIndex(index);
-    } 
-    // Handle case where URL is provided (with optional name)
-    else if (url.length() > 0) {
-      // If no name provided, check if we have a current stream name
-      if (name.length() == 0 && strlen(player.getStreamUrl()) > 0 && url == String(player.getStreamUrl())) {
-        name = (strlen(player.getStreamName()) > 0) ? String(player.getStreamName()) : "Unknown Station";
-      }
-      // Validate URL format
-      if (!url.startsWith("http://") && !url.startsWith("https://")) {
-        sendJsonResponse("error", "Invalid URL format. Must start with http:// or https://");
-        return;
-      }
-      // Update currentSelection based on URL
-      for (int i = 0; i < player.getPlaylistCount(); i++) {
-        if (strcmp(player.getPlaylistItem(i).url, url.c_str()) == 0) {
-          player.setPlaylistIndex(i);
-          break;
-        }
-      }
-    }
-    // Handle case where we're resuming playback
-    else if (url.length() == 0 && strlen(player.getStreamUrl()) > 0) {
-      url = String(player.getStreamUrl());
-      name = (strlen(player.getStreamName()) > 0) ? String(player.getStreamName()) : "Unknown Station";
-    }
-    // No valid play parameters
-    else {
-      sendJsonResponse("error", "Missing required parameters for play action");
-      return;
-    }
-    // Stop any currently playing stream
-    player.stopStream();
-    // Start the stream
-    player.startStream(url.c_str(), name.c_str());
-    // Save player state when user requests to play
-    player.savePlayerState();
-    // Update display and notify clients
-    updateDisplay();
-    sendStatusToClients();
-    // Send success response
-    sendJsonResponse("success", "Stream started successfully");
-  } 
-  else if (action == "stop") {
-    // Stop any currently playing stream
-    player.stopStream();
-    // Update display and notify clients
-    updateDisplay();
-    sendStatusToClients();
-    // Send success response
-    sendJsonResponse("success", "Stream stopped successfully");
-  } 
-  else {
-    sendJsonResponse("error", "Invalid action. Supported actions: play, stop");
-    return;
-  }
-}
-
-/**
- * @brief Handle mixer request
- * Gets or sets the volume and tone levels
- * This function handles HTTP requests to get or set the volume and/or tone levels. 
- * For GET requests, it returns the current mixer status as JSON.
- * For POST requests, it supports both JSON payload and form data, validates the input, and updates the settings.
- * 
- * GET /api/mixer:
- *   Returns: {"volume": 11, "bass": 0, "mid": 0, "treble": 0}
- * 
- * POST /api/mixer:
- *   JSON payload: {"volume": 10}
- *   JSON payload: {"bass": 4, "treble": -2}
- *   Form data: volume=10
- *   Form data: bass=4&treble=-2
- */
-void handleMixer() {
-  // Handle GET request - return current mixer status
-  if (server.method() == HTTP_GET) {
-    // Create JSON document with appropriate size
-    DynamicJsonDocument doc(256);
-    // Add mixer status
-    doc["volume"] = player.getVolume();
-    doc["bass"] = player.getBass();
-    doc["mid"] = player.getMid();
-    doc["treble"] = player.getTreble();
-    // Serialize JSON to string
-    String json;
-    serializeJson(doc, json);
-    // Return status as JSON
-    server.send(200, "application/json", json);
-    return;
-  }
-  // Handle POST request - update mixer settings
-  DynamicJsonDocument doc(256);
-  bool hasData = false;
-  // Handle JSON payload
-  if (server.hasArg("plain")) {
-    String json = server.arg("plain");
-    DeserializationError error = deserializeJson(doc, json);
-    // Check for JSON parsing errors
-    if (error) {
-      sendJsonResponse("error", "Invalid JSON");
-      return;
-    }
-    hasData = true;
-  }
-  // Handle form data
-  else {
-    // Check if any form parameters are present
-    if (server.hasArg("volume") || server.hasArg("bass") || 
-        server.hasArg("mid") || server.hasArg("treble")) {
-      hasData = true;
-      // Add form data to JSON document
-      if (server.hasArg("volume")) {
-        doc["volume"] = server.arg("volume");
-      }
-      if (server.hasArg("bass")) {
-        doc["bass"] = server.arg("bass");
-      }
-      if (server.hasArg("mid")) {
-        doc["mid"] = server.arg("mid");
-      }
-      if (server.hasArg("treble")) {
-        doc["treble"] = server.arg("treble");
-      }
-    }
-  }
-  // Check if any data was provided
-  if (!hasData) {
-    sendJsonResponse("error", "Missing data: volume, bass, mid, or treble");
-    return;
-  }
-  bool toneUpdated = false;
-  // Handle volume setting
-  if (doc.containsKey("volume")) {
-    int newVolume;
-    if (doc["volume"].is<const char*>()) {
-      newVolume = atoi(doc["volume"].as<const char*>());
-    } else {
-      newVolume = doc["volume"];
-    }
-    // Validate volume range
-    if (newVolume < 0 || newVolume > 22) {
-      sendJsonResponse("error", "Volume must be between 0 and 22");
-      return;
-    }
-    player.setVolume(newVolume);
-  }
-  // Handle bass setting
-  if (doc.containsKey("bass")) {
-    int newBass;
-    if (doc["bass"].is<const char*>()) {
-      newBass = atoi(doc["bass"].as<const char*>());
-    } else {
-      newBass = doc["bass"];
-    }
-    if (newBass < -6 || newBass > 6) {
-      sendJsonResponse("error", "Bass must be between -6 and 6");
-      return;
-    }
-    player.setBass(newBass);
-    toneUpdated = true;
-  }
-  // Handle mid setting
-  if (doc.containsKey("mid")) {
-    int newMid;
-    if (doc["mid"].is<const char*>()) {
-      newMid = atoi(doc["mid"].as<const char*>());
-    } else {
-      newMid = doc["mid"];
-    }
-    if (newMid < -6 || newMid > 6) {
-      sendJsonResponse("error", "Midrange must be between -6 and 6");
-      return;
-    }
-    player.setMid(newMid);
-    toneUpdated = true;
-  }
-  // Handle treble setting
-  if (doc.containsKey("treble")) {
-    int newTreble;
-    if (doc["treble"].is<const char*>()) {
-      newTreble = atoi(doc["treble"].as<const char*>());
-    } else {
-      newTreble = doc["treble"];
-    }
-    if (newTreble < -6 || newTreble > 6) {
-      sendJsonResponse("error", "Treble must be between -6 and 6");
-      return;
-    }
-    player.setTreble(newTreble);
-    toneUpdated = true;
-  }
-  // Apply tone settings to audio
-  if (toneUpdated) {
-    player.setTone();
-  }
-  // Update display and notify clients
-  updateDisplay();
-  sendStatusToClients();
-  // Send success response
-  sendJsonResponse("success", "Mixer settings updated successfully");
-}
-
-
-/**
- * @brief Handle export configuration request
- * Exports all JSON configuration files from SPIFFS as a single JSON object
- * This function reads all JSON files from SPIFFS and combines them into a single
- * JSON object where keys are filenames and values are file contents.
- */
-void handleExportConfig() {
-  // Yield to other tasks before processing
-  yield();
-  // List of configuration files to export
-  const char* configFiles[] = {"/config.json", "/wifi.json", "/playlist.json", "/player.json"};
-  // Initialize output string
-  String output = "{";
-  // Process each configuration file
-  for (int i = 0; i < 4; i++) {
-    const char* filename = configFiles[i];
-    // Check if file exists
-    if (SPIFFS.exists(filename)) {
-      // Open the file
-      File file = SPIFFS.open(filename, "r");
-      if (file) {
-        // Get file size
-        size_t size = file.size();
-        if (size > 0 && size < 4096) { // Reasonable size limit
-          // Allocate buffer for file content
-          std::unique_ptr<char[]> buf(new char[size + 1]);
-          if (buf) {
-            // Read file content
-            if (file.readBytes(buf.get(), size) == size) {
-              buf[size] = '\0';              
-              // Add to main document with filename as key (without leading slash)
-              output += "\n\"" + String(filename + 1) + "\":" + String(buf.get());
-              if (i < 3) output += ",";
-              // Yield to other tasks during long operations
-              yield(); 
-            }
-          }
-        }
-        file.close();
-      }
-    }
-  }
-  // Close the JSON object
-  output += "}";
-  // Send the combined JSON as response
-  server.send(200, "application/json", output);
-  // Yield to other tasks after processing
-  delay(1);
-}
-
-/**
- * @brief Handle import configuration request
- * Imports a combined JSON configuration file and saves individual files to SPIFFS
- * This function receives a JSON file containing all configurations and decomposes
- * it into individual config.json, wifi.json, playlist.json, and player.json files.
- */
-void handleImportConfig() {
-  // Check if request method is POST
-  if (server.method() != HTTP_POST) {
-    sendJsonResponse("error", "Method not allowed", 405);
-    return;
-  }
-  // Check if we have data in the request body
-  if (!server.hasArg("plain")) {
-    sendJsonResponse("error", "No data received");
-    return;
-  }
-  // Get the JSON data from the request body
-  String jsonData = server.arg("plain");
-  // Check if data is empty
-  if (jsonData.length() == 0) {
-    sendJsonResponse("error", "No file uploaded");
-    return;
-  }
-  // Parse the JSON data
-  DynamicJsonDocument doc(8192);
-  DeserializationError error = deserializeJson(doc, jsonData);
-  if (error) {
-    Serial.printf("Failed to parse uploaded JSON: %s\n", error.c_str());
-    sendJsonResponse("error", "Invalid JSON format");
-    return;
-  }
-  // Process each configuration section
-  bool success = true;
-  const char* configFiles[] = {"config.json", "wifi.json", "playlist.json", "player.json"};
-  for (int i = 0; i < 4; i++) {
-    const char* filename = configFiles[i];
-    // Check if this section exists in the uploaded data
-    if (doc.containsKey(filename)) {
-      String file = String("/") + String(filename);
-      // Create a temporary DynamicJsonDocument from the JsonVariant
-      // TODO: Optimize size based on actual content
-      // TODO: needs testing
-      DynamicJsonDocument tempDoc(1024);
-      tempDoc.set(doc[filename]);
-      // Save the JSON to SPIFFS using helper function
-      if (writeJsonFile(file.c_str(), tempDoc)) {
-        Serial.println("Saved " + String(filename) + " to SPIFFS");
-      } else {
-        Serial.println("Failed to save " + String(filename) + " to SPIFFS");
-      }
-      // Yield to other tasks during long operations
-      delay(1);
-    }
-  }
-  if (success) {
-    sendJsonResponse("success", "Configuration imported successfully");
-  } else {
-    sendJsonResponse("error", "Error importing configuration", 500);
-  }
-}
-
-
 /**
  * @brief Generate JSON status string
  * Creates a JSON string with current player status information
@@ -1704,6 +1102,12 @@ String generateStatusJSON(bool fullStatus) {
  * It only sends the status if it has changed from the previous status.
  */
 void sendStatusToClients(bool fullStatus) {
+  // The WebSocket server is not thread safe, let loop() send it
+  if (uiTaskHandle && xTaskGetCurrentTaskHandle() != uiTaskHandle) {
+    statusUpdateFull = statusUpdateFull || fullStatus;
+    statusUpdatePending = true;
+    return;
+  }
   // Only broadcast if WebSocket server has clients AND they are connected
   if (webSocket.connectedClients() > 0) {
     String status = generateStatusJSON(fullStatus);
@@ -1736,39 +1140,36 @@ void handleProxyRequest() {
     sendJsonResponse("error", "Invalid URL format. Must start with http:// or https://", 400);
     return;
   }
-  // Create HTTP client
-  HTTPClient http;
+  // Create HTTP client, shared with the response stream that outlives this handler
+  std::shared_ptr<HTTPClient> http = std::make_shared<HTTPClient>();
   // Set timeouts to prevent hanging
-  http.setTimeout(5000);
+  http->setTimeout(5000);
   // Configure the request based on the original method
-  http.begin(targetUrl);
-  // Copy headers from the original request
-  int headerCount = server.headers();
-  for (int i = 0; i < headerCount; i++) {
-    String headerName = server.headerName(i);
-    String headerValue = server.header(i);
-    // Skip headers that shouldn't be forwarded
-    if (headerName.equalsIgnoreCase("Host") || 
-        headerName.equalsIgnoreCase("Connection") ||
-        headerName.equalsIgnoreCase("Content-Length")) {
-      continue;
+  http->begin(targetUrl);
+  // Copy the headers that describe the request itself. Encoding, range,
+  // conditional and cookie headers stay here: HTTPClient does not decode a
+  // compressed answer and the response headers are not all passed back
+  static const char* const forwardedHeaders[] = {
+    "Accept", "Accept-Language", "Authorization", "Content-Type", "User-Agent"
+  };
+  for (const char* name : forwardedHeaders) {
+    if (server.hasHeader(name)) {
+      http->addHeader(name, server.header(name));
     }
-    // Forward all other headers
-    http.addHeader(headerName, headerValue);
   }
   // Variable to hold HTTP response code
   int httpResponseCode;
   // Handle different HTTP methods
   if (server.method() == HTTP_GET) {
-    httpResponseCode = http.GET();
+    httpResponseCode = http->GET();
   } else if (server.method() == HTTP_HEAD) {
-    httpResponseCode = http.GET(); // Use GET but we'll only send headers
+    httpResponseCode = http->GET(); // Use GET but we'll only send headers
   } else if (server.method() == HTTP_POST) {
     // Get request body if present
     String requestBody = server.arg("plain");
-    httpResponseCode = http.POST(requestBody);
+    httpResponseCode = http->POST(requestBody);
   } else {
-    http.end();
+    http->end();
     sendJsonResponse("error", "Unsupported HTTP method", 405);
     return;
   }
@@ -1780,8 +1181,8 @@ void handleProxyRequest() {
     String headerName, headerValue;
     // Get all headers one by one until we've processed them all
     while (true) {
-      headerName = http.headerName(headerCount);
-      headerValue = http.header(headerCount);
+      headerName = http->headerName(headerCount);
+      headerValue = http->header(headerCount);
       // If we get empty strings, we've reached the end of headers
       if (headerName.length() == 0 && headerValue.length() == 0) {
         break;
@@ -1801,7 +1202,7 @@ void handleProxyRequest() {
     // For HEAD requests, only send headers without content
     if (server.method() == HTTP_HEAD) {
       // Get content type
-      String contentType = http.header("Content-Type");
+      String contentType = http->header("Content-Type");
       if (contentType.isEmpty()) {
         // Try to determine content type from URL
         if (targetUrl.endsWith(".png") || targetUrl.endsWith(".PNG")) {
@@ -1816,13 +1217,12 @@ void handleProxyRequest() {
         }
       }
       // Send response with proper content type and length (no content body for HEAD)
-      server.setContentLength(http.getSize());
+      server.setContentLength(http->getSize());
       server.send(httpResponseCode, contentType, "");
     } else {
       // For GET requests, stream the response directly to client
-      WiFiClient * stream = http.getStreamPtr();
       // Get content type
-      String contentType = http.header("Content-Type");
+      String contentType = http->header("Content-Type");
       if (contentType.isEmpty()) {
         // Try to determine content type from URL
         if (targetUrl.endsWith(".png") || targetUrl.endsWith(".PNG")) {
@@ -1836,35 +1236,31 @@ void handleProxyRequest() {
           contentType = "application/octet-stream";
         }
       }
-      // Send response with proper content type and length
-      server.setContentLength(http.getSize());
-      server.send(httpResponseCode, contentType, "");
-      // Stream the content
-      const size_t bufferSize = 1024;
-      uint8_t buffer[bufferSize];
-      size_t totalBytesRead = 0;
-      size_t contentLength = http.getSize();
-      // Read and send data in chunks
-      while (http.connected() && (contentLength == 0 || totalBytesRead < contentLength)) {
-        size_t bytesAvailable = stream->available();
-        if (bytesAvailable) {
-          size_t bytesRead = stream->readBytes(buffer, min(bytesAvailable, bufferSize));
-          server.client().write(buffer, bytesRead);
-          totalBytesRead += bytesRead;
+      // Stream the content from the following handleClient() calls, so a
+      // slow remote server does not hold up loop()
+      server.sendStream(httpResponseCode, contentType, [http](uint8_t* buffer, size_t size) -> int {
+        WiFiClient* stream = http->getStreamPtr();
+        int available = stream ? stream->available() : 0;
+        if (available > 0) {
+          return stream->read(buffer, min((size_t)available, size));
         }
-        // Yield to other tasks
-        yield();
-      }
+        if (!http->connected()) {
+          http->end();
+          return -1;
+        }
+        return 0;
+      }, http->getSize());
+      return;
     }
   } else {
     // HTTP error occurred
-    http.end();
-    Serial.printf("HTTP request failed: %s\n", http.errorToString(httpResponseCode).c_str());
-    sendJsonResponse("error", "Proxy request failed: " + String(http.errorToString(httpResponseCode)), 500);
+    http->end();
+    Serial.printf("HTTP request failed: %s\n", http->errorToString(httpResponseCode).c_str());
+    sendJsonResponse("error", "Proxy request failed: " + String(http->errorToString(httpResponseCode)), 500);
     return;
   }
   // End the HTTP connection
-  http.end();
+  http->end();
 }
 
 /**
@@ -1915,6 +1311,11 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
 void updateDisplay() {
   // Check if display is initialized
   if (display == nullptr) return;
+  // The display is driven by loop() only, defer updates from other tasks
+  if (uiTaskHandle && xTaskGetCurrentTaskHandle() != uiTaskHandle) {
+    displayUpdatePending = true;
+    return;
+  }
   // Get current IP address or "No IP" if not connected
   String ipString;
   if (WiFi.status() == WL_CONNECTED) {
@@ -1987,16 +1388,9 @@ bool initSPIFFS() {
  * Configures all HTTP routes and static file mappings for the web server
  */
 void setupWebServer() {
-  server.on("/api/streams", HTTP_GET, handleGetStreams);
-  server.on("/api/streams", HTTP_POST, handlePostStreams);
-  server.on("/api/player", HTTP_GET, handlePlayer);
-  server.on("/api/player", HTTP_POST, handlePlayer);
-  server.on("/api/mixer", HTTP_GET, handleMixer);
-  server.on("/api/mixer", HTTP_POST, handleMixer);
+  setupApiRoutes();
   server.on("/api/config", HTTP_GET, handleGetConfig);
   server.on("/api/config", HTTP_POST, handlePostConfig);
-  server.on("/api/config/export", HTTP_GET, handleExportConfig);
-  server.on("/api/config/import", HTTP_POST, handleImportConfig);
   server.on("/api/wifi/scan", HTTP_GET, handleWiFiScan);
   server.on("/api/wifi/save", HTTP_POST, handleWiFiSave);
   server.on("/api/wifi/status", HTTP_GET, handleWiFiStatus);
@@ -2114,10 +1508,36 @@ void loop() {
   ArduinoOTA.handle();           // Handle OTA updates
   server.handleClient();         // Process incoming web requests
   webSocket.loop();              // Process WebSocket events
-  mpdInterface.handleClient();   // Process MPD commands
+  if (!mpdInterface.isTaskRunning()) {
+    mpdInterface.handleClient(); // Process MPD commands
+  }
+  if (config.control_port > 0 && !controlInterface.isTaskRunning()) {
+    controlInterface.handleClient(); // Process control requests
+  }
   handleBoardButton();           // Process board button input
   handleRotary();                // Process rotary encoder input
   handleTouch();                 // Process touch button actions
+  if (!artCache.isTaskRunning()) {
+    artCache.handle();           // Fetch the station art, if requested
+  }
+  static uint32_t artVersion = 0;
+  if (artCache.getVersion() != artVersion) {
+    // Let MPD clients reload the art of the current stream
+    artVersion = artCache.getVersion();
+    player.notify(PLAYER_EVENT_PLAYER);
+  }
+
+  // Display and WebSocket updates requested by the audio and MPD tasks
+  if (statusUpdatePending) {
+    bool full = statusUpdateFull;
+    statusUpdatePending = false;
+    statusUpdateFull = false;
+    sendStatusToClients(full);
+  }
+  if (displayUpdatePending) {
+    displayUpdatePending = false;
+    updateDisplay();
+  }
 
   // Periodically update display for scrolling text animation
   static unsigned long lastDisplayUpdate = 0;
@@ -2144,16 +1564,15 @@ void loop() {
             // 1 second has passed, attempt to restart
             Serial.println("Attempting to restart stream...");
             // Resume the current stream
+            player.countReconnect();
             player.startStream();
             // Reset the timer
             streamStoppedTime = 0;
           }
         }
       } else {
-        // Stream is running
+        // Stream is running, the audio task keeps the bitrate and statistics
         streamStoppedTime = 0;
-        // Update the bitrate if it has changed
-        player.updateBitrate();
       }
 
       // Send status to clients every 3 seconds instead of 2 to reduce load
@@ -2183,8 +1602,10 @@ void loop() {
   // Handle display timeout with configurable timeout value
   display->handleTimeout(player.isPlaying(), millis());
 
-  // Small delay to prevent busy waiting and reduce network load
-  delay(150);  // Increased from 100 to 150 to reduce CPU usage
+  // Small delay to prevent busy waiting and reduce network load, but
+  // not while a browser is loading a page; a player change ends it early,
+  // see playerEventListener()
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(server.isActive() ? 5 : 150));  // Increased from 100 to 150 to reduce CPU usage
 }
 
 
@@ -2199,6 +1620,9 @@ void setup() {
   Serial.println("CubeRadio - An ESP32-based internet radio player with MPD protocol support");
   Serial.print("Build timestamp: ");
   Serial.println(BUILD_TIME);
+  // Display and WebSocket belong to this task
+  uiTaskHandle = xTaskGetCurrentTaskHandle();
+  player.setEventListener(playerEventListener, nullptr);
   
   // Initialize PSRAM if available
   #if defined(BOARD_HAS_PSRAM)
@@ -2314,6 +1738,26 @@ void setup() {
     // Start MPD server
   mpdServer.begin();
   Serial.println("MPD server started");
+  // Serve MPD from its own task, falling back to loop()
+  if (mpdInterface.startTask()) {
+    Serial.println("MPDTask created successfully");
+  } else {
+    Serial.println("ERROR: Failed to create MPDTask, serving MPD from loop()");
+  }
+  // Fetch the station art in the background, falling back to loop()
+  if (artCache.startTask()) {
+    Serial.println("ArtTask created successfully");
+  } else {
+    Serial.println("ERROR: Failed to create ArtTask, fetching art from loop()");
+  }
+  // Start the binary control server, if enabled
+  if (config.control_port > 0) {
+    controlServer.begin(config.control_port);
+    Serial.printf("Control server started on port %d\n", config.control_port);
+    if (!controlInterface.startTask()) {
+      Serial.println("ERROR: Failed to create ControlTask, serving control from loop()");
+    }
+  }
   
   // Setup ArduinoOTA
   ArduinoOTA
@@ -2352,8 +1796,9 @@ void setup() {
   // Start ArduinoOTA
   ArduinoOTA.begin();
   Serial.println("ArduinoOTA ready");
-  // Create audio task on core 0 with error checking
-  BaseType_t result = xTaskCreatePinnedToCore(audioTask, "AudioTask", 4096, NULL, 5, &audioTaskHandle, 0);
+  // Create audio task on core 0 with error checking, it also connects to
+  // the streams, so leave room for a TLS handshake
+  BaseType_t result = xTaskCreatePinnedToCore(audioTask, "AudioTask", 8192, NULL, 5, &audioTaskHandle, 0);
   if (result != pdPASS) {
     Serial.println("ERROR: Failed to create AudioTask");
   } else {
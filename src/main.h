@@ -21,7 +21,6 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
@@ -33,11 +32,12 @@
 #include <ESPmDNS.h>
 #include <ArduinoOTA.h>
 #include "rotary.h"
+#include "httpserver.h"
 
 
 // Forward declarations
 class Audio;
-class WebServer;
+class HTTPServer;
 class WebSocketsServer;
 class WiFiServer;
 class Adafruit_SSD1306;
@@ -66,6 +66,11 @@ struct Config {
   int touch_prev;      ///< Touch button previous/volume-down pin
   int touch_threshold; ///< Touch threshold value
   int touch_debounce;  ///< Touch debounce time in milliseconds
+  int mpd_budget;      ///< MPD command processing budget per loop pass in milliseconds
+  int mpd_timeout;     ///< Seconds without MPD traffic before a client is dropped, 0 = never
+  int mpd_queue;       ///< Bytes of unsent MPD responses a client may have
+  int mpd_keepalive;   ///< Seconds of silence before TCP keepalive probes, 0 = off
+  int control_port;    ///< TCP port of the binary control protocol, 0 = disabled
 };
 extern Config config;
 
@@ -77,9 +82,11 @@ extern Config config;
 
 // Global variables
 extern const char* BUILD_TIME;
-extern WebServer server;
+extern WiFiServer webServer;
+extern HTTPServer server;
 extern WebSocketsServer webSocket;
 extern WiFiServer mpdServer;
+extern WiFiServer controlServer;
 extern Display* display;
 extern TaskHandle_t audioTaskHandle;
 extern char ssid[MAX_WIFI_NETWORKS][64];
@@ -99,18 +106,28 @@ void saveWiFiCredentials();
 
 // Web server handlers
 void handleSimpleWebPage();
-void handleGetStreams();
-void handlePostStreams();
 void handleGetConfig();
 void handlePostConfig();
-void handleExportConfig();
-void handleImportConfig();
 void handleWiFiScan();
 void handleWiFiSave();
 void handleWiFiStatus();
 void handleWiFiConfig();
 void handleProxyRequest();
 
+// Web API handlers (webapi.cpp), shared with the host build
+void sendJsonResponse(const String& status, const String& message, int code = -1);
+void handleGetStreams();
+void handlePostStreams();
+void handlePostStreamsBody(HTTPBodyStatus status, const uint8_t* data, size_t length);
+void handleSearchStreams();
+void handlePlayer();
+void handleMixer();
+void handleBatch();
+void handleExportConfig();
+void handleImportConfig();
+void handleImportConfigBody(HTTPBodyStatus status, const uint8_t* data, size_t length);
+void setupApiRoutes();
+
 // WebSocket handlers
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
 
@@ -126,7 +143,7 @@ void audio_id3data(const char *info);
 // Utility functions
 String generateStatusJSON(bool fullStatus = true);
 
-// JSON file helper functions
+// JSON file helper functions (storage.cpp)
 bool readJsonFile(const char* filename, size_t maxFileSize, DynamicJsonDocument& doc);
 bool writeJsonFile(const char* filename, DynamicJsonDocument& doc);
 
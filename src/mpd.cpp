@@ -21,6 +21,236 @@
 #include "mpd.h"
 #include "main.h"
 #include "player.h"
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+#include <assert.h>
+
+// lwIP never raises SIGPIPE and may not know the flag
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * @brief Get the send queue limit of a session
+ * @return config.mpd_queue, but at least MPD_MIN_QUEUE bytes
+ */
+static size_t queueLimit() {
+  return max((size_t)max(config.mpd_queue, 0), (size_t)MPD_MIN_QUEUE);
+}
+
+/**
+ * @brief MPD idle subsystems
+ * @details Maps the subsystem names of the idle command to player events.
+ * Subsystems the player never reports are accepted with no event, so waiting
+ * on them only ends with noidle, as on a real MPD with nothing to report.
+ */
+static const struct {
+  const char* name;
+  uint8_t event;
+} idleSubsystems[] = {
+  {"database", 0},
+  {"update", 0},
+  {"stored_playlist", 0},
+  {"playlist", PLAYER_EVENT_PLAYLIST},
+  {"player", PLAYER_EVENT_PLAYER},
+  {"mixer", PLAYER_EVENT_MIXER},
+  {"output", PLAYER_EVENT_OUTPUT},
+  {"options", 0},
+  {"partition", 0},
+  {"sticker", 0},
+  {"subscription", 0},
+  {"message", 0},
+  {"neighbor", 0},
+  {"mount", 0}
+};
+
+/**
+ * @brief Append one byte to the response
+ * @param c Byte to append
+ * @return Number of bytes written
+ */
+size_t MPDResponseWriter::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+/**
+ * @brief Append data to the response
+ * @details Data is copied into the buffer; a full buffer is sent to the
+ * client before more data is accepted, so responses of any size work.
+ * @param data Data to append
+ * @param size Number of bytes
+ * @return Number of bytes written
+ */
+size_t MPDResponseWriter::write(const uint8_t* data, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    if (length == sizeof(buffer)) {
+      flush();
+    }
+    size_t chunk = min(size - written, sizeof(buffer) - length);
+    memcpy(buffer + length, data + written, chunk);
+    length += chunk;
+    written += chunk;
+  }
+  return written;
+}
+
+/**
+ * @brief Format directly into the response buffer
+ * @details Formats into the free space of the buffer without temporary
+ * Strings. If the text does not fit, the buffer is sent and the text is
+ * formatted again into the empty buffer; only text longer than the whole
+ * buffer goes through a heap copy.
+ * @param format printf style format
+ * @return Number of characters written
+ */
+size_t MPDResponseWriter::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer + length, sizeof(buffer) - length, format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  if ((size_t)len < sizeof(buffer) - length) {
+    length += len;
+    return len;
+  }
+  // Did not fit, send what we have and try again
+  flush();
+  if ((size_t)len < sizeof(buffer)) {
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    length = len;
+    return len;
+  }
+  // Longer than the whole buffer
+  char* text = (char*)malloc(len + 1);
+  if (!text) {
+    return 0;
+  }
+  va_start(args, format);
+  vsnprintf(text, len + 1, format, args);
+  va_end(args);
+  size_t written = write((const uint8_t*)text, len);
+  free(text);
+  return written;
+}
+
+/**
+ * @brief Send the buffered data to the client, queueing what does not fit
+ * @details The socket gets as much as it takes without blocking, the rest is
+ * appended to the send queue. The buffer is emptied even if the client is
+ * gone or broken, the data has nowhere else to go.
+ */
+void MPDResponseWriter::flush() {
+  if (length == 0) {
+    return;
+  }
+  if (!broken && client.connected()) {
+    size_t sent = 0;
+    // Keep the order: queued data goes out first
+    if (queueLength == 0) {
+      sent = send((const uint8_t*)buffer, length);
+    }
+    if (sent < length) {
+      enqueue((const uint8_t*)buffer + sent, length - sent);
+    }
+  }
+  length = 0;
+}
+
+/**
+ * @brief Send queued data without blocking
+ * @return Number of bytes sent
+ */
+size_t MPDResponseWriter::drain() {
+  if (queueLength == 0 || broken) {
+    return 0;
+  }
+  size_t sent = send(queue, queueLength);
+  if (sent > 0) {
+    memmove(queue, queue + sent, queueLength - sent);
+    queueLength -= sent;
+  }
+  // Give the memory back once a burst is over
+  if (queueLength == 0) {
+    free(queue);
+    queue = nullptr;
+    queueCapacity = 0;
+  }
+  return sent;
+}
+
+/**
+ * @brief Drop the buffered and queued data without sending it
+ */
+void MPDResponseWriter::clear() {
+  length = 0;
+  free(queue);
+  queue = nullptr;
+  queueLength = 0;
+  queueCapacity = 0;
+  broken = false;
+}
+
+/**
+ * @brief Write to the socket without blocking
+ * @details WiFiClient::write() retries for seconds on a full send buffer;
+ * this goes to the socket directly and returns what it took. Errors other
+ * than a full buffer mark the connection broken.
+ * @param data Data to send
+ * @param size Number of bytes
+ * @return Number of bytes sent
+ */
+size_t MPDResponseWriter::send(const uint8_t* data, size_t size) {
+  int fd = client.fd();
+  if (fd < 0) {
+    broken = true;
+    return 0;
+  }
+  ssize_t sent = ::send(fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (sent < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      broken = true;
+    }
+    return 0;
+  }
+  return sent;
+}
+
+/**
+ * @brief Append data to the send queue
+ * @details The queue grows in 1 KB steps up to queueLimit(). Data that does
+ * not fit marks the connection broken, a partial response is useless.
+ * @param data Data to queue
+ * @param size Number of bytes
+ * @return true if the data was queued
+ */
+bool MPDResponseWriter::enqueue(const uint8_t* data, size_t size) {
+  size_t needed = queueLength + size;
+  if (needed > queueLimit()) {
+    broken = true;
+    return false;
+  }
+  if (needed > queueCapacity) {
+    size_t capacity = min((needed + 1023) & ~(size_t)1023, queueLimit());
+    uint8_t* grown = (uint8_t*)realloc(queue, capacity);
+    if (!grown) {
+      broken = true;
+      return false;
+    }
+    queue = grown;
+    queueCapacity = capacity;
+  }
+  memcpy(queue + queueLength, data, size);
+  queueLength += size;
+  return true;
+}
 
 /**
  * @brief Parse value from string, handling quotes
@@ -33,30 +263,117 @@
  * - Quote removal for both single and double quotes
  * - Safe integer conversion with fallback to 0 for invalid values
  * 
+ * The string is scanned in place, no temporary copies are made.
+ * 
  * @param valueStr The value string to parse
  * @return The parsed value as integer, or 0 if parsing fails
  */
-int parseValue(const String& valueStr) {
-  String cleanedStr = valueStr;
+int parseValue(const char* valueStr) {
+  if (!valueStr) {
+    return 0;
+  }
   // Remove whitespace
-  cleanedStr.trim();
-  // Remove quotes if present
-  if (cleanedStr.startsWith("\"") && cleanedStr.endsWith("\"") && cleanedStr.length() >= 2) {
-    cleanedStr = cleanedStr.substring(1, cleanedStr.length() - 1);
+  const char* start = valueStr;
+  while (isspace((unsigned char)*start)) {
+    start++;
   }
-  if (cleanedStr.startsWith("\'") && cleanedStr.endsWith("\'") && cleanedStr.length() >= 2) {
-    cleanedStr = cleanedStr.substring(1, cleanedStr.length() - 1);
+  const char* end = start + strlen(start);
+  while (end > start && isspace((unsigned char)end[-1])) {
+    end--;
+  }
+  // Remove quotes if present
+  if (end - start >= 2 && (*start == '"' || *start == '\'') && end[-1] == *start) {
+    start++;
+    end--;
   }
   // Validate that string contains only digits (and optional minus sign)
-  for (int i = 0; i < cleanedStr.length(); i++) {
-    if ((i == 0 && cleanedStr[i] == '-') || isDigit(cleanedStr[i])) {
+  if (start == end) {
+    return 0;
+  }
+  for (const char* p = start; p < end; p++) {
+    if ((p == start && *p == '-') || isDigit(*p)) {
       continue;
     } else {
       return 0; // Return 0 for invalid input
     }
   }
   // Convert to integer
-  return cleanedStr.toInt();
+  return (int)strtol(start, nullptr, 10);
+}
+
+/**
+ * @brief Extract the next argument of an MPD command
+ * @details Arguments are separated by whitespace and may be double quoted,
+ * in which case backslash escapes the next character. The unquoted argument
+ * is copied into the given buffer.
+ * @param args Remaining command arguments
+ * @param buffer Buffer for the argument
+ * @param size Buffer size
+ * @return Pointer after the argument, or nullptr if there is no argument, it
+ * is malformed or it does not fit in the buffer
+ */
+const char* nextArgument(const char* args, char* buffer, size_t size) {
+  const char* p = args;
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  if (*p == '\0' || size == 0) {
+    return nullptr;
+  }
+  size_t len = 0;
+  bool quoted = (*p == '"');
+  if (quoted) {
+    p++;
+  }
+  while (*p != '\0' && (quoted ? *p != '"' : (*p != ' ' && *p != '\t'))) {
+    if (quoted && *p == '\\' && p[1] != '\0') {
+      p++;
+    }
+    if (len + 1 >= size) {
+      return nullptr;
+    }
+    buffer[len++] = *p++;
+  }
+  if (quoted) {
+    if (*p != '"') {
+      return nullptr;
+    }
+    p++;
+  }
+  buffer[len] = '\0';
+  return p;
+}
+
+/**
+ * @brief Parse a playlist position or range argument
+ * @details Accepts "POS", "START:END" and "START:", END being exclusive.
+ * A single position is the range POS:POS+1, a missing END is the playlist
+ * length. The range is not checked against the playlist.
+ * @param text Unquoted argument
+ * @param count Playlist length
+ * @param start First position of the range
+ * @param end Position after the last one of the range
+ * @return true if the argument is a valid range
+ */
+bool parseRange(const char* text, int count, int& start, int& end) {
+  if (!isDigit(*text)) {
+    return false;
+  }
+  char* next;
+  start = (int)strtol(text, &next, 10);
+  end = start + 1;
+  if (*next == ':') {
+    text = next + 1;
+    if (*text == '\0') {
+      end = count;
+      next = (char*)text;
+    } else if (isDigit(*text)) {
+      end = (int)strtol(text, &next, 10);
+    } else {
+      return false;
+    }
+  }
+  return *next == '\0' && end >= start;
 }
 
 /**
@@ -76,9 +393,9 @@ int parseValue(const String& valueStr) {
  * 
  * @param args Command arguments (not used for stop command)
  */
-void MPDInterface::handleStopCommand(const String& args) {
+void MPDInterface::handleStopCommand(const char* args) {
   this->player.stopStream();
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -88,7 +405,7 @@ void MPDInterface::handleStopCommand(const String& args) {
  * MPD clients to stop monitoring for changes and resume normal operation.
  * 
  * The function implements MPD protocol compatibility by:
- * - Clearing the inIdleMode flag to disable idle processing
+ * - Clearing the session->inIdleMode flag to disable idle processing
  * - Returning standard OK response to acknowledge command
  * - Resuming normal command processing on next handleClient() call
  * 
@@ -98,29 +415,27 @@ void MPDInterface::handleStopCommand(const String& args) {
  * 
  * @param args Command arguments (not used for noidle command)
  */
-void MPDInterface::handleNoIdleCommand(const String& args) {
-  inIdleMode = false;
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleNoIdleCommand(const char* args) {
+  session->inIdleMode = false;
+  session->out.print(mpdResponseOK());
 }
 
 /**
  * @brief Handle the MPD plchanges command
  * @details This function processes the MPD "plchanges" command by returning
- * information about playlist entries that have changed since a specified
- * playlist version. In this implementation, it returns all playlist entries
- * since detailed change tracking is not implemented.
+ * the playlist entries that changed since the playlist version the client
+ * has, so clients polling or reconnecting only download what is new.
  * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning all playlist entries with full metadata
- * - Using standard response format for playlist changes
- * - Maintaining compatibility with MPD clients
+ * Every playlist change increments the playlist version (reported as
+ * "playlist" by status) and stamps the changed positions with it. Removing
+ * an entry stamps all entries after it, since their positions changed.
+ * Entries removed from the end are not listed, the client truncates its copy
+ * to the playlistlength reported by status.
  * 
- * Note: This implementation does not track detailed playlist changes since
- * the playlist is managed through the web interface. It simply returns
- * the entire playlist to maintain client compatibility.
+ * A version newer than the current one, such as one from before a reboot,
+ * cannot be compared, so the whole playlist is returned.
  * 
- * Response information for each playlist entry includes:
+ * Response information for each changed entry includes:
  * - File URI (stream URL)
  * - Track title (stream name)
  * - Artist name (WebRadio)
@@ -130,11 +445,79 @@ void MPDInterface::handleNoIdleCommand(const String& args) {
  * - Track number (1-based index)
  * - Last modified timestamp
  * 
- * @param args Command arguments (not used for plchanges command)
+ * @param args Playlist version and optional START:END range
  */
-void MPDInterface::handlePlChangesCommand(const String& args) {
-  sendPlaylistInfo(3);
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handlePlChangesCommand(const char* args) {
+  uint32_t version;
+  int start, end;
+  if (!parsePlChangesArgs("plchanges", args, version, start, end)) {
+    return;
+  }
+  for (int i = start; i < end; i++) {
+    if (this->player.getPlaylistItemVersion(i) > version) {
+      sendPlaylistItem(i, 3);
+    }
+  }
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Handle the MPD plchangesposid command
+ * @details Same selection as plchanges, but only the position and ID of
+ * each changed entry are returned, as "cpos" and "Id" pairs. Clients use it
+ * to refresh their copy of the playlist without the metadata.
+ * @param args Playlist version and optional START:END range
+ */
+void MPDInterface::handlePlChangesPosIdCommand(const char* args) {
+  uint32_t version;
+  int start, end;
+  if (!parsePlChangesArgs("plchangesposid", args, version, start, end)) {
+    return;
+  }
+  for (int i = start; i < end; i++) {
+    if (this->player.getPlaylistItemVersion(i) > version) {
+      session->out.printf("cpos: %d\nId: %d\n", i, i);
+    }
+  }
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Parse the plchanges/plchangesposid arguments
+ * @details Accepts "VERSION" or "VERSION START:END", with each argument
+ * optionally quoted. A missing END means the end of the playlist, and the
+ * range is clamped to the playlist length.
+ * @param command Command name, used in the error response
+ * @param args Command arguments
+ * @param version Parsed client playlist version
+ * @param start First position to report
+ * @param end Position after the last one to report
+ * @return true if the arguments are valid
+ */
+bool MPDInterface::parsePlChangesArgs(const char* command, const char* args, uint32_t& version, int& start, int& end) {
+  int count = this->player.getPlaylistCount();
+  char arg[24];
+  const char* next = nextArgument(args, arg, sizeof(arg));
+  char* last;
+  unsigned long value = next && isDigit(arg[0]) ? strtoul(arg, &last, 10) : 0;
+  if (!next || !isDigit(arg[0]) || *last != '\0') {
+    session->out.print(mpdResponseError(command, "Need a playlist version"));
+    return false;
+  }
+  // A version from the future cannot be compared, send everything
+  version = (value > this->player.getPlaylistVersion()) ? 0 : (uint32_t)value;
+  start = 0;
+  end = count;
+  // Optional START:END range
+  if (nextArgument(next, arg, sizeof(arg))) {
+    if (!parseRange(arg, count, start, end)) {
+      session->out.print(mpdResponseError(command, "Invalid range"));
+      return false;
+    }
+    start = min(start, count);
+    end = min(end, count);
+  }
+  return true;
 }
 
 /**
@@ -155,8 +538,8 @@ void MPDInterface::handlePlChangesCommand(const String& args) {
  * 
  * @param args Command arguments (not used for seekid command)
  */
-void MPDInterface::handleSeekIdCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleSeekIdCommand(const char* args) {
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -177,8 +560,8 @@ void MPDInterface::handleSeekIdCommand(const String& args) {
  * 
  * @param args Command arguments (not used for seek command)
  */
-void MPDInterface::handleSeekCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleSeekCommand(const char* args) {
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -195,18 +578,18 @@ void MPDInterface::handleSeekCommand(const String& args) {
  * Search behavior:
  * - Case-insensitive matching
  * - Exact string matching (equals)
- * - Supports title searches
+ * - Supports title, file, any, artist and album searches
  * - Returns file URI, title, track number, and last modified for matches
  * 
- * Special handling:
- * - Artist/album searches return all playlist entries
- * - Empty searches handled by existing search function
+ * Filter expressions such as "(Title contains 'x')" are supported too,
+ * see handleMPDSearchCommand().
  * 
  * @param args Command arguments (search criteria)
  */
-void MPDInterface::handleFindCommand(const String& args) {
-  handleMPDSearchCommand(args, true);
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleFindCommand(const char* args) {
+  if (handleMPDSearchCommand(args, true)) {
+    session->out.print(mpdResponseOK());
+  }
 }
 
 /**
@@ -223,18 +606,18 @@ void MPDInterface::handleFindCommand(const String& args) {
  * Search behavior:
  * - Case-insensitive matching
  * - Partial string matching (contains)
- * - Supports title searches
+ * - Supports title, file, any, artist and album searches
  * - Returns file URI, title, track number, and last modified for matches
  * 
- * Special handling:
- * - Artist/album searches return all playlist entries
- * - Empty searches handled by existing search function
+ * Filter expressions such as "(Title contains 'x')" are supported too,
+ * see handleMPDSearchCommand().
  * 
  * @param args Command arguments (search criteria)
  */
-void MPDInterface::handleSearchCommand(const String& args) {
-  handleMPDSearchCommand(args, false);
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleSearchCommand(const char* args) {
+  if (handleMPDSearchCommand(args, false)) {
+    session->out.print(mpdResponseOK());
+  }
 }
 
 /**
@@ -263,40 +646,40 @@ void MPDInterface::handleSearchCommand(const String& args) {
  * 
  * @param args Command arguments (tag type to list)
  */
-void MPDInterface::handleListCommand(const String& args) {
+void MPDInterface::handleListCommand(const char* args) {
   // Validate arguments length
-  if (args.length() > 20) { // Reasonable limit for tag type
-    mpdClient.print(mpdResponseError("list", "Tag type too long"));
+  if (strlen(args) > 20) { // Reasonable limit for tag type
+    session->out.print(mpdResponseError("list", "Tag type too long"));
     return;
   }
   // Parse tag type
-  if (args.length() > 0) {
+  if (strlen(args) > 0) {
     String tagType = args;
     tagType.toLowerCase();
     tagType.trim();
     // Validate supported tag types
     if (!tagType.startsWith("artist") && !tagType.startsWith("album") && !tagType.startsWith("title")) {
-      mpdClient.print(mpdResponseError("list", "Unsupported tag type"));
+      session->out.print(mpdResponseError("list", "Unsupported tag type"));
       return;
     }
     // Return values based on tag type
     if (tagType.startsWith("artist")) {
       // Return dummy artist
-      mpdClient.print("Artist: WebRadio\n");
+      session->out.print("Artist: WebRadio\n");
     } else if (tagType.startsWith("album")) {
       // Return dummy album
-      mpdClient.print("Album: WebRadio\n");
+      session->out.print("Album: WebRadio\n");
     } else if (tagType.startsWith("title")) {
       // Return the playlist
       for (int i = 0; i < this->player.getPlaylistCount(); i++) {
-        mpdClient.print("Title: " + String(this->player.getPlaylistItem(i).name) + "\n");
+        session->out.printf("Title: %s\n", this->player.getPlaylistItem(i).name);
       }
     }
   } else {
-    mpdClient.print(mpdResponseError("list", "Missing tag type"));
+    session->out.print(mpdResponseError("list", "Missing tag type"));
     return;
   }
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -319,10 +702,10 @@ void MPDInterface::handleListCommand(const String& args) {
  * 
  * @param args Command arguments (not used for listplaylists command)
  */
-void MPDInterface::handleListPlaylistsCommand(const String& args) {
-  mpdClient.print("playlist: WebRadio\n");
-  mpdClient.print("Last-Modified: " + String(BUILD_TIME) + "\n");
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleListPlaylistsCommand(const char* args) {
+  session->out.print("playlist: WebRadio\n");
+  session->out.printf("Last-Modified: %s\n", BUILD_TIME);
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -346,9 +729,9 @@ void MPDInterface::handleListPlaylistsCommand(const String& args) {
  * 
  * @param args Command arguments (not used for listplaylistinfo command)
  */
-void MPDInterface::handleListPlaylistInfoCommand(const String& args) {
+void MPDInterface::handleListPlaylistInfoCommand(const char* args) {
   sendPlaylistInfo(0); // Minimal detail
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -373,9 +756,9 @@ void MPDInterface::handleListPlaylistInfoCommand(const String& args) {
  * 
  * @param args Command arguments (not used for listallinfo command)
  */
-void MPDInterface::handleListAllInfoCommand(const String& args) {
+void MPDInterface::handleListAllInfoCommand(const char* args) {
   sendPlaylistInfo(1); // Simple detail
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -396,9 +779,9 @@ void MPDInterface::handleListAllInfoCommand(const String& args) {
  * 
  * @param args Command arguments (not used for update command)
  */
-void MPDInterface::handleUpdateCommand(const String& args) {
-  mpdClient.print("updating_db: 1\n");
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleUpdateCommand(const char* args) {
+  session->out.print("updating_db: 1\n");
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -417,8 +800,8 @@ void MPDInterface::handleUpdateCommand(const String& args) {
  * 
  * @param args Command arguments (not used for password command)
  */
-void MPDInterface::handlePasswordCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handlePasswordCommand(const char* args) {
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -437,8 +820,8 @@ void MPDInterface::handlePasswordCommand(const String& args) {
  * 
  * @param args Command arguments (not used for ping command)
  */
-void MPDInterface::handlePingCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handlePingCommand(const char* args) {
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -465,12 +848,20 @@ void MPDInterface::handlePingCommand(const String& args) {
  * Statistics tracking:
  * - Uptime calculated from system start
  * - Play time includes both historical and current playback
- * - Media counts reflect current playlist state
+ * - Media counts reflect current playlist state, streams carry no artist tag
  * - Database timestamp uses build time
  * 
+ * The audio pipeline is reported after the standard fields, with names MPD
+ * does not use so clients skip them: the codec and format of the current
+ * stream, the bytes received as estimated from the bitrate (the decoder
+ * does not count them, so a stalled connection still adds to it), the
+ * decode errors, buffer underruns and reconnects counted since boot, the
+ * input buffer levels and the heap. Stalls show in buffer_underruns and
+ * buffer_filled.
+ * 
  * @param args Command arguments (not used for stats command)
  */
-void MPDInterface::handleStatsCommand(const String& args) {
+void MPDInterface::handleStatsCommand(const char* args) {
   // Calculate uptime and playtime
   unsigned long uptime = (millis() / 1000);
   unsigned long playtime = this->player.getTotalPlayTime();
@@ -478,14 +869,29 @@ void MPDInterface::handleStatsCommand(const String& args) {
     playtime += (millis() / 1000) - this->player.getPlayStartTime();
   }
   // Send stats information
-  mpdClient.print("artists: 1\n");
-  mpdClient.print("albums: 1\n");
-  mpdClient.print("songs: " + String(this->player.getPlaylistCount()) + "\n");
-  mpdClient.print("uptime: " + String(uptime) + "\n");
-  mpdClient.print("playtime: " + String(playtime) + "\n");
-  mpdClient.print("db_playtime: " + String(playtime) + "\n");
-  mpdClient.print("db_update: 0\n");
-  mpdClient.print(mpdResponseOK());
+  session->out.print("artists: 0\n");
+  session->out.print("albums: 1\n");
+  session->out.printf("songs: %d\n", this->player.getPlaylistCount());
+  session->out.printf("uptime: %lu\n", uptime);
+  session->out.printf("playtime: %lu\n", playtime);
+  session->out.printf("db_playtime: %lu\n", playtime);
+  session->out.print("db_update: 0\n");
+  // Audio pipeline
+  const AudioStats& stats = this->player.getAudioStats();
+  if (this->player.isPlaying() && stats.sampleRate > 0) {
+    session->out.printf("audio_codec: %s\n", stats.codec);
+    session->out.printf("audio_format: %lu:%u:%u\n", (unsigned long)stats.sampleRate,
+                        stats.bitsPerSample, stats.channels);
+  }
+  session->out.printf("stream_bytes_estimated: %llu\n", (unsigned long long)stats.streamBytesEstimated);
+  session->out.printf("decode_errors: %lu\n", (unsigned long)stats.decodeErrors);
+  session->out.printf("buffer_underruns: %lu\n", (unsigned long)stats.underruns);
+  session->out.printf("reconnects: %lu\n", (unsigned long)stats.reconnects);
+  session->out.printf("buffer_filled: %lu\n", (unsigned long)stats.bufferFilled);
+  session->out.printf("buffer_free: %lu\n", (unsigned long)stats.bufferFree);
+  session->out.printf("free_heap: %lu\n", (unsigned long)ESP.getFreeHeap());
+  session->out.printf("min_free_heap: %lu\n", (unsigned long)ESP.getMinFreeHeap());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -506,8 +912,8 @@ void MPDInterface::handleStatsCommand(const String& args) {
  * 
  * @param args Command arguments (not used for notcommands command)
  */
-void MPDInterface::handleNotCommandsCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleNotCommandsCommand(const char* args) {
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -531,14 +937,11 @@ void MPDInterface::handleNotCommandsCommand(const String& args) {
  * 
  * @param args Command arguments (not used for commands command)
  */
-void MPDInterface::handleCommandsCommand(const String& args) {
+void MPDInterface::handleCommandsCommand(const char* args) {
   for (const auto& cmd : supportedCommands) {
-    mpdClient.print("command: ");
-    mpdClient.print(cmd.c_str());
-    mpdClient.print("\n");
-    yield();
+    session->out.printf("command: %s\n", cmd.c_str());
   }
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -555,125 +958,371 @@ void MPDInterface::handleCommandsCommand(const String& args) {
  * Response information includes:
  * - Output ID (0 for I2S output)
  * - Output name (I2S (External DAC))
- * - Enabled status (1 for enabled)
+ * - Output plugin (i2s)
+ * - Enabled status, as set by enableoutput and disableoutput
  * 
  * This command allows MPD clients to understand the available audio
  * output options and their current status.
  * 
  * @param args Command arguments (not used for outputs command)
  */
-void MPDInterface::handleOutputsCommand(const String& args) {
-  mpdClient.print("outputid: 0\n");
-  mpdClient.print("outputname: I2S (External DAC)\n");
-  mpdClient.print("outputenabled: 1\n");
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleOutputsCommand(const char* args) {
+  session->out.print("outputid: 0\n");
+  session->out.print("outputname: I2S (External DAC)\n");
+  session->out.print("plugin: i2s\n");
+  session->out.printf("outputenabled: %d\n", this->player.isOutputEnabled() ? 1 : 0);
+  session->out.print(mpdResponseOK());
 }
 
 /**
  * @brief Handle the MPD save command
- * @details This function processes the MPD "save" command which would normally
- * save the current playlist. In this implementation, the command is acknowledged
- * but has no effect since playlist management is handled through the web interface.
- * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning standard OK response
- * - Maintaining compatibility with MPD clients
+ * @details This function processes the MPD "save" command by writing the
+ * current playlist to SPIFFS. The radio has a single stored playlist, the
+ * one listplaylists reports as "WebRadio", so that is the only name accepted.
  * 
- * Note: This implementation does not actually save playlists since
- * playlist management is performed through the web interface. The command
- * is simply acknowledged to maintain client compatibility.
+ * Inside a command list the write is deferred to command_list_end, together
+ * with the other playlist changes of the list.
  * 
- * @param args Command arguments (not used for save command)
+ * @param args Optional playlist name
  */
-void MPDInterface::handleSaveCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleSaveCommand(const char* args) {
+  char name[STREAM_NAME_SIZE];
+  if (nextArgument(args, name, sizeof(name)) && strcmp(name, "WebRadio") != 0) {
+    session->out.print(mpdResponseError("save", "Only the WebRadio playlist can be stored"));
+    return;
+  }
+  playlistChanged();
+  session->out.print(mpdResponseOK());
 }
 
 /**
  * @brief Handle the MPD load command
- * @details This function processes the MPD "load" command which would normally
- * load a stored playlist. In this implementation, the command is acknowledged
- * but has no effect since playlist management is handled through the web interface.
- * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning standard OK response
- * - Maintaining compatibility with MPD clients
+ * @details This function processes the MPD "load" command by reloading the
+ * playlist from SPIFFS, dropping any change that was not saved yet. Only
+ * the "WebRadio" stored playlist exists.
  * 
- * Note: This implementation does not actually load playlists since
- * playlist management is performed through the web interface. The command
- * is simply acknowledged to maintain client compatibility.
- * 
- * @param args Command arguments (not used for load command)
+ * @param args Optional playlist name
  */
-void MPDInterface::handleLoadCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleLoadCommand(const char* args) {
+  char name[STREAM_NAME_SIZE];
+  if (nextArgument(args, name, sizeof(name)) && strcmp(name, "WebRadio") != 0) {
+    session->out.print(mpdResponseError("load", "No such playlist"));
+    return;
+  }
+  this->player.loadPlaylist();
+  this->player.getPlaylist()->validate();
+  // The playlist now matches what is stored
+  session->playlistDirty = false;
+  session->out.print(mpdResponseOK());
 }
 
 /**
  * @brief Handle the MPD delete command
- * @details This function processes the MPD "delete" command which would normally
- * remove a stream from the current playlist. In this implementation, the command
- * is acknowledged but has no effect since playlist management is handled through
- * the web interface.
+ * @details This function processes the MPD "delete" command by removing the
+ * stream at a position, or all streams of a START:END range, from the
+ * playlist. The following streams move up and the current selection keeps
+ * pointing to the same stream.
  * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning standard OK response
- * - Maintaining compatibility with MPD clients
+ * The playlist is saved to SPIFFS right away, or at command_list_end when
+ * the command is part of a command list.
  * 
- * Note: This implementation does not actually delete streams from the playlist since
- * playlist management is performed through the web interface. The command
- * is simply acknowledged to maintain client compatibility.
+ * Error handling:
+ * - Returns ACK error for a missing or malformed position
+ * - Returns ACK error for positions outside the playlist
  * 
- * @param args Command arguments (not used for delete command)
+ * @param args Position or START:END range
  */
-void MPDInterface::handleDeleteCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleDeleteCommand(const char* args) {
+  removeStreams("delete", args);
+}
+
+/**
+ * @brief Handle the MPD deleteid command
+ * @details Same as delete with a single position, since stream IDs are
+ * their playlist positions.
+ * @param args Stream ID
+ */
+void MPDInterface::handleDeleteIdCommand(const char* args) {
+  char arg[16];
+  if (!nextArgument(args, arg, sizeof(arg)) || strchr(arg, ':')) {
+    session->out.print(mpdResponseError("deleteid", "Missing or invalid ID argument"));
+    return;
+  }
+  removeStreams("deleteid", args);
+}
+
+/**
+ * @brief Remove a position or range of streams from the playlist
+ * @param command Command name, used in the responses
+ * @param args Position or START:END range
+ */
+void MPDInterface::removeStreams(const char* command, const char* args) {
+  char arg[24];
+  int count = this->player.getPlaylistCount();
+  int start, end;
+  if (!nextArgument(args, arg, sizeof(arg)) || !parseRange(arg, count, start, end)) {
+    session->out.print(mpdResponseError(command, "Missing or invalid position argument"));
+    return;
+  }
+  if (start >= count || end > count) {
+    session->out.print(mpdResponseError(command, "Position out of range"));
+    return;
+  }
+  for (int i = start; i < end; i++) {
+    this->player.removePlaylistItem(start);
+  }
+  playlistChanged();
+  session->out.print(mpdResponseOK());
 }
 
 /**
  * @brief Handle the MPD add command
- * @details This function processes the MPD "add" command which would normally
- * add a stream to the current playlist. In this implementation, the command is
- * acknowledged but has no effect since playlist management is handled through
- * the web interface.
+ * @details This function processes the MPD "add" command by appending a
+ * stream URL to the playlist, or inserting it at the given position. The
+ * URL is also used as the stream name, it can be renamed from the web
+ * interface.
  * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning standard OK response
- * - Maintaining compatibility with MPD clients
+ * The playlist is saved to SPIFFS right away, or at command_list_end when
+ * the command is part of a command list.
  * 
- * Note: This implementation does not actually add streams to the playlist since
- * playlist management is performed through the web interface. The command
- * is simply acknowledged to maintain client compatibility.
+ * Error handling:
+ * - Returns ACK error for a missing URI or one that is not http(s)
+ * - Returns ACK error when the playlist is full
+ * - Returns ACK error for positions past the end of the playlist
  * 
- * @param args Command arguments (not used for add command)
+ * @param args Stream URL and optional position
  */
-void MPDInterface::handleAddCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleAddCommand(const char* args) {
+  addStream("add", args, false);
 }
 
 /**
- * @brief Handle the MPD clear command
- * @details This function processes the MPD "clear" command which would normally
- * clear the current playlist. In this implementation, the command is acknowledged
- * but has no effect since playlist management is handled through the web interface.
+ * @brief Handle the MPD addid command
+ * @details Same as add, and reports the ID of the new stream, which is its
+ * playlist position.
+ * @param args Stream URL and optional position
+ */
+void MPDInterface::handleAddIdCommand(const char* args) {
+  addStream("addid", args, true);
+}
+
+/**
+ * @brief Add a stream to the playlist
+ * @param command Command name, used in the responses
+ * @param args Stream URL and optional position
+ * @param reportId Send the "Id" of the new stream
+ */
+void MPDInterface::addStream(const char* command, const char* args, bool reportId) {
+  char url[STREAM_URL_SIZE];
+  const char* next = nextArgument(args, url, sizeof(url));
+  if (!next) {
+    session->out.print(mpdResponseError(command, "Missing or invalid URI argument"));
+    return;
+  }
+  if (!VALIDATE_URL(url)) {
+    session->out.print(mpdResponseError(command, "Unsupported URI scheme"));
+    return;
+  }
+  int count = this->player.getPlaylistCount();
+  if (count >= MAX_PLAYLIST_SIZE) {
+    session->out.print(mpdResponseError(command, "Playlist is full"));
+    return;
+  }
+  // Optional position, append by default
+  int position = count;
+  char arg[16];
+  if (nextArgument(next, arg, sizeof(arg))) {
+    int end;
+    if (!parseRange(arg, count, position, end) || end != position + 1) {
+      session->out.print(mpdResponseError(command, "Invalid position argument"));
+      return;
+    }
+    if (position > count) {
+      session->out.print(mpdResponseError(command, "Position out of range"));
+      return;
+    }
+  }
+  this->player.addPlaylistItem(url, url);
+  if (position < count) {
+    this->player.movePlaylistItems(count, count + 1, position);
+  }
+  playlistChanged();
+  if (reportId) {
+    session->out.printf("Id: %d\n", position);
+  }
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Handle the MPD move command
+ * @details This function processes the MPD "move" command by moving the
+ * stream at a position, or the streams of a START:END range, so that the
+ * first of them ends up at the target position. The current selection keeps
+ * pointing to the same stream.
  * 
- * The function implements MPD protocol compatibility by:
- * - Accepting the command without error
- * - Returning standard OK response
- * - Maintaining compatibility with MPD clients
+ * The playlist is saved to SPIFFS right away, or at command_list_end when
+ * the command is part of a command list.
+ * 
+ * @param args Position or START:END range, and the target position
+ */
+void MPDInterface::handleMoveCommand(const char* args) {
+  char arg[24];
+  int count = this->player.getPlaylistCount();
+  int start, end, to, toEnd;
+  const char* next = nextArgument(args, arg, sizeof(arg));
+  if (!next || !parseRange(arg, count, start, end) ||
+      !nextArgument(next, arg, sizeof(arg)) || !parseRange(arg, count, to, toEnd) || toEnd != to + 1) {
+    session->out.print(mpdResponseError("move", "Missing or invalid position argument"));
+    return;
+  }
+  if (start >= count || end > count || to + (end - start) > count) {
+    session->out.print(mpdResponseError("move", "Position out of range"));
+    return;
+  }
+  if (to != start) {
+    this->player.movePlaylistItems(start, end, to);
+    playlistChanged();
+  }
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Handle the MPD clear command
+ * @details This function processes the MPD "clear" command by removing all
+ * streams from the playlist. Playback is not stopped, the current stream
+ * keeps playing until another one is selected.
  * 
- * Note: This implementation does not actually clear the playlist since
- * playlist management is performed through the web interface. The command
- * is simply acknowledged to maintain client compatibility.
+ * The playlist is saved to SPIFFS right away, or at command_list_end when
+ * the command is part of a command list.
  * 
  * @param args Command arguments (not used for clear command)
  */
-void MPDInterface::handleClearCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleClearCommand(const char* args) {
+  this->player.clearPlaylist();
+  playlistChanged();
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Handle the MPD albumart command
+ * @details This function processes the MPD "albumart" command by sending a
+ * chunk of the logo or cover image of a stream, starting at the given byte
+ * offset. Chunks are at most the session binary limit long; clients repeat
+ * the command with increasing offsets until they have "size" bytes.
+ * 
+ * Images come from the station art cache. When the art of the playing
+ * stream is not cached yet, its fetch is scheduled and the client gets
+ * "No file exists", like MPD does for songs without cover files.
+ * 
+ * @param args Stream URI and byte offset
+ */
+void MPDInterface::handleAlbumArtCommand(const char* args) {
+  sendArt("albumart", args, false);
+}
+
+/**
+ * @brief Handle the MPD readpicture command
+ * @details Same as albumart, also sending the MIME type of the image. A
+ * stream without art gets an empty OK response, as MPD sends for songs
+ * without embedded pictures.
+ * @param args Stream URI and byte offset
+ */
+void MPDInterface::handleReadPictureCommand(const char* args) {
+  sendArt("readpicture", args, true);
+}
+
+/**
+ * @brief Send one chunk of the art of a stream
+ * @param command Command name, used in the responses
+ * @param args Stream URI and byte offset
+ * @param withType Send the MIME type, as readpicture does
+ */
+void MPDInterface::sendArt(const char* command, const char* args, bool withType) {
+  char uri[STREAM_URL_SIZE];
+  char arg[16];
+  const char* next = nextArgument(args, uri, sizeof(uri));
+  if (!next) {
+    session->out.print(mpdResponseError(command, "Missing URI argument"));
+    return;
+  }
+  // Offset, defaults to the start of the image
+  unsigned long offset = 0;
+  if (nextArgument(next, arg, sizeof(arg))) {
+    char* end;
+    offset = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0') {
+      session->out.print(mpdResponseError(command, "Invalid offset argument"));
+      return;
+    }
+  }
+  size_t size;
+  const uint8_t* data = this->artCache.acquire(uri, size);
+  if (!data) {
+    // Fetch the art of the playing stream for the next time
+    if (strcmp(uri, this->player.getStreamUrl()) == 0 && this->player.getStreamIconUrl()[0] != '\0') {
+      this->artCache.request(uri, this->player.getStreamIconUrl());
+    }
+    if (withType) {
+      session->out.print(mpdResponseOK());
+    } else {
+      session->out.print(mpdResponseError(command, "No file exists"));
+    }
+    return;
+  }
+  if (offset > size) {
+    this->artCache.release();
+    session->out.print(mpdResponseError(command, "Offset out of range"));
+    return;
+  }
+  // Keep the chunk well inside the send queue, even for a stalled socket
+  size_t chunk = min(size - offset, min(session->binaryLimit, queueLimit() / 2));
+  session->out.printf("size: %u\n", (unsigned)size);
+  if (withType) {
+    session->out.printf("type: %s\n", ArtCache::mimeType(data, size));
+  }
+  session->out.printf("binary: %u\n", (unsigned)chunk);
+  session->out.write(data + offset, chunk);
+  this->artCache.release();
+  session->out.print("\n");
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Handle the MPD binarylimit command
+ * @details Sets the largest chunk the session gets from albumart and
+ * readpicture. Larger chunks mean fewer round trips for big images.
+ * @param args Limit in bytes, at least 64
+ */
+void MPDInterface::handleBinaryLimitCommand(const char* args) {
+  char arg[16];
+  char* end;
+  unsigned long limit = 0;
+  if (nextArgument(args, arg, sizeof(arg))) {
+    limit = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0') {
+      limit = 0;
+    }
+  }
+  if (limit < 64) {
+    session->out.print(mpdResponseError("binarylimit", "Missing or invalid limit argument"));
+    return;
+  }
+  session->binaryLimit = limit;
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Persist a playlist change made by an MPD command
+ * @details Saves the playlist right away, unless the command is part of a
+ * command list: then all changes of the list are saved once, at
+ * command_list_end, so a script reshaping the playlist costs one flash write.
+ */
+void MPDInterface::playlistChanged() {
+  if (session->inCommandList) {
+    session->playlistDirty = true;
+  } else {
+    this->player.savePlaylist();
+  }
 }
 
 /**
@@ -696,10 +1345,10 @@ void MPDInterface::handleClearCommand(const String& args) {
  * 
  * @param args Command arguments (not used for getvol command)
  */
-void MPDInterface::handleGetVolCommand(const String& args) {
+void MPDInterface::handleGetVolCommand(const char* args) {
   int volPercent = map(this->player.getVolume(), 0, 22, 0, 100);
-  mpdClient.print("volume: " + String(volPercent) + "\n");
-  mpdClient.print(mpdResponseOK());
+  session->out.printf("volume: %d\n", volPercent);
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -724,9 +1373,9 @@ void MPDInterface::handleGetVolCommand(const String& args) {
  * 
  * @param args Command arguments (not used for lsinfo command)
  */
-void MPDInterface::handleLsInfoCommand(const String& args) {
+void MPDInterface::handleLsInfoCommand(const char* args) {
   sendPlaylistInfo(1); // Simple detail
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -755,13 +1404,13 @@ void MPDInterface::handleLsInfoCommand(const String& args) {
  * 
  * @param args Command arguments (optional playlist ID)
  */
-void MPDInterface::handlePlaylistIdCommand(const String& args) {
+void MPDInterface::handlePlaylistIdCommand(const char* args) {
   int id = -1;
-  if (args.length() > 0) {
+  if (strlen(args) > 0) {
     id = parseValue(args);
     // Validate ID range
     if (id < 0 || id >= this->player.getPlaylistCount()) {
-      mpdClient.print(mpdResponseError("playlistid", "Invalid playlist ID"));
+      session->out.print(mpdResponseError("playlistid", "Invalid playlist ID"));
       return;
     }
   }
@@ -769,17 +1418,17 @@ void MPDInterface::handlePlaylistIdCommand(const String& args) {
   if (id >= 0 && id < this->player.getPlaylistCount()) {
     // Return specific entry
     const StreamInfo& item = this->player.getPlaylistItem(id);
-    mpdClient.print("file: " + String(item.url) + "\n");
-    mpdClient.print("Title: " + String(item.name) + "\n");
-    mpdClient.print("Artist: WebRadio\n");
-    mpdClient.print("Album: WebRadio\n");
-    mpdClient.print("Id: " + String(id) + "\n");
-    mpdClient.print("Pos: " + String(id) + "\n");
+    session->out.printf("file: %s\n", item.url);
+    session->out.printf("Title: %s\n", item.name);
+    session->out.print("Artist: WebRadio\n");
+    session->out.print("Album: WebRadio\n");
+    session->out.printf("Id: %d\n", id);
+    session->out.printf("Pos: %d\n", id);
   } else {
     // Return all if no specific ID
     sendPlaylistInfo(3);
   }
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -804,9 +1453,9 @@ void MPDInterface::handlePlaylistIdCommand(const String& args) {
  * 
  * @param args Command arguments (not used for playlistinfo command)
  */
-void MPDInterface::handlePlaylistInfoCommand(const String& args) {
+void MPDInterface::handlePlaylistInfoCommand(const char* args) {
   sendPlaylistInfo(3);
-  mpdClient.print(mpdResponseOK());
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -836,33 +1485,10 @@ void MPDInterface::handlePlaylistInfoCommand(const String& args) {
  * 
  * @param args Command arguments (not used for currentsong command)
  */
-void MPDInterface::handleCurrentSongCommand(const String& args) {
-  if (this->player.isPlaying() && strlen(this->player.getStreamName()) > 0) {
-    mpdClient.print("file: " + String(this->player.getStreamUrl()) + "\n");
-    if (strlen(this->player.getStreamTitle()) > 0) {
-      String streamTitleStr = String(this->player.getStreamTitle());
-      // Check if stream title contains " - " separator for artist/track parsing
-      int separatorPos = streamTitleStr.indexOf(" - ");
-      if (separatorPos != -1) {
-        // Split into artist and track using the " - " separator
-        String artist = streamTitleStr.substring(0, separatorPos);
-        String title = streamTitleStr.substring(separatorPos + 3); // Skip " - "
-        mpdClient.print("Artist: " + artist + "\n");
-        mpdClient.print("Title: " + title + "\n");
-      } else {
-        // No separator, use full title as track name
-        mpdClient.print("Title: " + streamTitleStr + "\n");
-      }
-    } else {
-      // No stream title, use stream name as fallback
-      mpdClient.print("Title: " + String(this->player.getStreamName()) + "\n");
-    }
-    mpdClient.print("Album: WebRadio\n");
-    mpdClient.print("Id: " + String(this->player.getPlaylistIndex()) + "\n");
-    mpdClient.print("Pos: " + String(this->player.getPlaylistIndex()) + "\n");
-    mpdClient.print("Track: " + String(this->player.getPlaylistIndex() + 1) + "\n");
-  }
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleCurrentSongCommand(const char* args) {
+  refreshResponseCache();
+  session->out.write((const uint8_t*)responseCache.currentSong, responseCache.currentSongLength);
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -891,37 +1517,131 @@ void MPDInterface::handleCurrentSongCommand(const String& args) {
  * 
  * @param args Command arguments (not used for status command)
  */
-void MPDInterface::handleStatusCommand(const String& args) {
+void MPDInterface::handleStatusCommand(const char* args) {
+  refreshResponseCache();
+  const ResponseCache& c = responseCache;
+  if (c.elapsedOffset == 0) {
+    session->out.write((const uint8_t*)c.status, c.statusLength);
+  } else {
+    // Only the elapsed time changes between two player changes
+    unsigned long elapsed = 0;
+    if (this->player.getPlayStartTime() > 0) {
+      elapsed = (millis() / 1000) - this->player.getPlayStartTime();
+    }
+    session->out.write((const uint8_t*)c.status, c.elapsedOffset);
+    session->out.printf("elapsed: %lu.000\n", elapsed);
+    session->out.write((const uint8_t*)c.status + c.elapsedOffset, c.statusLength - c.elapsedOffset);
+  }
+  session->out.print(mpdResponseOK());
+}
+
+/**
+ * @brief Append formatted text to a fixed buffer
+ * @details Text that does not fit is cut, the length never passes the end.
+ * @param buffer Destination buffer
+ * @param size Buffer size
+ * @param length Length of the text in the buffer, updated
+ * @param format printf style format
+ */
+static void appendf(char* buffer, size_t size, size_t& length, const char* format, ...) {
+  if (length + 1 >= size) {
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer + length, size - length, format, args);
+  va_end(args);
+  if (len > 0) {
+    length = min(length + len, size - 1);
+  }
+}
+
+/**
+ * @brief Rebuild the status and currentsong responses if the player changed
+ * @details The responses are formatted once per change of the player event
+ * versions (or of the bitrate and audio format, which change without an
+ * event), so clients
+ * polling status every second get a copy instead of a dozen printf calls.
+ * The elapsed time is left out of the status block and formatted at send
+ * time, at elapsedOffset.
+ */
+void MPDInterface::refreshResponseCache() {
+  ResponseCache& c = responseCache;
+  uint32_t versions[PLAYER_EVENT_COUNT];
+  for (int i = 0; i < PLAYER_EVENT_COUNT; i++) {
+    versions[i] = this->player.getEventVersion(1 << i);
+  }
+  int bitrate = this->player.getBitrate();
+  bool playing = this->player.isPlaying();
+  const AudioStats& stats = this->player.getAudioStats();
+  if (c.valid && c.bitrate == bitrate && c.playing == playing &&
+      c.sampleRate == stats.sampleRate && c.bitsPerSample == stats.bitsPerSample &&
+      c.channels == stats.channels && memcmp(c.versions, versions, sizeof(versions)) == 0) {
+    return;
+  }
+  memcpy(c.versions, versions, sizeof(versions));
+  c.bitrate = bitrate;
+  c.playing = playing;
+  c.sampleRate = stats.sampleRate;
+  c.bitsPerSample = stats.bitsPerSample;
+  c.channels = stats.channels;
+  c.valid = true;
+  bool current = playing && this->player.getStreamName()[0] != '\0';
   int index = this->player.getPlaylistIndex();
-  int volPercent = map(this->player.getVolume(), 0, 22, 0, 100);
-  mpdClient.print("volume: " + String(volPercent) + "\n");
-  mpdClient.print("repeat: 0\n");
-  mpdClient.print("random: 0\n");
-  mpdClient.print("single: 0\n");
-  mpdClient.print("consume: 0\n");
-  mpdClient.print("playlist: 1\n");
-  mpdClient.print("playlistlength: " + String(this->player.getPlaylistCount()) + "\n");
-  mpdClient.print("mixrampdb: 0.000000\n");
-  mpdClient.print("state: " + String(this->player.isPlaying() ? "play" : "stop") + "\n");
-  if (this->player.isPlaying() && strlen(this->player.getStreamName()) > 0) {
-    mpdClient.print("song: " + String(index) + "\n");
-    mpdClient.print("songid: " + String(index) + "\n");
-    // Calculate elapsed time since playback started
-    unsigned long elapsed = 0;
-    if (this->player.getPlayStartTime() > 0) {
-      elapsed = (millis() / 1000) - this->player.getPlayStartTime();
+  // Status, without the elapsed time
+  size_t len = 0;
+  appendf(c.status, sizeof(c.status), len, "volume: %d\n", (int)map(this->player.getVolume(), 0, 22, 0, 100));
+  appendf(c.status, sizeof(c.status), len, "repeat: 0\n"
+                                           "random: 0\n"
+                                           "single: 0\n"
+                                           "consume: 0\n");
+  appendf(c.status, sizeof(c.status), len, "playlist: %lu\n", (unsigned long)this->player.getPlaylistVersion());
+  appendf(c.status, sizeof(c.status), len, "playlistlength: %d\n", this->player.getPlaylistCount());
+  appendf(c.status, sizeof(c.status), len, "mixrampdb: 0.000000\n");
+  appendf(c.status, sizeof(c.status), len, "state: %s\n", playing ? "play" : "stop");
+  c.elapsedOffset = 0;
+  if (current) {
+    appendf(c.status, sizeof(c.status), len, "song: %d\nsongid: %d\n", index, index);
+    c.elapsedOffset = len;
+    appendf(c.status, sizeof(c.status), len, "bitrate: %d\n", bitrate);
+    // Format of the decoded stream, unknown until the decoder started
+    if (stats.sampleRate > 0) {
+      appendf(c.status, sizeof(c.status), len, "audio: %lu:%u:%u\n", (unsigned long)stats.sampleRate,
+              stats.bitsPerSample, stats.channels);
     }
-    mpdClient.print("elapsed: " + String(elapsed) + ".000\n");
-    mpdClient.print("bitrate: " + String(this->player.getBitrate()) + "\n");
-    mpdClient.print("audio: 44100:16:2\n");
-    if (++index >= this->player.getPlaylistCount()) {
-      index = 0; // Wrap around to start
+    int next = index + 1;
+    if (next >= this->player.getPlaylistCount()) {
+      next = 0; // Wrap around to start
+    }
+    appendf(c.status, sizeof(c.status), len, "nextsong: %d\nnextsongid: %d\n", next, next);
+  }
+  appendf(c.status, sizeof(c.status), len, "updating_db: 0\n");
+  c.statusLength = len;
+  // Current song
+  len = 0;
+  if (current) {
+    appendf(c.currentSong, sizeof(c.currentSong), len, "file: %s\n", this->player.getStreamUrl());
+    const char* streamTitle = this->player.getStreamTitle();
+    if (streamTitle[0] != '\0') {
+      // Check if stream title contains " - " separator for artist/track parsing
+      const char* separator = strstr(streamTitle, " - ");
+      if (separator) {
+        // Split into artist and track using the " - " separator
+        appendf(c.currentSong, sizeof(c.currentSong), len, "Artist: %.*s\n",
+                (int)(separator - streamTitle), streamTitle);
+        appendf(c.currentSong, sizeof(c.currentSong), len, "Title: %s\n", separator + 3); // Skip " - "
+      } else {
+        // No separator, use full title as track name
+        appendf(c.currentSong, sizeof(c.currentSong), len, "Title: %s\n", streamTitle);
+      }
+    } else {
+      // No stream title, use stream name as fallback
+      appendf(c.currentSong, sizeof(c.currentSong), len, "Title: %s\n", this->player.getStreamName());
     }
-    mpdClient.print("nextsong: " + String(index) + "\n");
-    mpdClient.print("nextsongid: " + String(index) + "\n");
+    appendf(c.currentSong, sizeof(c.currentSong), len, "Album: WebRadio\n");
+    appendf(c.currentSong, sizeof(c.currentSong), len, "Id: %d\nPos: %d\nTrack: %d\n", index, index, index + 1);
   }
-  mpdClient.print("updating_db: 0\n");
-  mpdClient.print(mpdResponseOK());
+  c.currentSongLength = len;
 }
 
 /**
@@ -948,27 +1668,25 @@ void MPDInterface::handleStatusCommand(const String& args) {
  * 
  * @param args Command arguments (optional "all" or "clear")
  */
-void MPDInterface::handleTagTypesCommand(const String& args) {
-  if (args.equals("\"all\"") || args.equals("\"clear\"")) {
+void MPDInterface::handleTagTypesCommand(const char* args) {
+  if (strcmp(args, "\"all\"") == 0 || strcmp(args, "\"clear\"") == 0) {
     // These commands simply return OK
-    mpdClient.print(mpdResponseOK());
+    session->out.print(mpdResponseOK());
   } else {
     // Send the list of supported tag types
     for (const auto& tagType : supportedTagTypes) {
-      mpdClient.print("tagtype: ");
-      mpdClient.print(tagType.c_str());
-      mpdClient.print("\n");
-      yield();
+      session->out.printf("tagtype: %s\n", tagType.c_str());
     }
-    mpdClient.print(mpdResponseOK());
+    session->out.print(mpdResponseOK());
   }
 }
 
 /**
  * @brief Handle the MPD enableoutput command
- * @details This function processes the MPD "enableoutput" command which would
- * normally enable a specific audio output. In this implementation, the command
- * is acknowledged but has no effect since the I2S output is always enabled.
+ * @details This function processes the MPD "enableoutput" command which
+ * enables a specific audio output. The I2S output is the only one; enabling
+ * it restores the volume the disableoutput command muted, without
+ * reconnecting the stream.
  * 
  * The function implements MPD protocol compatibility by:
  * - Validating the output ID (only 0 is supported)
@@ -976,9 +1694,7 @@ void MPDInterface::handleTagTypesCommand(const String& args) {
  * - Returning standard OK response
  * - Maintaining compatibility with MPD clients
  * 
- * Note: This implementation does not actually enable outputs since
- * the I2S output is always enabled. The command is simply acknowledged
- * to maintain client compatibility.
+ * The setting is saved with the player state.
  * 
  * Error handling:
  * - Returns ACK error for invalid output IDs (not 0)
@@ -986,28 +1702,30 @@ void MPDInterface::handleTagTypesCommand(const String& args) {
  * 
  * @param args Command arguments (output ID to enable)
  */
-void MPDInterface::handleEnableOutputCommand(const String& args) {
-  if (args.length() > 0) {
+void MPDInterface::handleEnableOutputCommand(const char* args) {
+  if (strlen(args) > 0) {
     int outputId = parseValue(args);
     if (outputId == 0) {
       // Only output 0 (I2S) is supported with ESP32-audioI2S
-      mpdClient.print(mpdResponseOK());
+      this->player.setOutputEnabled(true);
+      this->player.savePlayerState();
+      session->out.print(mpdResponseOK());
     } else {
-      mpdClient.print(mpdResponseError("enableoutput", "Invalid output ID"));
+      session->out.print(mpdResponseError("enableoutput", "Invalid output ID"));
       return;
     }
   } else {
-    mpdClient.print(mpdResponseError("enableoutput", "Missing output ID"));
+    session->out.print(mpdResponseError("enableoutput", "Missing output ID"));
     return;
   }
 }
 
 /**
  * @brief Handle the MPD disableoutput command
- * @details This function processes the MPD "disableoutput" command which would
- * normally disable a specific audio output. In this implementation, the command
- * is acknowledged but has no effect since only I2S output is available and it
- * cannot be disabled.
+ * @details This function processes the MPD "disableoutput" command which
+ * disables a specific audio output. The I2S output is the only one; disabling
+ * it mutes the DAC while the stream keeps playing, so enabling it again is
+ * instant.
  * 
  * The function implements MPD protocol compatibility by:
  * - Validating the output ID (only 0 is supported)
@@ -1015,9 +1733,7 @@ void MPDInterface::handleEnableOutputCommand(const String& args) {
  * - Returning standard OK response
  * - Maintaining compatibility with MPD clients
  * 
- * Note: This implementation does not actually disable outputs since
- * the I2S output is always enabled. The command is simply acknowledged
- * to maintain client compatibility.
+ * The setting is saved with the player state.
  * 
  * Error handling:
  * - Returns ACK error for invalid output IDs (not 0)
@@ -1025,18 +1741,19 @@ void MPDInterface::handleEnableOutputCommand(const String& args) {
  * 
  * @param args Command arguments (output ID to disable)
  */
-void MPDInterface::handleDisableOutputCommand(const String& args) {
-  if (args.length() > 0) {
+void MPDInterface::handleDisableOutputCommand(const char* args) {
+  if (strlen(args) > 0) {
     int outputId = parseValue(args);
     // Validate output ID (only 0 is supported)
     if (outputId != 0) {
-      mpdClient.print(mpdResponseError("disableoutput", "Invalid output ID"));
+      session->out.print(mpdResponseError("disableoutput", "Invalid output ID"));
       return;
     }
-    // We don't actually disable outputs, just acknowledge the command
-    mpdClient.print(mpdResponseOK());
+    this->player.setOutputEnabled(false);
+    this->player.savePlayerState();
+    session->out.print(mpdResponseOK());
   } else {
-    mpdClient.print(mpdResponseError("disableoutput", "Missing output ID"));
+    session->out.print(mpdResponseError("disableoutput", "Missing output ID"));
     return;
   }
 }
@@ -1065,17 +1782,17 @@ void MPDInterface::handleDisableOutputCommand(const String& args) {
  * 
  * @param args Command arguments (not used for previous command)
  */
-void MPDInterface::handlePreviousCommand(const String& args) {
+void MPDInterface::handlePreviousCommand(const char* args) {
   if (this->player.getPlaylistCount() > 0) {
     int prevIndex = (this->player.getPlaylistIndex() - 1 + this->player.getPlaylistCount()) % this->player.getPlaylistCount();
     if (handlePlayback(prevIndex)) {
-      mpdClient.print(mpdResponseOK());
+      session->out.print(mpdResponseOK());
     } else {
-      mpdClient.print(mpdResponseError("previous", "Playback failed"));
+      session->out.print(mpdResponseError("previous", "Playback failed"));
       return;
     }
   } else {
-    mpdClient.print(mpdResponseError("previous", "No playlist"));
+    session->out.print(mpdResponseError("previous", "No playlist"));
     return;
   }
 }
@@ -1104,18 +1821,18 @@ void MPDInterface::handlePreviousCommand(const String& args) {
  * 
  * @param args Command arguments (not used for next command)
  */
-void MPDInterface::handleNextCommand(const String& args) {
+void MPDInterface::handleNextCommand(const char* args) {
   // Next command
   if (this->player.getPlaylistCount() > 0) {
     int nextIndex = (this->player.getPlaylistIndex() + 1) % this->player.getPlaylistCount();
     if (handlePlayback(nextIndex)) {
-      mpdClient.print(mpdResponseOK());
+      session->out.print(mpdResponseOK());
     } else {
-      mpdClient.print(mpdResponseError("next", "Playback failed"));
+      session->out.print(mpdResponseError("next", "Playback failed"));
       return;
     }
   } else {
-    mpdClient.print(mpdResponseError("next", "No playlist"));
+    session->out.print(mpdResponseError("next", "No playlist"));
     return;
   }
 }
@@ -1145,19 +1862,19 @@ void MPDInterface::handleNextCommand(const String& args) {
  * 
  * @param args Command arguments (relative volume change)
  */
-void MPDInterface::handleVolumeCommand(const String& args) {
+void MPDInterface::handleVolumeCommand(const char* args) {
   // Validate arguments length
-  if (args.length() > 5) { // Reasonable limit for volume change value
-    mpdClient.print(mpdResponseError("volume", "Invalid argument length"));
+  if (strlen(args) > 5) { // Reasonable limit for volume change value
+    session->out.print(mpdResponseError("volume", "Invalid argument length"));
     return;
   }
   // Volume command - change volume by relative amount
-  if (args.length() > 0) {
+  if (strlen(args) > 0) {
     // Parse volume change value (can be negative for decrease)
     int volumeChange = parseValue(args);
     // Validate volume change range (reasonable limits)
     if (volumeChange < -100 || volumeChange > 100) {
-      mpdClient.print(mpdResponseError("volume", "Volume change out of range"));
+      session->out.print(mpdResponseError("volume", "Volume change out of range"));
       return;
     }
     // Get volume change as value for MPD compatibility
@@ -1172,9 +1889,9 @@ void MPDInterface::handleVolumeCommand(const String& args) {
     this->player.setVolume(this->player.getVolume() + volumeChangeMPD);
     updateDisplay();
     sendStatusToClients();  // Notify WebSocket clients of volume change
-    mpdClient.print(mpdResponseOK());
+    session->out.print(mpdResponseOK());
   } else {
-    mpdClient.print(mpdResponseError("volume", "Missing volume change value"));
+    session->out.print(mpdResponseError("volume", "Missing volume change value"));
     return;
   }
 }
@@ -1205,14 +1922,14 @@ void MPDInterface::handleVolumeCommand(const String& args) {
  * 
  * @param args Command arguments (volume percentage 0-100)
  */
-void MPDInterface::handleSetVolCommand(const String& args) {
+void MPDInterface::handleSetVolCommand(const char* args) {
   // Validate arguments length
-  if (args.length() > 5) { // Reasonable limit for volume value (0-100)
-    mpdClient.print(mpdResponseError("setvol", "Invalid argument length"));
+  if (strlen(args) > 5) { // Reasonable limit for volume value (0-100)
+    session->out.print(mpdResponseError("setvol", "Invalid argument length"));
     return;
   }
   // Set volume command
-  if (args.length() > 0) {
+  if (strlen(args) > 0) {
     // Parse volume value, handling quotes if present
     int newVolume = parseValue(args);
     // Validate volume range (0-100 for MPD compatibility)
@@ -1231,13 +1948,13 @@ void MPDInterface::handleSetVolCommand(const String& args) {
       this->player.setVolume(volume);
       updateDisplay();
       sendStatusToClients();  // Notify WebSocket clients of volume change
-      mpdClient.print(mpdResponseOK());
+      session->out.print(mpdResponseOK());
     } else {
-      mpdClient.print(mpdResponseError("setvol", "Volume out of range"));
+      session->out.print(mpdResponseError("setvol", "Volume out of range"));
       return;
     }
   } else {
-    mpdClient.print(mpdResponseError("setvol", "Missing volume value"));
+    session->out.print(mpdResponseError("setvol", "Missing volume value"));
     return;
   }
 }
@@ -1271,28 +1988,28 @@ void MPDInterface::handleSetVolCommand(const String& args) {
  * 
  * @param args Command arguments (optional playlist index/ID)
  */
-void MPDInterface::handlePlayCommand(const String& args) {
+void MPDInterface::handlePlayCommand(const char* args) {
   // Validate arguments length
-  if (args.length() > 10) { // Reasonable limit for playlist index
-    mpdClient.print(mpdResponseError("play", "Invalid argument length"));
+  if (strlen(args) > 10) { // Reasonable limit for playlist index
+    session->out.print(mpdResponseError("play", "Invalid argument length"));
     return;
   }
   // Play command - optional playlist index
   int playlistIndex = -1;
-  if (args.length() > 0) {
+  if (strlen(args) > 0) {
     // Convert to 0-based index
     playlistIndex = parseValue(args);
     // Validate index if provided
     if (playlistIndex < -1 || playlistIndex >= this->player.getPlaylistCount()) {
-      mpdClient.print(mpdResponseError("play", "Invalid playlist index"));
+      session->out.print(mpdResponseError("play", "Invalid playlist index"));
       return;
     }
   }
   // If no index provided, use current selection
   if (handlePlayback(playlistIndex)) {
-    mpdClient.print(mpdResponseOK());
+    session->out.print(mpdResponseOK());
   } else {
-    mpdClient.print(mpdResponseError("play", "No playlist"));
+    session->out.print(mpdResponseError("play", "No playlist"));
     return;
   }
 }
@@ -1319,9 +2036,9 @@ void MPDInterface::handlePlayCommand(const String& args) {
  * 
  * @param args Command arguments (not used for kill command)
  */
-void MPDInterface::handleKillCommand(const String& args) {
-  mpdClient.print(mpdResponseOK());
-  mpdClient.flush();
+void MPDInterface::handleKillCommand(const char* args) {
+  session->out.print(mpdResponseOK());
+  session->out.flush();
   // Use ESP32 restart function
   ESP.restart();
 }
@@ -1334,33 +2051,70 @@ void MPDInterface::handleKillCommand(const String& args) {
  * monitor player status without polling.
  * 
  * The function implements MPD protocol compatibility by:
- * - Setting the inIdleMode flag to enable idle processing
- * - Initializing hash values for change detection
- * - Computing initial hashes of stream title and player status
+ * - Setting the session->inIdleMode flag to enable idle processing
+ * - Accepting an optional list of subsystems to wait for (all by default)
+ * - Answering immediately if a matching change happened since the last idle
  * - Suspending normal command processing until changes occur
  * 
- * Idle mode behavior:
- * - Monitors stream title for playlist changes
- * - Monitors player status (playing, volume, bitrate) for player changes
- * - Sends "changed: " notifications when changes are detected
- * - Supports noidle command to exit idle mode
- * 
- * Change detection uses hash-based comparison for efficiency:
- * - Title hash: polynomial rolling hash of stream title string
- * - Status hash: combined hash of playing status, volume, and bitrate
+ * Changes are published by the Player as events (player, mixer, playlist)
+ * and collected per session by handleClient(), so an idle session costs
+ * nothing until something actually changes.
  * 
- * @param args Command arguments (not used for idle command)
+ * @param args Optional subsystem names, e.g. "player mixer"
+ */
+void MPDInterface::handleIdleCommand(const char* args) {
+  uint8_t mask = 0;
+  bool any = false;
+  const char* p = args;
+  while (*p) {
+    // Skip separators and quotes around the subsystem name
+    if (*p == ' ' || *p == '\t' || *p == '"') {
+      p++;
+      continue;
+    }
+    size_t len = strcspn(p, " \t\"");
+    bool known = false;
+    for (const auto& subsystem : idleSubsystems) {
+      if (strlen(subsystem.name) == len && strncmp(subsystem.name, p, len) == 0) {
+        mask |= subsystem.event;
+        known = true;
+        break;
+      }
+    }
+    if (!known) {
+      session->out.print(mpdResponseError("idle", "Unrecognized idle event argument"));
+      return;
+    }
+    any = true;
+    p += len;
+  }
+  session->idleMask = any ? mask : 0xFF;
+  session->inIdleMode = true;
+  // Report changes that happened since the last idle right away
+  sendIdleChanges();
+}
+
+/**
+ * @brief Report pending changes to an idle client
+ * @details Sends one "changed:" line per subsystem with pending events the
+ * client waits for, followed by OK, and leaves idle mode. Events the client
+ * did not ask for stay pending for its next idle.
+ * @return true if the changes were sent, false if there was nothing to report
  */
-void MPDInterface::handleIdleCommand(const String& args) {
-  inIdleMode = true;
-  // Initialize hashes for tracking changes
-  lastTitleHash = 0;
-  for (int i = 0; this->player.getStreamTitle()[i]; i++) {
-    lastTitleHash = lastTitleHash * 31 + this->player.getStreamTitle()[i];
+bool MPDInterface::sendIdleChanges() {
+  uint8_t changes = session->idleEvents & session->idleMask;
+  if (!changes) {
+    return false;
+  }
+  for (const auto& subsystem : idleSubsystems) {
+    if (subsystem.event & changes) {
+      session->out.printf("changed: %s\n", subsystem.name);
+    }
   }
-  lastStatusHash = this->player.isPlaying() ? 1 : 0;
-  lastStatusHash = lastStatusHash * 31 + this->player.getVolume();
-  // Don't send immediate response - wait for changes
+  session->out.print(mpdResponseOK());
+  session->idleEvents &= ~changes;
+  session->inIdleMode = false;
+  return true;
 }
 
 /**
@@ -1372,12 +2126,12 @@ void MPDInterface::handleIdleCommand(const String& args) {
  * The function implements MPD protocol compatibility by:
  * - Accepting the command without error
  * - Returning standard OK response before closing
- * - Closing the client connection using mpdClient.stop()
+ * - Closing the client connection using session->client.stop()
  * - Cleaning up connection state for next client
  * 
  * Connection cleanup:
  * - Sends OK response to acknowledge command
- * - Calls mpdClient.stop() to close connection
+ * - Calls session->client.stop() to close connection
  * - Resets command list and idle mode state
  * - Clears command buffer for next connection
  * 
@@ -1386,39 +2140,40 @@ void MPDInterface::handleIdleCommand(const String& args) {
  * 
  * @param args Command arguments (not used for close command)
  */
-void MPDInterface::handleCloseCommand(const String& args) {
+void MPDInterface::handleCloseCommand(const char* args) {
   // Close command
-  mpdClient.print(mpdResponseOK());
-  mpdClient.flush();
+  session->out.print(mpdResponseOK());
+  session->out.flush();
   // Close the client connection
-  mpdClient.stop();
+  session->client.stop();
 }
 
 /**
  * @brief Handle the MPD command_list_begin command
  * @details This function is called when the command_list_begin command is received.
- * It puts the MPD interface into command list mode where commands are buffered
- * until command_list_end is received.
- * 
- * In command list mode, commands are not executed immediately but are stored
- * in a buffer. When command_list_end is received, all buffered commands are
- * executed sequentially. This allows clients to send multiple commands as a
- * single atomic operation.
+ * It puts the MPD interface into command list mode: the following commands
+ * are executed as they arrive, their responses are collected in the session
+ * output buffer and the list is answered with a single OK at
+ * command_list_end.
  * 
  * The function sets the following state variables:
- * - inCommandList: true to indicate command list mode is active
- * - commandListOK: false to indicate standard responses should be used
- * - commandListCount: 0 to reset the command counter
+ * - session->inCommandList: true to indicate command list mode is active
+ * - session->commandListOK: false to indicate standard responses should be used
+ * - session->commandListCount: 0 to reset the command counter
  * 
- * The actual command list processing is handled by the handleCommandList function
- * when command_list_end is received.
+ * The commands of the list are handled by the handleCommandList function.
+ * Command lists cannot be nested.
  * 
  * @param args Command arguments (not used for this command)
  */
-void MPDInterface::handleCommandListBeginCommand(const String& args) {
-  inCommandList = true;
-  commandListOK = false;
-  commandListCount = 0;
+void MPDInterface::handleCommandListBeginCommand(const char* args) {
+  if (session->inCommandList) {
+    session->out.print(mpdResponseError("command_list_begin", "Already in command list mode"));
+    return;
+  }
+  session->inCommandList = true;
+  session->commandListOK = false;
+  session->commandListCount = 0;
 }
 
 /**
@@ -1427,25 +2182,27 @@ void MPDInterface::handleCommandListBeginCommand(const String& args) {
  * It puts the MPD interface into command list mode where each command in the list
  * will receive a "list_OK" response instead of the standard "OK" response.
  * 
- * Command list mode allows clients to send multiple commands as a single atomic
- * operation. In command_list_ok_begin mode, each command (except the final 
- * command_list_end) receives a "list_OK" response, allowing the client to know
- * that each individual command was processed successfully.
+ * In command_list_ok_begin mode, each successful command of the list
+ * receives a "list_OK" response, allowing the client to know that each
+ * individual command was processed, and the list ends with a standard "OK".
  * 
  * The function sets the following state variables:
- * - inCommandList: true to indicate command list mode is active
- * - commandListOK: true to indicate list_OK responses should be used
- * - commandListCount: 0 to reset the command counter
+ * - session->inCommandList: true to indicate command list mode is active
+ * - session->commandListOK: true to indicate list_OK responses should be used
+ * - session->commandListCount: 0 to reset the command counter
  * 
- * The actual command list processing is handled by the handleCommandList function
- * when command_list_end is received.
+ * The commands of the list are handled by the handleCommandList function.
  * 
  * @param args Command arguments (not used for this command)
  */
-void MPDInterface::handleCommandListOkBeginCommand(const String& args) {
-  inCommandList = true;
-  commandListOK = true;
-  commandListCount = 0;
+void MPDInterface::handleCommandListOkBeginCommand(const char* args) {
+  if (session->inCommandList) {
+    session->out.print(mpdResponseError("command_list_ok_begin", "Already in command list mode"));
+    return;
+  }
+  session->inCommandList = true;
+  session->commandListOK = true;
+  session->commandListCount = 0;
 }
 
 /**
@@ -1455,27 +2212,16 @@ void MPDInterface::handleCommandListOkBeginCommand(const String& args) {
  * or command_list_ok_begin). If called outside of command list mode, it sends
  * an error response indicating that the command is not valid in the current context.
  * 
- * This function validates that we're in command list mode and then executes
- * all buffered commands, sending appropriate responses (OK or list_OK) based 
- * on the command list type, then resets command list state.
+ * Inside a command list, command_list_end is intercepted by handleCommandList,
+ * so this handler only runs outside of one.
  * 
  * @param args Command arguments (not used for this command)
  */
-void MPDInterface::handleCommandListEndCommand(const String& args) {
-  if (inCommandList) {
-    // Execute all buffered commands
-    for (int i = 0; i < commandListCount; i++) {
-      // Yield to allow other tasks to run
-      yield();
-      handleMPDCommand(commandList[i]);
-    }
-    // Reset command list state
-    inCommandList = false;
-    commandListOK = false;
-    commandListCount = 0;
-    mpdClient.print(mpdResponseOK());
+void MPDInterface::handleCommandListEndCommand(const char* args) {
+  if (session->inCommandList) {
+    endCommandList();
   } else {
-    mpdClient.print(mpdResponseError("command_list", "Not in command list mode"));
+    session->out.print(mpdResponseError("command_list", "Not in command list mode"));
   }
 }
 
@@ -1493,20 +2239,31 @@ void MPDInterface::handleCommandListEndCommand(const String& args) {
  * This information allows MPD clients to understand what audio formats
  * the CubeRadio can decode and play.
  * 
- * Currently supported formats:
- * - MP3: Using the HelixMP3 decoder
- * - AAC: Using the HelixAAC decoder
+ * Currently supported formats, the decoders built into ESP32-audioI2S:
+ * - MP3: Using the Helix MP3 decoder
+ * - AAC and M4A: Using the Helix AAC decoder
+ * - FLAC: Using the libFLAC based decoder
+ * - WAV: Uncompressed PCM
  * 
  * @param args Command arguments (not used for this command)
  */
-void MPDInterface::handleDecodersCommand(const String& args) {
-  mpdClient.print("plugin: HelixMP3\n");
-  mpdClient.print("suffix: mp3\n");
-  mpdClient.print("mime_type: audio/mpeg\n");
-  mpdClient.print("plugin: HelixAAC\n");
-  mpdClient.print("suffix: aac\n");
-  mpdClient.print("mime_type: audio/aac\n");
-  mpdClient.print(mpdResponseOK());
+void MPDInterface::handleDecodersCommand(const char* args) {
+  session->out.print("plugin: HelixMP3\n"
+                     "suffix: mp3\n"
+                     "mime_type: audio/mpeg\n"
+                     "plugin: HelixAAC\n"
+                     "suffix: aac\n"
+                     "suffix: m4a\n"
+                     "mime_type: audio/aac\n"
+                     "mime_type: audio/aacp\n"
+                     "mime_type: audio/mp4\n"
+                     "plugin: FLAC\n"
+                     "suffix: flac\n"
+                     "mime_type: audio/flac\n"
+                     "plugin: WAV\n"
+                     "suffix: wav\n"
+                     "mime_type: audio/wav\n");
+  session->out.print(mpdResponseOK());
 }
 
 /**
@@ -1520,23 +2277,45 @@ void MPDInterface::handleDecodersCommand(const String& args) {
  * 
  * @param serverRef WiFiServer instance for MPD connections
  * @param playerRef Player instance for controlling playback
+ * @param artCacheRef Station art cache for albumart and readpicture
  */
-MPDInterface::MPDInterface(WiFiServer& serverRef, Player& playerRef)
-    : mpdServer(serverRef), player(playerRef) {
+MPDInterface::MPDInterface(WiFiServer& serverRef, Player& playerRef, ArtCache& artCacheRef)
+    : mpdServer(serverRef), player(playerRef), artCache(artCacheRef) {
   // Initialize supported commands list
   supportedCommands = {
-    "add", "clear", "close", "currentsong", "delete", "disableoutput", 
-    "enableoutput", "find", "idle", "kill", "list", "listallinfo", 
-    "listplaylistinfo", "listplaylists", "load", "lsinfo", "next", 
-    "notcommands", "outputs", "password", "pause", "ping", "play", "playid", 
-    "playlistid", "playlistinfo", "plchanges", "previous", "save", "search", 
-    "seek", "seekid", "setvol", "stats", "status", "stop", "tagtypes", 
-    "update"
+    "add", "addid", "albumart", "binarylimit", "clear", "close",
+    "currentsong", "delete", "deleteid", "disableoutput", "enableoutput",
+    "find", "idle", "kill", "list", "listallinfo", "listplaylistinfo",
+    "listplaylists", "load", "lsinfo", "move", "next", "notcommands",
+    "outputs", "password", "pause", "ping", "play", "playid", "playlistid",
+    "playlistinfo", "plchanges", "plchangesposid", "previous",
+    "readpicture", "save", "search", "seek", "seekid", "setvol", "stats",
+    "status", "stop", "tagtypes", "update"
   };
   // Default tagtypes response
   supportedTagTypes = {
     "Artist", "Album", "Title", "Track", "Name", "Genre", "Date", "Comment", "Disc"
   };
+  // Get woken by player changes instead of polling for them
+  playerRef.setEventListener(&MPDInterface::onPlayerEvent, this);
+  // A misplaced registry entry would silently become an unknown command
+  bool sorted = checkCommandRegistry();
+  assert(sorted && "MPD command registry is not sorted");
+  (void)sorted;
+}
+
+/**
+ * @brief Player change event listener
+ * @details Called from whichever task changed the player state, so it only
+ * records the events; handleClient() hands them to the sessions.
+ * @param events Bit mask of PLAYER_EVENT_* values
+ * @param context The MPDInterface instance
+ */
+void MPDInterface::onPlayerEvent(uint8_t events, void* context) {
+  MPDInterface* self = (MPDInterface*)context;
+  portENTER_CRITICAL(&self->eventLock);
+  self->pendingEvents |= events;
+  portEXIT_CRITICAL(&self->eventLock);
 }
 
 /**
@@ -1545,69 +2324,75 @@ MPDInterface::MPDInterface(WiFiServer& serverRef, Player& playerRef)
  * handler functions. Each entry contains:
  * - Command name as a string literal
  * - Pointer to the handler function (member function pointer)
- * - Exact match flag (true = exact match, false = prefix match)
  * 
  * The registry is used by the command processing system to efficiently dispatch
- * incoming MPD commands to their appropriate handlers. Commands are matched
- * either exactly (for commands like "stop") or as prefixes (for commands like
- * "play" which should also match "playid").
+ * incoming MPD commands to their appropriate handlers. The first token of the
+ * command line is looked up with a binary search and must match a name exactly,
+ * so "play" and "playid" or "list" and "listallinfo" never shadow each other.
  * 
- * The registry is sorted alphabetically by command name for readability, though
- * the command processing system does a linear search through all entries.
+ * The registry MUST stay sorted by command name in byte order (as strcmp()
+ * compares, so '_' sorts before the letters), or the lookup will miss entries.
  * 
  * Adding new commands requires:
  * 1. Adding a handler function declaration in the header file
  * 2. Implementing the handler function
- * 3. Adding an entry to this registry
+ * 3. Adding an entry to this registry, at its sorted position
  * 4. Adding the command to supportedCommands vector if it should appear in "commands" response
  */
 const MPDInterface::MPDCommand MPDInterface::commandRegistry[] = {
-  {"stop", &MPDInterface::handleStopCommand, true},
-  {"pause", &MPDInterface::handleStopCommand, false},
-  {"status", &MPDInterface::handleStatusCommand, true},
-  {"currentsong", &MPDInterface::handleCurrentSongCommand, true},
-  {"playlistinfo", &MPDInterface::handlePlaylistInfoCommand, false},
-  {"playlistid", &MPDInterface::handlePlaylistIdCommand, false},
-  {"playid", &MPDInterface::handlePlayCommand, false},
-  {"play", &MPDInterface::handlePlayCommand, false},
-  {"lsinfo", &MPDInterface::handleLsInfoCommand, true},
-  {"setvol", &MPDInterface::handleSetVolCommand, false},
-  {"getvol", &MPDInterface::handleGetVolCommand, true},
-  {"volume", &MPDInterface::handleVolumeCommand, false},
-  {"next", &MPDInterface::handleNextCommand, true},
-  {"previous", &MPDInterface::handlePreviousCommand, true},
-  {"clear", &MPDInterface::handleClearCommand, true},
-  {"add", &MPDInterface::handleAddCommand, true},
-  {"delete", &MPDInterface::handleDeleteCommand, true},
-  {"load", &MPDInterface::handleLoadCommand, true},
-  {"save", &MPDInterface::handleSaveCommand, true},
-  {"outputs", &MPDInterface::handleOutputsCommand, true},
-  {"disableoutput", &MPDInterface::handleDisableOutputCommand, false},
-  {"enableoutput", &MPDInterface::handleEnableOutputCommand, false},
-  {"commands", &MPDInterface::handleCommandsCommand, true},
-  {"notcommands", &MPDInterface::handleNotCommandsCommand, true},
-  {"stats", &MPDInterface::handleStatsCommand, true},
-  {"ping", &MPDInterface::handlePingCommand, true},
-  {"password", &MPDInterface::handlePasswordCommand, false},
-  {"kill", &MPDInterface::handleKillCommand, true},
-  {"update", &MPDInterface::handleUpdateCommand, true},
-  {"listallinfo", &MPDInterface::handleListAllInfoCommand, true},
-  {"listplaylistinfo", &MPDInterface::handleListPlaylistInfoCommand, true},
-  {"listplaylists", &MPDInterface::handleListPlaylistsCommand, true},
-  {"list", &MPDInterface::handleListCommand, false},
-  {"search", &MPDInterface::handleSearchCommand, false},
-  {"find", &MPDInterface::handleFindCommand, false},
-  {"seek", &MPDInterface::handleSeekCommand, false},
-  {"seekid", &MPDInterface::handleSeekIdCommand, false},
-  {"tagtypes", &MPDInterface::handleTagTypesCommand, false},
-  {"plchanges", &MPDInterface::handlePlChangesCommand, false},
-  {"idle", &MPDInterface::handleIdleCommand, true},
-  {"noidle", &MPDInterface::handleNoIdleCommand, true},
-  {"close", &MPDInterface::handleCloseCommand, true},
-  {"command_list_begin", &MPDInterface::handleCommandListBeginCommand, true},
-  {"command_list_ok_begin", &MPDInterface::handleCommandListOkBeginCommand, true},
-  {"command_list_end", &MPDInterface::handleCommandListEndCommand, true},
-  {"decoders", &MPDInterface::handleDecodersCommand, true}
+  {"add", &MPDInterface::handleAddCommand},
+  {"addid", &MPDInterface::handleAddIdCommand},
+  {"albumart", &MPDInterface::handleAlbumArtCommand},
+  {"binarylimit", &MPDInterface::handleBinaryLimitCommand},
+  {"clear", &MPDInterface::handleClearCommand},
+  {"close", &MPDInterface::handleCloseCommand},
+  {"command_list_begin", &MPDInterface::handleCommandListBeginCommand},
+  {"command_list_end", &MPDInterface::handleCommandListEndCommand},
+  {"command_list_ok_begin", &MPDInterface::handleCommandListOkBeginCommand},
+  {"commands", &MPDInterface::handleCommandsCommand},
+  {"currentsong", &MPDInterface::handleCurrentSongCommand},
+  {"decoders", &MPDInterface::handleDecodersCommand},
+  {"delete", &MPDInterface::handleDeleteCommand},
+  {"deleteid", &MPDInterface::handleDeleteIdCommand},
+  {"disableoutput", &MPDInterface::handleDisableOutputCommand},
+  {"enableoutput", &MPDInterface::handleEnableOutputCommand},
+  {"find", &MPDInterface::handleFindCommand},
+  {"getvol", &MPDInterface::handleGetVolCommand},
+  {"idle", &MPDInterface::handleIdleCommand},
+  {"kill", &MPDInterface::handleKillCommand},
+  {"list", &MPDInterface::handleListCommand},
+  {"listallinfo", &MPDInterface::handleListAllInfoCommand},
+  {"listplaylistinfo", &MPDInterface::handleListPlaylistInfoCommand},
+  {"listplaylists", &MPDInterface::handleListPlaylistsCommand},
+  {"load", &MPDInterface::handleLoadCommand},
+  {"lsinfo", &MPDInterface::handleLsInfoCommand},
+  {"move", &MPDInterface::handleMoveCommand},
+  {"next", &MPDInterface::handleNextCommand},
+  {"noidle", &MPDInterface::handleNoIdleCommand},
+  {"notcommands", &MPDInterface::handleNotCommandsCommand},
+  {"outputs", &MPDInterface::handleOutputsCommand},
+  {"password", &MPDInterface::handlePasswordCommand},
+  {"pause", &MPDInterface::handleStopCommand},
+  {"ping", &MPDInterface::handlePingCommand},
+  {"play", &MPDInterface::handlePlayCommand},
+  {"playid", &MPDInterface::handlePlayCommand},
+  {"playlistid", &MPDInterface::handlePlaylistIdCommand},
+  {"playlistinfo", &MPDInterface::handlePlaylistInfoCommand},
+  {"plchanges", &MPDInterface::handlePlChangesCommand},
+  {"plchangesposid", &MPDInterface::handlePlChangesPosIdCommand},
+  {"previous", &MPDInterface::handlePreviousCommand},
+  {"readpicture", &MPDInterface::handleReadPictureCommand},
+  {"save", &MPDInterface::handleSaveCommand},
+  {"search", &MPDInterface::handleSearchCommand},
+  {"seek", &MPDInterface::handleSeekCommand},
+  {"seekid", &MPDInterface::handleSeekIdCommand},
+  {"setvol", &MPDInterface::handleSetVolCommand},
+  {"stats", &MPDInterface::handleStatsCommand},
+  {"status", &MPDInterface::handleStatusCommand},
+  {"stop", &MPDInterface::handleStopCommand},
+  {"tagtypes", &MPDInterface::handleTagTypesCommand},
+  {"update", &MPDInterface::handleUpdateCommand},
+  {"volume", &MPDInterface::handleVolumeCommand}
 };
 // Calculate the number of commands in the registry
 const size_t MPDInterface::commandCount = sizeof(commandRegistry) / sizeof(MPDCommand);
@@ -1621,149 +2406,281 @@ const size_t MPDInterface::commandCount = sizeof(commandRegistry) / sizeof(MPDCo
  * client disconnections and ensures proper cleanup.
  * 
  * Connection handling:
- * - Accepts new connections when no client is connected
- * - Rejects new connections when a client is already connected
+ * - Keeps a pool of MPD_MAX_CLIENTS sessions, each with its own command
+ *   state, idle mode and output buffer
+ * - Accepts a new connection into a free session slot
+ * - Rejects a new connection with "Too many clients" when all slots are taken
  * - Properly closes disconnected clients
  * 
- * In idle mode, the function monitors for changes in playback status and stream
- * information, sending notifications to clients when changes occur.
+ * Connected sessions are served round-robin, one command each per round,
+ * starting with a different session each pass, so no client holds up the
+ * others. Sessions in idle mode get the player changes as notifications.
  * 
  * The function implements proper resource management:
- * - Ensures previous clients are properly closed before accepting new ones
- * - Resets command processing state on new connections
+ * - Resets the session state when a slot takes a new connection
  * - Handles unexpected disconnections gracefully
+ * 
+ * No call ever blocks on a client: responses the socket does not take are
+ * queued and drained by the following passes, and a session is not served
+ * new commands while it has queued data. Clients that overflow the queue,
+ * or send and read nothing for config.mpd_timeout seconds outside idle, are
+ * disconnected.
  */
-void MPDInterface::handleClient() {
-    // Check if client disconnected unexpectedly
-    if (mpdClient && !mpdClient.connected()) {
-        mpdClient.flush();
-        delay(1);
-        mpdClient.stop();
-        // Reset all state variables
-        inCommandList = false;
-        commandListOK = false;
-        commandListCount = 0;
-        inIdleMode = false;
-        commandBuffer = "";
-        return;
-    }
-    // Handle new client connections
-    if (mpdServer.hasClient()) {
-        // Reject new connection if we already have one
-        if (mpdClient && mpdClient.connected()) {
-            WiFiClient newClient = mpdServer.available();
-            if (newClient && newClient.connected()) {
-                newClient.print("OK MPD " MPD_VERSION "\n");
-                newClient.print("ACK [0@0] {} Only one client allowed at a time\n");
-                newClient.flush();
-                delay(1);
-                newClient.stop();
-            }
-            return;
-        }
-        // Properly close existing client first
-        if (mpdClient && mpdClient.connected()) {
-            mpdClient.flush();
-            delay(1);
-            mpdClient.stop();
-        }
-        // Accept the new client connection
-        mpdClient = mpdServer.available();
-        // Send MPD welcome message with error checking
-        if (mpdClient && mpdClient.connected()) {
-            mpdClient.print("OK MPD " MPD_VERSION "\n");
+bool MPDInterface::handleClient() {
+  unsigned long now = millis();
+  unsigned long timeout = config.mpd_timeout > 0 ? (unsigned long)config.mpd_timeout * 1000UL : 0;
+  for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+    MPDSession& s = sessions[i];
+    if (!s.client) {
+      continue;
+    }
+    // Close sessions whose client disconnected unexpectedly
+    if (!s.client.connected()) {
+      closeSession(s, nullptr);
+      continue;
+    }
+    // Send what earlier passes queued
+    if (s.out.drain() > 0) {
+      s.lastActivity = now;
+    }
+    if (s.out.isBroken()) {
+      closeSession(s, "not reading its responses");
+    } else if (timeout > 0 && now - s.lastActivity > timeout &&
+               (!s.inIdleMode || s.out.queued() > 0)) {
+      // Idle clients may stay silent, TCP keepalive notices when they are gone
+      closeSession(s, "timed out");
+    }
+  }
+  // Handle new client connections
+  if (mpdServer.hasClient()) {
+    // Find a free session slot
+    MPDSession* slot = nullptr;
+    for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+      if (!sessions[i].client.connected()) {
+        slot = &sessions[i];
+        break;
+      }
+    }
+    if (slot) {
+      // Accept the new client connection
+      slot->client = mpdServer.available();
+      slot->reset();
+      // Responses are already coalesced, don't let Nagle hold back the last segment
+      slot->client.setNoDelay(true);
+      // Probe silent connections, so clients parked in idle are dropped once gone
+      int fd = slot->client.fd();
+      if (fd >= 0 && config.mpd_keepalive > 0) {
+        int on = 1;
+        int idle = config.mpd_keepalive;
+        int interval = 5;
+        int count = 3;
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+#ifdef TCP_KEEPIDLE
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+      }
+      // Send MPD welcome message with error checking
+      if (slot->client && slot->client.connected()) {
+        slot->out.print("OK MPD " MPD_VERSION "\n");
+      }
+    } else {
+      // Reject new connection if all slots are in use
+      WiFiClient newClient = mpdServer.available();
+      if (newClient && newClient.connected()) {
+        newClient.print("OK MPD " MPD_VERSION "\n");
+        newClient.print("ACK [0@0] {} Too many clients\n");
+        newClient.stop();
+      }
+    }
+  }
+  // Serve connected sessions round-robin, one command each per round, starting
+  // with a different one each pass. Keep going while there are complete
+  // commands pending and the time budget allows, so pipelined commands are
+  // answered in the same pass instead of one per loop() iteration.
+  unsigned long budget = config.mpd_budget > 0 ? (unsigned long)config.mpd_budget * 1000UL : 0;
+  unsigned long start = micros();
+  bool pending = true;
+  while (pending) {
+    pending = false;
+    // Hand the player changes to every connected session
+    portENTER_CRITICAL(&eventLock);
+    uint8_t events = pendingEvents;
+    pendingEvents = 0;
+    portEXIT_CRITICAL(&eventLock);
+    if (events) {
+      for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+        if (sessions[i].client) {
+          sessions[i].idleEvents |= events;
         }
-        // Reset all state variables
-        inCommandList = false;
-        commandListOK = false;
-        commandListCount = 0;
-        inIdleMode = false;
-        commandBuffer = "";
-    }
-    // Process client if connected
-    if (mpdClient && mpdClient.connected()) {
-        if (inIdleMode) {
-            handleIdleMode();
+      }
+    }
+    for (int n = 0; n < MPD_MAX_CLIENTS; n++) {
+      session = &sessions[(nextSession + n) % MPD_MAX_CLIENTS];
+      // Sessions with unsent responses get no new work until the client reads them
+      if (session->client && session->client.connected() && session->out.queued() == 0) {
+        if (session->inIdleMode) {
+          pending |= handleIdleMode();
         } else {
-            handleAsyncCommands();
+          pending |= handleAsyncCommands();
         }
+      }
+    }
+    // Changes made by these commands go out to idle clients in the same pass
+    pending |= pendingEvents != 0;
+    if (micros() - start >= budget) {
+      break;
     }
+  }
+  // Send the responses, all those of a session at once
+  for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+    sessions[i].out.flush();
+  }
+  // Sessions with queued responses go through the next pass again
+  for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+    if (sessions[i].out.queued() > 0 && sessions[i].out.drain() > 0) {
+      sessions[i].lastActivity = millis();
+    }
+  }
+  nextSession = (nextSession + 1) % MPD_MAX_CLIENTS;
+  session = nullptr;
+  // Commands are still waiting if the budget ran out
+  return pending;
 }
 
 /**
- * @brief Handle idle mode monitoring and notifications
- * @details Monitors for changes in playback status and stream information using
- * hash-based change detection for efficient monitoring.
- * 
- * Change detection works by computing hash values of the monitored data:
- * - Title hash: Computed from the stream title string using polynomial rolling hash
- * - Status hash: Computed from playing status, volume, and bitrate
- * 
- * When changes are detected, appropriate MPD idle notifications are sent:
- * - "changed: playlist" for title changes
- * - "changed: player" and "changed: mixer" for status changes
- * 
- * The function also handles the noidle command to exit idle mode.
- * 
- * Hash computation uses a simple polynomial rolling hash with base 31 for good
- * distribution properties while being computationally efficient.
- * 
- * The idle monitoring implements an efficient polling mechanism:
- * - Computes rolling hashes of monitored data on each call
- * - Compares with previously stored hashes to detect changes
- * - Sends appropriate MPD notifications when changes occur
- * - Handles noidle command to exit idle mode gracefully
- * - Maintains low CPU usage through minimal processing per call
+ * @brief Start the MPD task
+ * @details Creates a FreeRTOS task that services the MPD server on its own,
+ * so MPD latency does not depend on the web server, display and inputs
+ * handled by loop() and its delay. Priority, stack size and core are set
+ * with MPD_TASK_PRIORITY, MPD_TASK_STACK_SIZE and MPD_TASK_CORE.
+ * @return true if the task was created, false if loop() has to call handleClient()
  */
-void MPDInterface::handleIdleMode() {
-  // Check for title changes using hash computation
-  // Uses polynomial rolling hash with base 31 for good distribution
-  unsigned long currentTitleHash = 0;
-  for (int i = 0; this->player.getStreamTitle()[i]; i++) {
-    currentTitleHash = currentTitleHash * 31 + this->player.getStreamTitle()[i];
-  }
-  // Check for status changes using hash computation
-  // Combines playing status (boolean) and volume (0-22) into a single hash
-  unsigned long currentStatusHash = this->player.isPlaying() ? 1 : 0;
-  currentStatusHash = currentStatusHash * 31 + this->player.getVolume();
-  // Prepare to send idle response if changes detected
-  bool sendIdleResponse = false;
-  String idleChanges = "";
-  // Check for title change - indicates playlist content change
-  if (currentTitleHash != lastTitleHash) {
-    idleChanges += "changed: playlist\n";
-    lastTitleHash = currentTitleHash;
-    sendIdleResponse = true;
+bool MPDInterface::startTask() {
+  BaseType_t result = xTaskCreatePinnedToCore(mpdTask, "MPDTask", MPD_TASK_STACK_SIZE, this,
+                                              MPD_TASK_PRIORITY, &taskHandle, MPD_TASK_CORE);
+  if (result != pdPASS) {
+    taskHandle = nullptr;
+    return false;
   }
-  // Check for status change - indicates player or mixer state change
-  if (currentStatusHash != lastStatusHash) {
-    idleChanges += "changed: player\n";
-    idleChanges += "changed: mixer\n";
-    lastStatusHash = currentStatusHash;
-    sendIdleResponse = true;
+  return true;
+}
+
+/**
+ * @brief MPD task function
+ * @details Serves the clients, then sleeps in select() until a client sends
+ * data or MPD_TASK_POLL_MS passes, the longest new connections and player
+ * changes wait to be handled.
+ * @param parameters The MPDInterface instance
+ */
+void MPDInterface::mpdTask(void* parameters) {
+  MPDInterface* self = (MPDInterface*)parameters;
+  while (true) {
+    if (self->handleClient()) {
+      // Budget used up with commands still waiting, let other tasks run
+      vTaskDelay(1);
+    } else {
+      self->waitForActivity(MPD_TASK_POLL_MS);
+    }
   }
-  // Send idle response if there are changes
-  if (sendIdleResponse) {
-    if (mpdClient && mpdClient.connected()) {
-        mpdClient.print(idleChanges);
-        mpdClient.print(mpdResponseOK());
+}
+
+/**
+ * @brief Wait for data from any client
+ * @details Blocks in select() on the sockets of the connected sessions, for
+ * reading, or for writing when a session has queued responses. The
+ * wait is skipped when a session has a complete command buffered or player
+ * events are pending, and replaced by a plain delay when nobody is connected.
+ * @param timeoutMs Longest wait in milliseconds
+ */
+void MPDInterface::waitForActivity(unsigned long timeoutMs) {
+  fd_set readSet;
+  fd_set writeSet;
+  FD_ZERO(&readSet);
+  FD_ZERO(&writeSet);
+  int maxFd = -1;
+  for (int i = 0; i < MPD_MAX_CLIENTS; i++) {
+    MPDSession& s = sessions[i];
+    if (!s.client || !s.client.connected()) {
+      continue;
     }
-    inIdleMode = false;
+    // A complete command is already buffered and can be served
+    if (s.out.queued() == 0 && memchr(s.lineBuffer + s.lineStart, '\n', s.lineLength - s.lineStart)) {
+      return;
+    }
+    int fd = s.client.fd();
+    if (fd >= 0) {
+      // Wait for room to send queued responses, new commands wait for them
+      if (s.out.queued() > 0) {
+        FD_SET(fd, &writeSet);
+      } else {
+        FD_SET(fd, &readSet);
+      }
+      maxFd = max(maxFd, fd);
+    }
+  }
+  if (pendingEvents) {
+    return;
+  }
+  if (maxFd < 0) {
+    vTaskDelay(pdMS_TO_TICKS(timeoutMs));
     return;
   }
-  // Check if there's data available (for noidle command)
-  if (mpdClient && mpdClient.connected() && mpdClient.available()) {
-    String command = mpdClient.readStringUntil('\n');
-    command.trim();
-    Serial.println("MPD Command: " + command);
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  select(maxFd + 1, &readSet, &writeSet, nullptr, &tv);
+}
+
+/**
+ * @brief Disconnect a session and free its slot
+ * @details Keeps the playlist changes of an unfinished command list, then
+ * drops whatever the session still had to send.
+ * @param s Session to close
+ * @param reason Reason logged, nullptr if the client left by itself
+ */
+void MPDInterface::closeSession(MPDSession& s, const char* reason) {
+  if (reason) {
+    Serial.printf("MPD client dropped: %s\n", reason);
+  }
+  s.client.stop();
+  // Keep the playlist changes of an unfinished command list
+  if (s.playlistDirty) {
+    this->player.savePlaylist();
+  }
+  // Reset all state variables
+  s.reset();
+}
+
+/**
+ * @brief Handle idle mode notifications
+ * @details Sends the pending change notifications the client waits for, if
+ * any, otherwise checks for the noidle command to exit idle mode.
+ * 
+ * Change events come from the Player through onPlayerEvent() and are added
+ * to every session by handleClient(), so nothing is recomputed here while
+ * nothing changes.
+ * 
+ * @return true if a command line was consumed, false otherwise
+ */
+bool MPDInterface::handleIdleMode() {
+  // Send idle response if there are changes
+  if (sendIdleChanges()) {
+    return false;
+  }
+  // Check if there's data available (for noidle command) without blocking
+  char* command = readLine();
+  if (command) {
+    Serial.print("MPD Command: ");
+    Serial.println(command);
     // Handle noidle command to exit idle mode
-    if (command == "noidle") {
-      inIdleMode = false;
-      if (mpdClient && mpdClient.connected()) {
-          mpdClient.print(mpdResponseOK());
-      }
+    if (strcmp(command, "noidle") == 0) {
+      session->inIdleMode = false;
+      session->out.print(mpdResponseOK());
     }
   }
+  return command != nullptr;
 }
 /**
  * @brief Handle playback command
@@ -1820,12 +2737,13 @@ bool MPDInterface::handlePlayback(int index) {
  * it in a buffer until a complete command (terminated by newline) is received.
  * It then processes the command according to the current mode (normal, command list, etc.).
  * 
- * The function processes only one command per call to avoid blocking other operations,
- * which is important for maintaining responsive MPD service.
+ * The function processes only one command per call; handleClient() calls it
+ * again while commands are pending and its time budget is not used up.
  * 
  * Command processing implements a state machine with the following states:
  * - Normal mode: Process commands immediately
- * - Command list mode: Buffer commands until command_list_end
+ * - Command list mode: Run each command as it arrives, the list ends with a
+ *   single OK at command_list_end (see handleCommandList())
  * - Idle mode: Handled separately in handleIdleMode()
  * 
  * The function implements proper buffering and command boundary detection:
@@ -1833,32 +2751,92 @@ bool MPDInterface::handlePlayback(int index) {
  * - Trims whitespace from commands
  * - Routes commands to appropriate handlers based on current mode
  * - Processes one command at a time to maintain responsiveness
+ * 
+ * @return true if a command line was consumed, false if none was complete
  */
-void MPDInterface::handleAsyncCommands() {
-    // Read available data without blocking
-    while (mpdClient.available()) {
-        char c = mpdClient.read();
-        if (c == '\n') {
-            // Process complete command
-            String command = commandBuffer;
-            command.trim();
-            commandBuffer = "";
-            // Only process if command is not empty
-            if (command.length() > 0) {
-                Serial.println("MPD Command: " + command);
-                // Handle command list mode
-                if (inCommandList) {
-                    handleCommandList(command);
-                } else {
-                    // Normal command processing
-                    handleMPDCommand(command);
-                }
-            }
-            break; // Process one command at a time to avoid blocking
-        } else {
-            commandBuffer += c;
+bool MPDInterface::handleAsyncCommands() {
+  // Get the next complete command, if any, without blocking
+  char* command = readLine();
+  // Only process if command is not empty
+  if (command && command[0] != '\0') {
+    Serial.print("MPD Command: ");
+    Serial.println(command);
+    // Handle command list mode
+    if (session->inCommandList) {
+      handleCommandList(command);
+    } else {
+      // Normal command processing
+      handleMPDCommand(command);
+    }
+  }
+  return command != nullptr;
+}
+
+/**
+ * @brief Read the next complete command line of the current session
+ * @details Reads whatever the socket has in one bulk read into the session's
+ * fixed line buffer and scans it in place for a newline. The returned line is
+ * NUL-terminated and trimmed inside the buffer; it stays valid until the next
+ * call. Data following the line (pipelined commands) is kept for later calls.
+ * 
+ * Lines that do not fit in MPD_LINE_BUFFER_SIZE are discarded up to their
+ * newline and answered with an error, so the buffer never grows.
+ * 
+ * @return Pointer to the command line, or nullptr if no complete line is available
+ */
+char* MPDInterface::readLine() {
+  MPDSession& s = *session;
+  for (;;) {
+    // Look for a complete line in the data already buffered
+    char* start = s.lineBuffer + s.lineStart;
+    char* eol = (char*)memchr(start, '\n', s.lineLength - s.lineStart);
+    if (eol) {
+      *eol = '\0';
+      s.lineStart = eol - s.lineBuffer + 1;
+      if (s.discardLine) {
+        // End of an overlong line, drop it
+        s.discardLine = false;
+        continue;
+      }
+      // Trim whitespace (and the CR of CRLF terminated lines) in place
+      while (isspace((unsigned char)*start)) {
+        start++;
+      }
+      char* end = eol;
+      while (end > start && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+      }
+      return start;
+    }
+    // Move the partial line to the front of the buffer
+    if (s.lineStart > 0) {
+      memmove(s.lineBuffer, start, s.lineLength - s.lineStart);
+      s.lineLength -= s.lineStart;
+      s.lineStart = 0;
+    }
+    // Buffer full without a newline: drop the line
+    if (s.lineLength >= sizeof(s.lineBuffer)) {
+      s.lineLength = 0;
+      if (!s.discardLine) {
+        s.discardLine = true;
+        s.out.print(mpdResponseError("", "Command line too long"));
+        // The dropped line was part of the list, the list fails with it
+        if (s.inCommandList) {
+          s.commandListFailed = true;
         }
+      }
+    }
+    // Read more data in bulk
+    if (s.client.available() <= 0) {
+      return nullptr;
     }
+    int n = s.client.read((uint8_t*)s.lineBuffer + s.lineLength, sizeof(s.lineBuffer) - s.lineLength);
+    if (n <= 0) {
+      return nullptr;
+    }
+    s.lineLength += n;
+    s.lastActivity = millis();
+  }
 }
 
 /**
@@ -1866,54 +2844,61 @@ void MPDInterface::handleAsyncCommands() {
  * @details Processes commands in command list mode with support for both
  * command_list_begin and command_list_ok_begin modes.
  * 
- * In command_list_begin mode, commands are buffered until command_list_end
- * is received, then all commands are executed sequentially.
+ * Commands are executed as they arrive, nothing is buffered but their
+ * responses, so a list can have any number of commands in bounded memory.
+ * The session output buffer is flushed when full and at the end of the
+ * handleClient() pass, like for single commands.
  * 
  * In command_list_ok_begin mode, each command receives a "list_OK" response
- * except the last which receives a standard "OK" response.
- * 
- * The function implements a safety limit of 50 commands to prevent memory issues
- * and potential denial of service attacks.
+ * and command_list_end a standard "OK" response.
  * 
  * Command list processing follows the MPD protocol specification:
  * - Commands are executed in order
  * - Each command is processed as if sent individually
- * - Error in any command stops processing and returns error
- * 
- * The function implements proper command list state management:
- * - Buffers commands until command_list_end is received
- * - Executes all buffered commands sequentially
- * - Handles both command_list_begin and command_list_ok_begin modes
- * - Implements safety limit to prevent memory exhaustion
- * - Properly resets state after command list execution
+ * - The first error stops processing: its ACK carries the position of the
+ *   failed command in the list, the following commands are skipped up to
+ *   command_list_end and no final OK is sent
  * 
  * @param command The command to process
  */
-void MPDInterface::handleCommandList(const String& command) {
-  if (command == "command_list_end") {
-    // Execute all buffered commands
-    for (int i = 0; i < commandListCount; i++) {
-      // Yield to allow other tasks to run
-      yield();
-      handleMPDCommand(commandList[i]);
-    }
-    // Reset command list state
-    inCommandList = false;
-    commandListOK = false;
-    commandListCount = 0;
-    mpdClient.print(mpdResponseOK());
+void MPDInterface::handleCommandList(const char* command) {
+  if (strcmp(command, "command_list_end") == 0) {
+    endCommandList();
+    return;
+  }
+  // Skip the rest of a failed list
+  if (session->commandListFailed) {
+    return;
+  }
+  session->commandFailed = false;
+  handleMPDCommand(command);
+  if (session->commandFailed) {
+    session->commandListFailed = true;
   } else {
-    // Buffer the command
-    if (commandListCount < MAX_COMMAND_LIST_SIZE) {
-      commandList[commandListCount] = command;
-      commandListCount++;
-    } else {
-      // Command list too long, send error
-      inCommandList = false;
-      commandListOK = false;
-      commandListCount = 0;
-      mpdClient.print(mpdResponseError("command_list", "Command list too long"));
-    }
+    session->commandListCount++;
+  }
+}
+
+/**
+ * @brief Finish the current command list
+ * @details Saves the playlist once if any command of the list changed it,
+ * resets the command list state and sends the final OK, unless a command of
+ * the list failed and its ACK already ended the response.
+ */
+void MPDInterface::endCommandList() {
+  // One flash write for all playlist changes of the list, even a failed one
+  if (session->playlistDirty) {
+    session->playlistDirty = false;
+    this->player.savePlaylist();
+  }
+  bool failed = session->commandListFailed;
+  // Reset command list state
+  session->inCommandList = false;
+  session->commandListOK = false;
+  session->commandListFailed = false;
+  session->commandListCount = 0;
+  if (!failed) {
+    session->out.print(mpdResponseOK());
   }
 }
 
@@ -1929,13 +2914,15 @@ void MPDInterface::handleCommandList(const String& command) {
  * - Command list responses follow specific sequencing rules
  * - Proper handling of intermediate vs final responses in command lists
  * 
+ * The returned string is a constant, so building the response allocates nothing.
+ * 
  * @return OK response string
  */
-String MPDInterface::mpdResponseOK() {
+const char* MPDInterface::mpdResponseOK() {
   // Check if in command list mode
-  if (inCommandList) {
+  if (session->inCommandList) {
     // Send OK for each command if in command_list_ok_begin mode
-    if (commandListOK) {
+    if (session->commandListOK) {
       return "list_OK\n";
     }
     else
@@ -1956,7 +2943,9 @@ String MPDInterface::mpdResponseOK() {
  * - Error code 1 (ACK_ERROR_NOT_LIST) for command list errors
  * - Error code 0 (ACK_ERROR_UNKNOWN) for unknown errors
  * 
- * Command list number 0 indicates error in current command.
+ * The command list number is the position of the failed command in the
+ * current command list, 0 outside of command lists. Generating the error
+ * also marks the command as failed, which ends a command list.
  * 
  * Error response format follows MPD specification:
  * - Appropriate error codes for different error types
@@ -1968,19 +2957,27 @@ String MPDInterface::mpdResponseOK() {
  * @param message Error message
  * @return Error response string in MPD format
  */
-String MPDInterface::mpdResponseError(const String& command, const String& message) {
+String MPDInterface::mpdResponseError(const char* command, const char* message) {
   // Determine appropriate error code based on message content
   int errorCode = 5; // Default to ACK_ERROR_NO_EXIST
   // Map common error conditions to appropriate MPD error codes
-  if (message.indexOf("argument") != -1 || message.indexOf("missing") != -1 || message.indexOf("range") != -1) {
+  if (strstr(message, "argument") || strstr(message, "missing") || strstr(message, "range")) {
     errorCode = 2; // ACK_ERROR_ARG
-  } else if (message.indexOf("command list") != -1) {
+  } else if (strstr(message, "command list")) {
     errorCode = 1; // ACK_ERROR_NOT_LIST
-  } else if (message.indexOf("unknown") != -1) {
+  } else if (strstr(message, "unknown")) {
     errorCode = 0; // ACK_ERROR_UNKNOWN
   }
+  // Errors end command lists, report the position of the failed command
+  int index = 0;
+  if (session) {
+    session->commandFailed = true;
+    if (session->inCommandList) {
+      index = session->commandListCount;
+    }
+  }
   // Format the error response according to MPD specification
-  return "ACK [" + String(errorCode) + "@0] {" + command + "} " + message + "\n";
+  return "ACK [" + String(errorCode) + "@" + String(index) + "] {" + command + "} " + message + "\n";
 }
 
 /**
@@ -2011,148 +3008,293 @@ String MPDInterface::mpdResponseError(const String& command, const String& messa
  */
 void MPDInterface::sendPlaylistInfo(int detailLevel) {
   for (int i = 0; i < min(this->player.getPlaylistCount(), MAX_PLAYLIST_SIZE); i++) {
-    const StreamInfo& item = this->player.getPlaylistItem(i);
-    mpdClient.print("file: " + String(item.url) + "\n");
-    mpdClient.print("Title: " + String(item.name) + "\n");
-    if (detailLevel >= 3) {
-      // Artist/Album detail level
-      mpdClient.print("Artist: WebRadio\n");
-      mpdClient.print("Album: WebRadio\n");
-    }
-    if (detailLevel >= 2) {
-      // Full detail level
-      mpdClient.print("Id: " + String(i) + "\n");
-      mpdClient.print("Pos: " + String(i) + "\n");
-    }
-    if (detailLevel >= 1) {
-      // Simple detail level
-      mpdClient.print("Track: " + String(i + 1) + "\n");
-      mpdClient.print("Last-Modified: " + String(BUILD_TIME) + "\n");
-    }
+    sendPlaylistItem(i, detailLevel);
   }
 }
 
 /**
- * @brief Handle MPD search/find commands
- * @details Processes search and find commands with partial or exact matching in stream names.
- * The function parses the search criteria and filters the playlist entries based on
- * the specified matching mode (partial for search, exact for find).
- * 
- * Command format examples:
- * - search "Title" "search term"
- * - find "Artist" "exact artist name"
- * 
- * Special handling is implemented for artist/album searches which return
- * simple playlist information rather than filtered results.
- * 
- * Search is case-insensitive and handles quoted strings properly.
- * 
- * The function implements proper parsing of search commands:
- * - Extracts search filter and term from command string
- * - Handles quoted strings with proper quote removal
- * - Performs case-insensitive comparison
- * - Supports both partial (search) and exact (find) matching
- * 
- * Search algorithm implements efficient string matching:
- * - Case-insensitive comparison by converting to lowercase
- * - Exact matching for 'find' commands (strcmp equivalent)
- * - Partial matching for 'search' commands (strstr equivalent)
- * - Special handling for artist/album tags (returns all entries)
- * - Proper metadata formatting for matched entries
- * 
- * @param command The full command string
- * @param exactMatch Whether to perform exact matching (find) or partial matching (search)
+ * @brief Send one playlist entry
+ * @param index Playlist position
+ * @param detailLevel Detail level, see sendPlaylistInfo()
  */
-void MPDInterface::handleMPDSearchCommand(const String& args, bool exactMatch) {
-  // Validate arguments length
-  if (args.length() > 200) { // Reasonable limit for search arguments
-    mpdClient.print(mpdResponseError("search/find", "Arguments too long"));
-    return;
+void MPDInterface::sendPlaylistItem(int index, int detailLevel) {
+  const StreamInfo& item = this->player.getPlaylistItem(index);
+  session->out.printf("file: %s\nTitle: %s\n", item.url, item.name);
+  if (detailLevel >= 3) {
+    // Artist/Album detail level
+    session->out.print("Artist: WebRadio\nAlbum: WebRadio\n");
   }
-  // Extract search filter and term
-  String searchFilter = args;
-  searchFilter.trim();
-  String searchTerm;
-  // Validate that we have arguments
-  if (searchFilter.length() == 0) {
-    mpdClient.print(mpdResponseError("search/find", "Missing search arguments"));
-    return;
+  if (detailLevel >= 2) {
+    // Full detail level
+    session->out.printf("Id: %d\nPos: %d\n", index, index);
   }
-  // Extract search filter (after the first space and before the next space)
-  int firstSpace = searchFilter.indexOf(' ');
-  if (firstSpace != -1) {
-    // Extract search term (everything after the next space)
-    searchTerm = searchFilter.substring(firstSpace + 1);
-    searchTerm.trim();
-    // Extract search filter (everything before the next space)
-    searchFilter = searchFilter.substring(0, firstSpace);
-    searchFilter.trim();
-  }
-  // Validate search filter and term
-  if (searchFilter.length() == 0) {
-    mpdClient.print(mpdResponseError("search/find", "Missing search filter"));
-    return;
+  if (detailLevel >= 1) {
+    // Simple detail level
+    session->out.printf("Track: %d\nLast-Modified: %s\n", index + 1, BUILD_TIME);
   }
-  // Check for search term
-  if (searchTerm.length() == 0) {
-    mpdClient.print(mpdResponseError("search/find", "Missing search term"));
-    return;
+}
+
+/**
+ * @brief Tags a search term can match
+ */
+enum SearchTag : uint8_t {
+  SEARCH_TAG_TITLE,     ///< Stream name (Title, Name)
+  SEARCH_TAG_FILE,      ///< Stream URL (file)
+  SEARCH_TAG_ANY,       ///< Stream name or URL (any)
+  SEARCH_TAG_WEBRADIO   ///< Artist and Album, always "WebRadio"
+};
+
+/**
+ * @brief Comparisons a search term can make
+ */
+enum SearchOp : uint8_t {
+  SEARCH_OP_EQUAL,        ///< ==, and the legacy find syntax
+  SEARCH_OP_NOT_EQUAL,    ///< !=
+  SEARCH_OP_CONTAINS,     ///< contains, and the legacy search syntax
+  SEARCH_OP_STARTS_WITH   ///< starts_with
+};
+
+/**
+ * @brief One condition of a search, all conditions must match
+ */
+struct SearchTerm {
+  SearchTag tag;                  ///< Tag to match
+  SearchOp op;                    ///< Comparison
+  char value[STREAM_NAME_SIZE];   ///< Value, folded with Playlist::foldSearchKey()
+};
+
+// Most conditions of one search command
+#define MAX_SEARCH_TERMS 4
+
+/**
+ * @brief Map a tag name to a search tag
+ * @param name Tag name, case insensitive
+ * @param tag Resulting search tag
+ * @return true if the tag can be searched
+ */
+static bool parseSearchTag(const char* name, SearchTag& tag) {
+  if (strcasecmp(name, "title") == 0 || strcasecmp(name, "name") == 0) {
+    tag = SEARCH_TAG_TITLE;
+  } else if (strcasecmp(name, "file") == 0) {
+    tag = SEARCH_TAG_FILE;
+  } else if (strcasecmp(name, "any") == 0) {
+    tag = SEARCH_TAG_ANY;
+  } else if (strcasecmp(name, "artist") == 0 || strcasecmp(name, "album") == 0) {
+    tag = SEARCH_TAG_WEBRADIO;
+  } else {
+    return false;
   }
-  // Validate search filter type
-  String lowerFilter = searchFilter;
-  lowerFilter.toLowerCase();
-  if (lowerFilter != "title" && lowerFilter != "artist" && lowerFilter != "album") {
-    mpdClient.print(mpdResponseError("search/find", "Unsupported search filter"));
-    return;
+  return true;
+}
+
+/**
+ * @brief Parse an MPD filter expression
+ * @details Supports "(TAG OP 'VALUE')" with the ==, !=, contains and
+ * starts_with operators, and "((EXPR) AND (EXPR) ...)". Values may be single
+ * or double quoted, backslash escapes the next character.
+ * @param p Parse position, advanced past the expression
+ * @param terms Array receiving the conditions
+ * @param count Number of conditions in the array
+ * @return true if the expression is valid and fits in MAX_SEARCH_TERMS
+ */
+static bool parseSearchFilter(const char*& p, SearchTerm* terms, int& count) {
+  while (*p == ' ') p++;
+  if (*p != '(') {
+    return false;
   }
-  // Remove quotes if present
-  if (searchFilter.startsWith("\"") && searchFilter.endsWith("\"") && searchFilter.length() >= 2) {
-    searchFilter = searchFilter.substring(1, searchFilter.length() - 1);
+  p++;
+  while (*p == ' ') p++;
+  if (*p == '(') {
+    // Conjunction of expressions
+    for (;;) {
+      if (!parseSearchFilter(p, terms, count)) {
+        return false;
+      }
+      while (*p == ' ') p++;
+      if (strncmp(p, "AND", 3) != 0) {
+        break;
+      }
+      p += 3;
+    }
+  } else {
+    if (count >= MAX_SEARCH_TERMS) {
+      return false;
+    }
+    SearchTerm& term = terms[count];
+    // Tag name
+    char word[16];
+    size_t len = strcspn(p, " ");
+    if (len == 0 || len >= sizeof(word)) {
+      return false;
+    }
+    memcpy(word, p, len);
+    word[len] = '\0';
+    p += len;
+    if (!parseSearchTag(word, term.tag)) {
+      return false;
+    }
+    while (*p == ' ') p++;
+    // Operator
+    len = strcspn(p, " ");
+    if (len == 2 && strncmp(p, "==", 2) == 0) {
+      term.op = SEARCH_OP_EQUAL;
+    } else if (len == 2 && strncmp(p, "!=", 2) == 0) {
+      term.op = SEARCH_OP_NOT_EQUAL;
+    } else if (len == 8 && strncmp(p, "contains", 8) == 0) {
+      term.op = SEARCH_OP_CONTAINS;
+    } else if (len == 11 && strncmp(p, "starts_with", 11) == 0) {
+      term.op = SEARCH_OP_STARTS_WITH;
+    } else {
+      return false;
+    }
+    p += len;
+    while (*p == ' ') p++;
+    // Quoted value
+    char quote = *p;
+    if (quote != '\'' && quote != '"') {
+      return false;
+    }
+    p++;
+    char value[STREAM_NAME_SIZE];
+    len = 0;
+    while (*p && *p != quote) {
+      if (*p == '\\' && p[1]) {
+        p++;
+      }
+      if (len + 1 >= sizeof(value)) {
+        return false;
+      }
+      value[len++] = *p++;
+    }
+    if (*p != quote) {
+      return false;
+    }
+    p++;
+    value[len] = '\0';
+    Playlist::foldSearchKey(value, term.value, sizeof(term.value));
+    count++;
   }
-  if (searchTerm.startsWith("\"") && searchTerm.endsWith("\"") && searchTerm.length() >= 2) {
-    searchTerm = searchTerm.substring(1, searchTerm.length() - 1);
+  while (*p == ' ') p++;
+  if (*p != ')') {
+    return false;
   }
-  // Validate search term length
-  if (searchTerm.length() == 0) {
-    mpdClient.print(mpdResponseError("search/find", "Empty search term"));
-    return;
+  p++;
+  return true;
+}
+
+/**
+ * @brief Compare a folded tag value with a search term
+ * @param text Folded tag value
+ * @param term Search term
+ * @return true if the condition holds
+ */
+static bool matchSearchValue(const char* text, const SearchTerm& term) {
+  switch (term.op) {
+    case SEARCH_OP_EQUAL:
+      return strcmp(text, term.value) == 0;
+    case SEARCH_OP_NOT_EQUAL:
+      return strcmp(text, term.value) != 0;
+    case SEARCH_OP_STARTS_WITH:
+      return strncmp(text, term.value, strlen(term.value)) == 0;
+    case SEARCH_OP_CONTAINS:
+    default:
+      return strstr(text, term.value) != nullptr;
   }
-  // Handle special cases for artist/album searches
-  if (lowerFilter == "album" || lowerFilter == "artist") {
-    sendPlaylistInfo(1); // Send simple info for album search
-    return;
+}
+
+/**
+ * @brief Handle MPD search/find commands
+ * @details Processes search and find commands over the playlist, using the
+ * search keys the Playlist keeps for every stream name, so nothing is
+ * lowercased or allocated per stream.
+ * 
+ * Command format examples:
+ * - search "(Title contains 'jazz')"
+ * - find "((Title == 'Radio Swiss Jazz') AND (file starts_with 'http://'))"
+ * - search Title "jazz" (legacy syntax, contains)
+ * - find Title "Radio Swiss Jazz" (legacy syntax, exact match)
+ * 
+ * Searchable tags are Title (or Name), file, any, and Artist/Album which
+ * are "WebRadio" for every stream. All values are compared case and accent
+ * insensitive, for both search and find.
+ * 
+ * @param args Command arguments
+ * @param exactMatch Whether the legacy syntax uses exact matching (find) or partial matching (search)
+ * @return true if the arguments were valid and the matches were sent
+ */
+bool MPDInterface::handleMPDSearchCommand(const char* args, bool exactMatch) {
+  const char* command = exactMatch ? "find" : "search";
+  // Validate arguments length
+  if (strlen(args) > 200) { // Reasonable limit for search arguments
+    session->out.print(mpdResponseError(command, "Arguments too long"));
+    return false;
   }
-  // Search in playlist names
-  for (int i = 0; i < this->player.getPlaylistCount(); i++) {
-    const StreamInfo& item = this->player.getPlaylistItem(i);
-    String playlistName = String(item.name);
-    // Validate playlist name
-    if (playlistName.length() == 0) {
-      continue;
+  SearchTerm terms[MAX_SEARCH_TERMS];
+  int count = 0;
+  char arg[208];
+  const char* next = nextArgument(args, arg, sizeof(arg));
+  if (!next) {
+    session->out.print(mpdResponseError(command, "Missing search arguments"));
+    return false;
+  }
+  if (arg[0] == '(') {
+    // Filter expression
+    const char* p = arg;
+    if (!parseSearchFilter(p, terms, count) || *p != '\0' || nextArgument(next, arg, sizeof(arg))) {
+      session->out.print(mpdResponseError(command, "Invalid filter expression"));
+      return false;
     }
-    // Convert both to lowercase for case-insensitive comparison
-    String lowerName = playlistName;
-    lowerName.toLowerCase();
-    String lowerSearch = searchTerm;
-    lowerSearch.toLowerCase();
-    // Determine if there's a match based on mode
-    bool match = false;
-    if (exactMatch) {
-      // Exact match for find command
-      match = (lowerName == lowerSearch);
-    } else {
-      // Partial match for search command
-      match = (lowerName.indexOf(lowerSearch) != -1);
+  } else {
+    // Legacy TAG VALUE pairs
+    do {
+      if (count >= MAX_SEARCH_TERMS || !parseSearchTag(arg, terms[count].tag)) {
+        session->out.print(mpdResponseError(command, "Unsupported search filter"));
+        return false;
+      }
+      next = nextArgument(next, arg, sizeof(arg));
+      if (!next) {
+        session->out.print(mpdResponseError(command, "Missing search term"));
+        return false;
+      }
+      terms[count].op = exactMatch ? SEARCH_OP_EQUAL : SEARCH_OP_CONTAINS;
+      Playlist::foldSearchKey(arg, terms[count].value, sizeof(terms[count].value));
+      count++;
+      next = nextArgument(next, arg, sizeof(arg));
+    } while (next);
+  }
+  // Check every stream against all conditions
+  const Playlist* playlist = this->player.getPlaylist();
+  char url[STREAM_URL_SIZE];
+  for (int i = 0; i < playlist->getCount(); i++) {
+    const char* title = playlist->getSearchKey(i);
+    url[0] = '\0';
+    bool match = true;
+    for (int t = 0; t < count && match; t++) {
+      const SearchTerm& term = terms[t];
+      // Stream URLs are only folded when a condition needs them
+      if (term.tag != SEARCH_TAG_TITLE && term.tag != SEARCH_TAG_WEBRADIO && url[0] == '\0') {
+        Playlist::foldSearchKey(playlist->getItem(i).url, url, sizeof(url));
+      }
+      switch (term.tag) {
+        case SEARCH_TAG_TITLE:
+          match = matchSearchValue(title, term);
+          break;
+        case SEARCH_TAG_FILE:
+          match = matchSearchValue(url, term);
+          break;
+        case SEARCH_TAG_ANY:
+          match = matchSearchValue(title, term) || matchSearchValue(url, term);
+          break;
+        case SEARCH_TAG_WEBRADIO:
+          match = matchSearchValue("webradio", term);
+          break;
+      }
     }
-    // If a match is found, send the metadata
     if (match) {
-      mpdClient.print("file: " + String(item.url) + "\n");
-      mpdClient.print("Title: " + String(item.name) + "\n");
-      mpdClient.print("Track: " + String(i + 1) + "\n");
-      mpdClient.print("Last-Modified: " + String(BUILD_TIME) + "\n");
+      sendPlaylistItem(i, 1);
     }
-    yield(); // Allow other tasks to run
   }
+  return true;
 }
 
 /**
@@ -2173,7 +3315,9 @@ void MPDInterface::handleMPDSearchCommand(const String& args, bool exactMatch) {
  * 
  * @param command The command string to process
  */
-void MPDInterface::handleMPDCommand(const String& command) {
+void MPDInterface::handleMPDCommand(const char* command) {
+  // Commands run with the player locked, so they see and leave it consistent
+  PlayerLock guard(this->player);
   executeCommand(command);
 }
 
@@ -2183,16 +3327,11 @@ void MPDInterface::handleMPDCommand(const String& command) {
  * a registry-based approach for better organization and maintainability. Commands 
  * are mapped to handler functions using a lookup table for efficient command dispatch.
  * 
- * The function implements command matching with support for both exact and prefix matching:
- * - Exact matching for commands like "stop", "status", etc.
- * - Prefix matching for commands like "play" that need to handle "playid" as well
- * 
- * Command argument extraction is handled automatically based on the matching type:
- * - For exact matches, all remaining text is treated as arguments
- * - For prefix matches, text after the command name (plus space) is treated as arguments
+ * The command name is the first whitespace separated token and must match a
+ * registry entry exactly; the rest of the line is passed to the handler.
  * 
  * The function implements proper command dispatch following MPD protocol requirements:
- * - Efficient O(n) lookup where n is the number of registered commands
+ * - O(log n) binary search lookup where n is the number of registered commands
  * - Proper argument parsing and passing to handlers
  * - Standardized error handling for unknown commands
  * - Special handling for empty commands (returns OK)
@@ -2200,37 +3339,72 @@ void MPDInterface::handleMPDCommand(const String& command) {
  * @param command The command string to execute
  * @return true if command was found and executed, false otherwise
  */
-bool MPDInterface::executeCommand(const String& command) {
+bool MPDInterface::executeCommand(const char* command) {
   // Validate command string
-  if (command.length() == 0) {
-    mpdClient.print(mpdResponseOK());
+  if (command[0] == '\0') {
+    session->out.print(mpdResponseOK());
     return true;
   }
-  // Search for matching command in registry
-  for (size_t i = 0; i < commandCount; i++) {
-    // Yield to allow other tasks to run
-    yield();
-    const MPDCommand& cmd = commandRegistry[i];
-    // Check for exact or prefix match
-    if (cmd.exactMatch) {
-      if (command.equals(cmd.name)) {
-        (this->*cmd.handler)("");
-        return true;
-      }
-    } else {
-      if (command.startsWith(cmd.name)) {
-        // Extract arguments (everything after the command name)
-        String args = "";
-        if (command.length() > strlen(cmd.name)) {
-          // +1 for space
-          args = command.substring(strlen(cmd.name) + 1);
-        }
-        (this->*cmd.handler)(args);
-        return true;
-      }
+  // The command name is the first token, arguments follow after whitespace
+  size_t nameLen = strcspn(command, " \t");
+  const MPDCommand* cmd = findCommand(command, nameLen);
+  if (cmd) {
+    const char* args = command + nameLen;
+    while (*args == ' ' || *args == '\t') {
+      args++;
     }
+    (this->*cmd->handler)(args);
+    return true;
   }
   // Unknown command
-  mpdClient.print(mpdResponseError(command, "Unknown command"));
+  session->out.print(mpdResponseError(command, "Unknown command"));
   return false;
 }
+
+/**
+ * @brief Look up a command in the registry
+ * @details Binary search over the sorted registry, comparing the token with
+ * each name up to the token length and then checking that the name ends there
+ * too, so only exact matches are found.
+ * @param name Command name, not necessarily NUL-terminated
+ * @param len Length of the command name
+ * @return Registry entry, or nullptr if the command is unknown
+ */
+const MPDInterface::MPDCommand* MPDInterface::findCommand(const char* name, size_t len) {
+  size_t lo = 0;
+  size_t hi = commandCount;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    const char* entry = commandRegistry[mid].name;
+    int cmp = strncmp(entry, name, len);
+    if (cmp == 0 && entry[len] != '\0') {
+      // The entry is longer, so it sorts after the token
+      cmp = 1;
+    }
+    if (cmp == 0) {
+      return &commandRegistry[mid];
+    } else if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Check that the registry is sorted, as findCommand() needs
+ * @details Run once by the constructor, so a new command added at the
+ * wrong position stops a debug build at startup and is logged otherwise.
+ * @return true if sorted, false after logging the first misplaced entry
+ */
+bool MPDInterface::checkCommandRegistry() {
+  for (size_t i = 1; i < commandCount; i++) {
+    if (strcmp(commandRegistry[i - 1].name, commandRegistry[i].name) >= 0) {
+      Serial.printf("ERROR: MPD command \"%s\" is out of order in the registry\n",
+                    commandRegistry[i].name);
+      return false;
+    }
+  }
+  return true;
+}
@@ -27,6 +27,8 @@
 
 // Forward declarations
 #include "playlist.h"
+#include "player.h"
+#include "artcache.h"
 class Player;
 
 // External global variables
@@ -40,6 +42,184 @@ extern void savePlayerState();
 // Forward declaration for argument parser
 class MPDArgumentParser;
 
+// Maximum number of simultaneous MPD client connections
+#ifndef MPD_MAX_CLIENTS
+#define MPD_MAX_CLIENTS 4
+#endif
+
+// MPD task settings
+#ifndef MPD_TASK_PRIORITY
+#define MPD_TASK_PRIORITY 3        ///< Above loop() (1), below the audio task (5)
+#endif
+#ifndef MPD_TASK_STACK_SIZE
+#define MPD_TASK_STACK_SIZE 8192   ///< Stack size in bytes
+#endif
+#ifndef MPD_TASK_CORE
+#define MPD_TASK_CORE 1            ///< Same core as loop(), the audio task runs on core 0
+#endif
+#ifndef MPD_TASK_POLL_MS
+#define MPD_TASK_POLL_MS 10        ///< Longest wait for new connections and player events
+#endif
+
+// Default time budget for draining pipelined commands, in milliseconds
+#ifndef DEFAULT_MPD_BUDGET
+#define DEFAULT_MPD_BUDGET 5
+#endif
+
+// Default limits of a client connection, changed through /api/config
+#ifndef DEFAULT_MPD_TIMEOUT
+#define DEFAULT_MPD_TIMEOUT 60       ///< Seconds without traffic before a client is dropped, 0 = never
+#endif
+#ifndef DEFAULT_MPD_QUEUE
+#define DEFAULT_MPD_QUEUE 16384      ///< Bytes of unsent responses a client may have
+#endif
+#ifndef DEFAULT_MPD_KEEPALIVE
+#define DEFAULT_MPD_KEEPALIVE 30     ///< Seconds of silence before TCP keepalive probes, 0 = off
+#endif
+
+// Smallest send queue, whatever the configuration says
+#ifndef MPD_MIN_QUEUE
+#define MPD_MIN_QUEUE 4096
+#endif
+
+// Size of the per-session input buffer, also the longest accepted command line
+#ifndef MPD_LINE_BUFFER_SIZE
+#define MPD_LINE_BUFFER_SIZE 512
+#endif
+
+// Size of the per-session response buffer, one TCP segment on the ESP32
+#ifndef MPD_RESPONSE_BUFFER_SIZE
+#define MPD_RESPONSE_BUFFER_SIZE 1436
+#endif
+
+// Default largest binary chunk (albumart, readpicture), clients may change it
+#ifndef MPD_BINARY_LIMIT
+#define MPD_BINARY_LIMIT 8192
+#endif
+
+/**
+ * @brief Buffered MPD response writer
+ * @details Collects the lines of a response in a fixed buffer and sends them
+ * to the client with a single write when flushed, or whenever the buffer
+ * fills up. Handlers write many short lines; going through this buffer turns
+ * them into as few TCP segments as possible instead of one per line.
+ *
+ * Writes never block: what the socket does not take right away waits in a
+ * send queue, drained by later handleClient() passes. The queue holds at
+ * most config.mpd_queue bytes; a client that lets it overflow has stopped
+ * reading and is marked broken, to be disconnected.
+ */
+class MPDResponseWriter : public Print {
+public:
+  explicit MPDResponseWriter(WiFiClient& clientRef) : client(clientRef) {}
+  ~MPDResponseWriter() { free(queue); }
+
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t size) override;
+
+  /**
+   * @brief Format directly into the response buffer
+   * @param format printf style format
+   * @return Number of characters written
+   */
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  /**
+   * @brief Send the buffered data to the client, queueing what does not fit
+   */
+  void flush() override;
+
+  /**
+   * @brief Send queued data without blocking
+   * @return Number of bytes sent
+   */
+  size_t drain();
+
+  /**
+   * @brief Get the amount of data waiting in the send queue
+   * @return Number of bytes
+   */
+  size_t queued() const { return queueLength; }
+
+  /**
+   * @brief Check if the connection has to be dropped
+   * @return true if the send queue overflowed or the socket failed
+   */
+  bool isBroken() const { return broken; }
+
+  /**
+   * @brief Drop the buffered and queued data without sending it
+   */
+  void clear();
+
+private:
+  WiFiClient& client;                       ///< Connection the data is sent to
+  char buffer[MPD_RESPONSE_BUFFER_SIZE];    ///< Pending response data
+  size_t length = 0;                        ///< Number of bytes in the buffer
+  uint8_t* queue = nullptr;                 ///< Data the socket did not take yet
+  size_t queueLength = 0;                   ///< Number of bytes in the queue
+  size_t queueCapacity = 0;                 ///< Allocated size of the queue
+  bool broken = false;                      ///< Queue overflow or socket error
+
+  size_t send(const uint8_t* data, size_t size);
+  bool enqueue(const uint8_t* data, size_t size);
+};
+
+/**
+ * @brief MPD client session
+ * @details Holds the protocol state of one client connection: the partially
+ * received command line, the command list being collected and the idle
+ * subscription. Every connection gets its own session so a client parked in
+ * idle or sending a slow command list does not affect the others.
+ */
+struct MPDSession {
+  WiFiClient client;                 ///< Client connection
+  MPDResponseWriter out{client};     ///< Buffered writer for the responses
+
+  // MPD command list state variables for batch command processing
+  bool inCommandList = false;        ///< Flag indicating if we're in command list mode
+  bool commandListOK = false;        ///< Flag indicating if we should send list_OK responses
+  bool commandListFailed = false;    ///< A command of the list failed, skip to its end
+  int commandListCount = 0;          ///< Number of commands executed in the current command list
+  bool commandFailed = false;        ///< The last command sent an ACK
+  bool playlistDirty = false;        ///< Playlist changed by the command list, save at its end
+  size_t binaryLimit = MPD_BINARY_LIMIT;  ///< Largest binary chunk sent, set by binarylimit
+  unsigned long lastActivity = 0;    ///< millis() of the last data received or sent
+
+  // MPD idle state variables for efficient change notification
+  bool inIdleMode = false;           ///< Flag indicating if we're in idle mode
+  uint8_t idleMask = 0;              ///< Player events the idle client waits for
+  uint8_t idleEvents = 0;            ///< Player events not yet reported to the client
+
+  // Input buffer, filled in bulk and split into lines in place
+  char lineBuffer[MPD_LINE_BUFFER_SIZE];  ///< Received data not yet processed
+  size_t lineLength = 0;             ///< Number of bytes in the line buffer
+  size_t lineStart = 0;              ///< Offset of the first unprocessed byte
+  bool discardLine = false;          ///< Flag indicating an overlong line is being skipped
+
+  /**
+   * @brief Reset the protocol state for a new or closed connection
+   */
+  void reset() {
+    inCommandList = false;
+    commandListOK = false;
+    commandListFailed = false;
+    commandListCount = 0;
+    commandFailed = false;
+    playlistDirty = false;
+    binaryLimit = MPD_BINARY_LIMIT;
+    lastActivity = millis();
+    inIdleMode = false;
+    idleMask = 0;
+    idleEvents = 0;
+    lineLength = 0;
+    lineStart = 0;
+    discardLine = false;
+    out.clear();
+  }
+};
+
 /**
  * @brief MPD Interface Class
  * @details Encapsulates all MPD protocol functionality for the CubeRadio.
@@ -59,45 +239,51 @@ class MPDArgumentParser;
 class MPDInterface {
 private:
   WiFiServer& mpdServer;             ///< WiFi server instance for MPD connections
-  WiFiClient mpdClient;              ///< Current MPD client connection
 
   // Reference to player instance
   Player& player;                    ///< Reference to Player instance
+  ArtCache& artCache;                ///< Reference to the station art cache
 
-  // MPD command list state variables for batch command processing
-  static const int MAX_COMMAND_LIST_SIZE = 20;  ///< Maximum number of commands in a command list
-  String commandList[MAX_COMMAND_LIST_SIZE];    ///< Buffer for command list
-  bool inCommandList = false;        ///< Flag indicating if we're in command list mode
-  bool commandListOK = false;        ///< Flag indicating if we should send list_OK responses
-  int commandListCount = 0;          ///< Number of commands in the current command list
+  // Client sessions, served round-robin
+  MPDSession sessions[MPD_MAX_CLIENTS];  ///< Per-connection protocol state
+  MPDSession* session = nullptr;     ///< Session whose command is being processed
+  int nextSession = 0;               ///< Session served first on the next handleClient() pass
 
-  // MPD idle state variables for efficient change notification
-  bool inIdleMode = false;           ///< Flag indicating if we're in idle mode
-  unsigned long lastTitleHash = 0;   ///< Hash of last stream title for change detection
-  unsigned long lastStatusHash = 0;  ///< Hash of last status for change detection
+  TaskHandle_t taskHandle = nullptr;  ///< MPD task, if started
+
+  // Player change events not yet handed to the sessions, set from any task
+  portMUX_TYPE eventLock = portMUX_INITIALIZER_UNLOCKED;
+  volatile uint8_t pendingEvents = 0;  ///< Bit mask of PLAYER_EVENT_* values
+
+  /**
+   * @brief Preformatted status and currentsong responses
+   * @details Valid while the player event versions, bitrate and playing
+   * flag stay the same, see refreshResponseCache().
+   */
+  struct ResponseCache {
+    bool valid = false;                          ///< The responses were built
+    uint32_t versions[PLAYER_EVENT_COUNT] = {0}; ///< Player event versions they reflect
+    int bitrate = 0;                             ///< Bitrate they reflect
+    bool playing = false;                        ///< Playing flag they reflect
+    uint32_t sampleRate = 0;                     ///< Audio format they reflect
+    uint8_t bitsPerSample = 0;
+    uint8_t channels = 0;
+    char status[320];                            ///< status response, without elapsed and OK
+    size_t statusLength = 0;                     ///< Length of the status response
+    size_t elapsedOffset = 0;                    ///< Where the elapsed line goes, 0 if none
+    char currentSong[640];                       ///< currentsong response, without OK
+    size_t currentSongLength = 0;                ///< Length of the currentsong response
+  };
+  ResponseCache responseCache;       ///< Shared by all sessions, used from the MPD task only
 
-  // Asynchronous command handling buffer for non-blocking processing
-  String commandBuffer = "";         ///< Buffer for accumulating incoming commands
-  
   // Supported MPD commands list
   std::vector<std::string> supportedCommands;
   // Supported MPD tag types
   std::vector<std::string> supportedTagTypes;
 
-  // Command registry structure
-  struct MPDCommand {
-    const char* name;
-    void (MPDInterface::*handler)(const String& args);
-    bool exactMatch;  // true = exact match, false = prefix match
-  };
-  
-  // Command registry
-  static const MPDCommand commandRegistry[];
-  static const size_t commandCount;
-
 
 public:
-  MPDInterface(WiFiServer& serverRef, Player& playerRef);
+  MPDInterface(WiFiServer& serverRef, Player& playerRef, ArtCache& artCacheRef);
 
   /**
    * @brief Handle MPD client connections and process commands
@@ -107,16 +293,60 @@ public:
    * client disconnections and ensures proper cleanup.
    * 
    * Connection handling:
-   * - Accepts new connections when no client is connected
-   * - Rejects new connections when a client is already connected
-   * - Properly closes disconnected clients
+   * - Accepts new connections into a free session slot (up to MPD_MAX_CLIENTS)
+   * - Rejects new connections when all slots are in use
+   * - Properly closes disconnected clients and frees their slot
    * 
-   * In idle mode, the function monitors for changes in playback status and stream
-   * information, sending notifications to clients when changes occur.
+   * Connected sessions are served round-robin, one command each per round, so a
+   * client that is idle or sends a long command list never delays the others.
+   * Rounds repeat while complete commands are pending, for up to
+   * config.mpd_budget milliseconds, so pipelined commands are drained in a
+   * single call; with a zero budget each session gets one command per call.
+   * Each session's responses are then sent with a single write that never
+   * blocks; what does not fit in the socket is queued, see MPDResponseWriter.
+   * Idle clients are sent the player changes they wait for.
+   * 
+   * @return true if commands are still waiting because the budget ran out
+   */
+  bool handleClient();
+
+  /**
+   * @brief Start the MPD task
+   * @return true if the task was created, false if loop() has to call handleClient()
+   */
+  bool startTask();
+
+  /**
+   * @brief Check if the MPD server runs in its own task
+   * @return true if the MPD task was started
+   */
+  bool isTaskRunning() const { return taskHandle != nullptr; }
+
+  // Command registry entry
+  struct MPDCommand {
+    const char* name;
+    void (MPDInterface::*handler)(const char* args);
+  };
+
+  /**
+   * @brief Look up a command in the registry
+   * @param name Command name, not necessarily NUL-terminated
+   * @param len Length of the command name
+   * @return Registry entry, or nullptr if the command is unknown
    */
-  void handleClient();
+  static const MPDCommand* findCommand(const char* name, size_t len);
+
+  /**
+   * @brief Check that the registry is sorted, as findCommand() needs
+   * @return true if sorted, false after logging the first misplaced entry
+   */
+  static bool checkCommandRegistry();
 
 private:
+  // Command registry, sorted by name
+  static const MPDCommand commandRegistry[];
+  static const size_t commandCount;
+
   /**
    * @brief Handle asynchronous command processing
    * @details Processes commands without blocking, allowing for better responsiveness.
@@ -124,10 +354,19 @@ private:
    * it in a buffer until a complete command (terminated by newline) is received.
    * It then processes the command according to the current mode (normal, command list, etc.).
    * 
-   * The function processes only one command per call to avoid blocking other operations,
-   * which is important for maintaining responsive MPD service.
+   * Each call processes one command line. handleClient() keeps calling it
+   * while pipelined commands are buffered, until the mpd_budget time budget
+   * of the pass is used up, and leaves the rest for the next pass.
+   * 
+   * @return true if a command line was consumed, false if none was complete
    */
-  void handleAsyncCommands();
+  bool handleAsyncCommands();
+
+  /**
+   * @brief Read the next complete command line of the current session
+   * @return Pointer to the line inside the session buffer, or nullptr
+   */
+  char* readLine();
 
   /**
    * @brief Handle playback command
@@ -141,37 +380,106 @@ private:
   bool handlePlayback(int index = -1);
 
   /**
-   * @brief Handle idle mode monitoring and notifications
-   * @details Monitors for changes in playback status and stream information using
-   * hash-based change detection for efficient monitoring.
-   * 
-   * Change detection works by computing hash values of the monitored data:
-   * - Title hash: Computed from the stream title string
-   * - Status hash: Computed from playing status, volume, and bitrate
-   * 
-   * When changes are detected, appropriate MPD idle notifications are sent:
-   * - "changed: playlist" for title changes
-   * - "changed: player" and "changed: mixer" for status changes
+   * @brief Handle idle mode notifications
+   * @details Sends the pending player change events the idle client waits for:
+   * - "changed: player" for playback state, stream and stream title changes
+   * - "changed: mixer" for volume and tone changes
+   * - "changed: playlist" for playlist edits
    * 
    * The function also handles the noidle command to exit idle mode.
+   * 
+   * @return true if a command line was consumed, false otherwise
    */
-  void handleIdleMode();
+  bool handleIdleMode();
+
+  /**
+   * @brief Report pending changes to an idle client
+   * @return true if the changes were sent, false if there was nothing to report
+   */
+  bool sendIdleChanges();
+
+  /**
+   * @brief Player change event listener
+   * @param events Bit mask of PLAYER_EVENT_* values
+   * @param context The MPDInterface instance
+   */
+  static void onPlayerEvent(uint8_t events, void* context);
+
+  /**
+   * @brief MPD task function
+   * @param parameters The MPDInterface instance
+   */
+  static void mpdTask(void* parameters);
+
+  /**
+   * @brief Wait for data from any client
+   * @param timeoutMs Longest wait in milliseconds
+   */
+  void waitForActivity(unsigned long timeoutMs);
+
+  /**
+   * @brief Disconnect a session and free its slot
+   * @param s Session to close
+   * @param reason Reason logged, nullptr if the client left by itself
+   */
+  void closeSession(MPDSession& s, const char* reason);
+
+  /**
+   * @brief Rebuild the status and currentsong responses if the player changed
+   */
+  void refreshResponseCache();
 
   /**
    * @brief Handle command list processing
    * @details Processes commands in command list mode with support for both
    * command_list_begin and command_list_ok_begin modes.
    * 
-   * In command_list_begin mode, commands are buffered until command_list_end
-   * is received, then all commands are executed sequentially.
+   * Commands are executed as they arrive and only their responses are
+   * buffered, so lists are not limited in length. The first failing command
+   * ends the list with an ACK carrying its position.
    * 
    * In command_list_ok_begin mode, each command receives a "list_OK" response
-   * except the last which receives a standard "OK" response.
-   * 
-   * The function implements a safety limit of 50 commands to prevent memory issues.
+   * and command_list_end a standard "OK" response.
    * @param command The command to process
    */
-  void handleCommandList(const String& command);
+  void handleCommandList(const char* command);
+
+  /**
+   * @brief Finish the current command list
+   * @details Saves the playlist once if any command of the list changed it
+   * and sends the final OK, unless a command failed.
+   */
+  void endCommandList();
+
+  /**
+   * @brief Persist a playlist change made by an MPD command
+   * @details Saves right away, or marks the playlist for saving at
+   * command_list_end inside a command list.
+   */
+  void playlistChanged();
+
+  /**
+   * @brief Add a stream to the playlist (add, addid)
+   * @param command Command name, used in the responses
+   * @param args Stream URL and optional position
+   * @param reportId Send the "Id" of the new stream
+   */
+  void addStream(const char* command, const char* args, bool reportId);
+
+  /**
+   * @brief Remove a position or range of streams (delete, deleteid)
+   * @param command Command name, used in the responses
+   * @param args Position or START:END range
+   */
+  void removeStreams(const char* command, const char* args);
+
+  /**
+   * @brief Send one chunk of the art of a stream (albumart, readpicture)
+   * @param command Command name, used in the responses
+   * @param args Stream URI and byte offset
+   * @param withType Send the MIME type, as readpicture does
+   */
+  void sendArt(const char* command, const char* args, bool withType);
 
   /**
    * @brief Generate MPD OK response
@@ -181,20 +489,20 @@ private:
    * - In command list mode with list_OK disabled: returns empty string for intermediate responses
    * @return OK response string
    */
-  String mpdResponseOK();
+  const char* mpdResponseOK();
 
   /**
    * @brief Generate MPD error response
    * @details Generates a properly formatted MPD error response following the
    * MPD protocol specification: ACK [error_code@command_list_num] {current_command} message
    * 
-   * This implementation uses error code 5 (ACK_ERROR_NO_EXIST) and command list
-   * number 0 as these are appropriate for most general errors.
+   * The error code is derived from the message, the command list number is
+   * the position of the failed command in the current command list.
    * @param command The command that caused the error
    * @param message Error message
    * @return Error response string in MPD format
    */
-  String mpdResponseError(const String& command, const String& message);
+  String mpdResponseError(const char* command, const char* message);
 
   /**
    * @brief Send playlist information with configurable detail level
@@ -217,24 +525,44 @@ private:
    */
   void sendPlaylistInfo(int detailLevel);
 
+  /**
+   * @brief Send one playlist entry
+   * @details Same fields as sendPlaylistInfo() for the given detail level.
+   * @param index Playlist position
+   * @param detailLevel Detail level, see sendPlaylistInfo()
+   */
+  void sendPlaylistItem(int index, int detailLevel);
+
+  /**
+   * @brief Parse the plchanges/plchangesposid arguments
+   * @details Arguments are a playlist version and an optional START:END
+   * position range, END being exclusive and optional. Sends an ACK and
+   * returns false on malformed arguments.
+   * @param command Command name, used in the error response
+   * @param args Command arguments
+   * @param version Parsed client playlist version
+   * @param start First position to report
+   * @param end Position after the last one to report
+   * @return true if the arguments are valid
+   */
+  bool parsePlChangesArgs(const char* command, const char* args, uint32_t& version, int& start, int& end);
+
   /**
    * @brief Handle MPD search/find commands
-   * @details Processes search and find commands with partial or exact matching in stream names.
-   * The function parses the search criteria and filters the playlist entries based on
-   * the specified matching mode (partial for search, exact for find).
+   * @details Processes search and find commands over the playlist search keys.
    * 
    * Command format examples:
-   * - search "Title" "search term"
-   * - find "Artist" "exact artist name"
+   * - search "(Title contains 'search term')"
+   * - find "((Title == 'name') AND (file starts_with 'https://'))"
+   * - search Title "search term" (legacy syntax, partial match)
+   * - find Title "exact name" (legacy syntax, exact match)
    * 
-   * Special handling is implemented for artist/album searches which return
-   * simple playlist information rather than filtered results.
-   * 
-   * Search is case-insensitive and handles quoted strings properly.
-   * @param command The full command string
-   * @param exactMatch Whether to perform exact matching (find) or partial matching (search)
+   * Search is case and accent insensitive and handles quoted strings properly.
+   * @param args Command arguments
+   * @param exactMatch Whether the legacy syntax uses exact matching (find) or partial matching (search)
+   * @return true if the arguments were valid and the matches were sent
    */
-  void handleMPDSearchCommand(const String& command, bool exactMatch);
+  bool handleMPDSearchCommand(const char* args, bool exactMatch);
 
   /**
    * @brief Handle MPD commands
@@ -264,7 +592,7 @@ private:
    * - System: ping, commands, notcommands, tagtypes, outputs
    * - Special modes: idle, noidle, command lists
    */
-  void handleMPDCommand(const String& command);
+  void handleMPDCommand(const char* command);
   
   /**
    * @brief Execute command using registry lookup
@@ -272,64 +600,69 @@ private:
    * a registry-based approach for better organization and maintainability. Commands 
    * are mapped to handler functions using a lookup table for efficient command dispatch.
    * 
-   * The function implements command matching with support for both exact and prefix matching:
-   * - Exact matching for commands like "stop", "status", etc.
-   * - Prefix matching for commands like "play" that need to handle "playid" as well
-   * 
-   * Command argument extraction is handled automatically based on the matching type:
-   * - For exact matches, all remaining text is treated as arguments
-   * - For prefix matches, text after the command name (plus space) is treated as arguments
+   * The command name is the first whitespace separated token and is looked up
+   * in the sorted registry with a binary search, so dispatch costs O(log n)
+   * comparisons and only exact names match ("play" never catches "playid").
+   * The rest of the line, without the leading whitespace, is passed to the
+   * handler as arguments.
    * 
    * @param command The command string to execute
    * @return true if command was found and executed, false otherwise
    */
-  bool executeCommand(const String& command);
+  bool executeCommand(const char* command);
 
   // Individual command handlers
-  void handleStopCommand(const String& args);
-  void handleStatusCommand(const String& args);
-  void handleCurrentSongCommand(const String& args);
-  void handlePlaylistInfoCommand(const String& args);
-  void handlePlaylistIdCommand(const String& args);
-  void handlePlayCommand(const String& args);
-  void handleLsInfoCommand(const String& args);
-  void handleSetVolCommand(const String& args);
-  void handleGetVolCommand(const String& args);
-  void handleVolumeCommand(const String& args);
-  void handleNextCommand(const String& args);
-  void handlePreviousCommand(const String& args);
-  void handleClearCommand(const String& args);
-  void handleAddCommand(const String& args);
-  void handleDeleteCommand(const String& args);
-  void handleLoadCommand(const String& args);
-  void handleSaveCommand(const String& args);
-  void handleOutputsCommand(const String& args);
-  void handleDisableOutputCommand(const String& args);
-  void handleEnableOutputCommand(const String& args);
-  void handleCommandsCommand(const String& args);
-  void handleNotCommandsCommand(const String& args);
-  void handleStatsCommand(const String& args);
-  void handlePingCommand(const String& args);
-  void handlePasswordCommand(const String& args);
-  void handleKillCommand(const String& args);
-  void handleUpdateCommand(const String& args);
-  void handleListAllInfoCommand(const String& args);
-  void handleListPlaylistInfoCommand(const String& args);
-  void handleListPlaylistsCommand(const String& args);
-  void handleListCommand(const String& args);
-  void handleSearchCommand(const String& args);
-  void handleFindCommand(const String& args);
-  void handleSeekCommand(const String& args);
-  void handleSeekIdCommand(const String& args);
-  void handleTagTypesCommand(const String& args);
-  void handlePlChangesCommand(const String& args);
-  void handleIdleCommand(const String& args);
-  void handleNoIdleCommand(const String& args);
-  void handleCloseCommand(const String& args);
-  void handleCommandListBeginCommand(const String& args);
-  void handleCommandListOkBeginCommand(const String& args);
-  void handleCommandListEndCommand(const String& args);
-  void handleDecodersCommand(const String& args);
+  void handleStopCommand(const char* args);
+  void handleStatusCommand(const char* args);
+  void handleCurrentSongCommand(const char* args);
+  void handlePlaylistInfoCommand(const char* args);
+  void handlePlaylistIdCommand(const char* args);
+  void handlePlayCommand(const char* args);
+  void handleLsInfoCommand(const char* args);
+  void handleSetVolCommand(const char* args);
+  void handleGetVolCommand(const char* args);
+  void handleVolumeCommand(const char* args);
+  void handleNextCommand(const char* args);
+  void handlePreviousCommand(const char* args);
+  void handleClearCommand(const char* args);
+  void handleAddCommand(const char* args);
+  void handleAddIdCommand(const char* args);
+  void handleDeleteIdCommand(const char* args);
+  void handleMoveCommand(const char* args);
+  void handleAlbumArtCommand(const char* args);
+  void handleReadPictureCommand(const char* args);
+  void handleBinaryLimitCommand(const char* args);
+  void handleDeleteCommand(const char* args);
+  void handleLoadCommand(const char* args);
+  void handleSaveCommand(const char* args);
+  void handleOutputsCommand(const char* args);
+  void handleDisableOutputCommand(const char* args);
+  void handleEnableOutputCommand(const char* args);
+  void handleCommandsCommand(const char* args);
+  void handleNotCommandsCommand(const char* args);
+  void handleStatsCommand(const char* args);
+  void handlePingCommand(const char* args);
+  void handlePasswordCommand(const char* args);
+  void handleKillCommand(const char* args);
+  void handleUpdateCommand(const char* args);
+  void handleListAllInfoCommand(const char* args);
+  void handleListPlaylistInfoCommand(const char* args);
+  void handleListPlaylistsCommand(const char* args);
+  void handleListCommand(const char* args);
+  void handleSearchCommand(const char* args);
+  void handleFindCommand(const char* args);
+  void handleSeekCommand(const char* args);
+  void handleSeekIdCommand(const char* args);
+  void handleTagTypesCommand(const char* args);
+  void handlePlChangesCommand(const char* args);
+  void handlePlChangesPosIdCommand(const char* args);
+  void handleIdleCommand(const char* args);
+  void handleNoIdleCommand(const char* args);
+  void handleCloseCommand(const char* args);
+  void handleCommandListBeginCommand(const char* args);
+  void handleCommandListOkBeginCommand(const char* args);
+  void handleCommandListEndCommand(const char* args);
+  void handleDecodersCommand(const char* args);
 };
 
 #endif // MPD_H
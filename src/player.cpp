@@ -26,6 +26,9 @@
  * @brief Player constructor
  */
 Player::Player() {
+  // The audio task, the MPD task and loop() all change the player
+  mutex = xSemaphoreCreateRecursiveMutex();
+  saveMutex = xSemaphoreCreateRecursiveMutex();
   audio = nullptr;
   playlist = new Playlist();
   // Initialize player state with defaults
@@ -34,11 +37,191 @@ Player::Player() {
   clearStreamInfo();
 }
 
+/**
+ * @brief Take the player mutex
+ * @details The mutex is recursive, so a task holding it can call any other
+ * player method. Every method that changes the player state takes it.
+ * 
+ * The audio task does not take it while decoding. It only talks to the
+ * player through the spinlock guarded audio request and statistics, so a
+ * slow holder never starves the I2S output.
+ */
+void Player::lock() {
+  if (mutex) {
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+  }
+  lockDepth++;
+}
+
+/**
+ * @brief Release the player mutex
+ * @details The files asked for by savePlayerState() and savePlaylist() are
+ * written here, when the outermost holder lets go: the state is copied
+ * while still locked and written to SPIFFS after the mutex is given back,
+ * so the other tasks do not wait for the flash.
+ */
+void Player::unlock() {
+  if (--lockDepth > 0 || pendingSaves == 0) {
+    if (mutex) {
+      xSemaphoreGiveRecursive(mutex);
+    }
+    return;
+  }
+  uint8_t saves = pendingSaves;
+  pendingSaves = 0;
+  DynamicJsonDocument state(PLAYER_STATE_BUFFER_SIZE);
+  DynamicJsonDocument list(PLAYLIST_BUFFER_SIZE);
+  uint32_t stateVersion = 0;
+  uint32_t listVersion = 0;
+  if (saves & PLAYER_SAVE_STATE) {
+    serializePlayerState(state);
+    stateVersion = ++saveVersions[0];
+    resetDirty();
+  }
+  if (saves & PLAYER_SAVE_PLAYLIST) {
+    playlist->serialize(list);
+    listVersion = ++saveVersions[1];
+  }
+  if (mutex) {
+    xSemaphoreGiveRecursive(mutex);
+  }
+  if (stateVersion) {
+    writeSnapshot("/player.json", state, 0, stateVersion);
+  }
+  if (listVersion) {
+    writeSnapshot("/playlist.json", list, 1, listVersion);
+  }
+}
+
+/**
+ * @brief Write a copy of the player state or playlist
+ * @details Copies are taken in order but may reach this point out of order
+ * when two tasks save at once, so an older copy is dropped if a newer one
+ * was written already.
+ * @param filename File to write
+ * @param doc Copy to write
+ * @param slot 0 for the player state, 1 for the playlist
+ * @param version Sequence number of the copy
+ */
+void Player::writeSnapshot(const char* filename, DynamicJsonDocument& doc, int slot, uint32_t version) {
+  xSemaphoreTakeRecursive(saveMutex, portMAX_DELAY);
+  if ((int32_t)(version - writtenVersions[slot]) > 0) {
+    if (writeJsonFile(filename, doc)) {
+      Serial.printf("Saved %s to SPIFFS\n", filename);
+      writtenVersions[slot] = version;
+    } else {
+      Serial.printf("Failed to save %s to SPIFFS\n", filename);
+    }
+  }
+  xSemaphoreGiveRecursive(saveMutex);
+}
+
+/**
+ * @brief Queue work for the audio task
+ * @details The Audio object is only used by the audio task, so starting,
+ * stopping and mixer changes are left there. A stop cancels a connection
+ * not started yet. Call with the player locked, the volume and tone are
+ * taken from the player state.
+ * @param flags AUDIO_REQUEST_* bits
+ * @param url URL to connect to, with AUDIO_REQUEST_CONNECT
+ */
+void Player::requestAudio(uint8_t flags, const char* url) {
+  portENTER_CRITICAL(&spinlock);
+  if (flags & AUDIO_REQUEST_STOP) {
+    audioRequest.flags &= ~AUDIO_REQUEST_CONNECT;
+  }
+  if ((flags & AUDIO_REQUEST_CONNECT) && url) {
+    strncpy(audioRequest.url, url, sizeof(audioRequest.url) - 1);
+    audioRequest.url[sizeof(audioRequest.url) - 1] = '\0';
+  }
+  if (flags & AUDIO_REQUEST_VOLUME) {
+    audioRequest.volume = playerState.outputEnabled ? playerState.volume : 0;
+  }
+  if (flags & AUDIO_REQUEST_TONE) {
+    audioRequest.bass = playerState.bass;
+    audioRequest.mid = playerState.mid;
+    audioRequest.treble = playerState.treble;
+  }
+  audioRequest.flags |= flags;
+  portEXIT_CRITICAL(&spinlock);
+}
+
+/**
+ * @brief Carry out the queued audio work, on the audio task
+ * @details The mixer is set before connecting, so a new stream starts with
+ * the right volume. connecttohost() blocks for the connection, but only this
+ * task waits for it.
+ */
+void Player::serviceAudioRequests() {
+  AudioRequest request;
+  portENTER_CRITICAL(&spinlock);
+  request.flags = audioRequest.flags;
+  if (request.flags) {
+    request = audioRequest;
+    audioRequest.flags = 0;
+    // Connecting counts as running, see isRunning()
+    if (request.flags & AUDIO_REQUEST_CONNECT) {
+      audioRunning = true;
+    }
+  }
+  portEXIT_CRITICAL(&spinlock);
+  if (request.flags == 0) {
+    return;
+  }
+  if (request.flags & AUDIO_REQUEST_STOP) {
+    audio->stopSong();
+  }
+  if (request.flags & AUDIO_REQUEST_VOLUME) {
+    audio->setVolume(request.volume);
+  }
+  if (request.flags & AUDIO_REQUEST_TONE) {
+    audio->setTone(request.bass, request.mid, request.treble);
+  }
+  if (request.flags & AUDIO_REQUEST_CONNECT) {
+    if (audio->connecttohost(request.url)) {
+      Serial.println("Successfully connected to audio stream");
+    } else {
+      Serial.println("Error: Failed to connect to audio stream");
+      connectFailed(request.url);
+    }
+  }
+  bool running = audio->isRunning();
+  portENTER_CRITICAL(&spinlock);
+  audioRunning = running;
+  portEXIT_CRITICAL(&spinlock);
+}
+
+/**
+ * @brief Stop playing after a failed connection
+ * @details Does nothing if another stream was asked for meanwhile.
+ * @param url URL that could not be played
+ */
+void Player::connectFailed(const char* url) {
+  PlayerLock guard(*this);
+  portENTER_CRITICAL(&spinlock);
+  bool replaced = (audioRequest.flags & AUDIO_REQUEST_STREAM) || strcmp(streamInfo.url, url) != 0;
+  portEXIT_CRITICAL(&spinlock);
+  if (replaced || !playerState.playing) {
+    return;
+  }
+  playerState.playing = false;
+  clearStreamInfo();
+  if (config.led_pin >= 0) {
+    digitalWrite(config.led_pin, LOW);
+  }
+  savePlayerState();
+  updateDisplay();
+  sendStatusToClients();
+  notify(PLAYER_EVENT_PLAYER);
+}
+
 /**
  * @brief Set playlist index with validation
  * @param index New playlist index
  */
 void Player::setPlaylistIndex(int index) {
+  PlayerLock guard(*this);
+  int oldIndex = playerState.playlistIndex;
   // If playlist is empty, index must be -1
   if (playlist->getCount() <= 0) {
     playerState.playlistIndex = -1;
@@ -50,6 +233,9 @@ void Player::setPlaylistIndex(int index) {
     // If index is out of bounds, set to 0 (first item)
     playerState.playlistIndex = 0;
   }
+  if (playerState.playlistIndex != oldIndex) {
+    notify(PLAYER_EVENT_PLAYER);
+  }
 }
 
 /**
@@ -57,25 +243,46 @@ void Player::setPlaylistIndex(int index) {
  * @param volume New volume level (0-22)
  */
 void Player::setVolume(int volume) {
+  PlayerLock guard(*this);
   // Validate and set volume
+  int oldVolume = playerState.volume;
   playerState.volume = constrain(volume, 0, 22);
   // Mark state as dirty when volume changes
   setDirty();
-  // Apply volume to audio output
-  if (audio) {
-    audio->setVolume(playerState.volume);
+  // Apply volume to audio output, a disabled output stays silent
+  requestAudio(AUDIO_REQUEST_VOLUME);
+  if (playerState.volume != oldVolume) {
+    notify(PLAYER_EVENT_MIXER);
   }
 }
 
+/**
+ * @brief Enable or disable the I2S output
+ * @details A disabled output keeps the stream connected and decoding but
+ * sends silence to the DAC, so enabling it again is instant. The volume
+ * setting is kept and restored.
+ * @param enabled true to enable the output
+ */
+void Player::setOutputEnabled(bool enabled) {
+  PlayerLock guard(*this);
+  if (playerState.outputEnabled == enabled) {
+    return;
+  }
+  playerState.outputEnabled = enabled;
+  setDirty();
+  requestAudio(AUDIO_REQUEST_VOLUME);
+  notify(PLAYER_EVENT_OUTPUT);
+}
+
 /**
  * @brief Set tone controls (bass, mid, treble)
  * Applies the tone settings to the audio output
  */
 void Player::setTone() {
+  PlayerLock guard(*this);
   // Apply tone settings to audio output
-  if (audio) {
-    audio->setTone(playerState.bass, playerState.mid, playerState.treble);
-  }
+  requestAudio(AUDIO_REQUEST_TONE);
+  notify(PLAYER_EVENT_MIXER);
 }
 
 /**
@@ -86,6 +293,7 @@ void Player::setTone() {
  * @param treble Treble level (-6 to 6)
  */
 void Player::setTone(int bass, int mid, int treble) {
+  PlayerLock guard(*this);
   // Validate and set tone values
   playerState.bass = constrain(bass, -6, 6);
   playerState.mid = constrain(mid, -6, 6);
@@ -96,29 +304,50 @@ void Player::setTone(int bass, int mid, int treble) {
   setTone();
 }
 
+/**
+ * @brief Update one stream info field reported by the audio task
+ * @details The audio callbacks run inside Audio::loop() without the player
+ * lock, so the fields they write are guarded by the spinlock. Reports that
+ * arrive while a stop or a new stream is queued belong to the old stream
+ * and are dropped.
+ * @param field Field to update
+ * @param size Size of the field
+ * @param value New value, nullptr to clear
+ * @return true if the field changed
+ */
+bool Player::setStreamField(char* field, size_t size, const char* value) {
+  if (!value) {
+    value = "";
+  }
+  bool changed = false;
+  portENTER_CRITICAL(&spinlock);
+  if (!(audioRequest.flags & AUDIO_REQUEST_STREAM) && strncmp(field, value, size - 1) != 0) {
+    strncpy(field, value, size - 1);
+    field[size - 1] = '\0';
+    changed = true;
+  }
+  portEXIT_CRITICAL(&spinlock);
+  return changed;
+}
+
 /**
  * @brief Set stream URL
  * @param url New stream URL
  */
 void Player::setStreamUrl(const char* url) {
-  if (url) {
-    strncpy(streamInfo.url, url, sizeof(streamInfo.url) - 1);
-    streamInfo.url[sizeof(streamInfo.url) - 1] = '\0';
-  } else {
-    streamInfo.url[0] = '\0';
-  }
+  setStreamField(streamInfo.url, sizeof(streamInfo.url), url);
 }
 
 /**
  * @brief Set stream name
+ * @details Stations report their ICY name after connecting, which replaces
+ * the playlist name in currentsong and the status, so it is a player change
+ * like a new title.
  * @param name New stream name
  */
 void Player::setStreamName(const char* name) {
-  if (name) {
-    strncpy(streamInfo.name, name, sizeof(streamInfo.name) - 1);
-    streamInfo.name[sizeof(streamInfo.name) - 1] = '\0';
-  } else {
-    streamInfo.name[0] = '\0';
+  if (setStreamField(streamInfo.name, sizeof(streamInfo.name), name)) {
+    notify(PLAYER_EVENT_PLAYER);
   }
 }
 
@@ -127,11 +356,8 @@ void Player::setStreamName(const char* name) {
  * @param title New stream title
  */
 void Player::setStreamTitle(const char* title) {
-  if (title) {
-    strncpy(streamInfo.title, title, sizeof(streamInfo.title) - 1);
-    streamInfo.title[sizeof(streamInfo.title) - 1] = '\0';
-  } else {
-    streamInfo.title[0] = '\0';
+  if (setStreamField(streamInfo.title, sizeof(streamInfo.title), title)) {
+    notify(PLAYER_EVENT_PLAYER);
   }
 }
 
@@ -140,12 +366,7 @@ void Player::setStreamTitle(const char* title) {
  * @param icyUrl New stream ICY URL
  */
 void Player::setStreamIcyUrl(const char* icyUrl) {
-  if (icyUrl) {
-    strncpy(streamInfo.icyUrl, icyUrl, sizeof(streamInfo.icyUrl) - 1);
-    streamInfo.icyUrl[sizeof(streamInfo.icyUrl) - 1] = '\0';
-  } else {
-    streamInfo.icyUrl[0] = '\0';
-  }
+  setStreamField(streamInfo.icyUrl, sizeof(streamInfo.icyUrl), icyUrl);
 }
 
 /**
@@ -153,24 +374,33 @@ void Player::setStreamIcyUrl(const char* icyUrl) {
  * @param iconUrl New stream icon URL
  */
 void Player::setStreamIconUrl(const char* iconUrl) {
-  if (iconUrl) {
-    strncpy(streamInfo.iconUrl, iconUrl, sizeof(streamInfo.iconUrl) - 1);
-    streamInfo.iconUrl[sizeof(streamInfo.iconUrl) - 1] = '\0';
-  } else {
-    streamInfo.iconUrl[0] = '\0';
+  setStreamField(streamInfo.iconUrl, sizeof(streamInfo.iconUrl), iconUrl);
+}
+
+/**
+ * @brief Set stream bitrate
+ * @param newBitrate Bitrate in kbps
+ */
+void Player::setBitrate(int newBitrate) {
+  portENTER_CRITICAL(&spinlock);
+  if (!(audioRequest.flags & AUDIO_REQUEST_STREAM)) {
+    streamInfo.bitrate = newBitrate;
   }
+  portEXIT_CRITICAL(&spinlock);
 }
 
 /**
  * @brief Clear all stream information
  */
 void Player::clearStreamInfo() {
+  portENTER_CRITICAL(&spinlock);
   streamInfo.url[0] = '\0';
   streamInfo.name[0] = '\0';
   streamInfo.title[0] = '\0';
   streamInfo.icyUrl[0] = '\0';
   streamInfo.iconUrl[0] = '\0';
   streamInfo.bitrate = 0;
+  portEXIT_CRITICAL(&spinlock);
 }
 
 /**
@@ -184,6 +414,7 @@ void Player::clearPlayerState() {
   playerState.mid = 0;
   playerState.treble = 0;
   playerState.playlistIndex = 0;
+  playerState.outputEnabled = true;
   playerState.lastSaveTime = 0;
   playerState.dirty = false;
   playerState.playStartTime = 0;
@@ -194,6 +425,7 @@ void Player::clearPlayerState() {
  * @brief Load player state from SPIFFS
  */
 void Player::loadPlayerState() {
+  PlayerLock guard(*this);
   DynamicJsonDocument doc(PLAYER_STATE_BUFFER_SIZE);  // Use predefined buffer size
   if (readJsonFile("/player.json", PLAYER_STATE_BUFFER_SIZE, doc)) {
     playerState.playing = doc["playing"] | false;
@@ -202,16 +434,14 @@ void Player::loadPlayerState() {
     playerState.mid = doc["mid"] | 0;
     playerState.treble = doc["treble"] | 0;
     playerState.playlistIndex = doc["playlistIndex"] | 0;
+    playerState.outputEnabled = doc["output"] | true;
     Serial.println("Loaded player state from SPIFFS");
   } else {
     Serial.println("No player state file found, using defaults");
     clearPlayerState();
   }
   // Apply loaded state
-  if (audio) {
-    audio->setVolume(playerState.volume);
-    audio->setTone(playerState.bass, playerState.mid, playerState.treble);
-  }
+  requestAudio(AUDIO_REQUEST_VOLUME | AUDIO_REQUEST_TONE);
   // If it was playing, resume playback
   if (playerState.playing && isPlaylistIndexValid()) {
     Serial.println("Resuming playback from saved state");
@@ -221,22 +451,26 @@ void Player::loadPlayerState() {
 
 /**
  * @brief Save player state to SPIFFS
+ * @details The file is written when the player lock is released, see
+ * unlock(), so a command that saves several times writes once.
  */
 void Player::savePlayerState() {
-  DynamicJsonDocument doc(PLAYER_STATE_BUFFER_SIZE);  // Use predefined buffer size
+  PlayerLock guard(*this);
+  pendingSaves |= PLAYER_SAVE_STATE;
+}
+
+/**
+ * @brief Copy the player state to be saved
+ * @param doc Document to fill
+ */
+void Player::serializePlayerState(DynamicJsonDocument& doc) const {
   doc["playing"] = playerState.playing;
   doc["volume"] = playerState.volume;
   doc["bass"] = playerState.bass;
   doc["mid"] = playerState.mid;
   doc["treble"] = playerState.treble;
   doc["playlistIndex"] = playerState.playlistIndex;
-  if (writeJsonFile("/player.json", doc)) {
-    Serial.println("Saved player state to SPIFFS");
-    // Use critical section to protect against concurrent access to dirty flag
-    resetDirty();
-  } else {
-    Serial.println("Failed to save player state to SPIFFS");
-  }
+  doc["output"] = playerState.outputEnabled;
 }
 
 /**
@@ -244,15 +478,19 @@ void Player::savePlayerState() {
  * Delegates to the playlist object's load method
  */
 void Player::loadPlaylist() {
+  PlayerLock guard(*this);
   playlist->load();  // Load using predefined buffer size PLAYLIST_BUFFER_SIZE
+  notify(PLAYER_EVENT_PLAYLIST);
 }
 
 /**
  * @brief Save playlist to SPIFFS storage
- * Delegates to the playlist object's save method
+ * The playlist is copied and written when the player lock is released, see
+ * unlock()
  */
 void Player::savePlaylist() {
-  playlist->save();  // Save using predefined buffer size PLAYLIST_BUFFER_SIZE
+  PlayerLock guard(*this);
+  pendingSaves |= PLAYER_SAVE_PLAYLIST;
 }
 
 /**
@@ -263,7 +501,9 @@ void Player::savePlaylist() {
  * Delegates to the playlist object's setItem method
  */
 void Player::setPlaylistItem(int index, const char* name, const char* url) {
+  PlayerLock guard(*this);
   playlist->setItem(index, name, url);
+  notify(PLAYER_EVENT_PLAYLIST);
 }
 
 /**
@@ -273,7 +513,9 @@ void Player::setPlaylistItem(int index, const char* name, const char* url) {
  * Delegates to the playlist object's addItem method
  */
 void Player::addPlaylistItem(const char* name, const char* url) {
+  PlayerLock guard(*this);
   playlist->addItem(name, url);
+  notify(PLAYER_EVENT_PLAYLIST);
 }
 
 /**
@@ -282,7 +524,46 @@ void Player::addPlaylistItem(const char* name, const char* url) {
  * Delegates to the playlist object's removeItem method
  */
 void Player::removePlaylistItem(int index) {
+  PlayerLock guard(*this);
   playlist->removeItem(index);
+  // Keep the selection on the same stream
+  int current = playerState.playlistIndex;
+  if (index < current || current >= playlist->getCount()) {
+    playerState.playlistIndex = max(current - 1, playlist->getCount() > 0 ? 0 : -1);
+    notify(PLAYER_EVENT_PLAYER);
+  }
+  notify(PLAYER_EVENT_PLAYLIST);
+}
+
+/**
+ * @brief Move a range of playlist items
+ * @param start First position of the range
+ * @param end Position after the last one of the range
+ * @param to New position of the first item of the range
+ * Delegates to the playlist object's moveItems method, the selection follows
+ * the stream it points to
+ */
+void Player::movePlaylistItems(int start, int end, int to) {
+  PlayerLock guard(*this);
+  uint32_t version = playlist->getVersion();
+  playlist->moveItems(start, end, to);
+  if (playlist->getVersion() == version) {
+    return;
+  }
+  int n = end - start;
+  int current = playerState.playlistIndex;
+  if (current >= start && current < end) {
+    current += to - start;
+  } else if (to < start && current >= to && current < start) {
+    current += n;
+  } else if (to > start && current >= end && current < to + n) {
+    current -= n;
+  }
+  if (current != playerState.playlistIndex) {
+    playerState.playlistIndex = current;
+    notify(PLAYER_EVENT_PLAYER);
+  }
+  notify(PLAYER_EVENT_PLAYLIST);
 }
 
 /**
@@ -290,7 +571,27 @@ void Player::removePlaylistItem(int index) {
  * Delegates to the playlist object's clear method
  */
 void Player::clearPlaylist() {
+  PlayerLock guard(*this);
   playlist->clear();
+  notify(PLAYER_EVENT_PLAYLIST);
+}
+
+/**
+ * @brief Replace the playlist with a complete new one
+ * @details Copies all items at once, so clients see a single playlist
+ * change. The selection stays on its position if the new playlist is long
+ * enough, otherwise it moves to the first item.
+ * @param source Playlist to copy the items from
+ */
+void Player::replacePlaylist(const Playlist& source) {
+  PlayerLock guard(*this);
+  playlist->assign(source);
+  int count = playlist->getCount();
+  if (playerState.playlistIndex >= count) {
+    playerState.playlistIndex = count > 0 ? 0 : -1;
+    notify(PLAYER_EVENT_PLAYER);
+  }
+  notify(PLAYER_EVENT_PLAYLIST);
 }
 
 /**
@@ -378,19 +679,40 @@ const StreamInfo& Player::getPlaylistItem(int index) const {
   return playlist->getItem(index);
 }
 
+/**
+ * @brief Get the playlist version
+ * @return Version incremented on every playlist content change
+ */
+uint32_t Player::getPlaylistVersion() const {
+  return playlist->getVersion();
+}
+
+/**
+ * @brief Get the playlist version an item last changed in
+ * @param index Playlist index
+ * @return Version of the last change at this position
+ */
+uint32_t Player::getPlaylistItemVersion(int index) const {
+  return playlist->getItemVersion(index);
+}
+
 /**
  * @brief Start streaming an audio stream
  * Stops any currently playing stream and begins playing a new one
  * If called without parameters, resumes playback of streamURL if available
  * @param url URL of the audio stream to play (optional)
  * @param name Human-readable name of the stream (optional)
+ * @param announce Refresh the display and the web clients, false for a
+ * caller making more changes that announces them once
  */
-void Player::startStream(const char* url, const char* name) {
+void Player::startStream(const char* url, const char* name, bool announce) {
+  PlayerLock guard(*this);
   bool resume = false;
-  // Stop the currently playing stream if the stream changes
+  // Stop the currently playing stream if the stream changes, the new one is
+  // announced instead of the stopped state
   if (audio && url && strlen(url) > 0) {
     // Stop first
-    stopStream();
+    stopStream(false);
   }
   // If no URL provided, check if we have a current stream to resume
   if (!url || strlen(url) == 0) {
@@ -425,10 +747,12 @@ void Player::startStream(const char* url, const char* name) {
   }
   // Keep the stream url and name if they are new
   if (!resume) {
+    portENTER_CRITICAL(&spinlock);
     strncpy(streamInfo.url, url, sizeof(streamInfo.url) - 1);
     streamInfo.url[sizeof(streamInfo.url) - 1] = '\0';
     strncpy(streamInfo.name, name, sizeof(streamInfo.name) - 1);
     streamInfo.name[sizeof(streamInfo.name) - 1] = '\0';
+    portEXIT_CRITICAL(&spinlock);
   }
   // Set playback status to playing
   playerState.playing = true;
@@ -438,20 +762,13 @@ void Player::startStream(const char* url, const char* name) {
   if (config.led_pin >= 0) {
     digitalWrite(config.led_pin, HIGH);
   }
-  // Use ESP32-audioI2S to play the stream
-  if (audio) {
-    bool audioConnected = audio->connecttohost(url);
-    if (!audioConnected) {
-      Serial.println("Error: Failed to connect to audio stream");
-      playerState.playing = false;
-      clearStreamInfo();
-    } else {
-      playerState.playing = true;
-      Serial.println("Successfully connected to audio stream");
-    }
+  // The audio task connects, a failure stops the player again
+  requestAudio(AUDIO_REQUEST_CONNECT, url);
+  if (announce) {
+    updateDisplay();        // Refresh the display with new playback info
+    sendStatusToClients();  // Notify clients of status change
   }
-  updateDisplay();        // Refresh the display with new playback info
-  sendStatusToClients();  // Notify clients of status change
+  notify(PLAYER_EVENT_PLAYER);
 }
 
 /**
@@ -459,12 +776,13 @@ void Player::startStream(const char* url, const char* name) {
  * Cleans up audio components and resets playback state
  * This function stops audio playback, clears stream information, and resets
  * the playback state to stopped.
+ * @param announce Refresh the display and the web clients, false for a
+ * caller making more changes that announces them once
  */
-void Player::stopStream() {
+void Player::stopStream(bool announce) {
+  PlayerLock guard(*this);
   // Stop the audio playback
-  if (audio) {
-    audio->stopSong();
-  }
+  requestAudio(AUDIO_REQUEST_STOP);
   // Set playback status to stopped
   playerState.playing = false;
   clearStreamInfo();
@@ -477,8 +795,11 @@ void Player::stopStream() {
   if (config.led_pin >= 0) {
     digitalWrite(config.led_pin, LOW);
   }
-  updateDisplay();  // Refresh the display
-  sendStatusToClients();  // Notify clients of status change
+  if (announce) {
+    updateDisplay();  // Refresh the display
+    sendStatusToClients();  // Notify clients of status change
+  }
+  notify(PLAYER_EVENT_PLAYER);
 }
 
 /**
@@ -503,7 +824,7 @@ Audio* Player::setupAudioOutput() {
   }
   // Configure I2S pinout from settings
   audio->setPinout(config.i2s_bclk, config.i2s_lrc, config.i2s_dout);
-  audio->setVolume(playerState.volume); // Use 0-22 scale directly
+  audio->setVolume(playerState.outputEnabled ? playerState.volume : 0); // Use 0-22 scale directly
   #if defined(BOARD_HAS_PSRAM)
   Serial.println("PSRAM supported, using larger audio buffer");
   audio->setBufsize(4096, 1048576); // 4KB in RAM, 1MB in PSRAM
@@ -519,38 +840,118 @@ Audio* Player::setupAudioOutput() {
  * @return true if audio is running, false otherwise
  */
 bool Player::isRunning() const {
-  return audio ? audio->isRunning() : false;
+  if (!audio) {
+    return false;
+  }
+  portENTER_CRITICAL(&spinlock);
+  bool running = audioRunning || (audioRequest.flags & AUDIO_REQUEST_CONNECT);
+  portEXIT_CRITICAL(&spinlock);
+  return running;
 }
 
 /**
  * @brief Handle audio processing loop
  * Processes audio data and maintains playback state
- * This function should be called regularly in the main loop to process
- * audio data and maintain proper playback functionality.
+ * This function should be called regularly from the audio task. It runs the
+ * queued requests and the decoder without the player lock, so MPD, the web
+ * server and the audio task never wait for each other.
  */
 void Player::handleAudio() {
   if (audio) {
+    serviceAudioRequests();
     audio->loop();
+    updateAudioStats();
   }
   // Add yield to prevent blocking
   yield();
 }
 
 /**
- * @brief Update the current stream bitrate
- * Gets the current bitrate from the audio object and updates the stream info
- * @return The current bitrate in kbps
+ * @brief Refresh the audio pipeline statistics, on the audio task
+ * @details Reads the stream format, bitrate and buffer levels from the Audio
+ * object every AUDIO_STATS_INTERVAL. The Audio library does not count the
+ * bytes it receives, so streamBytesEstimated only adds the bitrate times
+ * the time the stream ran, and keeps growing when the connection stalls.
  */
-int Player::updateBitrate() {
-  if (audio) {
-    int newBitrate = audio->getBitRate() / 1000;  // Convert bps to kbps
-    if (newBitrate > 0 && newBitrate != streamInfo.bitrate) {
-      setBitrate(newBitrate);
-      return newBitrate;
-    }
+void Player::updateAudioStats() {
+  unsigned long now = millis();
+  bool running = audio->isRunning();
+  if (running == statsRunning && now - statsUpdateTime < AUDIO_STATS_INTERVAL) {
+    return;
+  }
+  AudioStats sample = {};
+  int bitrate = 0;
+  if (running) {
+    sample.sampleRate = audio->getSampleRate();
+    sample.bitsPerSample = audio->getBitsPerSample();
+    sample.channels = audio->getChannels();
+    const char* codec = audio->getCodecname();
+    strncpy(sample.codec, codec ? codec : "", sizeof(sample.codec) - 1);
+    sample.bufferFilled = audio->inBufferFilled();
+    sample.bufferFree = audio->inBufferFree();
+    bitrate = audio->getBitRate() / 1000;  // Convert bps to kbps
+  }
+  portENTER_CRITICAL(&spinlock);
+  audioRunning = running;
+  if (running && statsRunning) {
+    audioStats.streamBytesEstimated += (uint64_t)streamInfo.bitrate * 1000 / 8 * (now - statsUpdateTime) / 1000;
+  }
+  audioStats.sampleRate = sample.sampleRate;
+  audioStats.bitsPerSample = sample.bitsPerSample;
+  audioStats.channels = sample.channels;
+  memcpy(audioStats.codec, sample.codec, sizeof(audioStats.codec));
+  audioStats.bufferFilled = sample.bufferFilled;
+  audioStats.bufferFree = sample.bufferFree;
+  // Not after a stop, the stream info was cleared
+  if (bitrate > 0 && !(audioRequest.flags & AUDIO_REQUEST_STREAM)) {
+    streamInfo.bitrate = bitrate;
+  }
+  portEXIT_CRITICAL(&spinlock);
+  statsRunning = running;
+  statsUpdateTime = now;
+}
+
+/**
+ * @brief Get a copy of the audio pipeline statistics
+ * @return Statistics as of the last sample
+ */
+AudioStats Player::getAudioStats() const {
+  portENTER_CRITICAL(&spinlock);
+  AudioStats stats = audioStats;
+  portEXIT_CRITICAL(&spinlock);
+  return stats;
+}
+
+/**
+ * @brief Count the problems the Audio library reports
+ * @details The library reports decode errors and a starving input buffer
+ * only as info messages, so they are recognized by their text.
+ * @param info Message passed to audio_info()
+ */
+void Player::countAudioInfo(const char* info) {
+  if (!info) {
+    return;
   }
-  return streamInfo.bitrate;
+  portENTER_CRITICAL(&spinlock);
+  if (strstr(info, "decode error")) {
+    audioStats.decodeErrors++;
+  } else if (strstr(info, "slow stream")) {
+    audioStats.underruns++;
+  } else if (strstr(info, "try new connection")) {
+    audioStats.reconnects++;
+  }
+  portEXIT_CRITICAL(&spinlock);
+}
+
+/**
+ * @brief Count a stream reconnected after it stopped unexpectedly
+ */
+void Player::countReconnect() {
+  portENTER_CRITICAL(&spinlock);
+  audioStats.reconnects++;
+  portEXIT_CRITICAL(&spinlock);
 }
+
 /**
  * @brief Set the dirty flag to indicate state has changed
  */
@@ -564,3 +965,64 @@ void Player::setDirty() {
 void Player::resetDirty() {
   playerState.dirty = false;
 }
+
+/**
+ * @brief Register the change event listener
+ * @details The listener is called by notify() from whichever task made the
+ * change, so it must only record the events and wake its owner.
+ * @param listener Function to call, or nullptr to remove the listener
+ * @param context Pointer passed back to the listener
+ */
+void Player::setEventListener(PlayerEventListener listener, void* context) {
+  eventListener = listener;
+  eventContext = context;
+}
+
+/**
+ * @brief Publish change events
+ * @details Increments the version counter of every subsystem in the mask and
+ * wakes the listener, so nobody has to poll the player state for changes.
+ * @param events Bit mask of PLAYER_EVENT_* values
+ */
+void Player::notify(uint8_t events) {
+  portENTER_CRITICAL(&spinlock);
+  for (int i = 0; i < PLAYER_EVENT_COUNT; i++) {
+    if (events & (1 << i)) {
+      eventVersions[i]++;
+    }
+  }
+  portEXIT_CRITICAL(&spinlock);
+  if (eventListener) {
+    eventListener(events, eventContext);
+  }
+}
+
+/**
+ * @brief Get the change counter of a subsystem
+ * @param event One PLAYER_EVENT_* value
+ * @return Number of changes since boot
+ */
+uint32_t Player::getEventVersion(uint8_t event) const {
+  for (int i = 0; i < PLAYER_EVENT_COUNT; i++) {
+    if (event & (1 << i)) {
+      return eventVersions[i];
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Get a number that changes whenever the reported status changes
+ * @details Mixes the PLAYER_EVENT_PLAYER counter with the playback flag and
+ * the bitrate, which change without an event. The stream name and title
+ * reported by the station, the URL and the playlist index all notify
+ * PLAYER_EVENT_PLAYER when they change, so a new ICY name alone is enough
+ * to change the version. Only meant to be compared for equality, e.g. as
+ * the ETag of the web status.
+ * @return Status version
+ */
+uint32_t Player::getStatusVersion() const {
+  uint32_t version = getEventVersion(PLAYER_EVENT_PLAYER) * 0x9e3779b1u;
+  version ^= (uint32_t)streamInfo.bitrate * 0x85ebca77u;
+  return version ^ (playerState.playing ? 1 : 0);
+}
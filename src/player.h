@@ -20,11 +20,42 @@
 #define PLAYER_H
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
 
 // Buffer size constants
 #define PLAYER_STATE_BUFFER_SIZE 512   // JSON buffer for player state (512 bytes = 2^9)
 #define PLAYLIST_BUFFER_SIZE 4096      // JSON buffer for playlist data (4KB = 2^12)
 
+// Change events, one bit per MPD idle subsystem
+#define PLAYER_EVENT_PLAYER   0x01  ///< Playback state, current stream or stream title changed
+#define PLAYER_EVENT_MIXER    0x02  ///< Volume or tone controls changed
+#define PLAYER_EVENT_PLAYLIST 0x04  ///< Playlist contents changed
+#define PLAYER_EVENT_OUTPUT   0x08  ///< Audio output enabled or disabled
+#define PLAYER_EVENT_COUNT    4     ///< Number of event types
+
+// Requests to the audio task, which owns the Audio object
+#define AUDIO_REQUEST_STOP    0x01  ///< Stop the current stream
+#define AUDIO_REQUEST_CONNECT 0x02  ///< Connect to the requested URL
+#define AUDIO_REQUEST_VOLUME  0x04  ///< Apply the requested volume
+#define AUDIO_REQUEST_TONE    0x08  ///< Apply the requested tone controls
+#define AUDIO_REQUEST_STREAM  (AUDIO_REQUEST_STOP | AUDIO_REQUEST_CONNECT)
+
+// Files saved when the player lock is released, see Player::unlock()
+#define PLAYER_SAVE_STATE     0x01  ///< player.json
+#define PLAYER_SAVE_PLAYLIST  0x02  ///< playlist.json
+
+// Interval between two audio statistics samples, in milliseconds
+#ifndef AUDIO_STATS_INTERVAL
+#define AUDIO_STATS_INTERVAL 250
+#endif
+
+/**
+ * @brief Change event listener
+ * @param events Bit mask of PLAYER_EVENT_* values
+ * @param context Pointer given when the listener was registered
+ */
+typedef void (*PlayerEventListener)(uint8_t events, void* context);
+
 // Forward declarations
 class Audio;
 class Playlist;
@@ -42,6 +73,24 @@ struct StreamInfoData {
   int bitrate;      ///< Stream bitrate
 };
 
+/**
+ * @brief Audio pipeline statistics
+ * @details The format fields describe the stream being decoded and are 0
+ * when nothing plays. The counters run since boot.
+ */
+struct AudioStats {
+  uint32_t sampleRate;     ///< Sample rate in Hz
+  uint8_t bitsPerSample;   ///< Bits per sample
+  uint8_t channels;        ///< Number of channels
+  char codec[8];           ///< Codec name, e.g. "MP3"
+  uint32_t bufferFilled;   ///< Bytes waiting in the input buffer
+  uint32_t bufferFree;     ///< Free bytes in the input buffer
+  uint64_t streamBytesEstimated;  ///< Bitrate times playing time, not a byte count
+  uint32_t decodeErrors;   ///< Frames the decoder rejected
+  uint32_t underruns;      ///< Times the input buffer ran low
+  uint32_t reconnects;     ///< Times a stream was reconnected after a loss
+};
+
 /**
  * @brief Player state structure
  * Contains all the state information for the player
@@ -53,6 +102,7 @@ struct PlayerState {
   int mid;                     ///< Mid tone control (-6 to 6)
   int treble;                  ///< Treble tone control (-6 to 6)
   int playlistIndex;           ///< Current selected playlist index
+  bool outputEnabled;          ///< I2S output enabled, silent when disabled
   unsigned long lastSaveTime;  ///< Timestamp of last state save
   bool dirty;                  ///< Flag indicating if state has changed and needs saving
   unsigned long playStartTime; ///< Timestamp when current playback started
@@ -64,14 +114,52 @@ class Player {
 private:
   PlayerState playerState;
   StreamInfoData streamInfo;
+  AudioStats audioStats = {};
+  unsigned long statsUpdateTime = 0;  ///< millis() of the last updateAudioStats()
+  bool statsRunning = false;          ///< Stream running at the last sample
   Playlist* playlist;
   Audio* audio;
-  portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+  mutable portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;  ///< Guards the audio task data
+  SemaphoreHandle_t mutex = nullptr;  ///< Serializes changes made from different tasks
+  int lockDepth = 0;                  ///< Nesting level of the mutex holder
+  uint8_t pendingSaves = 0;           ///< PLAYER_SAVE_* files to write on the last unlock()
+  SemaphoreHandle_t saveMutex = nullptr;     ///< Serializes the file writes
+  uint32_t saveVersions[2] = {0};            ///< Copies taken of player.json and playlist.json
+  uint32_t writtenVersions[2] = {0};         ///< Copies written of player.json and playlist.json
+  /**
+   * @brief Pending work for the audio task, guarded by the spinlock
+   */
+  struct AudioRequest {
+    uint8_t flags;   ///< AUDIO_REQUEST_* bits
+    char url[256];   ///< URL to connect to
+    int volume;      ///< Volume to apply, 0 while the output is disabled
+    int bass;        ///< Bass to apply
+    int mid;         ///< Mid to apply
+    int treble;      ///< Treble to apply
+  } audioRequest = {};
+  bool audioRunning = false;  ///< Stream running or connecting, as seen by the audio task
+  uint32_t eventVersions[PLAYER_EVENT_COUNT] = {0};  ///< Per-subsystem change counters
+  PlayerEventListener eventListener = nullptr;       ///< Listener woken on changes
+  void* eventContext = nullptr;                      ///< Context passed to the listener
+
+  // Audio task helpers
+  void requestAudio(uint8_t flags, const char* url = nullptr);
+  void serviceAudioRequests();
+  void connectFailed(const char* url);
+  void updateAudioStats();
+  bool setStreamField(char* field, size_t size, const char* value);
+  // Deferred saves
+  void serializePlayerState(DynamicJsonDocument& doc) const;
+  void writeSnapshot(const char* filename, DynamicJsonDocument& doc, int slot, uint32_t version);
 
 public:
   // Constructor
   Player();
 
+  // Locking, for callers that need a consistent view across several calls
+  void lock();
+  void unlock();
+
   // Audio getter
   Audio* getAudioObject() const { return audio; }
   bool isRunning() const;
@@ -90,6 +178,8 @@ public:
   int getPlaylistIndex() const { return playerState.playlistIndex; }
   int getPlaylistCount() const;
   int getBitrate() const { return streamInfo.bitrate; }
+  bool isOutputEnabled() const { return playerState.outputEnabled; }
+  AudioStats getAudioStats() const;
 
   // Playlist navigation helper functions
   int getNextPlaylistItem() const;
@@ -109,11 +199,9 @@ public:
   void setVolume(int volume);
   void setTone();
   void setTone(int bass, int mid, int treble);
-  void setBass(int bass) { playerState.bass = bass; }
-  void setMid(int mid) { playerState.mid = mid; }
-  void setTreble(int treble) { playerState.treble = treble; }
   void setPlaylistIndex(int index);
-  void setBitrate(int newBitrate) { streamInfo.bitrate = newBitrate; }
+  void setOutputEnabled(bool enabled);
+  void setBitrate(int newBitrate);
   void setPlayStartTime(unsigned long time) { playerState.playStartTime = time; }
   void setTotalPlayTime(unsigned long time) { playerState.totalPlayTime = time; }
   void addPlayTime(unsigned long time) { playerState.totalPlayTime += time; }
@@ -122,6 +210,12 @@ public:
   void setDirty();
   void resetDirty();
 
+  // Change events
+  void setEventListener(PlayerEventListener listener, void* context);
+  void notify(uint8_t events);
+  uint32_t getEventVersion(uint8_t event) const;
+  uint32_t getStatusVersion() const;
+
   // Stream info getters
   const char* getStreamUrl() const { return streamInfo.url; }
   const char* getStreamName() const { return streamInfo.name; }
@@ -139,6 +233,8 @@ public:
 
   // Playlist getters
   const struct StreamInfo& getPlaylistItem(int index) const;
+  uint32_t getPlaylistVersion() const;
+  uint32_t getPlaylistItemVersion(int index) const;
   Playlist* getPlaylist() const { return playlist; }
 
   // Playlist methods
@@ -147,18 +243,37 @@ public:
   void setPlaylistItem(int index, const char* name, const char* url);
   void addPlaylistItem(const char* name, const char* url);
   void removePlaylistItem(int index);
+  void movePlaylistItems(int start, int end, int to);
   void clearPlaylist();
+  void replacePlaylist(const Playlist& source);
 
   // Audio control methods
-  void startStream(const char* url = nullptr, const char* name = nullptr);
-  void stopStream();
+  void startStream(const char* url = nullptr, const char* name = nullptr, bool announce = true);
+  void stopStream(bool announce = true);
 
   // Audio setup method
   Audio* setupAudioOutput();
-  // Audio handler
+  // Audio handler, the only caller of the Audio object once running
   void handleAudio();
-  // Update the bitrate from the Audio object
-  int updateBitrate();
+  // Audio pipeline statistics
+  void countAudioInfo(const char* info);
+  void countReconnect();
+};
+
+/**
+ * @brief Scoped player lock
+ * @details Holds the player mutex for the lifetime of the object, so every
+ * return path of the enclosing block releases it.
+ */
+class PlayerLock {
+public:
+  explicit PlayerLock(Player& playerRef) : player(playerRef) { player.lock(); }
+  ~PlayerLock() { player.unlock(); }
+  PlayerLock(const PlayerLock&) = delete;
+  PlayerLock& operator=(const PlayerLock&) = delete;
+
+private:
+  Player& player;  ///< Locked player
 };
 
 #endif // PLAYER_H
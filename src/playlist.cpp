@@ -19,6 +19,7 @@
 #include "playlist.h"
 #include "main.h"
 #include <ArduinoJson.h>
+#include <algorithm>
 
 extern bool readJsonFile(const char* filename, size_t maxFileSize, DynamicJsonDocument& doc);
 extern bool writeJsonFile(const char* filename, DynamicJsonDocument& doc);
@@ -29,10 +30,39 @@ extern bool writeJsonFile(const char* filename, DynamicJsonDocument& doc);
 Playlist::Playlist() {
   count = 0;
   current = 0;
+  version = 1;
   // Initialize playlist
   for (int i = 0; i < MAX_PLAYLIST_SIZE; i++) {
     playlist[i].name[0] = '\0';
     playlist[i].url[0] = '\0';
+    itemVersions[i] = 0;
+    searchKeys[i][0] = '\0';
+  }
+}
+
+/**
+ * @brief Record a playlist change
+ * @details Increments the playlist version and stamps the changed positions
+ * with it, so plchanges can tell which entries a client has not seen yet.
+ * Positions are clamped to the playlist capacity, an empty range only
+ * increments the version.
+ * 
+ * The search keys of the changed positions are refreshed here too, so the
+ * search index follows every change without a rebuild.
+ * @param first First changed position
+ * @param last Last changed position (inclusive)
+ */
+void Playlist::touch(int first, int last) {
+  version++;
+  if (first < 0) {
+    first = 0;
+  }
+  if (last >= MAX_PLAYLIST_SIZE) {
+    last = MAX_PLAYLIST_SIZE - 1;
+  }
+  for (int i = first; i <= last; i++) {
+    itemVersions[i] = version;
+    foldSearchKey(playlist[i].name, searchKeys[i], STREAM_NAME_SIZE);
   }
 }
 
@@ -48,6 +78,7 @@ void Playlist::load() {
   DynamicJsonDocument doc(PLAYLIST_BUFFER_SIZE);
   if (!readJsonFile("/playlist.json", PLAYLIST_BUFFER_SIZE, doc)) {
     Serial.println("Failed to load playlist, continuing with empty playlist");
+    touch(0, -1);
     return;
   }
   // Check if the JSON document is an array
@@ -55,6 +86,7 @@ void Playlist::load() {
     Serial.println("Error: Playlist JSON is not an array");
     // Don't create an empty playlist, just return with empty playlist
     Serial.println("Continuing with empty playlist");
+    touch(0, -1);
     return;
   }
   // Populate the playlist array
@@ -96,6 +128,8 @@ void Playlist::load() {
     Serial.print(count);
     Serial.println(" streams from playlist");
   }
+  // All loaded entries are new to the clients
+  touch(0, count - 1);
   // Validate playlist integrity after loading
   validate();
 }
@@ -107,21 +141,21 @@ void Playlist::load() {
  * It creates a backup before saving and restores from backup if saving fails.
  */
 void Playlist::save() {
-  // Estimate required buffer size (rough estimation)
-  // Each entry needs approximately: {"name":"...","url":"..."},
-  // Plus some overhead for JSON structure
-  size_t estimatedSize = 1024; // Base size for JSON structure
-  for (int i = 0; i < count; i++) {
-    // Add estimated size for each entry (name + url + JSON overhead)
-    estimatedSize += strlen(playlist[i].name) + strlen(playlist[i].url) + 64;
-  }
-  // Ensure we don't exceed our maximum buffer size
-  if (estimatedSize > PLAYLIST_BUFFER_SIZE) {
-    Serial.println("Warning: Playlist too large, truncating to fit buffer");
-    estimatedSize = PLAYLIST_BUFFER_SIZE;
+  DynamicJsonDocument doc(PLAYLIST_BUFFER_SIZE);
+  serialize(doc);
+  // Save the JSON document to SPIFFS using helper function
+  if (writeJsonFile("/playlist.json", doc)) {
+    Serial.println("Saved playlist to SPIFFS");
+  } else {
+    Serial.println("Failed to save playlist to SPIFFS");
   }
-  // Create JSON array with appropriate buffer size
-  DynamicJsonDocument doc(estimatedSize);
+}
+
+/**
+ * @brief Copy the playlist into a JSON array, as saved in playlist.json
+ * @param doc Document to fill
+ */
+void Playlist::serialize(DynamicJsonDocument& doc) const {
   JsonArray array = doc.to<JsonArray>();
   // Add playlist entries
   for (int i = 0; i < count; i++) {
@@ -136,12 +170,6 @@ void Playlist::save() {
     item["name"] = playlist[i].name;
     item["url"] = playlist[i].url;
   }
-  // Save the JSON document to SPIFFS using helper function
-  if (writeJsonFile("/playlist.json", doc)) {
-    Serial.println("Saved playlist to SPIFFS");
-  } else {
-    Serial.println("Failed to save playlist to SPIFFS");
-  }
 }
 
 /**
@@ -160,7 +188,11 @@ void Playlist::setItem(int index, const char* name, const char* url) {
     SAFE_STRNCPY(playlist[index].name, name, STREAM_NAME_SIZE);
     SAFE_STRNCPY(playlist[index].url, url, STREAM_URL_SIZE);
     if (index >= count) {
+      // Positions between the old end and the new item appear as well
+      touch(count, index);
       count = index + 1;
+    } else {
+      touch(index, index);
     }
   }
 }
@@ -179,6 +211,7 @@ void Playlist::addItem(const char* name, const char* url) {
     }
     SAFE_STRNCPY(playlist[count].name, name, STREAM_NAME_SIZE);
     SAFE_STRNCPY(playlist[count].url, url, STREAM_URL_SIZE);
+    touch(count, count);
     count++;
   }
 }
@@ -198,6 +231,30 @@ void Playlist::removeItem(int index) {
     playlist[count - 1].name[0] = '\0';
     playlist[count - 1].url[0] = '\0';
     count--;
+    // Every following entry moved one position up
+    touch(index, count - 1);
+  }
+}
+
+/**
+ * @brief Move a range of playlist items
+ * @details The items keep their order and the ones in between shift to make
+ * room. Invalid ranges and targets are ignored.
+ * @param start First position of the range
+ * @param end Position after the last one of the range
+ * @param to New position of the first item of the range
+ */
+void Playlist::moveItems(int start, int end, int to) {
+  int n = end - start;
+  if (start < 0 || n <= 0 || end > count || to < 0 || to + n > count || to == start) {
+    return;
+  }
+  if (to < start) {
+    std::rotate(playlist + to, playlist + start, playlist + end);
+    touch(to, end - 1);
+  } else {
+    std::rotate(playlist + start, playlist + end, playlist + to + n);
+    touch(start, to + n - 1);
   }
 }
 
@@ -211,6 +268,28 @@ void Playlist::clear() {
   }
   count = 0;
   current = 0;
+  touch(0, -1);
+}
+
+/**
+ * @brief Replace all playlist items with the ones of another playlist
+ * @details The version keeps increasing, so clients see every position of
+ * the old and the new contents as changed.
+ * @param source Playlist to copy the items from
+ */
+void Playlist::assign(const Playlist& source) {
+  int last = max(count, source.count) - 1;
+  for (int i = 0; i < MAX_PLAYLIST_SIZE; i++) {
+    if (i < source.count) {
+      playlist[i] = source.playlist[i];
+    } else {
+      playlist[i].name[0] = '\0';
+      playlist[i].url[0] = '\0';
+    }
+  }
+  count = source.count;
+  current = 0;
+  touch(0, last);
 }
 
 /**
@@ -242,6 +321,95 @@ const StreamInfo& Playlist::getItem(int index) const {
   return playlist[index];
 }
 
+/**
+ * @brief Get the playlist version
+ * @details The version is incremented on every change of the playlist
+ * contents, it is what MPD clients see as "playlist" in status.
+ * @return Current playlist version
+ */
+uint32_t Playlist::getVersion() const {
+  return version;
+}
+
+/**
+ * @brief Get the playlist version an entry last changed in
+ * @param index Playlist index (0-based)
+ * @return Version of the last change at this position, 0 if out of bounds
+ */
+uint32_t Playlist::getItemVersion(int index) const {
+  if (index < 0 || index >= count) {
+    return 0;
+  }
+  return itemVersions[index];
+}
+
+/**
+ * @brief Get the search key of a playlist item
+ * @param index Playlist index (0-based)
+ * @return Folded stream name, empty if out of bounds
+ */
+const char* Playlist::getSearchKey(int index) const {
+  if (index < 0 || index >= count) {
+    return "";
+  }
+  return searchKeys[index];
+}
+
+/**
+ * @brief Search the stream names
+ * @details The query is folded like the names, so the search is case and
+ * accent insensitive, and then looked up in each search key. The keys are
+ * kept up to date on every playlist change, nothing is converted or
+ * allocated per name.
+ * @param query Text to look for
+ * @param matches Array receiving the matching playlist indexes
+ * @param maxMatches Capacity of the matches array
+ * @return Number of matching items, at most maxMatches
+ */
+int Playlist::search(const char* query, int* matches, int maxMatches) const {
+  char key[STREAM_NAME_SIZE];
+  foldSearchKey(query, key, sizeof(key));
+  int found = 0;
+  for (int i = 0; i < count && found < maxMatches; i++) {
+    if (strstr(searchKeys[i], key)) {
+      matches[found++] = i;
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Fold a text into a search key
+ * @details ASCII letters are lowercased and the accented letters of the
+ * Latin-1 range, written in UTF-8, are replaced with their base letter, so
+ * "Radio România" and "radio romania" give the same key. Other characters
+ * are copied unchanged. The key is never longer than the text.
+ * @param text Text to fold
+ * @param key Buffer receiving the key
+ * @param size Buffer size
+ * @return Length of the key
+ */
+size_t Playlist::foldSearchKey(const char* text, char* key, size_t size) {
+  // Base letters of U+00C0..U+00FF, indexed by the second UTF-8 byte
+  static const char latin1[] = "aaaaaaaceeeeiiiidnooooo" "xouuuuyts"
+                               "aaaaaaaceeeeiiiidnooooo" "/ouuuuyty";
+  size_t len = 0;
+  if (size == 0) {
+    return 0;
+  }
+  while (*text && len + 1 < size) {
+    unsigned char c = *text++;
+    if (c == 0xC3 && (*text & 0xC0) == 0x80) {
+      c = latin1[*text++ & 0x3F];
+    } else if (c >= 'A' && c <= 'Z') {
+      c += 'a' - 'A';
+    }
+    key[len++] = c;
+  }
+  key[len] = '\0';
+  return len;
+}
+
 /**
  * @brief Set the current playlist index
  * @param index New current index (0-based)
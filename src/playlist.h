@@ -42,8 +42,14 @@ struct StreamInfo {
 class Playlist {
 private:
   StreamInfo playlist[MAX_PLAYLIST_SIZE];
+  uint32_t itemVersions[MAX_PLAYLIST_SIZE];  ///< Playlist version each position last changed in
+  uint32_t version;                          ///< Incremented on every content change
+  char searchKeys[MAX_PLAYLIST_SIZE][STREAM_NAME_SIZE];  ///< Folded names, see foldSearchKey()
   int count;
   int current;
+
+  // Start a new version and mark positions first..last as changed in it
+  void touch(int first, int last);
   
 public:
   // Constructor
@@ -52,15 +58,25 @@ public:
   // Playlist management methods
   void load();
   void save();
+  void serialize(DynamicJsonDocument& doc) const;
   void setItem(int index, const char* name, const char* url);
   void addItem(const char* name, const char* url);
   void removeItem(int index);
+  void moveItems(int start, int end, int to);
   void clear();
+  void assign(const Playlist& source);
   
   // Getters
   int getCount() const;
   int getCurrent() const;
   const StreamInfo& getItem(int index) const;
+  uint32_t getVersion() const;
+  uint32_t getItemVersion(int index) const;
+
+  // Search methods
+  const char* getSearchKey(int index) const;
+  int search(const char* query, int* matches, int maxMatches) const;
+  static size_t foldSearchKey(const char* text, char* key, size_t size);
 
   // Setters
   void setCurrent(int index);
@@ -0,0 +1,135 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "main.h"
+
+/**
+ * @brief Read JSON file from SPIFFS
+ * Helper function to read and parse JSON files from SPIFFS
+ * @param filename Path to the file in SPIFFS
+ * @param maxFileSize Maximum allowed file size
+ * @param doc JsonDocument to populate with parsed data
+ * @return true if successful, false otherwise
+ */
+bool readJsonFile(const char* filename, size_t maxFileSize, DynamicJsonDocument& doc) {
+  // Check if the file exists
+  if (!SPIFFS.exists(filename)) {
+    Serial.printf("JSON file not found: %s\n", filename);
+    return false;
+  }
+  // Open the file
+  File file = SPIFFS.open(filename, "r");
+  if (!file) {
+    Serial.printf("Failed to open JSON file: %s\n", filename);
+    return false;
+  }
+  // Get the size of the file
+  size_t size = file.size();
+  if (size > maxFileSize) {
+    Serial.printf("JSON file too large: %s\n", filename);
+    file.close();
+    return false;
+  }
+  // Check if the file is empty
+  if (size == 0) {
+    Serial.printf("JSON file is empty: %s\n", filename);
+    file.close();
+    return false;
+  }
+  // Allocate buffer for file content
+  std::unique_ptr<char[]> buf(new char[size + 1]);
+  if (!buf) {
+    Serial.printf("Error: Failed to allocate memory for JSON file: %s\n", filename);
+    file.close();
+    return false;
+  }
+  // Read the file content
+  if (file.readBytes(buf.get(), size) != size) {
+    Serial.printf("Failed to read JSON file: %s\n", filename);
+    file.close();
+    return false;
+  }
+  // Null-terminate the buffer
+  buf[size] = '\0';
+  file.close();
+  // Parse the JSON document
+  DeserializationError error = deserializeJson(doc, buf.get());
+  if (error) {
+    Serial.printf("Failed to parse JSON file %s: %s\n", filename, error.c_str());
+    return false;
+  }
+  // Successfully read and parsed the JSON file
+  return true;
+}
+
+/**
+ * @brief Write JSON file to SPIFFS
+ * Helper function to serialize and write JSON files to SPIFFS
+ * @param filename Path to the file in SPIFFS
+ * @param doc JsonDocument to serialize
+ * @return true if successful, false otherwise
+ */
+bool writeJsonFile(const char* filename, DynamicJsonDocument& doc) {
+  // Create backup of existing file
+  String backupFilename = String(filename) + ".bak";
+  if (SPIFFS.exists(filename)) {
+    if (SPIFFS.exists(backupFilename)) {
+      SPIFFS.remove(backupFilename);
+    }
+    if (!SPIFFS.rename(filename, backupFilename)) {
+      Serial.printf("Warning: Failed to create backup of %s\n", filename);
+    }
+  }
+  // Open the file for writing
+  File file = SPIFFS.open(filename, "w");
+  if (!file) {
+    Serial.printf("Failed to open JSON file for writing: %s\n", filename);
+    // Try to restore from backup
+    if (SPIFFS.exists(backupFilename)) {
+      if (SPIFFS.rename(backupFilename, filename)) {
+        Serial.printf("Restored %s from backup\n", filename);
+      } else {
+        Serial.printf("Error: Failed to restore %s from backup\n", filename);
+      }
+    }
+    return false;
+  }
+  // Serialize the JSON document to the file
+  size_t bytesWritten = serializeJson(doc, file);
+  if (bytesWritten == 0) {
+    Serial.printf("Failed to write JSON to file: %s\n", filename);
+    file.close();
+    // Try to restore from backup
+    if (SPIFFS.exists(backupFilename)) {
+      SPIFFS.remove(filename); // Remove the failed file
+      if (SPIFFS.rename(backupFilename, filename)) {
+        Serial.printf("Restored %s from backup\n", filename);
+      } else {
+        Serial.printf("Error: Failed to restore %s from backup\n", filename);
+      }
+    }
+    return false;
+  }
+  file.close();
+  // Remove backup file after successful save
+  if (SPIFFS.exists(backupFilename)) {
+    SPIFFS.remove(backupFilename);
+  }
+  // Successfully wrote the JSON file
+  return true;
+}
@@ -0,0 +1,604 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "main.h"
+#include "player.h"
+#include "playlist.h"
+#include "importer.h"
+#include "exporter.h"
+#include "batch.h"
+#include <memory>
+
+// Globals defined in main.cpp
+extern Player player;
+extern PlaylistImporter playlistImporter;
+extern ConfigImporter configImporter;
+
+/**
+ * @brief Send JSON response with status and message
+ * Helper function to send standardized JSON responses
+ * @param status Status string ("success" or "error")
+ * @param message Human-readable message
+ * @param code HTTP status code (default 200 for success, 400 for error)
+ */
+void sendJsonResponse(const String& status, const String& message, int code) {
+  // If code not specified, determine based on status
+  if (code == -1) {
+    code = (status == "success") ? 200 : 400;
+  }
+  // Create JSON response
+  DynamicJsonDocument doc(256);
+  doc["status"] = status;
+  doc["message"] = message;
+  String json;
+  serializeJson(doc, json);
+  server.send(code, "application/json", json);
+}
+
+/**
+ * @brief Handle GET request for streams
+ * Returns the current playlist as JSON
+ * The playlist is serialized from memory as it is sent, with chunked
+ * transfer encoding, so neither the file nor the response is buffered.
+ */
+void handleGetStreams() {
+  auto exporter = std::make_shared<PlaylistExporter>(player);
+  server.sendStream(200, "application/json", [exporter](uint8_t* buffer, size_t size) -> int {
+    return exporter->read(buffer, size);
+  });
+}
+
+/**
+ * @brief Handle GET request for stream search
+ * Returns the playlist entries whose name contains the "q" query argument
+ * The search is case and accent insensitive and uses the search keys the
+ * playlist keeps up to date, so the playlist file is not read.
+ */
+void handleSearchStreams() {
+  if (!server.hasArg("q")) {
+    sendJsonResponse("error", "Missing search query");
+    return;
+  }
+  String query = server.arg("q");
+  // Find the matching entries, the MPD task may be editing the playlist
+  PlayerLock guard(player);
+  Playlist* playlist = player.getPlaylist();
+  int matches[MAX_PLAYLIST_SIZE];
+  int count = playlist->search(query.c_str(), matches, MAX_PLAYLIST_SIZE);
+  // Create JSON array with the index, name and URL of each match
+  DynamicJsonDocument doc(256 + count * (STREAM_NAME_SIZE + STREAM_URL_SIZE + 48));
+  JsonArray array = doc.to<JsonArray>();
+  for (int i = 0; i < count; i++) {
+    const StreamInfo& item = playlist->getItem(matches[i]);
+    JsonObject entry = array.createNestedObject();
+    entry["index"] = matches[i];
+    entry["name"] = item.name;
+    entry["url"] = item.url;
+  }
+  String json;
+  serializeJson(doc, json);
+  server.send(200, "application/json", json);
+}
+
+/**
+ * @brief Receive the body of a POST request for streams
+ * Feeds the playlist importer as the body arrives, so a large playlist is
+ * never held in memory. Only one playlist import runs at a time.
+ * @param status Stage of the body
+ * @param data Body bytes
+ * @param length Number of bytes
+ */
+void handlePostStreamsBody(HTTPBodyStatus status, const uint8_t* data, size_t length) {
+  switch (status) {
+    case HTTP_BODY_START:
+      if (!playlistImporter.begin()) {
+        sendJsonResponse("error", "Another playlist import is in progress", 409);
+      }
+      break;
+    case HTTP_BODY_DATA:
+      playlistImporter.feed(data, length);
+      break;
+    case HTTP_BODY_ABORT:
+      playlistImporter.abort();
+      break;
+  }
+}
+
+/**
+ * @brief Handle POST request for streams
+ * Updates the playlist with new JSON data and saves to SPIFFS
+ * The JSON array was parsed into a staging playlist while it was received
+ * (see handlePostStreamsBody). This swaps the new playlist in and saves it,
+ * or leaves the playlist unchanged if any item was invalid.
+ */
+void handlePostStreams() {
+  if (!playlistImporter.finish()) {
+    sendJsonResponse("error", playlistImporter.error());
+    return;
+  }
+  // Send success response
+  sendJsonResponse("success", "Playlist updated successfully");
+}
+
+/**
+ * @brief Send the player status as JSON
+ * Used by handlePlayer() through HTTPServer::sendVersioned(), the version
+ * field is the one to pass back as "since" to wait for the next change.
+ */
+static void sendPlayerStatus() {
+  // Create JSON document with appropriate size
+  DynamicJsonDocument doc(512);
+  // Add player status
+  doc["status"] = player.isPlaying() ? "play" : "stop";
+  doc["version"] = player.getStatusVersion();
+  // If playing, add stream information
+  if (player.isPlaying()) {
+    JsonObject streamObj = doc.createNestedObject("stream");
+    streamObj["name"] = player.getStreamName();
+    streamObj["title"] = player.getStreamTitle();
+    streamObj["url"] = player.getStreamUrl();
+    streamObj["index"] = player.getPlaylistIndex();
+    streamObj["bitrate"] = player.getBitrate();
+    // Calculate elapsed time
+    if (player.getPlayStartTime() > 0) {
+      unsigned long currentTime = millis() / 1000;
+      unsigned long elapsedTime = currentTime - player.getPlayStartTime();
+      streamObj["elapsed"] = elapsedTime;
+    } else {
+      streamObj["elapsed"] = 0;
+    }
+  }
+  // Serialize JSON to string
+  String json;
+  serializeJson(doc, json);
+  // Return status as JSON
+  server.send(200, "application/json", json);
+}
+
+/**
+ * @brief Handle player request
+ * Controls stream playback (play/stop) or returns player status
+ * This function handles HTTP requests to control playback or get player status.
+ * For POST requests, it supports both JSON payload and form data with action parameter.
+ * For GET requests, it returns player status and stream information.
+ * 
+ * POST /api/player:
+ *   JSON payload: {"action": "play", "url": "...", "name": "...", "index": 0}
+ *   JSON payload: {"action": "play", "index": 0}
+ *   JSON payload: {"action": "stop"}
+ *   Form data: action=play&url=...&name=...&index=0
+ *   Form data: action=play&index=0
+ *   Form data: action=stop
+ * 
+ * GET /api/player:
+ *   Returns: {"status": "play|stop", "version": 123, "stream": {...}}
+ *   When playing: stream object contains name, title, url, index, bitrate, elapsed
+ *   When stopped: stream object is omitted
+ *   With If-None-Match: 304 while the status is unchanged
+ *   With ?wait=<ms>&since=<version>: held until the status changes or the
+ *   wait is over
+ */
+void handlePlayer() {
+  // Handle GET request - return player status, or 304 if unchanged
+  if (server.method() == HTTP_GET) {
+    // The elapsed time changes without a new version, so the ETag is weak
+    server.sendVersioned([]() { return player.getStatusVersion(); }, sendPlayerStatus, true);
+    return;
+  }
+  // Handle POST request - control playback
+  String action, url, name;
+  int index = -1;
+  // Check if request has JSON payload
+  if (server.hasArg("plain")) {
+    // Handle JSON payload
+    String json = server.arg("plain");
+    DynamicJsonDocument doc(512);
+    DeserializationError error = deserializeJson(doc, json);
+    // Check for JSON parsing errors
+    if (error) {
+      sendJsonResponse("error", "Invalid JSON");
+      return;
+    }
+    // Extract parameters from JSON
+    if (doc.containsKey("action")) {
+      action = doc["action"].as<String>();
+    }
+    if (doc.containsKey("url")) {
+      url = doc["url"].as<String>();
+    }
+    if (doc.containsKey("name")) {
+      name = doc["name"].as<String>();
+    }
+    if (doc.containsKey("index")) {
+      index = doc["index"].as<int>();
+    }
+  } 
+  // Check if request has form data
+  else if (server.hasArg("action")) {
+    // Handle form data
+    action = server.arg("action");
+    if (server.hasArg("url")) {
+      url = server.arg("url");
+    }
+    if (server.hasArg("name")) {
+      name = server.arg("name");
+    }
+    if (server.hasArg("index")) {
+      index = server.arg("index").toInt();
+    }
+  } 
+  else {
+    sendJsonResponse("error", "Missing action parameter");
+    return;
+  }
+  // Check for required action parameter
+  if (action.length() == 0) {
+    sendJsonResponse("error", "Missing required parameter: action");
+    return;
+  }
+  // The MPD and control tasks change the player too, make the changes as one
+  PlayerLock guard(player);
+  if (action == "play") {
+    // Handle case where only index is provided
+    if (url.length() == 0 && name.length() == 0 && index >= 0) {
+      // Validate index
+      if (index >= player.getPlaylistCount()) {
+        sendJsonResponse("error", "Invalid playlist index");
+        return;
+      }
+      // Extract stream data from playlist
+      url = String(player.getPlaylistItem(index).url);
+      name = String(player.getPlaylistItem(index).name);
+      player.setPlaylistIndex(index);
+    } 
+    // Handle case where URL is provided (with optional name)
+    else if (url.length() > 0) {
+      // If no name provided, check if we have a current stream name
+      if (name.length() == 0 && strlen(player.getStreamUrl()) > 0 && url == String(player.getStreamUrl())) {
+        name = (strlen(player.getStreamName()) > 0) ? String(player.getStreamName()) : "Unknown Station";
+      }
+      // Validate URL format
+      if (!url.startsWith("http://") && !url.startsWith("https://")) {
+        sendJsonResponse("error", "Invalid URL format. Must start with http:// or https://");
+        return;
+      }
+      // Update currentSelection based on URL
+      for (int i = 0; i < player.getPlaylistCount(); i++) {
+        if (strcmp(player.getPlaylistItem(i).url, url.c_str()) == 0) {
+          player.setPlaylistIndex(i);
+          break;
+        }
+      }
+    }
+    // Handle case where we're resuming playback
+    else if (url.length() == 0 && strlen(player.getStreamUrl()) > 0) {
+      url = String(player.getStreamUrl());
+      name = (strlen(player.getStreamName()) > 0) ? String(player.getStreamName()) : "Unknown Station";
+    }
+    // No valid play parameters
+    else {
+      sendJsonResponse("error", "Missing required parameters for play action");
+      return;
+    }
+    // Stop any currently playing stream
+    player.stopStream();
+    // Start the stream
+    player.startStream(url.c_str(), name.c_str());
+    // Save player state when user requests to play
+    player.savePlayerState();
+    // Update display and notify clients
+    updateDisplay();
+    sendStatusToClients();
+    // Send success response
+    sendJsonResponse("success", "Stream started successfully");
+  } 
+  else if (action == "stop") {
+    // Stop any currently playing stream
+    player.stopStream();
+    // Update display and notify clients
+    updateDisplay();
+    sendStatusToClients();
+    // Send success response
+    sendJsonResponse("success", "Stream stopped successfully");
+  } 
+  else {
+    sendJsonResponse("error", "Invalid action. Supported actions: play, stop");
+    return;
+  }
+}
+
+/**
+ * @brief Send the mixer status as JSON
+ * Used by handleMixer() through HTTPServer::sendVersioned().
+ */
+static void sendMixerStatus() {
+  // Create JSON document with appropriate size
+  DynamicJsonDocument doc(256);
+  // Add mixer status
+  doc["volume"] = player.getVolume();
+  doc["bass"] = player.getBass();
+  doc["mid"] = player.getMid();
+  doc["treble"] = player.getTreble();
+  doc["version"] = player.getEventVersion(PLAYER_EVENT_MIXER);
+  // Serialize JSON to string
+  String json;
+  serializeJson(doc, json);
+  // Return status as JSON
+  server.send(200, "application/json", json);
+}
+
+/**
+ * @brief Handle mixer request
+ * Gets or sets the volume and tone levels
+ * This function handles HTTP requests to get or set the volume and/or tone levels. 
+ * For GET requests, it returns the current mixer status as JSON.
+ * For POST requests, it supports both JSON payload and form data, validates the input, and updates the settings.
+ * 
+ * GET /api/mixer:
+ *   Returns: {"volume": 11, "bass": 0, "mid": 0, "treble": 0, "version": 4}
+ *   Conditional and long-poll requests as for GET /api/player
+ * 
+ * POST /api/mixer:
+ *   JSON payload: {"volume": 10}
+ *   JSON payload: {"bass": 4, "treble": -2}
+ *   Form data: volume=10
+ *   Form data: bass=4&treble=-2
+ */
+void handleMixer() {
+  // Handle GET request - return current mixer status, or 304 if unchanged
+  if (server.method() == HTTP_GET) {
+    server.sendVersioned([]() { return player.getEventVersion(PLAYER_EVENT_MIXER); }, sendMixerStatus);
+    return;
+  }
+  // Handle POST request - update mixer settings
+  DynamicJsonDocument doc(256);
+  bool hasData = false;
+  // Handle JSON payload
+  if (server.hasArg("plain")) {
+    String json = server.arg("plain");
+    DeserializationError error = deserializeJson(doc, json);
+    // Check for JSON parsing errors
+    if (error) {
+      sendJsonResponse("error", "Invalid JSON");
+      return;
+    }
+    hasData = true;
+  }
+  // Handle form data
+  else {
+    // Check if any form parameters are present
+    if (server.hasArg("volume") || server.hasArg("bass") || 
+        server.hasArg("mid") || server.hasArg("treble")) {
+      hasData = true;
+      // Add form data to JSON document
+      if (server.hasArg("volume")) {
+        doc["volume"] = server.arg("volume");
+      }
+      if (server.hasArg("bass")) {
+        doc["bass"] = server.arg("bass");
+      }
+      if (server.hasArg("mid")) {
+        doc["mid"] = server.arg("mid");
+      }
+      if (server.hasArg("treble")) {
+        doc["treble"] = server.arg("treble");
+      }
+    }
+  }
+  // Check if any data was provided
+  if (!hasData) {
+    sendJsonResponse("error", "Missing data: volume, bass, mid, or treble");
+    return;
+  }
+  // The MPD and control tasks change the mixer too, check and apply as one
+  PlayerLock guard(player);
+  bool toneUpdated = false;
+  int volume = -1;
+  int bass = player.getBass();
+  int mid = player.getMid();
+  int treble = player.getTreble();
+  // Handle volume setting
+  if (doc.containsKey("volume")) {
+    int newVolume;
+    if (doc["volume"].is<const char*>()) {
+      newVolume = atoi(doc["volume"].as<const char*>());
+    } else {
+      newVolume = doc["volume"];
+    }
+    // Validate volume range
+    if (newVolume < 0 || newVolume > 22) {
+      sendJsonResponse("error", "Volume must be between 0 and 22");
+      return;
+    }
+    volume = newVolume;
+  }
+  // Handle bass setting
+  if (doc.containsKey("bass")) {
+    int newBass;
+    if (doc["bass"].is<const char*>()) {
+      newBass = atoi(doc["bass"].as<const char*>());
+    } else {
+      newBass = doc["bass"];
+    }
+    if (newBass < -6 || newBass > 6) {
+      sendJsonResponse("error", "Bass must be between -6 and 6");
+      return;
+    }
+    bass = newBass;
+    toneUpdated = true;
+  }
+  // Handle mid setting
+  if (doc.containsKey("mid")) {
+    int newMid;
+    if (doc["mid"].is<const char*>()) {
+      newMid = atoi(doc["mid"].as<const char*>());
+    } else {
+      newMid = doc["mid"];
+    }
+    if (newMid < -6 || newMid > 6) {
+      sendJsonResponse("error", "Midrange must be between -6 and 6");
+      return;
+    }
+    mid = newMid;
+    toneUpdated = true;
+  }
+  // Handle treble setting
+  if (doc.containsKey("treble")) {
+    int newTreble;
+    if (doc["treble"].is<const char*>()) {
+      newTreble = atoi(doc["treble"].as<const char*>());
+    } else {
+      newTreble = doc["treble"];
+    }
+    if (newTreble < -6 || newTreble > 6) {
+      sendJsonResponse("error", "Treble must be between -6 and 6");
+      return;
+    }
+    treble = newTreble;
+    toneUpdated = true;
+  }
+  // Apply the settings once all are valid
+  if (volume >= 0) {
+    player.setVolume(volume);
+  }
+  if (toneUpdated) {
+    player.setTone(bass, mid, treble);
+  }
+  // Update display and notify clients
+  updateDisplay();
+  sendStatusToClients();
+  // Send success response
+  sendJsonResponse("success", "Mixer settings updated successfully");
+}
+
+/**
+ * @brief Handle batch request
+ * Applies several player and mixer actions as one change
+ * A scene change such as "select station 5, set volume 12, bass +2, play"
+ * takes one request, one state save and one status broadcast instead of
+ * one per action. The batch is checked first and rejected as a whole if an
+ * action is invalid, see PlayerBatch.
+ *
+ * POST /api/batch:
+ *   JSON payload: [{"action": "select", "index": 5},
+ *                  {"action": "mixer", "volume": 12, "bass": 2},
+ *                  {"action": "play"}]
+ *   JSON payload: {"actions": [...]}
+ *   Returns: {"status": "success", "message": "...", "player": {...}}
+ *   The player object holds the resulting state, index, name and mixer levels
+ */
+void handleBatch() {
+  if (!server.hasArg("plain")) {
+    sendJsonResponse("error", "Missing JSON data");
+    return;
+  }
+  DynamicJsonDocument request(2048);
+  if (deserializeJson(request, server.arg("plain"))) {
+    sendJsonResponse("error", "Invalid JSON");
+    return;
+  }
+  JsonVariantConst actions = request.as<JsonVariantConst>();
+  if (actions.is<JsonObjectConst>()) {
+    actions = actions["actions"];
+  }
+  PlayerBatch batch(player);
+  if (!batch.run(actions)) {
+    sendJsonResponse("error", batch.error());
+    return;
+  }
+  DynamicJsonDocument doc(512);
+  doc["status"] = "success";
+  doc["message"] = "Batch applied successfully";
+  batch.report(doc.createNestedObject("player"));
+  String json;
+  serializeJson(doc, json);
+  server.send(200, "application/json", json);
+}
+
+
+/**
+ * @brief Handle export configuration request
+ * Exports all JSON configuration files from SPIFFS as a single JSON object
+ * Keys are filenames and values are file contents. The files are copied to
+ * the client through the server's chunk buffer as it is sent, so the size
+ * of the backup does not depend on the free heap.
+ */
+void handleExportConfig() {
+  auto exporter = std::make_shared<ConfigExporter>(SPIFFS);
+  server.sendStream(200, "application/json", [exporter](uint8_t* buffer, size_t size) -> int {
+    return exporter->read(buffer, size);
+  });
+}
+
+/**
+ * @brief Receive the body of an import configuration request
+ * Copies each configuration section to a temporary file as the body
+ * arrives, so the backup is never held in memory.
+ * @param status Stage of the body
+ * @param data Body bytes
+ * @param length Number of bytes
+ */
+void handleImportConfigBody(HTTPBodyStatus status, const uint8_t* data, size_t length) {
+  switch (status) {
+    case HTTP_BODY_START:
+      if (!configImporter.begin()) {
+        sendJsonResponse("error", "Another configuration import is in progress", 409);
+      }
+      break;
+    case HTTP_BODY_DATA:
+      configImporter.feed(data, length);
+      break;
+    case HTTP_BODY_ABORT:
+      configImporter.abort();
+      break;
+  }
+}
+
+/**
+ * @brief Handle import configuration request
+ * Imports a combined JSON configuration file and saves individual files to SPIFFS
+ * The config.json, wifi.json, playlist.json and player.json sections were
+ * written to temporary files while the body was received (see
+ * handleImportConfigBody); they replace the settings files only if the whole
+ * backup is valid.
+ */
+void handleImportConfig() {
+  if (!configImporter.finish()) {
+    sendJsonResponse("error", configImporter.error());
+    return;
+  }
+  sendJsonResponse("success", "Configuration imported successfully");
+}
+
+/**
+ * @brief Register the routes of the player, mixer, playlist and backup API
+ * Called by setupWebServer(), the host programs register the same routes
+ * so they serve the handlers the firmware runs.
+ */
+void setupApiRoutes() {
+  server.on("/api/streams", HTTP_GET, handleGetStreams);
+  server.on("/api/streams", HTTP_POST, handlePostStreams, handlePostStreamsBody);
+  server.on("/api/streams/search", HTTP_GET, handleSearchStreams);
+  server.on("/api/player", HTTP_GET, handlePlayer);
+  server.on("/api/player", HTTP_POST, handlePlayer);
+  server.on("/api/mixer", HTTP_GET, handleMixer);
+  server.on("/api/mixer", HTTP_POST, handleMixer);
+  server.on("/api/batch", HTTP_POST, handleBatch);
+  server.on("/api/config/export", HTTP_GET, handleExportConfig);
+  server.on("/api/config/import", HTTP_POST, handleImportConfig, handleImportConfigBody);
+}
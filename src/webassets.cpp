@@ -0,0 +1,70 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "webassets.h"
+#include <string.h>
+
+// Written to the build directory by tools/gzip_assets.py before each build
+#if __has_include("webassets_data.h")
+#include "webassets_data.h"
+#else
+static const uint8_t webAssetImage[4] = {0};
+static const WebAsset webAssetIndex[1] = {{"", "", "", 0, 0, false}};
+static const size_t webAssetCount = 0;
+#endif
+
+/**
+ * @brief Find a linked-in asset
+ * @details Binary search of the index, which the build step sorts by path.
+ * @param path Path as in data/, like "/player.html"
+ * @return The asset, or nullptr if the firmware has none by that path
+ */
+const WebAsset* findWebAsset(const char* path) {
+  size_t low = 0;
+  size_t high = webAssetCount;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    int cmp = strcmp(path, webAssetIndex[mid].path);
+    if (cmp == 0) {
+      return &webAssetIndex[mid];
+    }
+    if (cmp < 0) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Get the stored bytes of an asset
+ * @param asset Asset from findWebAsset()
+ * @return Pointer to flash
+ */
+const uint8_t* webAssetData(const WebAsset* asset) {
+  return webAssetImage + asset->offset;
+}
+
+/**
+ * @brief Get the number of linked-in assets
+ * @return Asset count, 0 if the firmware was built without them
+ */
+size_t webAssetsCount() {
+  return webAssetCount;
+}
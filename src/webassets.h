@@ -0,0 +1,59 @@
+/*
+ * CubeRadio - An ESP32-based internet radio player with MPD protocol support
+ * Copyright (C) 2025 Costin Stroie
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEBASSETS_H
+#define WEBASSETS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Web asset linked into the firmware
+ * @details Built from data/ by tools/gzip_assets.py. The bytes stay in flash
+ * and are read through the cache mapping, so serving them needs neither
+ * SPIFFS nor a copy in RAM.
+ */
+struct WebAsset {
+  const char* path;    ///< Path in data/, with the leading slash
+  const char* type;    ///< MIME type
+  const char* etag;    ///< Quoted strong ETag
+  uint32_t offset;     ///< Offset in the asset image
+  uint32_t length;     ///< Stored length
+  bool gzip;           ///< Stored gzipped
+};
+
+/**
+ * @brief Find a linked-in asset
+ * @param path Path as in data/, like "/player.html"
+ * @return The asset, or nullptr if the firmware has none by that path
+ */
+const WebAsset* findWebAsset(const char* path);
+
+/**
+ * @brief Get the stored bytes of an asset
+ * @param asset Asset from findWebAsset()
+ * @return Pointer to flash
+ */
+const uint8_t* webAssetData(const WebAsset* asset);
+
+/**
+ * @brief Get the number of linked-in assets
+ * @return Asset count, 0 if the firmware was built without them
+ */
+size_t webAssetsCount();
+
+#endif // WEBASSETS_H
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# CubeRadio - Web asset packer for the firmware and the SPIFFS image
+# Copyright (C) 2025 Costin Stroie
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Pack the web UI from data/ into the firmware and stage the rest for SPIFFS.
+
+Text assets (HTML, CSS, JavaScript, SVG) are gzipped. Every web asset gets a
+strong ETag, the first 16 hex digits of the SHA-256 of the stored bytes, and
+references from the HTML pages to the other assets get a ?v=<etag> suffix,
+so the browser can keep those for a year and still fetch new versions after
+an update.
+
+The assets are written as one C++ header (webassets_data.h): a single byte
+array holding all of them back to back, and an index sorted by path with
+the offset, length, MIME type and ETag of each. Linked into the firmware,
+the array stays in flash and is read through the cache mapping, see
+webassets.cpp. The SPIFFS image then only needs the JSON settings files.
+With --no-bundle the assets go to SPIFFS instead, as name.gz, with their
+ETags in /assets.json for HTTPServer::serveStatic().
+
+As a PlatformIO extra script it writes the header to the build directory
+before every build, and before buildfs/uploadfs stages the SPIFFS image. It
+also runs on its own:
+  tools/gzip_assets.py --header .pio/generated/webassets_data.h
+  tools/gzip_assets.py --spiffs .pio/assets --no-bundle
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+
+# Extensions stored compressed
+COMPRESS = (".html", ".css", ".js", ".svg", ".txt")
+# Extensions of web assets, the others (JSON settings) change on the device
+ASSETS = COMPRESS + (".png", ".jpg", ".gif", ".ico")
+# MIME types, as HTTPServer::contentTypeFor() names them
+TYPES = {
+    ".html": "text/html", ".css": "text/css", ".js": "application/javascript",
+    ".svg": "image/svg+xml", ".txt": "text/plain", ".png": "image/png",
+    ".jpg": "image/jpeg", ".gif": "image/gif", ".ico": "image/x-icon",
+}
+# Manifest read by the firmware, must match HTTP_ASSET_MANIFEST
+MANIFEST = "assets.json"
+# Generated header, included by src/webassets.cpp
+HEADER = "webassets_data.h"
+# Local asset references in the HTML pages
+REFERENCE = re.compile(r'(href|src)="(/?)([\w.\-]+\.(?:css|js|svg|png|ico))"')
+
+
+def etag(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def pack(source):
+    """Read source and prepare the assets.
+
+    Returns the web assets as a list of (name, data, gzipped, etag) sorted by
+    name, the other files as (name, data) and the total size before packing.
+    """
+    names = sorted(n for n in os.listdir(source)
+                   if not n.startswith(".") and os.path.isfile(os.path.join(source, n)))
+    contents = {}
+    for name in names:
+        with open(os.path.join(source, name), "rb") as f:
+            contents[name] = f.read()
+
+    # Assets first, the pages refer to their tags
+    tags = {}
+    assets = []
+    others = []
+    pages = [n for n in names if n.endswith(".html")]
+    for name in [n for n in names if n not in pages] + pages:
+        data = contents[name]
+        if not name.endswith(ASSETS):
+            others.append((name, data))
+            continue
+        if name in pages:
+            data = REFERENCE.sub(lambda m: version(m, tags), data.decode("utf-8")).encode("utf-8")
+        packed = False
+        if name.endswith(COMPRESS):
+            compressed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(compressed) < len(data):
+                data, packed = compressed, True
+        tags[name] = etag(data)
+        assets.append((name, data, packed, tags[name]))
+    assets.sort()
+    return assets, others, sum(len(c) for c in contents.values())
+
+
+def version(match, tags):
+    """Add the ETag of a referenced asset as its version."""
+    attribute, slash, name = match.groups()
+    if name not in tags:
+        return match.group(0)
+    return '%s="%s%s?v=%s"' % (attribute, slash, name, tags[name])
+
+
+def stage(target, assets, others, bundle):
+    """Write the SPIFFS image directory, with the assets unless bundled."""
+    if os.path.isdir(target):
+        shutil.rmtree(target)
+    os.makedirs(target)
+    for name, data in others:
+        with open(os.path.join(target, name), "wb") as f:
+            f.write(data)
+    if bundle:
+        return
+    manifest = {}
+    for name, data, packed, tag in assets:
+        stored = name + ".gz" if packed else name
+        with open(os.path.join(target, stored), "wb") as f:
+            f.write(data)
+        manifest["/" + stored] = tag
+    with open(os.path.join(target, MANIFEST), "w") as f:
+        json.dump(manifest, f, separators=(",", ":"), sort_keys=True)
+
+
+def header(assets):
+    """Generate the C++ header with the asset image and its index."""
+    lines = [
+        "// Generated by tools/gzip_assets.py from data/, do not edit",
+        "",
+        "// All assets back to back",
+        "static const uint8_t webAssetImage[] PROGMEM __attribute__((aligned(4))) = {",
+    ]
+    offset = 0
+    index = []
+    for name, data, packed, tag in assets:
+        index.append('  {"/%s", "%s", "\\"%s\\"", %d, %d, %s},' % (
+            name, TYPES[os.path.splitext(name)[1]], tag, offset, len(data), "true" if packed else "false"))
+        lines.append("  // /%s" % name)
+        for i in range(0, len(data), 16):
+            lines.append("  " + ",".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+        # Keep every asset aligned
+        padding = -len(data) % 4
+        if padding:
+            lines.append("  " + ",".join(["0x00"] * padding) + ",")
+        offset += len(data) + padding
+    if not assets:
+        lines.append("  0x00,")
+    lines += ["};", "", "// Index sorted by path", "static const WebAsset webAssetIndex[] = {"]
+    lines += index or ['  {"", "", "", 0, 0, false},']
+    lines += ["};", "", "static const size_t webAssetCount = %d;" % len(assets), ""]
+    return "\n".join(lines)
+
+
+def write_header(path, assets):
+    """Write the header, leaving it alone when unchanged so nothing rebuilds."""
+    text = header(assets)
+    if os.path.isfile(path):
+        with open(path) as f:
+            if f.read() == text:
+                return False
+    directory = os.path.dirname(path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    with open(path, "w") as f:
+        f.write(text)
+    return True
+
+
+def report(source, assets, others, before):
+    after = sum(len(a[1]) for a in assets)
+    print("Assets: %s, %d web assets packed to %d bytes, %d other files, %d bytes before" % (
+        source, len(assets), after, len(others), before))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Pack the CubeRadio web assets")
+    parser.add_argument("source", nargs="?", default="data", help="asset directory")
+    parser.add_argument("--header", help="write the firmware asset header to this file")
+    parser.add_argument("--spiffs", help="stage the SPIFFS image in this directory")
+    parser.add_argument("--no-bundle", action="store_true", help="put the assets on SPIFFS instead")
+    args = parser.parse_args(argv[1:])
+    assets, others, before = pack(args.source)
+    if args.header:
+        write_header(args.header, assets if not args.no_bundle else [])
+    if args.spiffs:
+        stage(args.spiffs, assets, others, not args.no_bundle)
+    report(args.source, assets, others, before)
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821, only defined inside PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main(sys.argv))
+else:
+    from SCons.Script import COMMAND_LINE_TARGETS  # noqa: E402
+
+    source = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+    generated = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+    assets, others, before = pack(source)
+    if write_header(os.path.join(generated, HEADER), assets):
+        report(source, assets, others, before)
+    env.Append(CPPPATH=[generated])  # noqa: F821
+    if any(t in COMMAND_LINE_TARGETS for t in ("buildfs", "uploadfs", "uploadfsota")):
+        target = os.path.join(env.subst("$BUILD_DIR"), "spiffs")  # noqa: F821
+        stage(target, assets, others, True)
+        env.Replace(PROJECT_DATA_DIR=target)  # noqa: F821
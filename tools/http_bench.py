@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+#
+# CubeRadio - HTTP load generator and latency benchmark
+# Copyright (C) 2025 Costin Stroie
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Replay mixes of web interface requests against a CubeRadio (device or host
+build) over concurrent connections and report per-request latency
+percentiles and throughput.
+
+Examples:
+  tools/http_bench.py --host cuberadio.local --mix poll --connections 4 --duration 30
+  tools/http_bench.py --port 8080 --mix page --connections 4 --json before.json
+  tools/http_bench.py --port 8080 --mix page --connections 4 --compare before.json
+  tools/http_bench.py --port 8080 --mix poll --slow-clients 1 --close
+  tools/http_bench.py --port 8080 --mix page --gzip --cache
+  tools/http_bench.py --port 8080 --mix firstpaint --gzip
+"""
+
+import argparse
+import json
+import random
+import socket
+import sys
+import threading
+import time
+
+# Request mixes: each entry is (operation name, weight)
+MIXES = {
+    "poll": [("player", 1), ("mixer", 1)],
+    "player": [("player", 1)],
+    "setvol": [("setvol", 1)],
+    "streams": [("streams", 1)],
+    "export": [("export", 1)],
+    "page": [("page", 1), ("styles", 1), ("scripts", 1)],
+    "firstpaint": [("firstpaint", 1)],
+    "mixed": [("player", 10), ("mixer", 4), ("streams", 2), ("page", 1), ("styles", 1),
+              ("scripts", 1), ("setvol", 1)],
+}
+
+# Request sent for each operation: (method, path, body)
+REQUESTS = {
+    "player": ("GET", "/api/player", None),
+    "mixer": ("GET", "/api/mixer", None),
+    "setvol": ("POST", "/api/mixer", None),
+    "streams": ("GET", "/api/streams", None),
+    "export": ("GET", "/api/config/export", None),
+    "page": ("GET", "/", None),
+    "styles": ("GET", "/styles.css", None),
+    "scripts": ("GET", "/scripts.js", None),
+    "firstpaint": ("GET", "/", None),
+}
+
+# Render-blocking requests of the player page, timed together as "firstpaint"
+FIRST_PAINT = ["/", "/pico.min.css", "/styles.css", "/scripts.js"]
+
+
+class HTTPError(Exception):
+    pass
+
+
+class Connection:
+    """Minimal HTTP/1.1 client, keeps the connection open between requests."""
+
+    def __init__(self, host, port, timeout, close, gzip=False, cache=False):
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+        self.close_each = close
+        self.gzip = gzip
+        self.cache = cache
+        self.etags = {}
+        self.sock = None
+        self.buf = b""
+
+    def connect(self):
+        self.sock = socket.create_connection((self.host, self.port), timeout=self.timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buf = b""
+
+    def request(self, method, path, body=None):
+        """Send one request and read the response, return (status, body length)."""
+        if self.sock is None:
+            self.connect()
+        headers = "Host: %s\r\n" % self.host
+        if self.close_each:
+            headers += "Connection: close\r\n"
+        if self.gzip:
+            headers += "Accept-Encoding: gzip, deflate\r\n"
+        if self.cache and path in self.etags:
+            headers += "If-None-Match: %s\r\n" % self.etags[path]
+        data = body or b""
+        if body is not None:
+            headers += "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: %d\r\n" % len(data)
+        self.sock.sendall(("%s %s HTTP/1.1\r\n%s\r\n" % (method, path, headers)).encode() + data)
+        while b"\r\n\r\n" not in self.buf:
+            self.recv()
+        head, self.buf = self.buf.split(b"\r\n\r\n", 1)
+        lines = head.decode(errors="replace").split("\r\n")
+        status = int(lines[0].split(" ")[1])
+        length = None
+        chunked = False
+        keep = True
+        for line in lines[1:]:
+            name, _, value = line.partition(":")
+            if name.lower() == "content-length":
+                length = int(value)
+            elif name.lower() == "transfer-encoding" and value.strip().lower() == "chunked":
+                chunked = True
+            elif name.lower() == "connection" and value.strip().lower() == "close":
+                keep = False
+            elif name.lower() == "etag" and self.cache:
+                self.etags[path] = value.strip()
+        if status in (204, 304):
+            length = 0
+        elif chunked:
+            return status, self.read_chunked(keep)
+        elif length is None:
+            # Body runs to the end of the connection
+            try:
+                while self.recv():
+                    pass
+            except HTTPError:
+                pass
+            length = len(self.buf)
+            keep = False
+        else:
+            while len(self.buf) < length:
+                self.recv()
+        self.buf = self.buf[length:]
+        if not keep:
+            self.close()
+        return status, length
+
+    def read_chunked(self, keep):
+        """Read a chunked body, return its decoded length."""
+        length = 0
+        while True:
+            while b"\r\n" not in self.buf:
+                self.recv()
+            line, self.buf = self.buf.split(b"\r\n", 1)
+            size = int(line.split(b";")[0], 16)
+            while len(self.buf) < size + 2:
+                self.recv()
+            self.buf = self.buf[size + 2:]
+            length += size
+            if size == 0:
+                break
+        if not keep:
+            self.close()
+        return length
+
+    def recv(self):
+        chunk = self.sock.recv(65536)
+        if not chunk:
+            raise HTTPError("connection closed")
+        self.buf += chunk
+        return len(chunk)
+
+    def close(self):
+        if self.sock is not None:
+            self.sock.close()
+        self.sock = None
+
+
+class Stats:
+    """Thread safe latency collector."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.samples = {}
+        self.errors = {}
+        self.requests = 0
+        self.bytes = 0
+
+    def add(self, op, latency, length, ok):
+        with self.lock:
+            self.samples.setdefault(op, []).append(latency)
+            self.requests += 1
+            self.bytes += length
+            if not ok:
+                self.errors[op] = self.errors.get(op, 0) + 1
+
+    def error(self, kind):
+        with self.lock:
+            self.errors[kind] = self.errors.get(kind, 0) + 1
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0.0
+    k = min(len(sorted_values) - 1, int(round(pct / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[k]
+
+
+def worker(args, ops, weights, stats, deadline, seed):
+    rng = random.Random(seed)
+    conn = Connection(args.host, args.port, args.timeout, args.close, args.gzip, args.cache)
+    try:
+        while time.perf_counter() < deadline:
+            op = rng.choices(ops, weights)[0]
+            method, path, _ = REQUESTS[op]
+            body = b"volume=%d" % rng.randint(5, 18) if op == "setvol" else None
+            start = time.perf_counter()
+            if op == "firstpaint":
+                ok, length = True, 0
+                for page_path in FIRST_PAINT:
+                    status, size = conn.request(method, page_path)
+                    ok, length = ok and status in (200, 304), length + size
+            else:
+                status, length = conn.request(method, path, body)
+                ok = status in (200, 304)
+            stats.add(op, time.perf_counter() - start, length, ok)
+            if args.think:
+                time.sleep(args.think / 1000.0)
+    except (OSError, HTTPError, ValueError, IndexError) as exc:
+        stats.error("io")
+        if args.verbose:
+            print("worker: %s" % exc, file=sys.stderr)
+    finally:
+        conn.close()
+
+
+def slow_client(args, stats, deadline):
+    """Upload a request body one byte at a time, like a client on a bad link."""
+    try:
+        sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+        length = 4096
+        sock.sendall(("POST /api/mixer HTTP/1.1\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                      "Content-Length: %d\r\n\r\n" % (args.host, length)).encode())
+        sent = 0
+        while time.perf_counter() < deadline and sent < length:
+            sock.send(b" ")
+            sent += 1
+            time.sleep(args.slow_interval / 1000.0)
+        sock.close()
+    except OSError as exc:
+        stats.error("slow")
+        if args.verbose:
+            print("slow client: %s" % exc, file=sys.stderr)
+
+
+def summarize(stats, elapsed):
+    ops = {}
+    for op, values in sorted(stats.samples.items()):
+        values = sorted(values)
+        ops[op] = {
+            "count": len(values),
+            "errors": stats.errors.get(op, 0),
+            "p50_ms": percentile(values, 50) * 1000,
+            "p99_ms": percentile(values, 99) * 1000,
+            "p999_ms": percentile(values, 99.9) * 1000,
+            "max_ms": values[-1] * 1000,
+        }
+    return {
+        "elapsed_s": elapsed,
+        "requests": stats.requests,
+        "requests_per_s": stats.requests / elapsed if elapsed > 0 else 0.0,
+        "bytes_per_s": stats.bytes / elapsed if elapsed > 0 else 0.0,
+        "io_errors": stats.errors.get("io", 0),
+        "ops": ops,
+    }
+
+
+def print_report(result, baseline=None):
+    print("%-14s %8s %6s %10s %10s %10s %10s" % ("request", "count", "errs", "p50 ms", "p99 ms", "p999 ms", "max ms"))
+    for op, s in result["ops"].items():
+        print("%-14s %8d %6d %10.2f %10.2f %10.2f %10.2f" % (
+            op, s["count"], s["errors"], s["p50_ms"], s["p99_ms"], s["p999_ms"], s["max_ms"]))
+        if baseline and op in baseline["ops"]:
+            b = baseline["ops"][op]
+            print("%-14s %8s %6s %10s %10s %10s %10s" % (
+                "  vs baseline", "", "", ratio(b["p50_ms"], s["p50_ms"]), ratio(b["p99_ms"], s["p99_ms"]),
+                ratio(b["p999_ms"], s["p999_ms"]), ratio(b["max_ms"], s["max_ms"])))
+    print("requests: %d in %.1f s = %.1f req/s, %.1f KB/s" % (
+        result["requests"], result["elapsed_s"], result["requests_per_s"], result["bytes_per_s"] / 1024))
+    if baseline:
+        print("throughput vs baseline: %s" % ratio(result["requests_per_s"], baseline["requests_per_s"]))
+    if result["io_errors"]:
+        print("I/O errors: %d" % result["io_errors"])
+
+
+def ratio(before, after):
+    """Speedup factor, greater than 1 means the new run is better."""
+    if after <= 0:
+        return "n/a"
+    return "x%.2f" % (before / after)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CubeRadio HTTP load generator")
+    parser.add_argument("--host", default="127.0.0.1", help="device or host build address")
+    parser.add_argument("--port", type=int, default=80, help="web server port")
+    parser.add_argument("--mix", default="poll", help="request mix: %s, or op=weight,..." % ", ".join(MIXES))
+    parser.add_argument("--connections", type=int, default=1, help="concurrent connections")
+    parser.add_argument("--close", action="store_true", help="open a new connection for every request")
+    parser.add_argument("--gzip", action="store_true", help="accept gzip encoded responses")
+    parser.add_argument("--cache", action="store_true", help="revalidate with the ETags received, like a browser")
+    parser.add_argument("--slow-clients", type=int, default=0, help="extra connections uploading a byte at a time")
+    parser.add_argument("--slow-interval", type=float, default=50.0, help="pause between slow upload bytes, ms")
+    parser.add_argument("--duration", type=float, default=10.0, help="run time in seconds")
+    parser.add_argument("--think", type=float, default=0.0, help="pause between requests in ms")
+    parser.add_argument("--timeout", type=float, default=10.0, help="socket timeout in seconds")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("--json", help="write results to this file")
+    parser.add_argument("--compare", help="baseline results file to compare against")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    if args.mix in MIXES:
+        mix = MIXES[args.mix]
+    else:
+        mix = []
+        for part in args.mix.split(","):
+            name, _, weight = part.partition("=")
+            mix.append((name.strip(), float(weight or 1)))
+    ops = [op for op, _ in mix]
+    weights = [w for _, w in mix]
+    unknown = [op for op in ops if op not in REQUESTS]
+    if unknown:
+        parser.error("unknown request: %s" % ", ".join(unknown))
+
+    stats = Stats()
+    start = time.perf_counter()
+    deadline = start + args.duration
+    slow = [threading.Thread(target=slow_client, args=(args, stats, deadline)) for _ in range(args.slow_clients)]
+    # Let the slow uploads start before the load
+    for t in slow:
+        t.start()
+    if slow:
+        time.sleep(0.3)
+    workers = [threading.Thread(target=worker, args=(args, ops, weights, stats, deadline, args.seed + i))
+               for i in range(args.connections)]
+    for t in workers:
+        t.start()
+    for t in workers + slow:
+        t.join()
+    elapsed = time.perf_counter() - start
+
+    result = summarize(stats, elapsed)
+    result["config"] = {k: v for k, v in vars(args).items() if k not in ("json", "compare", "verbose")}
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+    print_report(result, baseline)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+    return 0 if not result["io_errors"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+#
+# CubeRadio - MPD protocol load generator and latency benchmark
+# Copyright (C) 2025 Costin Stroie
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Replay mixes of MPD commands against a CubeRadio (device or host build) and
+report per-operation latency percentiles and throughput.
+
+Examples:
+  tools/mpd_bench.py --host cuberadio.local --mix poll --duration 30
+  tools/mpd_bench.py --port 6600 --connections 4 --mix mixed --json after.json
+  tools/mpd_bench.py --mix status --pipeline 10 --compare before.json
+  tools/mpd_bench.py --mix setvol --idle-clients 2
+"""
+
+import argparse
+import json
+import random
+import socket
+import sys
+import threading
+import time
+
+# Command mixes: each entry is (operation name, weight)
+MIXES = {
+    "status": [("status", 1)],
+    "currentsong": [("currentsong", 1)],
+    "poll": [("status", 1), ("currentsong", 1)],
+    "playlist": [("playlistinfo", 1)],
+    "idle": [("idle", 1)],
+    "cmdlist": [("cmdlist", 1)],
+    "setvol": [("setvol", 1)],
+    "mixed": [("status", 10), ("currentsong", 6), ("playlistinfo", 2),
+              ("cmdlist", 2), ("idle", 1), ("setvol", 1)],
+}
+
+# Command sequence sent for the "cmdlist" operation
+CMDLIST = ["command_list_ok_begin", "status", "currentsong", "playlistinfo", "command_list_end"]
+
+
+class MPDError(Exception):
+    pass
+
+
+class Connection:
+    """Minimal line oriented MPD client."""
+
+    def __init__(self, host, port, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buf = b""
+        banner = self.readline()
+        if not banner.startswith(b"OK MPD"):
+            raise MPDError("unexpected banner: %r" % banner)
+        # Servers refusing extra clients send an ACK right after the banner
+        self.sock.settimeout(0.05)
+        try:
+            self.buf += self.sock.recv(4096)
+        except socket.timeout:
+            pass
+        self.sock.settimeout(timeout)
+        if self.buf.startswith(b"ACK"):
+            raise MPDError("connection refused: %s" % self.buf.decode(errors="replace").strip())
+
+    def send(self, data):
+        self.sock.sendall(data)
+
+    def readline(self):
+        while b"\n" not in self.buf:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                raise MPDError("connection closed")
+            self.buf += chunk
+        line, self.buf = self.buf.split(b"\n", 1)
+        return line
+
+    def read_response(self):
+        """Read lines up to the final OK or ACK, return (lines, ok)."""
+        lines = []
+        while True:
+            line = self.readline()
+            if line == b"OK":
+                return lines, True
+            if line.startswith(b"ACK "):
+                return lines + [line], False
+            lines.append(line)
+
+    def drain(self, wait):
+        """Discard anything arriving within wait seconds."""
+        self.sock.settimeout(wait)
+        try:
+            while True:
+                chunk = self.sock.recv(65536)
+                if not chunk:
+                    break
+        except socket.timeout:
+            pass
+        self.buf = b""
+
+    def close(self):
+        try:
+            self.send(b"close\n")
+        except OSError:
+            pass
+        self.sock.close()
+
+
+class Stats:
+    """Thread safe latency collector."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.samples = {}
+        self.errors = {}
+        self.commands = 0
+        self.refused = 0
+        self.setvol_times = []
+        self.notify_times = []
+
+    def add(self, op, latency, commands, ok):
+        with self.lock:
+            self.samples.setdefault(op, []).append(latency)
+            self.commands += commands
+            if not ok:
+                self.errors[op] = self.errors.get(op, 0) + 1
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0.0
+    k = min(len(sorted_values) - 1, int(round(pct / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[k]
+
+
+def run_op(conn, op, args, stats):
+    """Execute one benchmark operation and record its latency."""
+    if op == "cmdlist":
+        payload = ("\n".join(CMDLIST) + "\n").encode()
+        start = time.perf_counter()
+        conn.send(payload)
+        _, ok = conn.read_response()
+        stats.add(op, time.perf_counter() - start, len(CMDLIST) - 2, ok)
+    elif op == "idle":
+        # Enter idle, hold it, then measure how fast noidle is answered
+        conn.send(b"idle\n")
+        time.sleep(args.idle_hold / 1000.0)
+        start = time.perf_counter()
+        conn.send(b"noidle\n")
+        lines, ok = conn.read_response()
+        stats.add(op, time.perf_counter() - start, 2, ok)
+        if any(l.startswith(b"changed:") for l in lines):
+            # Idle ended on its own, the noidle may get a reply of its own
+            conn.drain(0.2)
+    elif op == "setvol":
+        volume = random.randint(10, 90)
+        start = time.perf_counter()
+        with stats.lock:
+            stats.setvol_times.append(start)
+        conn.send(b"setvol %d\n" % volume)
+        _, ok = conn.read_response()
+        stats.add(op, time.perf_counter() - start, 1, ok)
+    else:
+        count = max(1, args.pipeline)
+        payload = (op + "\n").encode() * count
+        start = time.perf_counter()
+        conn.send(payload)
+        ok = True
+        for _ in range(count):
+            _, res = conn.read_response()
+            ok = ok and res
+        # With pipelining the sample is the time to the last reply
+        stats.add(op, time.perf_counter() - start, count, ok)
+
+
+def worker(args, ops, weights, stats, deadline, seed):
+    rng = random.Random(seed)
+    try:
+        conn = Connection(args.host, args.port, args.timeout)
+    except (OSError, MPDError) as exc:
+        with stats.lock:
+            stats.refused += 1
+        if args.verbose:
+            print("worker: %s" % exc, file=sys.stderr)
+        return
+    try:
+        while time.perf_counter() < deadline:
+            op = rng.choices(ops, weights)[0]
+            run_op(conn, op, args, stats)
+            if args.think:
+                time.sleep(args.think / 1000.0)
+    except (OSError, MPDError) as exc:
+        with stats.lock:
+            stats.errors["io"] = stats.errors.get("io", 0) + 1
+        if args.verbose:
+            print("worker: %s" % exc, file=sys.stderr)
+    finally:
+        conn.close()
+
+
+def idle_client(args, stats, deadline):
+    """Keep a persistent idle connection open, like a phone app does."""
+    try:
+        conn = Connection(args.host, args.port, args.timeout)
+    except (OSError, MPDError) as exc:
+        with stats.lock:
+            stats.refused += 1
+        if args.verbose:
+            print("idle client: %s" % exc, file=sys.stderr)
+        return
+    try:
+        conn.sock.settimeout(0.25)
+        conn.send(b"idle\n")
+        while time.perf_counter() < deadline:
+            try:
+                lines, _ = conn.read_response()
+            except socket.timeout:
+                continue
+            now = time.perf_counter()
+            if any(l.startswith(b"changed:") for l in lines):
+                with stats.lock:
+                    stats.notify_times.append(now)
+            conn.send(b"idle\n")
+        conn.sock.settimeout(args.timeout)
+        conn.send(b"noidle\n")
+        conn.drain(0.2)
+    except (OSError, MPDError) as exc:
+        if args.verbose:
+            print("idle client: %s" % exc, file=sys.stderr)
+    finally:
+        conn.close()
+
+
+def notify_latencies(stats):
+    """Match each idle notification to the latest setvol sent before it."""
+    sends = sorted(stats.setvol_times)
+    result = []
+    for t in sorted(stats.notify_times):
+        prior = [s for s in sends if s <= t]
+        if prior:
+            result.append(t - prior[-1])
+    return result
+
+
+def summarize(stats, elapsed):
+    ops = {}
+    for op, values in sorted(stats.samples.items()):
+        values = sorted(values)
+        ops[op] = {
+            "count": len(values),
+            "errors": stats.errors.get(op, 0),
+            "p50_ms": percentile(values, 50) * 1000,
+            "p99_ms": percentile(values, 99) * 1000,
+            "p999_ms": percentile(values, 99.9) * 1000,
+            "max_ms": values[-1] * 1000,
+        }
+    notify = sorted(notify_latencies(stats))
+    if notify:
+        ops["idle-notify"] = {
+            "count": len(notify),
+            "errors": 0,
+            "p50_ms": percentile(notify, 50) * 1000,
+            "p99_ms": percentile(notify, 99) * 1000,
+            "p999_ms": percentile(notify, 99.9) * 1000,
+            "max_ms": notify[-1] * 1000,
+        }
+    return {
+        "elapsed_s": elapsed,
+        "commands": stats.commands,
+        "commands_per_s": stats.commands / elapsed if elapsed > 0 else 0.0,
+        "refused_connections": stats.refused,
+        "io_errors": stats.errors.get("io", 0),
+        "ops": ops,
+    }
+
+
+def print_report(result, baseline=None):
+    print("%-14s %8s %6s %10s %10s %10s %10s" % ("operation", "count", "errs", "p50 ms", "p99 ms", "p999 ms", "max ms"))
+    for op, s in result["ops"].items():
+        print("%-14s %8d %6d %10.2f %10.2f %10.2f %10.2f" % (
+            op, s["count"], s["errors"], s["p50_ms"], s["p99_ms"], s["p999_ms"], s["max_ms"]))
+        if baseline and op in baseline["ops"]:
+            b = baseline["ops"][op]
+            print("%-14s %8s %6s %10s %10s %10s %10s" % (
+                "  vs baseline", "", "", ratio(b["p50_ms"], s["p50_ms"]), ratio(b["p99_ms"], s["p99_ms"]),
+                ratio(b["p999_ms"], s["p999_ms"]), ratio(b["max_ms"], s["max_ms"])))
+    print("commands: %d in %.1f s = %.1f cmds/s" % (result["commands"], result["elapsed_s"], result["commands_per_s"]))
+    if baseline:
+        print("throughput vs baseline: %s" % ratio(result["commands_per_s"], baseline["commands_per_s"]))
+    if result["refused_connections"] or result["io_errors"]:
+        print("refused connections: %d, I/O errors: %d" % (result["refused_connections"], result["io_errors"]))
+
+
+def ratio(before, after):
+    """Speedup factor, greater than 1 means the new run is better."""
+    if after <= 0:
+        return "n/a"
+    return "x%.2f" % (before / after)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="CubeRadio MPD load generator")
+    parser.add_argument("--host", default="127.0.0.1", help="device or host build address")
+    parser.add_argument("--port", type=int, default=6600, help="MPD port")
+    parser.add_argument("--mix", default="poll", help="command mix: %s, or op=weight,..." % ", ".join(MIXES))
+    parser.add_argument("--connections", type=int, default=1, help="concurrent command connections")
+    parser.add_argument("--idle-clients", type=int, default=0, help="extra connections parked in idle")
+    parser.add_argument("--duration", type=float, default=10.0, help="run time in seconds")
+    parser.add_argument("--pipeline", type=int, default=1, help="commands sent before reading replies")
+    parser.add_argument("--think", type=float, default=0.0, help="pause between operations in ms")
+    parser.add_argument("--idle-hold", type=float, default=20.0, help="time spent in idle before noidle, ms")
+    parser.add_argument("--timeout", type=float, default=10.0, help="socket timeout in seconds")
+    parser.add_argument("--seed", type=int, default=1, help="random seed")
+    parser.add_argument("--json", help="write results to this file")
+    parser.add_argument("--compare", help="baseline results file to compare against")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    if args.mix in MIXES:
+        mix = MIXES[args.mix]
+    else:
+        mix = []
+        for part in args.mix.split(","):
+            name, _, weight = part.partition("=")
+            mix.append((name.strip(), float(weight or 1)))
+    ops = [op for op, _ in mix]
+    weights = [w for _, w in mix]
+
+    stats = Stats()
+    start = time.perf_counter()
+    deadline = start + args.duration
+    threads = [threading.Thread(target=idle_client, args=(args, stats, deadline)) for _ in range(args.idle_clients)]
+    # Let idle clients settle before the load starts
+    for t in threads:
+        t.start()
+    if threads:
+        time.sleep(0.3)
+    workers = [threading.Thread(target=worker, args=(args, ops, weights, stats, deadline, args.seed + i))
+               for i in range(args.connections)]
+    for t in workers:
+        t.start()
+    for t in workers + threads:
+        t.join()
+    elapsed = time.perf_counter() - start
+
+    result = summarize(stats, elapsed)
+    result["config"] = {k: v for k, v in vars(args).items() if k not in ("json", "compare", "verbose")}
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+    print_report(result, baseline)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+    return 0 if not result["io_errors"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())